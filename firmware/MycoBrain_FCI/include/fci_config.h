@@ -45,6 +45,7 @@
 #define BUZZER_PIN             47  // Audio feedback
 #define STIMULUS_OUT_PIN       4   // DAC output for mycelium stimulation
 #define BUTTON_PIN             0   // Boot button for calibration
+#define ADS1115_ALERT_PIN      5   // ADS1115 ALERT/RDY (open drain, conversion ready)
 
 // ============================================================================
 // ADC CONFIGURATION (ADS1115 - 16-bit differential ADC)
@@ -58,6 +59,10 @@
 #define ADC_CHANNEL_BIO_REF    1   // A2-A3: Reference electrode pair
 #define ADC_CHANNEL_IMPEDANCE  2   // For impedance measurement
 
+// Electrode pairs sampled per frame, indexed by ADC_CHANNEL_BIO_DIFF and
+// ADC_CHANNEL_BIO_REF (the ADS1115 has two differential pairs)
+#define FCI_NUM_CHANNELS       2
+
 // Gain settings for bioelectric signals
 // PGA Gain | Full Scale Range | Resolution
 // 2/3      | ±6.144V          | 187.5 µV
@@ -70,7 +75,15 @@
 
 // Sample rates
 #define ADC_SAMPLE_RATE        128  // Samples per second (SPS)
-#define ADC_BUFFER_SIZE        256  // Samples per buffer (2 seconds @ 128 SPS)
+#define ADC_SAMPLE_FREQ        128.0f  // Same rate as float, for the DSP chain
+#define ADC_BUFFER_SIZE        256  // Frames in the acquisition ring (2 s @ 128 SPS, power of 2)
+
+// Acquisition task: the sample timer only timestamps and wakes it; it
+// runs both conversions, each completion signalled on ADS1115_ALERT_PIN
+#define ACQ_TASK_CORE          1    // Pinned core (with loop(); WiFi runs on 0)
+#define ACQ_TASK_PRIORITY      20   // Above loop() (1) and lwIP (18)
+#define ACQ_TASK_STACK         4096 // Bytes
+#define ACQ_RDY_TIMEOUT_MS     5    // Conversion-ready wait (one takes ~2.1 ms)
 
 // ============================================================================
 // BIOELECTRIC SIGNAL PARAMETERS (Based on Scientific Literature)
@@ -102,6 +115,10 @@
 #define SPIKE_THRESHOLD_SIGMA  3.0f    // Standard deviations for spike detection
 #define SPIKE_MIN_DURATION_MS  5       // Minimum spike duration
 #define SPIKE_REFRACTORY_MS    50      // Refractory period
+#define SPIKE_BASELINE_TAU_MS  10000   // EW mean/deviation time constant
+#define SPIKE_EXIT_RATIO       0.5f    // Spike ends below this fraction of the threshold
+#define SPIKE_MAX_DURATION_MS  5000    // Longer excursions are baseline shifts
+#define SPIKE_EVENT_QUEUE      32      // Events held between sends
 
 // ============================================================================
 // DIGITAL FILTER PARAMETERS
@@ -110,7 +127,17 @@
 // Bandpass filter for bioelectric signals (0.1 - 50 Hz)
 #define FILTER_HIGHPASS_FREQ   0.1f    // High-pass cutoff (Hz)
 #define FILTER_LOWPASS_FREQ    50.0f   // Low-pass cutoff (Hz)
-#define FILTER_ORDER           4       // Butterworth filter order
+#define FILTER_ORDER           4       // Highpass and lowpass order each (even)
+#define FILTER_DESIGN          FILTER_DESIGN_BUTTERWORTH
+#define FILTER_RIPPLE_DB       0.5f    // Passband ripple for Chebyshev designs
+#define FILTER_MAX_SECTIONS    8       // Biquads per cascade
+#define FILTER_USE_Q31         0       // 1 = fixed-point filter path
+
+// IIR prototypes for the runtime SOS designer
+typedef enum {
+    FILTER_DESIGN_BUTTERWORTH = 0,    // Maximally flat passband
+    FILTER_DESIGN_CHEBYSHEV1  = 1     // Equiripple passband, steeper rolloff
+} fci_filter_design_t;
 
 // Notch filter for power line interference
 #define NOTCH_FREQ_50HZ        50.0f   // 50 Hz (Europe/Asia)
@@ -125,6 +152,86 @@
 #define FFT_SAMPLE_FREQ        128.0f  // Hz
 #define FFT_WINDOW_HAMMING     1       // Apply Hamming window
 
+// ============================================================================
+// STREAMING STFT / SPECTROGRAM CONFIGURATION
+// ============================================================================
+
+// Short frames with overlap: 1 Hz bins resolve the 1.5-8 Hz band, and a new
+// column every hop keeps burst detection latency near hop + frame/2.
+#define STFT_FRAME_SAMPLES     128     // 1 s @ 128 SPS, must be power of 2
+#define STFT_HOP_SAMPLES       32      // 75% overlap: one column per 250 ms
+#define STFT_MAX_BINS          32      // Bins kept per column (FREQ_BAND_LOW..MAX)
+#define STFT_COLUMNS_PER_MSG   8       // Columns batched per spectrogram message
+#define STFT_DB_FLOOR          -40.0f  // dB re 1 µV at code 0
+#define STFT_DB_STEP           0.5f    // dB per code step (code 255 = +87.5 dB)
+
+// ============================================================================
+// WELCH PSD CONFIGURATION
+// ============================================================================
+
+// Hann-windowed 50%-overlapped segments, carried across buffers and
+// averaged exponentially: a fixed 2 FFTs per 256-sample buffer.
+#define WELCH_SEGMENT_SAMPLES  256     // 2 s @ 128 SPS (0.5 Hz bins), power of 2
+#define WELCH_HOP_SAMPLES      128     // 50% overlap
+#define WELCH_AVERAGES         8       // Segments in the running average
+
+// ============================================================================
+// TONE TRACKING (SLIDING DFT BANK)
+// ============================================================================
+
+// Per-sample amplitude/phase at a few known frequencies (stimulus, mains,
+// chosen bio tones) for O(k) cost per sample instead of an FFT per buffer.
+#define TONE_MAX_TRACKERS      8
+#define TONE_HISTORY_SAMPLES   512     // Delay line, power of 2 (4 s @ 128 SPS)
+#define TONE_WINDOW_S          1.0f    // Target window, rounded to whole periods
+#define TONE_REFRESH_WINDOWS   16      // Recompute each tracker exactly every N windows
+
+// Spectral analysis paths (bitmask, selectable at runtime)
+typedef enum {
+    SPECTRAL_MODE_FFT      = 0x01,    // Per-buffer FFT + Welch band powers
+    SPECTRAL_MODE_TONES    = 0x02,    // Per-sample tone tracking
+    SPECTRAL_MODE_BOTH     = 0x03
+} fci_spectral_mode_t;
+
+// ============================================================================
+// MULTI-RATE DECIMATION (ULTRA-LOW FREQUENCY BANDS)
+// ============================================================================
+
+// CIC cascade on the unfiltered stream: 128 Hz -> 1 Hz -> 1/60 Hz -> 1/3600 Hz.
+// Each stage keeps its own ring; the last one spans 10.7 days.
+#define DECIM_STAGES           3
+#define DECIM_RATIO_1          128     // 128 Hz -> 1 Hz (nulls mains at 50/60 Hz)
+#define DECIM_RATIO_2          60      // 1 Hz -> 1 per minute
+#define DECIM_RATIO_3          60      // 1 per minute -> 1 per hour
+#define DECIM_CIC_ORDER        3       // Integrator/comb pairs per stage
+#define DECIM_RING_SAMPLES     256     // Ring per stage, power of 2
+#define DECIM_ANALYSIS_HOP     16      // Stage outputs between analyses
+#define DECIM_MIN_ANALYSIS     32      // Ring samples before the first analysis
+#define DECIM_UNITS_PER_UV     100.0f  // CIC integer units (0.01 µV)
+
+// ============================================================================
+// FEATURE HISTORY (ROUND-ROBIN TIERS IN PSRAM)
+// ============================================================================
+
+// Full feature vectors for the recent past, then min/max/mean buckets.
+// About 1 MB in total, allocated from PSRAM when the board has it.
+#define HISTORY_RAW_RECORDS    10800   // 6 h of 2-s feature vectors
+#define HISTORY_MINUTE_RECORDS 1440    // 24 h of 1-minute buckets
+#define HISTORY_HOUR_RECORDS   720     // 30 days of 1-hour buckets
+#define HISTORY_DAY_RECORDS    366     // 1 year of 1-day buckets
+#define HISTORY_METRICS        10      // Consolidated metrics per bucket
+#define HISTORY_POINTS_PER_MSG 240     // Records per history response page
+#define HISTORY_DEFAULT_POINTS 1000    // Auto tier selection target
+
+// History tiers, finest first
+typedef enum {
+    HISTORY_TIER_RAW       = 0,
+    HISTORY_TIER_MINUTE    = 1,
+    HISTORY_TIER_HOUR      = 2,
+    HISTORY_TIER_DAY       = 3,
+    HISTORY_TIER_COUNT     = 4
+} fci_history_tier_t;
+
 // ============================================================================
 // ENVIRONMENTAL SENSOR CONFIGURATION (BME688)
 // ============================================================================
@@ -184,6 +291,43 @@ typedef enum {
 #define WS_RECONNECT_DELAY_MS    3000
 #define WS_HEARTBEAT_INTERVAL_MS 30000
 
+// ============================================================================
+// TASK PIPELINE (DUAL CORE)
+// ============================================================================
+
+// acquisition (core 1, ACQ_TASK_PRIORITY) -> frame ring -> DSP (core 1)
+//   -> ping-pong output blocks -> encoder (core 0) -> message queue
+//   -> network (core 0); loop() keeps only the BME688 and the LED
+#define PIPE_DSP_CORE          1
+#define PIPE_DSP_PRIORITY      10      // Below acquisition, above loop()
+#define PIPE_DSP_STACK         8192
+#define PIPE_NET_CORE          0       // With the WiFi and lwIP tasks
+#define PIPE_NET_PRIORITY      5       // Keeps webSocket.loop() ahead of encoding
+#define PIPE_NET_STACK         8192
+#define PIPE_ENCODER_CORE      0
+#define PIPE_ENCODER_PRIORITY  4
+#define PIPE_ENCODER_STACK     8192
+
+#define PIPE_BLOCK_FRAMES      16      // DSP output block: 125 ms @ 128 SPS
+#define PIPE_BLOCK_SLOTS       2       // Ping-pong: DSP fills one, encoder drains the other
+#define PIPE_ENCODER_QUEUE     8       // Blocks, calibration results, history queries
+#define PIPE_NET_QUEUE         16      // Serialized messages waiting to be sent
+#define PIPE_COMMAND_QUEUE     4       // Commands waiting for the DSP task
+#define PIPE_DSP_IDLE_MS       10      // DSP wake-up without frames (commands)
+#define PIPE_NET_POLL_MS       5       // webSocket.loop() period when idle
+#define PIPE_BULK_WAIT_MS      100     // History pages wait this long for queue space
+#define PIPE_STATS_WINDOW_MS   2000    // Stage load averaging window
+#define PIPE_LED_FRAME_MS      20      // loop() period
+
+// Pipeline stages, for FCIStageStats
+typedef enum {
+    STAGE_ACQUIRE          = 0,
+    STAGE_DSP              = 1,
+    STAGE_ENCODE           = 2,
+    STAGE_NETWORK          = 3,
+    STAGE_COUNT            = 4
+} fci_stage_t;
+
 // ============================================================================
 // STIMULATION PARAMETERS (Write-back to mycelium)
 // ============================================================================
@@ -220,6 +364,23 @@ typedef struct __attribute__((packed)) {
     uint8_t  flags;           // Status flags
 } fci_sample_t;
 
+// One acquisition frame: a conversion of every electrode pair
+typedef struct {
+    int64_t  timestamp_us;    // esp_timer time of the sample tick
+    int16_t  raw[FCI_NUM_CHANNELS]; // Raw ADC values, indexed by ADC_CHANNEL_*
+} fci_frame_t;
+
+// Load and input-queue figures of one pipeline stage
+typedef struct {
+    float    busy_pct;        // Wall time spent awake and working (last window)
+    float    runs_per_s;      // Wake-ups with work (last window)
+    uint32_t max_run_us;      // Longest single run (last window)
+    uint16_t queue_now;       // Input queue occupancy at the last run
+    uint16_t queue_peak;      // Peak occupancy (last window)
+    uint16_t queue_capacity;
+    uint32_t drops;           // Items refused at the input (since boot)
+} fci_stage_stats_t;
+
 // Processed signal features
 typedef struct {
     float amplitude_uv;       // Peak-to-peak amplitude
@@ -231,8 +392,72 @@ typedef struct {
     float snr_db;            // Signal-to-noise ratio
     fci_pattern_t pattern;   // Detected pattern type
     float pattern_confidence; // 0.0 - 1.0
+    
+    // Welch band powers (µV²) and fractions of FREQ_BAND_LOW..Nyquist power
+    float band_power_low;    // FREQ_BAND_LOW..MID
+    float band_power_bio;    // FREQ_BAND_MID..HIGH (biological signature)
+    float band_power_high;   // FREQ_BAND_HIGH..MAX
+    float band_rel_low;
+    float band_rel_bio;
+    float band_rel_high;
 } fci_features_t;
 
+// One detected spike (sample indices count frames since boot)
+typedef struct {
+    uint32_t peak_sample;     // Frame index of the peak
+    uint16_t width_samples;   // Samples from onset to exit
+    uint8_t  channel;
+    int8_t   polarity;        // +1 or -1
+    float    amplitude_uv;    // Peak deviation from the EW baseline
+    float    threshold_uv;    // Threshold at onset
+} fci_spike_t;
+
+// One spectrogram column (STFT frame), restricted to FREQ_BAND_LOW..MAX
+typedef struct {
+    uint32_t end_sample;      // Index of the newest sample in the frame
+    uint8_t  n_bins;          // Valid entries in bins[]
+    uint8_t  bins[STFT_MAX_BINS]; // Log-magnitude codes, lowest bin first
+    float band_low_db;       // FREQ_BAND_LOW..MID amplitude (dB re 1 µV)
+    float band_bio_db;       // FREQ_BAND_MID..HIGH (biological signature)
+    float band_high_db;      // FREQ_BAND_HIGH..MAX
+} fci_spectrogram_column_t;
+
+// Slow-band summary of one decimation stage (over its whole ring)
+typedef struct {
+    float rate_hz;           // Stage output rate
+    uint16_t samples;        // Ring samples analyzed
+    float mean_uv;
+    float std_uv;            // After removing the linear trend
+    float min_uv;
+    float max_uv;
+    float slope_uv_per_h;    // Linear drift
+    float dominant_period_s; // Strongest oscillation (0 if none)
+    float dominant_amp_uv;   // Its sinusoid amplitude
+    float dominant_rel;      // Fraction of detrended power within ±1 bin
+} fci_slow_features_t;
+
+// Tracked tone (sliding DFT output)
+typedef struct {
+    float freq_hz;           // Tracked frequency
+    float amplitude_uv;      // Sinusoid amplitude over the window
+    float phase_rad;         // Cosine phase at the newest sample
+} fci_tone_t;
+
+// Full-resolution history record
+typedef struct {
+    uint32_t t_s;             // Device time (seconds since boot)
+    fci_features_t features;
+} fci_history_raw_t;
+
+// Consolidated history bucket
+typedef struct {
+    uint32_t t_s;             // Bucket start (seconds since boot)
+    uint16_t count;           // Feature vectors merged
+    float min[HISTORY_METRICS];
+    float max[HISTORY_METRICS];
+    float mean[HISTORY_METRICS];
+} fci_history_bucket_t;
+
 // Full telemetry packet
 typedef struct {
     char device_id[16];       // e.g., "FCI-001"
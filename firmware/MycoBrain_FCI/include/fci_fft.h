@@ -0,0 +1,105 @@
+/**
+ * FCI FFT - Real-input FFT engine
+ *
+ * In-place real FFT for the bioelectric spectral features:
+ * - n-point real transform computed as an n/2-point complex FFT plus a
+ *   split step (X[k] from Z[k] and Z[n/2-k])
+ * - Radix-2 DIT with precomputed per-stage twiddles and a bit-reversal
+ *   swap table, so the hot loops do no trig and no index arithmetic
+ * - Float and Q15 variants; float butterflies use esp-dsp on ESP32-S3
+ *   (when the component is available), SSE2 on x86 hosts and NEON on
+ *   AArch64 hosts, with a portable scalar fallback
+ *
+ * No Arduino dependencies: the same file builds in tools/host for the
+ * benchmark and correctness checks.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_FFT_H
+#define FCI_FFT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FCI_FFT_MIN_SIZE       4
+#define FCI_FFT_MAX_SIZE       8192    // Bit-reversal table holds uint16 indices
+
+// ============================================================================
+// REAL FFT CLASS
+// ============================================================================
+
+/**
+ * Packed spectrum layout (float and Q15), n real inputs -> n outputs:
+ *   x[0]            X[0]      (real)
+ *   x[1]            X[n/2]    (real, Nyquist)
+ *   x[2k], x[2k+1]  Re, Im of X[k] for 0 < k < n/2
+ */
+class FCIRealFFT {
+public:
+    FCIRealFFT();
+    ~FCIRealFFT();
+
+    /**
+     * Build twiddle and bit-reversal tables for n-point transforms
+     * @param n Transform size, power of 2 in [FCI_FFT_MIN_SIZE, FCI_FFT_MAX_SIZE]
+     * @return true if successful (false on bad size or out of memory)
+     */
+    bool begin(size_t n);
+
+    /**
+     * Release the tables
+     */
+    void end();
+
+    /**
+     * Forward real FFT, in place
+     * @param x n real samples in, packed spectrum out (unscaled)
+     */
+    void forward(float* x) const;
+
+    /**
+     * Forward real FFT in Q15, in place
+     * Every stage halves its outputs, so the result is X[k] / n and
+     * cannot overflow.
+     * @param x n Q15 samples in, packed spectrum / n out
+     */
+    void forwardQ15(int16_t* x) const;
+
+    /**
+     * Power spectrum from a packed float spectrum
+     * @param packed Output of forward()
+     * @param power Output |X[k]|^2 for k = 0 .. n/2 (n/2 + 1 values)
+     */
+    void powerSpectrum(const float* packed, float* power) const;
+
+    /**
+     * Transform size set by begin(), 0 if not initialized
+     */
+    size_t size() const { return _n; }
+
+    /**
+     * Name of the float butterfly backend in use
+     * @return "esp-dsp", "sse2", "neon" or "scalar"
+     */
+    const char* backend() const;
+
+private:
+    size_t _n;                 // Real points
+    size_t _m;                 // Complex points (n / 2)
+    bool _use_esp_dsp;         // Float core runs on esp-dsp
+
+    float* _stage_tw;          // Per-stage twiddles: half-span h at [2(h-1), 2(2h-1))
+    float* _split_tw;          // W_n^k for k = 0 .. m/2 (cos, -sin)
+    int16_t* _tw_q15;          // W_m^j for j < m/2 (Q15)
+    int16_t* _split_q15;       // W_n^k for k = 0 .. m/2 (Q15)
+    uint16_t* _bitrev;         // Swap pairs (i, j), i < j
+    size_t _n_swaps;
+
+    void complexForward(float* z) const;
+    void complexForwardQ15(int16_t* z) const;
+    void splitReal(float* z) const;
+    void splitRealQ15(int16_t* z) const;
+};
+
+#endif // FCI_FFT_H
@@ -0,0 +1,111 @@
+/**
+ * FCI History - Tiered round-robin feature history
+ *
+ * Round-robin-database layout for the 2-second feature vectors:
+ * - Raw tier: full fci_features_t records (HISTORY_RAW_RECORDS)
+ * - Minute/hour/day tiers: min/max/mean buckets of HISTORY_METRICS
+ *   metrics, each consolidated directly from the incoming vectors
+ * - Fixed-size rings, allocated once (PSRAM on BOARD_HAS_PSRAM boards);
+ *   the oldest record in a full tier is overwritten
+ * - Time-range queries by binary search; the open bucket of a tier is
+ *   returned as its newest record
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_HISTORY_H
+#define FCI_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+
+// ============================================================================
+// FEATURE HISTORY CLASS
+// ============================================================================
+
+class FCIFeatureHistory {
+public:
+    FCIFeatureHistory();
+    ~FCIFeatureHistory();
+
+    /**
+     * Allocate all tiers
+     * @return true if successful
+     */
+    bool begin();
+
+    /**
+     * Record one feature vector
+     * @param t_s Device time in seconds (non-decreasing)
+     * @param features Feature vector
+     */
+    void add(uint32_t t_s, const fci_features_t* features);
+
+    /**
+     * Number of records in [from_s, to_s] (open bucket included)
+     */
+    size_t count(fci_history_tier_t tier, uint32_t from_s, uint32_t to_s) const;
+
+    /**
+     * Finest tier that reaches back to from_s with at most max_points
+     * records in the range, else the coarsest tier
+     */
+    fci_history_tier_t selectTier(uint32_t from_s, uint32_t to_s, size_t max_points) const;
+
+    /**
+     * Copy raw records in [from_s, to_s], oldest first
+     * @param skip Matching records to skip (paging)
+     * @param out Destination
+     * @param max_records Capacity of out
+     * @return Records copied
+     */
+    size_t queryRaw(uint32_t from_s, uint32_t to_s, size_t skip,
+                    fci_history_raw_t* out, size_t max_records) const;
+
+    /**
+     * Copy consolidated buckets starting in [from_s, to_s], oldest first
+     * @param tier HISTORY_TIER_MINUTE, _HOUR or _DAY
+     * @return Records copied
+     */
+    size_t queryBuckets(fci_history_tier_t tier, uint32_t from_s, uint32_t to_s, size_t skip,
+                        fci_history_bucket_t* out, size_t max_records) const;
+
+    /**
+     * Bucket length of a tier in seconds (0 for the raw tier)
+     */
+    uint32_t bucketSeconds(fci_history_tier_t tier) const;
+
+    /**
+     * Oldest stored time of a tier (0 if empty)
+     */
+    uint32_t oldest(fci_history_tier_t tier) const;
+
+    /**
+     * Consolidated metric values of a feature vector / their names
+     */
+    static void metrics(const fci_features_t* features, float* out);
+    static const char* metricName(size_t index);
+    static const char* tierName(fci_history_tier_t tier);
+
+private:
+    struct Ring {
+        uint8_t* data;
+        size_t record_size;
+        size_t capacity;
+        size_t head;          // Next write position
+        size_t count;
+    };
+
+    Ring _rings[HISTORY_TIER_COUNT];
+    fci_history_bucket_t _open[HISTORY_TIER_COUNT];  // Buckets being filled
+    bool _open_valid[HISTORY_TIER_COUNT];
+
+    const uint8_t* record(const Ring& r, size_t index) const;  // 0 = oldest
+    void push(Ring& r, const void* rec);
+    uint32_t recordTime(const Ring& r, size_t index) const;
+    size_t lowerBound(const Ring& r, uint32_t t_s) const;
+    void closeBucket(size_t tier);
+};
+
+#endif // FCI_HISTORY_H
@@ -0,0 +1,94 @@
+/**
+ * FCI Multi-Rate - Decimation cascade for ultra-low-frequency bands
+ *
+ * Continuously downsamples one channel so oscillations with periods of
+ * minutes to days can be resolved in a few KB:
+ * - DECIM_STAGES CIC decimators in series (128 Hz -> 1 Hz -> 1/60 Hz ->
+ *   1/3600 Hz by default), integer arithmetic, no multiplies per sample
+ * - Each stage writes its output into its own DECIM_RING_SAMPLES ring
+ * - Every DECIM_ANALYSIS_HOP outputs a stage re-analyzes its ring:
+ *   mean/std/min/max, linear drift, and the dominant period from a
+ *   detrended, Hann-windowed FFT
+ *
+ * Fed before the bandpass: the 0.1 Hz highpass would remove exactly the
+ * bands tracked here.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_MULTIRATE_H
+#define FCI_MULTIRATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+#include "fci_fft.h"
+
+// ============================================================================
+// MULTI-RATE CLASS
+// ============================================================================
+
+class FCIMultiRate {
+public:
+    FCIMultiRate();
+    ~FCIMultiRate();
+
+    /**
+     * Allocate stage rings and the analysis FFT
+     * @param sample_rate Input samples per second
+     * @return true if successful
+     */
+    bool begin(float sample_rate = ADC_SAMPLE_FREQ);
+
+    /**
+     * Add one input sample; runs every stage it reaches
+     * @param value_uv Sample in µV
+     * @return Bitmask of stages whose features were just updated
+     */
+    uint8_t addSample(float value_uv);
+
+    /**
+     * Latest analysis of a stage
+     * @param stage Stage index (0 = fastest)
+     * @param out Output features
+     * @return true if the stage has been analyzed at least once
+     */
+    bool getFeatures(size_t stage, fci_slow_features_t* out) const;
+
+    /**
+     * Copy a stage's ring, oldest first
+     * @param stage Stage index
+     * @param out Destination (DECIM_RING_SAMPLES entries)
+     * @return Number of samples copied
+     */
+    size_t getHistory(size_t stage, float* out) const;
+
+    float stageRate(size_t stage) const;
+    size_t stages() const { return DECIM_STAGES; }
+
+private:
+    struct Stage {
+        uint32_t ratio;
+        uint32_t phase;                       // Inputs since the last output
+        uint32_t warmup;                      // Outputs dropped while settling
+        uint64_t integrator[DECIM_CIC_ORDER]; // Modular: wrap-around cancels
+        uint64_t comb[DECIM_CIC_ORDER];       // Previous integrator outputs
+        int64_t gain;                         // ratio^order
+        float rate_hz;
+        float* ring;
+        size_t head;
+        size_t filled;
+        size_t since_analysis;
+        bool analyzed;
+        fci_slow_features_t features;
+    };
+
+    Stage _stages[DECIM_STAGES];
+    FCIRealFFT _fft;
+    float* _scratch;   // Analysis frame, zero-padded to DECIM_RING_SAMPLES
+
+    bool cicStep(Stage& s, int64_t input, int64_t* output);
+    void analyze(Stage& s);
+};
+
+#endif // FCI_MULTIRATE_H
@@ -0,0 +1,84 @@
+/**
+ * FCI Pipeline - Per-stage load and queue accounting
+ *
+ * One FCIStageStats per pipeline task (fci_stage_t):
+ * - The stage brackets each run with enter()/leave() and samples its
+ *   input queue with queueLevel(); only the stage itself writes these
+ * - Every PIPE_STATS_WINDOW_MS the stage publishes busy share, run rate,
+ *   longest run and peak occupancy for that window
+ * - Producers count refused items with drop() (atomic, any task)
+ * - Readers take snapshot(); fields are individually consistent, not
+ *   as a set, which is enough for reporting
+ *
+ * Busy time is wall time between enter() and leave(), so a stage that
+ * blocks mid-run (I2C, ALERT/RDY) counts the wait: for a fixed-rate
+ * stage that is exactly its share of the period.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_PIPELINE_H
+#define FCI_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "fci_config.h"
+
+// ============================================================================
+// STAGE STATISTICS CLASS
+// ============================================================================
+
+class FCIStageStats {
+public:
+    FCIStageStats();
+
+    /**
+     * Name the stage and start the first window
+     * @param name Stage name for reports
+     * @param queue_capacity Input queue capacity (0 = none)
+     * @param now_us Current time (µs)
+     */
+    void begin(const char* name, size_t queue_capacity, int64_t now_us);
+
+    /**
+     * Bracket one run of the stage
+     */
+    void enter(int64_t now_us);
+    void leave(int64_t now_us);
+
+    /**
+     * Input queue occupancy seen by the stage at the start of a run
+     */
+    void queueLevel(size_t used);
+
+    /**
+     * Count items refused at this stage's input (called by producers)
+     */
+    void drop(uint32_t count = 1) { _drops.fetch_add(count, std::memory_order_relaxed); }
+
+    void snapshot(fci_stage_stats_t* out) const;
+    const char* name() const { return _name; }
+
+private:
+    const char* _name;
+
+    // Current window (stage task only)
+    int64_t _window_start_us;
+    int64_t _run_start_us;
+    int64_t _busy_us;
+    uint32_t _runs;
+    uint32_t _max_run_us;
+    uint16_t _queue_peak;
+
+    // Published
+    volatile float _busy_pct;
+    volatile float _runs_per_s;
+    volatile uint32_t _pub_max_run_us;
+    volatile uint16_t _queue_now;
+    volatile uint16_t _pub_queue_peak;
+    uint16_t _queue_capacity;
+    std::atomic<uint32_t> _drops;
+};
+
+#endif // FCI_PIPELINE_H
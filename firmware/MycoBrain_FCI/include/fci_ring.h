@@ -0,0 +1,88 @@
+/**
+ * FCI Ring - Lock-free single-producer/single-consumer frame ring
+ *
+ * Hands timestamped ADC frames from the acquisition task to the
+ * processing loop without critical sections:
+ * - Exactly one producer (push) and one consumer (pop), on any cores
+ * - Free-running 32-bit head/tail counters; the producer only writes
+ *   head, the consumer only writes tail, each published with
+ *   release/acquire ordering after (before) the slot access
+ * - Capacity ADC_BUFFER_SIZE (power of 2); a push into a full ring is
+ *   refused and counted, never overwrites unread frames
+ * - High-water mark of occupancy for sizing
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_RING_H
+#define FCI_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "fci_config.h"
+
+static_assert((ADC_BUFFER_SIZE & (ADC_BUFFER_SIZE - 1)) == 0,
+              "ADC_BUFFER_SIZE must be a power of 2");
+
+// ============================================================================
+// FRAME RING CLASS
+// ============================================================================
+
+class FCIFrameRing {
+public:
+    FCIFrameRing() : _head(0), _tail(0), _overruns(0), _high_water(0) {}
+
+    /**
+     * Producer: append a frame
+     * @return false if the ring was full (frame dropped, overrun counted)
+     */
+    bool push(const fci_frame_t& frame) {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t used = head - _tail.load(std::memory_order_acquire);
+        if (used >= ADC_BUFFER_SIZE) {
+            _overruns.store(_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        _frames[head & (ADC_BUFFER_SIZE - 1)] = frame;
+        _head.store(head + 1, std::memory_order_release);
+        if (used + 1 > _high_water.load(std::memory_order_relaxed)) {
+            _high_water.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * Consumer: take the oldest frame
+     * @return false if the ring was empty
+     */
+    bool pop(fci_frame_t* frame) {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *frame = _frames[tail & (ADC_BUFFER_SIZE - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Frames waiting (exact from either side, approximate elsewhere)
+     */
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return ADC_BUFFER_SIZE; }
+    uint32_t overruns() const { return _overruns.load(std::memory_order_relaxed); }
+    uint32_t highWater() const { return _high_water.load(std::memory_order_relaxed); }
+
+private:
+    fci_frame_t _frames[ADC_BUFFER_SIZE];
+    std::atomic<uint32_t> _head;        // Written by the producer only
+    std::atomic<uint32_t> _tail;        // Written by the consumer only
+    std::atomic<uint32_t> _overruns;    // Producer-side counters
+    std::atomic<uint32_t> _high_water;
+};
+
+#endif // FCI_RING_H
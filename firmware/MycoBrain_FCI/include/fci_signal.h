@@ -2,10 +2,16 @@
  * FCI Signal Processing - Bioelectric Signal Analysis
  * 
  * Implements signal processing algorithms for mycelium bioelectric analysis:
- * - Digital filtering (bandpass, notch)
+ * - FCI_NUM_CHANNELS electrode pairs per frame; features per channel
+ * - Digital filtering: runtime-designed SOS cascade (highpass, lowpass,
+ *   retunable notch) fused into one pass, vectorized across channels
  * - FFT spectral analysis
+ * - Welch PSD band powers (FREQ_BAND_* ranges)
+ * - Per-sample tone tracking (stimulus, mains) via a sliding DFT bank
+ * - Ultra-low-frequency bands via a CIC decimation cascade
  * - Pattern detection based on GFST
- * - Spike detection (action potential-like events)
+ * - Online spike detection (action potential-like events) with
+ *   EW baselines, emitting per-spike events
  * 
  * Physics basis: Ion channel dynamics, membrane potentials
  * Signal model: Quasi-periodic oscillations with spike events
@@ -18,6 +24,12 @@
 
 #include <Arduino.h>
 #include "fci_config.h"
+#include "fci_fft.h"
+#include "fci_sos.h"
+#include "fci_welch.h"
+#include "fci_tones.h"
+#include "fci_multirate.h"
+#include "fci_spike.h"
 
 // ============================================================================
 // SIGNAL PROCESSING CLASS
@@ -36,16 +48,17 @@ public:
     bool begin(float sample_rate = ADC_SAMPLE_FREQ);
     
     /**
-     * Add a new raw sample to the processing buffer
-     * @param raw_value Raw ADC value (16-bit signed)
-     * @param timestamp_ms Sample timestamp
+     * Add one frame (a sample from every channel) to the processing buffer,
+     * filter it and run the spike detector on it
+     * @param raw Raw ADC values (16-bit signed), FCI_NUM_CHANNELS entries
+     * @param timestamp_ms Frame timestamp
      * @return true if buffer is ready for processing
      */
-    bool addSample(int16_t raw_value, uint32_t timestamp_ms);
+    bool addFrame(const int16_t* raw, uint32_t timestamp_ms);
     
     /**
-     * Process the current buffer and extract features
-     * @param features Output structure for extracted features
+     * Process the current buffer and extract features for every channel
+     * @param features Output array, FCI_NUM_CHANNELS entries
      * @return true if processing successful
      */
     bool processBuffer(fci_features_t* features);
@@ -59,31 +72,39 @@ public:
     float rawToMicrovolts(int16_t raw_value, uint8_t gain = ADC_GAIN_BIOELECTRIC);
     
     /**
-     * Apply bandpass filter to signal
-     * @param input Input signal array
-     * @param output Output signal array
-     * @param length Signal length
+     * Apply the filter cascade (bandpass + power line notch) to all channels
+     * Buffers hold interleaved frames: [i * FCI_NUM_CHANNELS + channel]
+     * @param input Input frames
+     * @param output Output frames (may equal input)
+     * @param length Number of frames
      */
-    void applyBandpassFilter(float* input, float* output, size_t length);
+    void applyFilters(const float* input, float* output, size_t length);
     
     /**
-     * Apply notch filter for power line interference
-     * @param input Input signal array
-     * @param output Output signal array
-     * @param length Signal length
-     * @param notch_freq 50 or 60 Hz
+     * Retune the power line notch (filter state is kept)
+     * @param notch_freq NOTCH_FREQ_50HZ or NOTCH_FREQ_60HZ
+     * @return true if successful
      */
-    void applyNotchFilter(float* input, float* output, size_t length, float notch_freq);
+    bool setNotchFrequency(float notch_freq);
+    float getNotchFrequency() { return _notch_freq; }
     
     /**
      * Compute FFT and extract spectral features
+     * Hamming-windowed real FFT, in place in the FFT buffer
      * @param signal Time-domain signal
-     * @param length Signal length (must be power of 2)
+     * @param length Signal length (must equal the buffer size)
      * @param dominant_freq Output dominant frequency
      * @param total_power Output total spectral power
      */
     void computeFFT(float* signal, size_t length, float* dominant_freq, float* total_power);
     
+    /**
+     * Fill per-band absolute and relative powers from the Welch PSD
+     * @param channel Channel index
+     * @param features Output structure (band_* fields)
+     */
+    void computeBandPowers(size_t channel, fci_features_t* features);
+    
     /**
      * Detect pattern type from signal features
      * @param features Extracted features
@@ -91,16 +112,6 @@ public:
      */
     fci_pattern_t detectPattern(const fci_features_t* features);
     
-    /**
-     * Detect spike events (action potential-like)
-     * @param signal Input signal
-     * @param length Signal length
-     * @param spike_times Output array of spike timestamps
-     * @param max_spikes Maximum spikes to detect
-     * @return Number of spikes detected
-     */
-    int detectSpikes(float* signal, size_t length, uint32_t* spike_times, size_t max_spikes);
-    
     /**
      * Compute signal quality metric
      * @param signal Input signal
@@ -118,9 +129,35 @@ public:
      */
     float computeImpedance(float stimulus_amp, float response_amp, float frequency);
     
-    // Buffer access
-    float* getRawBuffer() { return _raw_buffer; }
-    float* getFilteredBuffer() { return _filtered_buffer; }
+    /**
+     * Select spectral paths (FFT + Welch, tone bank, or both)
+     * Disabled paths cost nothing; their feature fields read 0.
+     * @param mode fci_spectral_mode_t bitmask
+     */
+    void setSpectralMode(uint8_t mode) { _spectral_mode = mode; }
+    uint8_t getSpectralMode() { return _spectral_mode; }
+    
+    /**
+     * Tone bank, fed with raw µV samples of ADC_CHANNEL_BIO_DIFF
+     * from addFrame()
+     */
+    FCIToneBank& tones() { return _tones; }
+    
+    /**
+     * Decimation cascade (minutes to days), fed with unfiltered µV
+     * samples of ADC_CHANNEL_BIO_DIFF from addFrame()
+     */
+    FCIMultiRate& slowBands() { return _slow; }
+    
+    /**
+     * Spike detector, run over each filtered frame by addFrame();
+     * pop() its events after each frame or block of frames
+     */
+    FCISpikeDetector& spikes() { return _spikes; }
+    
+    // Buffer access (raw: interleaved frames; filtered: one array per channel)
+    float* getRawBuffer() { return _raw_frames; }
+    float* getFilteredBuffer(size_t channel) { return _filtered[channel]; }
     size_t getBufferSize() { return _buffer_size; }
     size_t getSampleCount() { return _sample_count; }
     
@@ -130,35 +167,38 @@ private:
     size_t _buffer_size;
     
     // Buffers
-    float* _raw_buffer;
-    float* _filtered_buffer;
+    float* _raw_frames;      // Interleaved: [i * FCI_NUM_CHANNELS + channel]
+    float* _work_frames;     // Filtered frames, written by addFrame() (interleaved)
+    float* _filtered[FCI_NUM_CHANNELS]; // Per-channel filtered signal
+    float* _filtered_block;  // Backing store for _filtered
     float* _fft_buffer;
+    float* _window;          // Hamming window, computed in begin()
     size_t _sample_count;
     size_t _buffer_index;
     
-    // Filter state variables (IIR biquad sections)
-    float _hp_state[4];  // Highpass filter state
-    float _lp_state[4];  // Lowpass filter state
-    float _notch_state[4]; // Notch filter state
-    
-    // Filter coefficients (computed in begin())
-    float _hp_b[3], _hp_a[3];  // Highpass coefficients
-    float _lp_b[3], _lp_a[3];  // Lowpass coefficients
-    float _notch_b[3], _notch_a[3]; // Notch coefficients
-    
-    // Statistics for adaptive thresholding
-    float _running_mean;
-    float _running_std;
-    uint32_t _total_samples;
-    
-    // Spike detection state
-    uint32_t _last_spike_time;
+    // Filter cascade: highpass, lowpass, notch (designed in begin())
+    FCISOSFilter _filter;
+    int _notch_section;
+    float _notch_freq;
+#if FILTER_USE_Q31
+    int32_t* _q31_frames;    // Fixed-point copy of the frames being filtered
+#endif
+    
+    // Spectral analysis
+    FCIRealFFT _fft;
+    FCIWelchPSD _welch[FCI_NUM_CHANNELS]; // Averaged across buffers
+    FCIToneBank _tones;      // Per-sample tone tracking
+    FCIMultiRate _slow;      // Ultra-low-frequency decimation cascade
+    uint8_t _spectral_mode;  // fci_spectral_mode_t bitmask
+    
+    // Spike detection on the filtered frames (per-channel EW baselines)
+    FCISpikeDetector _spikes;
+    uint32_t _total_samples; // Frames since boot
     
     // Helper methods
     void computeFilterCoefficients();
-    float applyBiquadSection(float input, float* b, float* a, float* state);
+    void computeChannelFeatures(size_t channel, fci_features_t* features);
     void computeWindowFunction(float* window, size_t length);
-    void updateRunningStats(float value);
 };
 
 // ============================================================================
@@ -0,0 +1,111 @@
+/**
+ * FCI SOS - Cascaded second-order-section IIR filters
+ *
+ * Runtime-designed IIR cascades for the bioelectric chain:
+ * - Butterworth or Chebyshev type I highpass/lowpass of any even order,
+ *   from the analog prototype's poles via the bilinear transform
+ * - Notch sections (retunable in place, e.g. 50 <-> 60 Hz)
+ * - All sections run fused in one pass over a buffer of interleaved
+ *   frames, one state lane per channel (FCI_NUM_CHANNELS)
+ * - Float path (Direct Form II Transposed) and Q31 path (Direct Form I,
+ *   64-bit accumulator, per-section coefficient shift)
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_SOS_H
+#define FCI_SOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+
+// ============================================================================
+// SOS CASCADE CLASS
+// ============================================================================
+
+class FCISOSFilter {
+public:
+    FCISOSFilter();
+
+    /**
+     * Remove all sections and zero the state
+     */
+    void clear();
+
+    /**
+     * Zero the state of every section (float and Q31)
+     */
+    void reset();
+
+    /**
+     * Append a lowpass of the given design and order
+     * Chebyshev cutoff is the passband (ripple) edge, Butterworth -3 dB.
+     * @param design Butterworth or Chebyshev type I
+     * @param order Filter order (even, one section per 2)
+     * @param cutoff_hz Cutoff frequency (0 < fc < fs / 2)
+     * @param sample_rate Samples per second
+     * @param ripple_db Passband ripple (Chebyshev only)
+     * @return Index of the first added section, or -1 if rejected
+     */
+    int addLowpass(fci_filter_design_t design, int order, float cutoff_hz,
+                   float sample_rate, float ripple_db = FILTER_RIPPLE_DB);
+
+    /**
+     * Append a highpass; parameters as addLowpass()
+     * @return Index of the first added section, or -1 if rejected
+     */
+    int addHighpass(fci_filter_design_t design, int order, float cutoff_hz,
+                    float sample_rate, float ripple_db = FILTER_RIPPLE_DB);
+
+    /**
+     * Append a notch section
+     * @param notch_hz Center frequency
+     * @param q Quality factor (center / -3 dB bandwidth)
+     * @param sample_rate Samples per second
+     * @return Section index, or -1 if rejected
+     */
+    int addNotch(float notch_hz, float q, float sample_rate);
+
+    /**
+     * Retune a notch section in place; its state is kept
+     * @return true if successful
+     */
+    bool setNotch(size_t section, float notch_hz, float q, float sample_rate);
+
+    /**
+     * Filter interleaved frames through every section (float)
+     * @param input Frames [i * FCI_NUM_CHANNELS + channel]
+     * @param output Output frames (may equal input)
+     * @param frames Number of frames
+     */
+    void process(const float* input, float* output, size_t frames);
+
+    /**
+     * Filter interleaved Q31 frames through every section (fixed point)
+     * Keeps its own state, separate from process().
+     */
+    void processQ31(const int32_t* input, int32_t* output, size_t frames);
+
+    size_t sections() const { return _count; }
+
+private:
+    struct Section {
+        float b0, b1, b2, a1, a2;        // a0 normalized to 1
+        int32_t qb0, qb1, qb2, qa1, qa2; // Coefficients * 2^(31 - q_shift)
+        uint8_t q_shift;                 // |coefficients| < 2^q_shift
+    };
+
+    Section _sections[FILTER_MAX_SECTIONS];
+    size_t _count;
+
+    float _state[FILTER_MAX_SECTIONS][2][FCI_NUM_CHANNELS];       // DF2T s1, s2
+    int32_t _state_q31[FILTER_MAX_SECTIONS][4][FCI_NUM_CHANNELS]; // DF1 x1, x2, y1, y2
+
+    int addPrototype(bool highpass, fci_filter_design_t design, int order,
+                     float cutoff_hz, float sample_rate, float ripple_db);
+    void setSection(Section& s, double b0, double b1, double b2,
+                    double a0, double a1, double a2);
+};
+
+#endif // FCI_SOS_H
@@ -0,0 +1,105 @@
+/**
+ * FCI Spike - Online adaptive spike detector
+ *
+ * Streaming detection over the filtered frames, every channel, one pass:
+ * - Baseline and spread are exponentially weighted (SPIKE_BASELINE_TAU_MS)
+ *   mean and mean absolute deviation, frozen while a spike is open so
+ *   the spike does not raise its own threshold
+ * - Threshold: SPIKE_THRESHOLD_SIGMA sigma, sigma estimated as
+ *   1.2533 x mean absolute deviation (exact for Gaussian noise, far less
+ *   pulled up by spikes than a running variance)
+ * - A spike opens when |x - mean| crosses the threshold outside the
+ *   refractory period, and closes below SPIKE_EXIT_RATIO x threshold or
+ *   on a polarity change; it is kept if it lasted SPIKE_MIN_DURATION_MS
+ * - Peak amplitude, peak sample and width (onset to exit) are
+ *   tracked while the spike is open, so events need no look-back
+ * - Events wait in a fixed queue of SPIKE_EVENT_QUEUE; when it is full
+ *   new events are counted as dropped
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_SPIKE_H
+#define FCI_SPIKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+
+// ============================================================================
+// SPIKE DETECTOR CLASS
+// ============================================================================
+
+class FCISpikeDetector {
+public:
+    FCISpikeDetector();
+
+    /**
+     * Derive sample counts from the rate and clear all state
+     * @param sample_rate Samples per second
+     * @return true if successful
+     */
+    bool begin(float sample_rate = ADC_SAMPLE_FREQ);
+
+    /**
+     * Clear baselines, open spikes and queued events
+     */
+    void reset();
+
+    /**
+     * Run the detector over consecutive frames
+     * @param frames Interleaved frames: [i * FCI_NUM_CHANNELS + channel]
+     * @param n_frames Number of frames
+     * @param first_sample Frame index of frames[0] (frames since boot)
+     */
+    void process(const float* frames, size_t n_frames, uint32_t first_sample);
+
+    /**
+     * Take the oldest queued event
+     * @return true if an event was returned
+     */
+    bool pop(fci_spike_t* event);
+
+    size_t pending() const { return _queue_count; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t detected() const { return _detected; }
+
+    /**
+     * Current baseline and threshold of a channel (µV)
+     */
+    float baseline(size_t channel) const;
+    float threshold(size_t channel) const;
+
+private:
+    struct Channel {
+        float mean;           // EW baseline
+        float mad;            // EW mean absolute deviation
+        uint32_t seen;        // Samples in the estimates (saturates)
+        bool open;            // Inside a spike
+        int8_t polarity;
+        uint16_t width;       // Samples in the spike so far
+        uint32_t peak_sample;
+        float peak;           // Largest |x - mean| so far
+        float onset_threshold;
+        bool has_last;
+        uint32_t last_peak;   // Peak of the last accepted spike
+    };
+
+    Channel _ch[FCI_NUM_CHANNELS];
+    float _alpha;                 // EW update weight per sample
+    uint32_t _warmup_samples;
+    uint32_t _refractory_samples;
+    uint32_t _min_samples;
+    uint32_t _max_samples;
+
+    fci_spike_t _queue[SPIKE_EVENT_QUEUE];
+    size_t _queue_head;           // Oldest event
+    size_t _queue_count;
+    uint32_t _dropped;
+    uint32_t _detected;
+
+    void closeSpike(size_t channel);
+    void push(const fci_spike_t& event);
+};
+
+#endif // FCI_SPIKE_H
@@ -0,0 +1,103 @@
+/**
+ * FCI STFT - Streaming overlapped spectrogram
+ *
+ * Turns the µV sample stream into spectrogram columns every hop:
+ * - Ring buffer of the last frame of samples; each hop unrolls it into
+ *   the FFT buffer (two contiguous copies, no per-sample modulo)
+ * - Periodic Hamming window applied in the frequency domain as a 3-tap
+ *   kernel, only on the bins that are kept, so frames are never
+ *   re-windowed in the time domain
+ * - Columns keep the FREQ_BAND_LOW..FREQ_BAND_MAX bins as 8-bit
+ *   log-magnitude codes plus band amplitudes for the FREQ_BAND_* ranges
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_STFT_H
+#define FCI_STFT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+#include "fci_fft.h"
+
+// ============================================================================
+// STREAMING SPECTROGRAM CLASS
+// ============================================================================
+
+class FCISpectrogram {
+public:
+    FCISpectrogram();
+    ~FCISpectrogram();
+
+    /**
+     * Allocate the frame ring and FFT tables
+     * @param sample_rate Samples per second
+     * @param frame_size STFT frame length (power of 2)
+     * @param hop Samples between columns (1 .. frame_size)
+     * @return true if successful
+     */
+    bool begin(float sample_rate = ADC_SAMPLE_FREQ,
+               size_t frame_size = STFT_FRAME_SAMPLES,
+               size_t hop = STFT_HOP_SAMPLES);
+
+    /**
+     * Change the hop size (e.g. frame/2 for 50%, frame/4 for 75% overlap)
+     * Takes effect from the next sample; history is kept.
+     * @param hop Samples between columns (1 .. frame_size)
+     * @return true if accepted
+     */
+    bool setHop(size_t hop);
+
+    /**
+     * Add one sample
+     * @param value_uv Sample in µV
+     * @return true if a new column is ready (see column())
+     */
+    bool addSample(float value_uv);
+
+    /**
+     * Most recent column
+     */
+    const fci_spectrogram_column_t& column() const { return _column; }
+
+    /**
+     * Center frequency of column bin i
+     */
+    float binFrequency(size_t i) const { return (float)(_first_bin + i) * _bin_hz; }
+
+    /**
+     * Convert a log-magnitude code back to dB re 1 µV
+     */
+    static float codeToDb(uint8_t code) { return STFT_DB_FLOOR + code * STFT_DB_STEP; }
+
+    float sampleRate() const { return _sample_rate; }
+    size_t frameSize() const { return _frame_size; }
+    size_t hop() const { return _hop; }
+    float binHz() const { return _bin_hz; }
+
+private:
+    FCIRealFFT _fft;
+    float _sample_rate;
+    size_t _frame_size;
+    size_t _hop;
+    float _bin_hz;
+
+    float* _ring;              // Last frame_size samples, oldest at _head
+    float* _frame;             // FFT work buffer
+    size_t _head;
+    size_t _since_column;      // Samples since the last column
+    uint32_t _total_samples;
+
+    // Bin ranges (inclusive first, exclusive last)
+    size_t _first_bin, _last_bin;
+    size_t _band_mid_bin, _band_high_bin;
+    float _amp_scale;          // |X_w| -> sinusoid amplitude (µV)
+
+    fci_spectrogram_column_t _column;
+
+    void computeColumn();
+    size_t frequencyToBin(float hz) const;
+};
+
+#endif // FCI_STFT_H
@@ -0,0 +1,106 @@
+/**
+ * FCI Tones - Sliding DFT bank for targeted-frequency tracking
+ *
+ * Tracks amplitude and phase of a few known frequencies (stimulus, mains,
+ * selected bio tones) continuously, updated every sample:
+ * - One sliding DFT per tone: S(n) = e^{jw} S(n-1) + x(n) - x(n-N);
+ *   4 multiplies per tone per sample
+ * - Window per tone is a whole number of periods (the frequency is
+ *   snapped to cycles * fs / N), so DC offset and the tone's
+ *   negative-frequency image cancel exactly
+ * - Shared delay line for x(n-N); any frequency, not just FFT bins
+ * - Each tracker is recomputed from the delay line every
+ *   TONE_REFRESH_WINDOWS windows, which bounds float drift at an
+ *   amortized cost of 1/TONE_REFRESH_WINDOWS multiply-adds per sample
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_TONES_H
+#define FCI_TONES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+
+// ============================================================================
+// TONE BANK CLASS
+// ============================================================================
+
+class FCIToneBank {
+public:
+    FCIToneBank();
+    ~FCIToneBank();
+
+    /**
+     * Allocate the delay line
+     * @param sample_rate Samples per second
+     * @param history Delay line length (power of 2), longest window
+     * @return true if successful
+     */
+    bool begin(float sample_rate = ADC_SAMPLE_FREQ, size_t history = TONE_HISTORY_SAMPLES);
+
+    /**
+     * Track a frequency in the first free slot
+     * The tracked frequency is snapped to whole periods of the window
+     * (see getTone()); at 128 SPS and 1 s that is within 0.5%.
+     * @param freq_hz Frequency (0 < f < sample_rate / 2)
+     * @param window_s Target window, rounded to whole periods
+     * @return Slot index, or -1 if full or the frequency is not trackable
+     */
+    int addTone(float freq_hz, float window_s = TONE_WINDOW_S);
+
+    /**
+     * Retune a slot (restarts its window); freq_hz <= 0 frees it
+     * @return true if successful
+     */
+    bool setTone(size_t slot, float freq_hz, float window_s = TONE_WINDOW_S);
+
+    /**
+     * Free all slots
+     */
+    void clear();
+
+    /**
+     * Add one sample, updates every active tone (O(k))
+     * @param value_uv Sample in µV
+     */
+    void addSample(float value_uv);
+
+    /**
+     * Current estimate for a slot
+     * @param slot Slot index
+     * @param out Tracked (snapped) frequency, amplitude (µV) and phase (rad)
+     * @return true if the slot is active and its window is full
+     */
+    bool getTone(size_t slot, fci_tone_t* out) const;
+
+    /**
+     * Window length of a slot in samples (0 if inactive)
+     */
+    size_t windowSamples(size_t slot) const;
+
+    size_t capacity() const { return TONE_MAX_TRACKERS; }
+
+private:
+    struct Tracker {
+        bool active;
+        float freq_hz;
+        size_t window;         // N, samples
+        size_t seen;           // Samples since (re)tune, saturates at N
+        size_t since_refresh;  // Samples since the last exact recompute
+        float rot_re, rot_im;  // e^{jw}
+        float s_re, s_im;      // Sliding DFT state
+        float amp_scale;       // 2 / N
+    };
+
+    float _sample_rate;
+    float* _history;
+    size_t _history_mask;
+    size_t _head;
+    Tracker _trackers[TONE_MAX_TRACKERS];
+
+    void refresh(Tracker& t);
+};
+
+#endif // FCI_TONES_H
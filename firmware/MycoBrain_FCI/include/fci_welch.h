@@ -0,0 +1,100 @@
+/**
+ * FCI Welch PSD - Averaged power spectral density
+ *
+ * Welch's method, streaming:
+ * - Samples are added in arbitrary blocks; a segment ring carries the
+ *   overlap across buffers, so a segment completes every hop samples
+ * - Each segment is Hann-windowed (precomputed) and transformed with
+ *   FCIRealFFT; |X|^2 is folded into a running average over the last
+ *   ~averages segments (exact mean until that many have been seen)
+ * - One-sided PSD in µV²/Hz; band powers integrate PSD * df
+ *
+ * Cost per added sample is bounded: one FFT per hop samples.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#ifndef FCI_WELCH_H
+#define FCI_WELCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fci_config.h"
+#include "fci_fft.h"
+
+// ============================================================================
+// WELCH PSD CLASS
+// ============================================================================
+
+class FCIWelchPSD {
+public:
+    FCIWelchPSD();
+    ~FCIWelchPSD();
+
+    /**
+     * Allocate segment ring, window and PSD accumulator
+     * @param sample_rate Samples per second
+     * @param segment_size Segment length (power of 2)
+     * @param hop Samples between segments (1 .. segment_size)
+     * @param averages Segments in the running average (>= 1)
+     * @return true if successful
+     */
+    bool begin(float sample_rate = ADC_SAMPLE_FREQ,
+               size_t segment_size = WELCH_SEGMENT_SAMPLES,
+               size_t hop = WELCH_HOP_SAMPLES,
+               size_t averages = WELCH_AVERAGES);
+
+    /**
+     * Forget history and the averaged PSD
+     */
+    void reset();
+
+    /**
+     * Add samples; every completed segment updates the PSD
+     * @param samples Input in µV
+     * @param length Number of samples
+     * @return Number of segments added
+     */
+    size_t addSamples(const float* samples, size_t length);
+
+    /**
+     * Power in [f_lo, f_hi): sum of PSD * df over bins whose center
+     * frequency falls in the range
+     * @return Band power in µV² (0 before the first segment)
+     */
+    float bandPower(float f_lo, float f_hi) const;
+
+    /**
+     * Averaged one-sided PSD, segment_size / 2 + 1 bins (µV²/Hz)
+     */
+    const float* psd() const { return _psd; }
+    size_t bins() const { return _segment_size / 2 + 1; }
+    float binHz() const { return _bin_hz; }
+
+    /**
+     * Segments averaged so far (saturates at the configured averages)
+     */
+    size_t segments() const { return _segments; }
+
+private:
+    FCIRealFFT _fft;
+    float _sample_rate;
+    size_t _segment_size;
+    size_t _hop;
+    size_t _averages;
+    float _bin_hz;
+    float _psd_scale;          // |X|^2 -> one-sided µV²/Hz (before doubling)
+
+    float* _ring;              // Last segment_size samples, oldest at _head
+    float* _window;            // Periodic Hann
+    float* _frame;             // FFT work buffer
+    float* _psd;               // Running average
+    size_t _head;
+    size_t _filled;            // Samples in the ring (saturates)
+    size_t _since_segment;
+    size_t _segments;
+
+    void addSegment();
+};
+
+#endif // FCI_WELCH_H
@@ -0,0 +1,353 @@
+/**
+ * FCI FFT Implementation
+ *
+ * forward() packs the n real samples as n/2 complex points z[i] =
+ * x[2i] + j x[2i+1], runs an n/2-point complex radix-2 DIT FFT (Z) and
+ * splits the result:
+ *   Fe[k] = (Z[k] + conj Z[m-k]) / 2       (spectrum of even samples)
+ *   Fo[k] = -j (Z[k] - conj Z[m-k]) / 2    (spectrum of odd samples)
+ *   X[k] = Fe[k] + W_n^k Fo[k],  X[m-k] = conj(Fe[k] - W_n^k Fo[k])
+ * which costs half of a full complex n-point transform.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_fft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#endif
+
+// Float butterfly backend
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && defined(__has_include)
+#if __has_include("dsps_fft2r.h")
+#include "dsps_fft2r.h"
+#define FCI_FFT_ESP_DSP 1
+#ifndef CONFIG_DSP_MAX_FFT_SIZE
+#define CONFIG_DSP_MAX_FFT_SIZE 4096
+#endif
+#endif
+#endif
+
+#if !defined(FCI_FFT_ESP_DSP) && defined(__SSE2__)
+#include <emmintrin.h>
+#define FCI_FFT_SSE2 1
+#elif !defined(FCI_FFT_ESP_DSP) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FCI_FFT_NEON 1
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static int16_t toQ15(double v) {
+    long q = lround(v * 32768.0);
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (int16_t)q;
+}
+
+static inline int16_t sat16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+// One DIT stage over a group: a[j] +- W^j b[j] for j < h, interleaved re/im.
+static inline void butterflies(float* a, float* b, const float* w, size_t h) {
+    size_t j = 0;
+#if defined(FCI_FFT_SSE2)
+    const __m128 sign = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    for (; j + 2 <= h; j += 2) {
+        __m128 wv = _mm_loadu_ps(w + 2 * j);
+        __m128 wr = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 wi = _mm_xor_ps(_mm_shuffle_ps(wv, wv, _MM_SHUFFLE(3, 3, 1, 1)), sign);
+        __m128 bv = _mm_loadu_ps(b + 2 * j);
+        __m128 bs = _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 t = _mm_add_ps(_mm_mul_ps(bv, wr), _mm_mul_ps(bs, wi));
+        __m128 av = _mm_loadu_ps(a + 2 * j);
+        _mm_storeu_ps(a + 2 * j, _mm_add_ps(av, t));
+        _mm_storeu_ps(b + 2 * j, _mm_sub_ps(av, t));
+    }
+#elif defined(FCI_FFT_NEON)
+    const float32x4_t sign = { -1.0f, 1.0f, -1.0f, 1.0f };
+    for (; j + 2 <= h; j += 2) {
+        float32x4_t wv = vld1q_f32(w + 2 * j);
+        float32x4_t wr = vtrn1q_f32(wv, wv);
+        float32x4_t wi = vmulq_f32(vtrn2q_f32(wv, wv), sign);
+        float32x4_t bv = vld1q_f32(b + 2 * j);
+        float32x4_t t = vfmaq_f32(vmulq_f32(bv, wr), vrev64q_f32(bv), wi);
+        float32x4_t av = vld1q_f32(a + 2 * j);
+        vst1q_f32(a + 2 * j, vaddq_f32(av, t));
+        vst1q_f32(b + 2 * j, vsubq_f32(av, t));
+    }
+#endif
+    for (; j < h; j++) {
+        float wr = w[2 * j], wi = w[2 * j + 1];
+        float br = b[2 * j], bi = b[2 * j + 1];
+        float tr = br * wr - bi * wi;
+        float ti = br * wi + bi * wr;
+        float ar = a[2 * j], ai = a[2 * j + 1];
+        a[2 * j] = ar + tr;
+        a[2 * j + 1] = ai + ti;
+        b[2 * j] = ar - tr;
+        b[2 * j + 1] = ai - ti;
+    }
+}
+
+// ============================================================================
+// FCIRealFFT Implementation
+// ============================================================================
+
+FCIRealFFT::FCIRealFFT() :
+    _n(0),
+    _m(0),
+    _use_esp_dsp(false),
+    _stage_tw(nullptr),
+    _split_tw(nullptr),
+    _tw_q15(nullptr),
+    _split_q15(nullptr),
+    _bitrev(nullptr),
+    _n_swaps(0)
+{
+}
+
+FCIRealFFT::~FCIRealFFT() {
+    end();
+}
+
+void FCIRealFFT::end() {
+    free(_stage_tw);
+    free(_split_tw);
+    free(_tw_q15);
+    free(_split_q15);
+    free(_bitrev);
+    _stage_tw = nullptr;
+    _split_tw = nullptr;
+    _tw_q15 = nullptr;
+    _split_q15 = nullptr;
+    _bitrev = nullptr;
+    _n = _m = _n_swaps = 0;
+    _use_esp_dsp = false;
+}
+
+bool FCIRealFFT::begin(size_t n) {
+    end();
+    if (n < FCI_FFT_MIN_SIZE || n > FCI_FFT_MAX_SIZE || (n & (n - 1)) != 0) {
+        return false;
+    }
+    const size_t m = n / 2;
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < m) bits++;
+
+#if defined(FCI_FFT_ESP_DSP)
+    // esp-dsp keeps one shared table sized for CONFIG_DSP_MAX_FFT_SIZE;
+    // fall back to our own butterflies if it is too small or unavailable.
+    static bool dsp_ready = false;
+    if (!dsp_ready) {
+        dsp_ready = dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE) == ESP_OK;
+    }
+    _use_esp_dsp = dsp_ready && m >= 8 && m <= CONFIG_DSP_MAX_FFT_SIZE;
+#endif
+
+    _split_tw = (float*)malloc((m / 2 + 1) * 2 * sizeof(float));
+    _tw_q15 = (int16_t*)malloc((m / 2) * 2 * sizeof(int16_t));
+    _split_q15 = (int16_t*)malloc((m / 2 + 1) * 2 * sizeof(int16_t));
+    _bitrev = (uint16_t*)malloc(m * sizeof(uint16_t));
+    if (!_use_esp_dsp) {
+        _stage_tw = (float*)malloc((m - 1) * 2 * sizeof(float));
+    }
+    if (!_split_tw || !_tw_q15 || !_split_q15 || !_bitrev || (!_use_esp_dsp && !_stage_tw)) {
+        end();
+        return false;
+    }
+
+    // Stage with half-span h uses W_{2h}^j = e^{-j pi j / h}, j < h
+    if (_stage_tw) {
+        for (size_t h = 1; h < m; h <<= 1) {
+            float* w = _stage_tw + 2 * (h - 1);
+            for (size_t j = 0; j < h; j++) {
+                double a = M_PI * (double)j / (double)h;
+                w[2 * j] = (float)cos(a);
+                w[2 * j + 1] = (float)-sin(a);
+            }
+        }
+    }
+    for (size_t j = 0; j < m / 2; j++) {
+        double a = 2.0 * M_PI * (double)j / (double)m;
+        _tw_q15[2 * j] = toQ15(cos(a));
+        _tw_q15[2 * j + 1] = toQ15(-sin(a));
+    }
+    for (size_t k = 0; k <= m / 2; k++) {
+        double a = 2.0 * M_PI * (double)k / (double)n;
+        _split_tw[2 * k] = (float)cos(a);
+        _split_tw[2 * k + 1] = (float)-sin(a);
+        _split_q15[2 * k] = toQ15(cos(a));
+        _split_q15[2 * k + 1] = toQ15(-sin(a));
+    }
+
+    // Bit-reversal permutation as a list of swaps
+    for (size_t i = 0; i < m; i++) {
+        size_t r = 0;
+        for (unsigned b = 0; b < bits; b++) {
+            if (i & ((size_t)1 << b)) r |= (size_t)1 << (bits - 1 - b);
+        }
+        if (i < r) {
+            _bitrev[_n_swaps++] = (uint16_t)i;
+            _bitrev[_n_swaps++] = (uint16_t)r;
+        }
+    }
+
+    _n = n;
+    _m = m;
+    return true;
+}
+
+const char* FCIRealFFT::backend() const {
+    if (_use_esp_dsp) return "esp-dsp";
+#if defined(FCI_FFT_SSE2)
+    return "sse2";
+#elif defined(FCI_FFT_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void FCIRealFFT::complexForward(float* z) const {
+#if defined(FCI_FFT_ESP_DSP)
+    if (_use_esp_dsp) {
+        dsps_fft2r_fc32(z, (int)_m);
+        dsps_bit_rev_fc32(z, (int)_m);
+        return;
+    }
+#endif
+    for (size_t s = 0; s < _n_swaps; s += 2) {
+        size_t i = 2 * (size_t)_bitrev[s], j = 2 * (size_t)_bitrev[s + 1];
+        float tr = z[i], ti = z[i + 1];
+        z[i] = z[j];
+        z[i + 1] = z[j + 1];
+        z[j] = tr;
+        z[j + 1] = ti;
+    }
+
+    // h = 1: twiddle is 1
+    for (size_t g = 0; g < 2 * _m; g += 4) {
+        float ar = z[g], ai = z[g + 1], br = z[g + 2], bi = z[g + 3];
+        z[g] = ar + br;
+        z[g + 1] = ai + bi;
+        z[g + 2] = ar - br;
+        z[g + 3] = ai - bi;
+    }
+    for (size_t h = 2; h < _m; h <<= 1) {
+        const float* w = _stage_tw + 2 * (h - 1);
+        for (size_t g = 0; g < _m; g += 2 * h) {
+            butterflies(z + 2 * g, z + 2 * (g + h), w, h);
+        }
+    }
+}
+
+void FCIRealFFT::splitReal(float* z) const {
+    const size_t m = _m;
+    float r0 = z[0], i0 = z[1];
+    z[0] = r0 + i0;
+    z[1] = r0 - i0;
+    for (size_t k = 1; k <= m / 2; k++) {
+        const size_t k2 = m - k;
+        float zr = z[2 * k], zi = z[2 * k + 1];
+        float cr = z[2 * k2], ci = -z[2 * k2 + 1];
+        float fer = 0.5f * (zr + cr), fei = 0.5f * (zi + ci);
+        float for_ = 0.5f * (zi - ci), foi = -0.5f * (zr - cr);
+        float wr = _split_tw[2 * k], wi = _split_tw[2 * k + 1];
+        float tr = wr * for_ - wi * foi;
+        float ti = wr * foi + wi * for_;
+        z[2 * k] = fer + tr;
+        z[2 * k + 1] = fei + ti;
+        z[2 * k2] = fer - tr;
+        z[2 * k2 + 1] = ti - fei;
+    }
+}
+
+void FCIRealFFT::forward(float* x) const {
+    if (!_n) return;
+    complexForward(x);
+    splitReal(x);
+}
+
+void FCIRealFFT::complexForwardQ15(int16_t* z) const {
+    for (size_t s = 0; s < _n_swaps; s += 2) {
+        size_t i = 2 * (size_t)_bitrev[s], j = 2 * (size_t)_bitrev[s + 1];
+        int16_t tr = z[i], ti = z[i + 1];
+        z[i] = z[j];
+        z[i + 1] = z[j + 1];
+        z[j] = tr;
+        z[j + 1] = ti;
+    }
+
+    // Each stage scales by 1/2; stage h reads W_m at stride m / (2h)
+    for (size_t h = 1; h < _m; h <<= 1) {
+        const size_t stride = _m / (2 * h);
+        for (size_t g = 0; g < _m; g += 2 * h) {
+            int16_t* a = z + 2 * g;
+            int16_t* b = z + 2 * (g + h);
+            for (size_t j = 0; j < h; j++) {
+                int32_t wr = _tw_q15[2 * j * stride], wi = _tw_q15[2 * j * stride + 1];
+                int32_t br = b[2 * j], bi = b[2 * j + 1];
+                int32_t tr = (br * wr - bi * wi + (1 << 14)) >> 15;
+                int32_t ti = (br * wi + bi * wr + (1 << 14)) >> 15;
+                int32_t ar = a[2 * j], ai = a[2 * j + 1];
+                a[2 * j] = sat16((ar + tr) >> 1);
+                a[2 * j + 1] = sat16((ai + ti) >> 1);
+                b[2 * j] = sat16((ar - tr) >> 1);
+                b[2 * j + 1] = sat16((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+void FCIRealFFT::splitRealQ15(int16_t* z) const {
+    // z holds Z / m; outputs X / n = (2 Fe + 2 W Fo) / 4
+    const size_t m = _m;
+    int32_t r0 = z[0], i0 = z[1];
+    z[0] = sat16((r0 + i0) >> 1);
+    z[1] = sat16((r0 - i0) >> 1);
+    for (size_t k = 1; k <= m / 2; k++) {
+        const size_t k2 = m - k;
+        int32_t zr = z[2 * k], zi = z[2 * k + 1];
+        int32_t cr = z[2 * k2], ci = -(int32_t)z[2 * k2 + 1];
+        int32_t sr = zr + cr, si = zi + ci;
+        int32_t dr = zi - ci, di = cr - zr;
+        // |d| reaches 2^17, so the products need 64 bits
+        int64_t wr = _split_q15[2 * k], wi = _split_q15[2 * k + 1];
+        int32_t tr = (int32_t)((dr * wr - di * wi + (1 << 14)) >> 15);
+        int32_t ti = (int32_t)((dr * wi + di * wr + (1 << 14)) >> 15);
+        z[2 * k] = sat16((sr + tr + 2) >> 2);
+        z[2 * k + 1] = sat16((si + ti + 2) >> 2);
+        z[2 * k2] = sat16((sr - tr + 2) >> 2);
+        z[2 * k2 + 1] = sat16((ti - si + 2) >> 2);
+    }
+}
+
+void FCIRealFFT::forwardQ15(int16_t* x) const {
+    if (!_n) return;
+    complexForwardQ15(x);
+    splitRealQ15(x);
+}
+
+void FCIRealFFT::powerSpectrum(const float* packed, float* power) const {
+    if (!_n) return;
+    power[0] = packed[0] * packed[0];
+    power[_m] = packed[1] * packed[1];
+    for (size_t k = 1; k < _m; k++) {
+        float re = packed[2 * k], im = packed[2 * k + 1];
+        power[k] = re * re + im * im;
+    }
+}
@@ -0,0 +1,250 @@
+/**
+ * FCI History Implementation
+ *
+ * Every tier consolidates from the primary feature vectors (not from the
+ * tier below), so a day bucket's min/max are exact. A bucket closes when
+ * a vector arrives past its end; gaps simply leave no bucket.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_history.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(BOARD_HAS_PSRAM) && __has_include(<esp_heap_caps.h>)
+#include <esp_heap_caps.h>
+#define HISTORY_ALLOC(bytes) heap_caps_malloc((bytes), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define HISTORY_ALLOC(bytes) malloc(bytes)
+#endif
+
+static const uint32_t TIER_SECONDS[HISTORY_TIER_COUNT] = { 0, 60, 3600, 86400 };
+
+static const size_t TIER_RECORDS[HISTORY_TIER_COUNT] = {
+    HISTORY_RAW_RECORDS, HISTORY_MINUTE_RECORDS, HISTORY_HOUR_RECORDS, HISTORY_DAY_RECORDS
+};
+
+static const char* const METRIC_NAMES[HISTORY_METRICS] = {
+    "amplitude_uv", "rms_uv", "mean_uv", "std_uv", "dominant_freq_hz",
+    "snr_db", "band_power_low", "band_power_bio", "band_power_high", "band_rel_bio"
+};
+
+// ============================================================================
+// FCIFeatureHistory Implementation
+// ============================================================================
+
+FCIFeatureHistory::FCIFeatureHistory() {
+    memset(_rings, 0, sizeof(_rings));
+    memset(_open, 0, sizeof(_open));
+    memset(_open_valid, 0, sizeof(_open_valid));
+}
+
+FCIFeatureHistory::~FCIFeatureHistory() {
+    for (size_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        if (_rings[i].data) free(_rings[i].data);
+    }
+}
+
+bool FCIFeatureHistory::begin() {
+    for (size_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        Ring& r = _rings[i];
+        if (r.data) free(r.data);
+        r.record_size = (i == HISTORY_TIER_RAW) ? sizeof(fci_history_raw_t)
+                                                : sizeof(fci_history_bucket_t);
+        r.capacity = TIER_RECORDS[i];
+        r.head = 0;
+        r.count = 0;
+        r.data = (uint8_t*)HISTORY_ALLOC(r.record_size * r.capacity);
+        if (!r.data) {
+            return false;
+        }
+        _open_valid[i] = false;
+    }
+    return true;
+}
+
+void FCIFeatureHistory::metrics(const fci_features_t* f, float* out) {
+    out[0] = f->amplitude_uv;
+    out[1] = f->rms_uv;
+    out[2] = f->mean_uv;
+    out[3] = f->std_uv;
+    out[4] = f->dominant_freq_hz;
+    out[5] = f->snr_db;
+    out[6] = f->band_power_low;
+    out[7] = f->band_power_bio;
+    out[8] = f->band_power_high;
+    out[9] = f->band_rel_bio;
+}
+
+const char* FCIFeatureHistory::metricName(size_t index) {
+    return (index < HISTORY_METRICS) ? METRIC_NAMES[index] : "";
+}
+
+const char* FCIFeatureHistory::tierName(fci_history_tier_t tier) {
+    switch (tier) {
+        case HISTORY_TIER_RAW:    return "raw";
+        case HISTORY_TIER_MINUTE: return "minute";
+        case HISTORY_TIER_HOUR:   return "hour";
+        case HISTORY_TIER_DAY:    return "day";
+        default:                  return "unknown";
+    }
+}
+
+uint32_t FCIFeatureHistory::bucketSeconds(fci_history_tier_t tier) const {
+    return (tier < HISTORY_TIER_COUNT) ? TIER_SECONDS[tier] : 0;
+}
+
+const uint8_t* FCIFeatureHistory::record(const Ring& r, size_t index) const {
+    size_t pos = (r.head + r.capacity - r.count + index) % r.capacity;
+    return r.data + pos * r.record_size;
+}
+
+uint32_t FCIFeatureHistory::recordTime(const Ring& r, size_t index) const {
+    // Both record types start with t_s
+    uint32_t t;
+    memcpy(&t, record(r, index), sizeof(t));
+    return t;
+}
+
+void FCIFeatureHistory::push(Ring& r, const void* rec) {
+    if (!r.data) return;
+    memcpy(r.data + r.head * r.record_size, rec, r.record_size);
+    r.head = (r.head + 1) % r.capacity;
+    if (r.count < r.capacity) r.count++;
+}
+
+size_t FCIFeatureHistory::lowerBound(const Ring& r, uint32_t t_s) const {
+    // First stored record with time >= t_s (records are time-ordered)
+    size_t lo = 0, hi = r.count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (recordTime(r, mid) < t_s) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void FCIFeatureHistory::closeBucket(size_t tier) {
+    fci_history_bucket_t& b = _open[tier];
+    for (size_t m = 0; m < HISTORY_METRICS; m++) {
+        b.mean[m] /= b.count;  // Held as a sum while open
+    }
+    push(_rings[tier], &b);
+    _open_valid[tier] = false;
+}
+
+void FCIFeatureHistory::add(uint32_t t_s, const fci_features_t* features) {
+    fci_history_raw_t raw;
+    raw.t_s = t_s;
+    raw.features = *features;
+    push(_rings[HISTORY_TIER_RAW], &raw);
+
+    float v[HISTORY_METRICS];
+    metrics(features, v);
+
+    for (size_t tier = HISTORY_TIER_MINUTE; tier < HISTORY_TIER_COUNT; tier++) {
+        const uint32_t start = t_s - t_s % TIER_SECONDS[tier];
+        fci_history_bucket_t& b = _open[tier];
+
+        if (_open_valid[tier] && b.t_s != start) {
+            closeBucket(tier);
+        }
+        if (!_open_valid[tier]) {
+            b.t_s = start;
+            b.count = 0;
+            for (size_t m = 0; m < HISTORY_METRICS; m++) {
+                b.min[m] = b.max[m] = v[m];
+                b.mean[m] = 0;
+            }
+            _open_valid[tier] = true;
+        }
+
+        b.count++;
+        for (size_t m = 0; m < HISTORY_METRICS; m++) {
+            if (v[m] < b.min[m]) b.min[m] = v[m];
+            if (v[m] > b.max[m]) b.max[m] = v[m];
+            b.mean[m] += v[m];
+        }
+    }
+}
+
+size_t FCIFeatureHistory::count(fci_history_tier_t tier, uint32_t from_s, uint32_t to_s) const {
+    if (tier >= HISTORY_TIER_COUNT || from_s > to_s) return 0;
+    const Ring& r = _rings[tier];
+
+    size_t n = 0;
+    for (size_t i = lowerBound(r, from_s); i < r.count && recordTime(r, i) <= to_s; i++) {
+        n++;
+    }
+    if (tier != HISTORY_TIER_RAW && _open_valid[tier] &&
+        _open[tier].t_s >= from_s && _open[tier].t_s <= to_s) {
+        n++;
+    }
+    return n;
+}
+
+uint32_t FCIFeatureHistory::oldest(fci_history_tier_t tier) const {
+    if (tier >= HISTORY_TIER_COUNT) return 0;
+    const Ring& r = _rings[tier];
+    if (r.count > 0) return recordTime(r, 0);
+    if (tier != HISTORY_TIER_RAW && _open_valid[tier]) return _open[tier].t_s;
+    return 0;
+}
+
+fci_history_tier_t FCIFeatureHistory::selectTier(uint32_t from_s, uint32_t to_s, size_t max_points) const {
+    for (size_t tier = HISTORY_TIER_RAW; tier < HISTORY_TIER_DAY; tier++) {
+        fci_history_tier_t t = (fci_history_tier_t)tier;
+        // The tier must still hold the start of the range (never wrapped,
+        // or oldest record within one bucket/feature period of it) and
+        // fit the point budget
+        const Ring& r = _rings[tier];
+        const uint32_t slack = (tier == HISTORY_TIER_RAW) ? FFT_SAMPLES / ADC_SAMPLE_RATE
+                                                          : bucketSeconds(t);
+        if (r.count == r.capacity && oldest(t) > from_s + slack) continue;
+        if (count(t, from_s, to_s) <= max_points) return t;
+    }
+    return HISTORY_TIER_DAY;
+}
+
+size_t FCIFeatureHistory::queryRaw(uint32_t from_s, uint32_t to_s, size_t skip,
+                                   fci_history_raw_t* out, size_t max_records) const {
+    if (from_s > to_s) return 0;
+    const Ring& r = _rings[HISTORY_TIER_RAW];
+
+    size_t n = 0;
+    for (size_t i = lowerBound(r, from_s) + skip; i < r.count && n < max_records; i++) {
+        const uint8_t* rec = record(r, i);
+        if (recordTime(r, i) > to_s) break;
+        memcpy(&out[n++], rec, sizeof(fci_history_raw_t));
+    }
+    return n;
+}
+
+size_t FCIFeatureHistory::queryBuckets(fci_history_tier_t tier, uint32_t from_s, uint32_t to_s, size_t skip,
+                                       fci_history_bucket_t* out, size_t max_records) const {
+    if (tier == HISTORY_TIER_RAW || tier >= HISTORY_TIER_COUNT || from_s > to_s) return 0;
+    const Ring& r = _rings[tier];
+
+    size_t n = 0;
+    size_t i = lowerBound(r, from_s) + skip;
+    for (; i < r.count && n < max_records; i++) {
+        if (recordTime(r, i) > to_s) return n;
+        memcpy(&out[n++], record(r, i), sizeof(fci_history_bucket_t));
+    }
+
+    // The open bucket follows the stored ones, with its running mean
+    const fci_history_bucket_t& b = _open[tier];
+    if (n < max_records && i == r.count && _open_valid[tier] &&
+        b.t_s >= from_s && b.t_s <= to_s) {
+        fci_history_bucket_t& o = out[n++];
+        o = b;
+        for (size_t m = 0; m < HISTORY_METRICS; m++) {
+            o.mean[m] = b.mean[m] / b.count;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,245 @@
+/**
+ * FCI Multi-Rate Implementation
+ *
+ * CIC decimator of order N and ratio R: N integrators at the input rate,
+ * N combs at the output rate, DC gain R^N, response
+ * |sin(pi f R / fs) / (R sin(pi f / fs))|^N with nulls at every multiple
+ * of the output rate, which is where aliases would land. Register growth
+ * is N log2(R) bits (21 for 128 at order 3) on top of the input, so
+ * 64-bit modular arithmetic is exact.
+ *
+ * Analysis detrends before the FFT: at hour scale, electrode drift would
+ * otherwise leak into every low bin.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_multirate.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const uint32_t DECIM_RATIOS[DECIM_STAGES] = {
+    DECIM_RATIO_1, DECIM_RATIO_2, DECIM_RATIO_3
+};
+
+// ============================================================================
+// FCIMultiRate Implementation
+// ============================================================================
+
+FCIMultiRate::FCIMultiRate() :
+    _scratch(nullptr)
+{
+    memset(_stages, 0, sizeof(_stages));
+}
+
+FCIMultiRate::~FCIMultiRate() {
+    for (size_t i = 0; i < DECIM_STAGES; i++) {
+        if (_stages[i].ring) free(_stages[i].ring);
+    }
+    if (_scratch) free(_scratch);
+}
+
+bool FCIMultiRate::begin(float sample_rate) {
+    if (!_fft.begin(DECIM_RING_SAMPLES)) {
+        return false;
+    }
+    if (_scratch) free(_scratch);
+    _scratch = (float*)malloc(DECIM_RING_SAMPLES * sizeof(float));
+    if (!_scratch) {
+        return false;
+    }
+
+    float rate = sample_rate;
+    for (size_t i = 0; i < DECIM_STAGES; i++) {
+        Stage& s = _stages[i];
+        if (s.ring) free(s.ring);
+        memset(&s, 0, sizeof(s));
+
+        s.ring = (float*)malloc(DECIM_RING_SAMPLES * sizeof(float));
+        if (!s.ring) {
+            return false;
+        }
+        memset(s.ring, 0, DECIM_RING_SAMPLES * sizeof(float));
+
+        s.ratio = DECIM_RATIOS[i];
+        s.gain = 1;
+        for (int k = 0; k < DECIM_CIC_ORDER; k++) {
+            s.gain *= s.ratio;
+        }
+        rate /= s.ratio;
+        s.rate_hz = rate;
+        s.features.rate_hz = rate;
+    }
+    return true;
+}
+
+bool FCIMultiRate::cicStep(Stage& s, int64_t input, int64_t* output) {
+    uint64_t v = (uint64_t)input;
+    for (int k = 0; k < DECIM_CIC_ORDER; k++) {
+        s.integrator[k] += v;
+        v = s.integrator[k];
+    }
+    if (++s.phase < s.ratio) {
+        return false;
+    }
+    s.phase = 0;
+
+    for (int k = 0; k < DECIM_CIC_ORDER; k++) {
+        uint64_t d = v - s.comb[k];
+        s.comb[k] = v;
+        v = d;
+    }
+
+    // Divide out R^N, rounding to nearest
+    int64_t sum = (int64_t)v;
+    int64_t half = s.gain / 2;
+    *output = (sum >= 0) ? (sum + half) / s.gain : -((-sum + half) / s.gain);
+    return true;
+}
+
+uint8_t FCIMultiRate::addSample(float value_uv) {
+    if (!_scratch) return 0;
+
+    uint8_t updated = 0;
+    int64_t x = llroundf(value_uv * DECIM_UNITS_PER_UV);
+
+    for (size_t i = 0; i < DECIM_STAGES; i++) {
+        Stage& s = _stages[i];
+        int64_t y;
+        if (!cicStep(s, x, &y)) {
+            break;
+        }
+        // The first outputs see integrators that started from zero
+        if (s.warmup < DECIM_CIC_ORDER) {
+            s.warmup++;
+            break;
+        }
+
+        s.ring[s.head] = y / DECIM_UNITS_PER_UV;
+        s.head = (s.head + 1) & (DECIM_RING_SAMPLES - 1);
+        if (s.filled < DECIM_RING_SAMPLES) s.filled++;
+
+        if (++s.since_analysis >= DECIM_ANALYSIS_HOP && s.filled >= DECIM_MIN_ANALYSIS) {
+            s.since_analysis = 0;
+            analyze(s);
+            updated |= (uint8_t)(1 << i);
+        }
+        x = y;  // Next stage runs on this stage's output
+    }
+    return updated;
+}
+
+void FCIMultiRate::analyze(Stage& s) {
+    const size_t n = s.filled;
+    const size_t start = (s.head + DECIM_RING_SAMPLES - n) & (DECIM_RING_SAMPLES - 1);
+    fci_slow_features_t& f = s.features;
+
+    // Oldest first, with mean and range
+    float sum = 0;
+    f.min_uv = f.max_uv = s.ring[start];
+    for (size_t i = 0; i < n; i++) {
+        float v = s.ring[(start + i) & (DECIM_RING_SAMPLES - 1)];
+        _scratch[i] = v;
+        sum += v;
+        if (v < f.min_uv) f.min_uv = v;
+        if (v > f.max_uv) f.max_uv = v;
+    }
+    const float mean = sum / n;
+
+    // Least-squares line over t = i - (n - 1) / 2
+    const float t_mid = (n - 1) * 0.5f;
+    float sxy = 0, sxx = 0;
+    for (size_t i = 0; i < n; i++) {
+        float t = i - t_mid;
+        sxy += t * (_scratch[i] - mean);
+        sxx += t * t;
+    }
+    const float slope = (sxx > 0) ? sxy / sxx : 0;  // µV per sample
+
+    // Detrend, residual variance, Hann window, zero-pad
+    float var = 0;
+    float window_sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        float r = _scratch[i] - mean - slope * (i - t_mid);
+        var += r * r;
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / n);
+        _scratch[i] = r * w;
+        window_sum += w;
+    }
+    for (size_t i = n; i < DECIM_RING_SAMPLES; i++) {
+        _scratch[i] = 0;
+    }
+    _fft.forward(_scratch);
+
+    // Strongest bin, excluding DC (removed) and Nyquist
+    const size_t nyquist = DECIM_RING_SAMPLES / 2;
+    float total = 0, best = 0;
+    size_t best_bin = 0;
+    for (size_t k = 1; k < nyquist; k++) {
+        float re = _scratch[2 * k], im = _scratch[2 * k + 1];
+        float p = re * re + im * im;
+        total += p;
+        if (p > best) {
+            best = p;
+            best_bin = k;
+        }
+    }
+
+    f.samples = (uint16_t)n;
+    f.mean_uv = mean;
+    f.std_uv = (n > 1) ? sqrtf(var / (n - 1)) : 0;
+    f.slope_uv_per_h = slope * s.rate_hz * 3600.0f;
+    f.dominant_period_s = 0;
+    f.dominant_amp_uv = 0;
+    f.dominant_rel = 0;
+    if (best_bin > 0 && total > 0) {
+        float near = best;
+        for (size_t k = best_bin - 1; k <= best_bin + 1; k += 2) {
+            if (k >= 1 && k < nyquist) {
+                near += _scratch[2 * k] * _scratch[2 * k] + _scratch[2 * k + 1] * _scratch[2 * k + 1];
+            }
+        }
+        // Parabolic peak interpolation on log magnitude (bin 0 is the
+        // detrended residual DC, close to zero)
+        float mag[3];
+        for (int j = 0; j < 3; j++) {
+            size_t k = best_bin - 1 + j;
+            float re = (k == 0) ? _scratch[0] : (k == nyquist) ? _scratch[1] : _scratch[2 * k];
+            float im = (k == 0 || k == nyquist) ? 0.0f : _scratch[2 * k + 1];
+            mag[j] = logf(sqrtf(re * re + im * im) + 1e-12f);
+        }
+        float denom = mag[0] - 2.0f * mag[1] + mag[2];
+        float delta = (denom < 0) ? 0.5f * (mag[0] - mag[2]) / denom : 0.0f;
+        if (delta > 0.5f) delta = 0.5f;
+        if (delta < -0.5f) delta = -0.5f;
+        f.dominant_period_s = DECIM_RING_SAMPLES / ((best_bin + delta) * s.rate_hz);
+        f.dominant_amp_uv = 2.0f * sqrtf(best) / window_sum;
+        f.dominant_rel = near / total;
+    }
+    s.analyzed = true;
+}
+
+bool FCIMultiRate::getFeatures(size_t stage, fci_slow_features_t* out) const {
+    if (stage >= DECIM_STAGES || !_stages[stage].analyzed) return false;
+    *out = _stages[stage].features;
+    return true;
+}
+
+size_t FCIMultiRate::getHistory(size_t stage, float* out) const {
+    if (stage >= DECIM_STAGES || !_stages[stage].ring) return 0;
+    const Stage& s = _stages[stage];
+    const size_t start = (s.head + DECIM_RING_SAMPLES - s.filled) & (DECIM_RING_SAMPLES - 1);
+    for (size_t i = 0; i < s.filled; i++) {
+        out[i] = s.ring[(start + i) & (DECIM_RING_SAMPLES - 1)];
+    }
+    return s.filled;
+}
+
+float FCIMultiRate::stageRate(size_t stage) const {
+    return (stage < DECIM_STAGES) ? _stages[stage].rate_hz : 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * FCI Pipeline Implementation
+ *
+ * A window closes on the first leave() after PIPE_STATS_WINDOW_MS; its
+ * figures are scaled by the actual window length, so a stage that wakes
+ * rarely still reports a correct busy share.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_pipeline.h"
+
+// ============================================================================
+// FCIStageStats Implementation
+// ============================================================================
+
+FCIStageStats::FCIStageStats() :
+    _name(""),
+    _window_start_us(0),
+    _run_start_us(0),
+    _busy_us(0),
+    _runs(0),
+    _max_run_us(0),
+    _queue_peak(0),
+    _busy_pct(0),
+    _runs_per_s(0),
+    _pub_max_run_us(0),
+    _queue_now(0),
+    _pub_queue_peak(0),
+    _queue_capacity(0),
+    _drops(0)
+{
+}
+
+void FCIStageStats::begin(const char* name, size_t queue_capacity, int64_t now_us) {
+    _name = name;
+    _queue_capacity = (uint16_t)queue_capacity;
+    _window_start_us = now_us;
+    _run_start_us = now_us;
+    _busy_us = 0;
+    _runs = 0;
+    _max_run_us = 0;
+    _queue_peak = 0;
+}
+
+void FCIStageStats::enter(int64_t now_us) {
+    _run_start_us = now_us;
+}
+
+void FCIStageStats::leave(int64_t now_us) {
+    const int64_t run = now_us - _run_start_us;
+    _busy_us += run;
+    _runs++;
+    if (run > (int64_t)_max_run_us) _max_run_us = (uint32_t)run;
+
+    const int64_t elapsed = now_us - _window_start_us;
+    if (elapsed >= (int64_t)PIPE_STATS_WINDOW_MS * 1000) {
+        _busy_pct = 100.0f * (float)_busy_us / (float)elapsed;
+        _runs_per_s = _runs * 1e6f / (float)elapsed;
+        _pub_max_run_us = _max_run_us;
+        _pub_queue_peak = _queue_peak;
+
+        _window_start_us = now_us;
+        _busy_us = 0;
+        _runs = 0;
+        _max_run_us = 0;
+        _queue_peak = 0;
+    }
+}
+
+void FCIStageStats::queueLevel(size_t used) {
+    const uint16_t u = (used > UINT16_MAX) ? UINT16_MAX : (uint16_t)used;
+    _queue_now = u;
+    if (u > _queue_peak) _queue_peak = u;
+}
+
+void FCIStageStats::snapshot(fci_stage_stats_t* out) const {
+    out->busy_pct = _busy_pct;
+    out->runs_per_s = _runs_per_s;
+    out->max_run_us = _pub_max_run_us;
+    out->queue_now = _queue_now;
+    out->queue_peak = _pub_queue_peak;
+    out->queue_capacity = _queue_capacity;
+    out->drops = _drops.load(std::memory_order_relaxed);
+}
@@ -2,14 +2,20 @@
  * FCI Signal Processing Implementation
  * 
  * Implements bioelectric signal analysis algorithms based on:
- * - Butterworth digital filters (IIR biquad sections)
+ * - Butterworth/Chebyshev IIR filters as one cascade of biquad sections
+ *   (fci_sos), run across all channels at once: frames are interleaved
+ *   and each section keeps one state lane per channel, so the channels'
+ *   independent recurrences hide FPU latency
  * - FFT spectral analysis
+ * - Welch PSD band powers
+ * - Sliding DFT tone tracking
+ * - CIC decimation to 1 Hz, 1/min and 1/h for ultra-low bands
  * - Pattern detection using GFST-derived parameters
- * - Spike detection using adaptive thresholding
+ * - Online spike detection using EW mean/deviation thresholds
  * 
  * Mathematical basis:
- * - Filter design: Bilinear transform of analog prototypes
- * - Spectral analysis: Cooley-Tukey FFT with Hamming window
+ * - Filter design: Bilinear transform of analog prototypes (any even order)
+ * - Spectral analysis: real-input radix-2 FFT (fci_fft) with Hamming window
  * - Pattern matching: Feature-based classification
  * 
  * (c) 2026 Mycosoft Labs
@@ -25,106 +31,145 @@
 FCISignalProcessor::FCISignalProcessor() :
     _sample_rate(ADC_SAMPLE_FREQ),
     _buffer_size(FFT_SAMPLES),
-    _raw_buffer(nullptr),
-    _filtered_buffer(nullptr),
+    _raw_frames(nullptr),
+    _work_frames(nullptr),
+    _filtered_block(nullptr),
     _fft_buffer(nullptr),
+    _window(nullptr),
     _sample_count(0),
     _buffer_index(0),
-    _running_mean(0),
-    _running_std(1.0f),
-    _total_samples(0),
-    _last_spike_time(0)
+    _notch_section(-1),
+    _notch_freq(NOTCH_FREQ_50HZ),
+#if FILTER_USE_Q31
+    _q31_frames(nullptr),
+#endif
+    _spectral_mode(SPECTRAL_MODE_BOTH),
+    _total_samples(0)
 {
-    memset(_hp_state, 0, sizeof(_hp_state));
-    memset(_lp_state, 0, sizeof(_lp_state));
-    memset(_notch_state, 0, sizeof(_notch_state));
+    memset(_filtered, 0, sizeof(_filtered));
 }
 
 FCISignalProcessor::~FCISignalProcessor() {
-    if (_raw_buffer) free(_raw_buffer);
-    if (_filtered_buffer) free(_filtered_buffer);
+    if (_raw_frames) free(_raw_frames);
+    if (_work_frames) free(_work_frames);
+    if (_filtered_block) free(_filtered_block);
     if (_fft_buffer) free(_fft_buffer);
+    if (_window) free(_window);
+#if FILTER_USE_Q31
+    if (_q31_frames) free(_q31_frames);
+#endif
 }
 
 bool FCISignalProcessor::begin(float sample_rate) {
     _sample_rate = sample_rate;
     
     // Allocate buffers
-    _raw_buffer = (float*)malloc(_buffer_size * sizeof(float));
-    _filtered_buffer = (float*)malloc(_buffer_size * sizeof(float));
+    const size_t frame_bytes = _buffer_size * FCI_NUM_CHANNELS * sizeof(float);
+    _raw_frames = (float*)malloc(frame_bytes);
+    _work_frames = (float*)malloc(frame_bytes);
+    _filtered_block = (float*)malloc(frame_bytes);
     _fft_buffer = (float*)malloc(_buffer_size * sizeof(float));
+    _window = (float*)malloc(_buffer_size * sizeof(float));
     
-    if (!_raw_buffer || !_filtered_buffer || !_fft_buffer) {
+    if (!_raw_frames || !_work_frames || !_filtered_block || !_fft_buffer || !_window) {
+        return false;
+    }
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        _filtered[ch] = _filtered_block + ch * _buffer_size;
+    }
+#if FILTER_USE_Q31
+    _q31_frames = (int32_t*)malloc(_buffer_size * FCI_NUM_CHANNELS * sizeof(int32_t));
+    if (!_q31_frames) {
+        return false;
+    }
+#endif
+    
+    // FFT tables and window are fixed for the buffer size
+    if (!_fft.begin(_buffer_size)) {
+        return false;
+    }
+    computeWindowFunction(_window, _buffer_size);
+    
+    // Welch PSD: its own segment ring per channel, carried across buffers
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        if (!_welch[ch].begin(sample_rate)) {
+            return false;
+        }
+    }
+    
+    // Tone bank: mains by default, stimulus/bio tones added at runtime
+    if (!_tones.begin(sample_rate)) {
+        return false;
+    }
+    _tones.addTone(NOTCH_FREQ_50HZ);
+    _tones.addTone(NOTCH_FREQ_60HZ);
+    
+    // Slow bands: decimated from the unfiltered stream
+    if (!_slow.begin(sample_rate)) {
+        return false;
+    }
+    
+    // Spike detector: sample counts for refractory/duration limits
+    if (!_spikes.begin(sample_rate)) {
         return false;
     }
     
     // Zero buffers
-    memset(_raw_buffer, 0, _buffer_size * sizeof(float));
-    memset(_filtered_buffer, 0, _buffer_size * sizeof(float));
+    memset(_raw_frames, 0, frame_bytes);
+    memset(_work_frames, 0, frame_bytes);
+    memset(_filtered_block, 0, frame_bytes);
     memset(_fft_buffer, 0, _buffer_size * sizeof(float));
     
-    // Compute filter coefficients
+    // Design the filter cascade
     computeFilterCoefficients();
+    if (_filter.sections() == 0 || _notch_section < 0) {
+        return false;
+    }
     
     return true;
 }
 
 void FCISignalProcessor::computeFilterCoefficients() {
-    // Butterworth 2nd-order highpass at 0.1 Hz
-    // Using bilinear transform
-    float fc_hp = FILTER_HIGHPASS_FREQ;
-    float w0_hp = tan(M_PI * fc_hp / _sample_rate);
-    float alpha_hp = w0_hp * w0_hp + sqrt(2.0f) * w0_hp + 1.0f;
-    
-    _hp_b[0] = 1.0f / alpha_hp;
-    _hp_b[1] = -2.0f / alpha_hp;
-    _hp_b[2] = 1.0f / alpha_hp;
-    _hp_a[0] = 1.0f;
-    _hp_a[1] = 2.0f * (w0_hp * w0_hp - 1.0f) / alpha_hp;
-    _hp_a[2] = (w0_hp * w0_hp - sqrt(2.0f) * w0_hp + 1.0f) / alpha_hp;
-    
-    // Butterworth 2nd-order lowpass at 50 Hz
-    float fc_lp = FILTER_LOWPASS_FREQ;
-    float w0_lp = tan(M_PI * fc_lp / _sample_rate);
-    float alpha_lp = w0_lp * w0_lp + sqrt(2.0f) * w0_lp + 1.0f;
-    
-    _lp_b[0] = w0_lp * w0_lp / alpha_lp;
-    _lp_b[1] = 2.0f * w0_lp * w0_lp / alpha_lp;
-    _lp_b[2] = w0_lp * w0_lp / alpha_lp;
-    _lp_a[0] = 1.0f;
-    _lp_a[1] = 2.0f * (w0_lp * w0_lp - 1.0f) / alpha_lp;
-    _lp_a[2] = (w0_lp * w0_lp - sqrt(2.0f) * w0_lp + 1.0f) / alpha_lp;
-    
-    // Notch filter at 50 Hz (adjustable)
-    float fc_notch = NOTCH_FREQ_50HZ;
-    float w0_notch = 2.0f * M_PI * fc_notch / _sample_rate;
-    float bw = w0_notch / NOTCH_Q_FACTOR;
-    float alpha_notch = sin(w0_notch) / (2.0f * NOTCH_Q_FACTOR);
-    
-    float b0 = 1.0f;
-    float b1 = -2.0f * cos(w0_notch);
-    float b2 = 1.0f;
-    float a0 = 1.0f + alpha_notch;
-    float a1 = -2.0f * cos(w0_notch);
-    float a2 = 1.0f - alpha_notch;
-    
-    _notch_b[0] = b0 / a0;
-    _notch_b[1] = b1 / a0;
-    _notch_b[2] = b2 / a0;
-    _notch_a[0] = 1.0f;
-    _notch_a[1] = a1 / a0;
-    _notch_a[2] = a2 / a0;
+    // Bandpass as FILTER_ORDER highpass + FILTER_ORDER lowpass, then the
+    // power line notch, all in one cascade
+    _filter.clear();
+    _filter.addHighpass(FILTER_DESIGN, FILTER_ORDER, FILTER_HIGHPASS_FREQ, _sample_rate);
+    _filter.addLowpass(FILTER_DESIGN, FILTER_ORDER, FILTER_LOWPASS_FREQ, _sample_rate);
+    _notch_section = _filter.addNotch(_notch_freq, NOTCH_Q_FACTOR, _sample_rate);
 }
 
-bool FCISignalProcessor::addSample(int16_t raw_value, uint32_t timestamp_ms) {
-    float uv = rawToMicrovolts(raw_value);
-    
-    _raw_buffer[_buffer_index] = uv;
+bool FCISignalProcessor::setNotchFrequency(float notch_freq) {
+    if (_notch_section < 0 ||
+        !_filter.setNotch(_notch_section, notch_freq, NOTCH_Q_FACTOR, _sample_rate)) {
+        return false;
+    }
+    _notch_freq = notch_freq;
+    return true;
+}
+
+bool FCISignalProcessor::addFrame(const int16_t* raw, uint32_t timestamp_ms) {
+    float* frame = _raw_frames + _buffer_index * FCI_NUM_CHANNELS;
+    float* filtered = _work_frames + _buffer_index * FCI_NUM_CHANNELS;
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        frame[ch] = rawToMicrovolts(raw[ch]);
+    }
     _buffer_index = (_buffer_index + 1) % _buffer_size;
     _sample_count++;
     
-    // Update running statistics
-    updateRunningStats(uv);
+    // Bandpass and power line notch per frame (all channels, all sections),
+    // so spikes are detected as they arrive rather than once per buffer
+    applyFilters(frame, filtered, 1);
+    _spikes.process(filtered, 1, _total_samples);
+    
+    _total_samples++;
+    
+    // Tone tracking runs per sample, before any filtering
+    if (_spectral_mode & SPECTRAL_MODE_TONES) {
+        _tones.addSample(frame[ADC_CHANNEL_BIO_DIFF]);
+    }
+    
+    // Ultra-low bands: ahead of the 0.1 Hz highpass, which would remove them
+    _slow.addSample(frame[ADC_CHANNEL_BIO_DIFF]);
     
     return (_buffer_index == 0);  // Buffer is full
 }
@@ -152,20 +197,44 @@ bool FCISignalProcessor::processBuffer(fci_features_t* features) {
         return false;
     }
     
-    // Apply bandpass filter
-    applyBandpassFilter(_raw_buffer, _filtered_buffer, _buffer_size);
+    // Frames were filtered (and run through the spike detector) in
+    // addFrame(); de-interleave into one contiguous array per channel
+    for (size_t i = 0; i < _buffer_size; i++) {
+        const float* frame = _work_frames + i * FCI_NUM_CHANNELS;
+        for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+            _filtered[ch][i] = frame[ch];
+        }
+    }
+    
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        computeChannelFeatures(ch, &features[ch]);
+    }
     
-    // Apply notch filter for power line interference
-    applyNotchFilter(_filtered_buffer, _filtered_buffer, _buffer_size, NOTCH_FREQ_50HZ);
+    return true;
+}
+
+void FCISignalProcessor::computeChannelFeatures(size_t channel, fci_features_t* features) {
+    float* signal = _filtered[channel];
     
     // Compute time-domain features
-    features->mean_uv = FCIMath::mean(_filtered_buffer, _buffer_size);
-    features->std_uv = FCIMath::stddev(_filtered_buffer, _buffer_size, features->mean_uv);
-    features->rms_uv = FCIMath::rms(_filtered_buffer, _buffer_size);
-    features->amplitude_uv = FCIMath::peakToPeak(_filtered_buffer, _buffer_size);
-    
-    // Compute FFT and spectral features
-    computeFFT(_filtered_buffer, _buffer_size, &features->dominant_freq_hz, &features->total_power);
+    features->mean_uv = FCIMath::mean(signal, _buffer_size);
+    features->std_uv = FCIMath::stddev(signal, _buffer_size, features->mean_uv);
+    features->rms_uv = FCIMath::rms(signal, _buffer_size);
+    features->amplitude_uv = FCIMath::peakToPeak(signal, _buffer_size);
+    
+    // Compute FFT and spectral features (skipped when only tones are tracked)
+    if (_spectral_mode & SPECTRAL_MODE_FFT) {
+        computeFFT(signal, _buffer_size, &features->dominant_freq_hz, &features->total_power);
+        
+        // Welch PSD update and band powers
+        _welch[channel].addSamples(signal, _buffer_size);
+        computeBandPowers(channel, features);
+    } else {
+        features->dominant_freq_hz = 0;
+        features->total_power = 0;
+        features->band_power_low = features->band_power_bio = features->band_power_high = 0;
+        features->band_rel_low = features->band_rel_bio = features->band_rel_high = 0;
+    }
     
     // Compute signal quality
     float noise_floor = 0.5f;  // µV RMS (from calibration)
@@ -174,37 +243,26 @@ bool FCISignalProcessor::processBuffer(fci_features_t* features) {
     
     // Pattern confidence based on SNR and stability
     features->pattern_confidence = FCIMath::clamp(features->snr_db / 20.0f, 0.0f, 1.0f);
-    
-    return true;
 }
 
-float FCISignalProcessor::applyBiquadSection(float input, float* b, float* a, float* state) {
-    // Direct Form II Transposed
-    float output = b[0] * input + state[0];
-    state[0] = b[1] * input - a[1] * output + state[1];
-    state[1] = b[2] * input - a[2] * output;
-    return output;
-}
-
-void FCISignalProcessor::applyBandpassFilter(float* input, float* output, size_t length) {
-    // Apply highpass then lowpass
-    float temp[length];
-    
-    // Highpass
-    for (size_t i = 0; i < length; i++) {
-        temp[i] = applyBiquadSection(input[i], _hp_b, _hp_a, _hp_state);
+void FCISignalProcessor::applyFilters(const float* input, float* output, size_t length) {
+#if FILTER_USE_Q31
+    // Fixed point: ±2x the ADC full scale spans the Q31 range, leaving
+    // headroom for filter overshoot on large steps
+    const size_t n = length * FCI_NUM_CHANNELS;
+    const float full_scale_uv = -rawToMicrovolts(INT16_MIN);
+    const float to_q31 = 1073741824.0f / full_scale_uv;
+    const float from_q31 = full_scale_uv / 1073741824.0f;
+    for (size_t i = 0; i < n; i++) {
+        _q31_frames[i] = (int32_t)lrintf(input[i] * to_q31);
     }
-    
-    // Lowpass
-    for (size_t i = 0; i < length; i++) {
-        output[i] = applyBiquadSection(temp[i], _lp_b, _lp_a, _lp_state);
-    }
-}
-
-void FCISignalProcessor::applyNotchFilter(float* input, float* output, size_t length, float notch_freq) {
-    for (size_t i = 0; i < length; i++) {
-        output[i] = applyBiquadSection(input[i], _notch_b, _notch_a, _notch_state);
+    _filter.processQ31(_q31_frames, _q31_frames, length);
+    for (size_t i = 0; i < n; i++) {
+        output[i] = _q31_frames[i] * from_q31;
     }
+#else
+    _filter.process(input, output, length);
+#endif
 }
 
 void FCISignalProcessor::computeWindowFunction(float* window, size_t length) {
@@ -215,36 +273,35 @@ void FCISignalProcessor::computeWindowFunction(float* window, size_t length) {
 }
 
 void FCISignalProcessor::computeFFT(float* signal, size_t length, float* dominant_freq, float* total_power) {
-    // Copy signal to FFT buffer with windowing
-    float window[length];
-    computeWindowFunction(window, length);
+    *dominant_freq = 0;
+    *total_power = 0;
+    if (length != _fft.size()) {
+        return;
+    }
     
+    // Windowed copy, transformed in place into a packed real spectrum:
+    // _fft_buffer[2k], _fft_buffer[2k + 1] = Re, Im of bin k (0 < k < N/2)
     for (size_t i = 0; i < length; i++) {
-        _fft_buffer[i] = signal[i] * window[i];
+        _fft_buffer[i] = signal[i] * _window[i];
     }
-    
-    // Zero imaginary part (using second half of buffer as imaginary)
-    float imaginary[length];
-    memset(imaginary, 0, length * sizeof(float));
-    
-    // Compute FFT (in-place, using arduinoFFT library)
-    // Note: Simplified implementation - real system would use full library
+    _fft.forward(_fft_buffer);
     
     // Find dominant frequency and total power
-    float max_magnitude = 0;
+    float max_power = 0;
     size_t max_bin = 0;
-    *total_power = 0;
     
-    // Only analyze positive frequencies up to Nyquist
+    // Only analyze positive frequencies up to Nyquist (DC excluded)
     size_t nyquist_bin = length / 2;
     float freq_resolution = _sample_rate / length;
     
     for (size_t i = 1; i < nyquist_bin; i++) {
-        float magnitude = sqrtf(_fft_buffer[i] * _fft_buffer[i] + imaginary[i] * imaginary[i]);
-        *total_power += magnitude * magnitude;
+        float re = _fft_buffer[2 * i];
+        float im = _fft_buffer[2 * i + 1];
+        float power = re * re + im * im;
+        *total_power += power;
         
-        if (magnitude > max_magnitude) {
-            max_magnitude = magnitude;
+        if (power > max_power) {
+            max_power = power;
             max_bin = i;
         }
     }
@@ -253,22 +310,21 @@ void FCISignalProcessor::computeFFT(float* signal, size_t length, float* dominan
     *total_power = sqrtf(*total_power / nyquist_bin);  // RMS spectral power
 }
 
-int FCISignalProcessor::detectSpikes(float* signal, size_t length, uint32_t* spike_times, size_t max_spikes) {
-    int spike_count = 0;
-    float threshold = _running_mean + SPIKE_THRESHOLD_SIGMA * _running_std;
-    
-    for (size_t i = 0; i < length && spike_count < max_spikes; i++) {
-        if (fabsf(signal[i]) > threshold) {
-            // Check refractory period
-            uint32_t current_time = i * (1000 / (int)_sample_rate);
-            if (current_time - _last_spike_time > SPIKE_REFRACTORY_MS) {
-                spike_times[spike_count++] = current_time;
-                _last_spike_time = current_time;
-            }
-        }
-    }
-    
-    return spike_count;
+void FCISignalProcessor::computeBandPowers(size_t channel, fci_features_t* features) {
+    const FCIWelchPSD& welch = _welch[channel];
+    
+    // FREQ_BAND_ULTRA_LOW is below the 0.1 Hz highpass and the PSD's
+    // 0.5 Hz resolution, so bands start at FREQ_BAND_LOW
+    features->band_power_low = welch.bandPower(FREQ_BAND_LOW, FREQ_BAND_MID);
+    features->band_power_bio = welch.bandPower(FREQ_BAND_MID, FREQ_BAND_HIGH);
+    features->band_power_high = welch.bandPower(FREQ_BAND_HIGH, FREQ_BAND_MAX);
+    
+    // Relative to everything from FREQ_BAND_LOW up to Nyquist
+    float total = welch.bandPower(FREQ_BAND_LOW, _sample_rate);
+    float inv = (total > 0) ? 1.0f / total : 0.0f;
+    features->band_rel_low = features->band_power_low * inv;
+    features->band_rel_bio = features->band_power_bio * inv;
+    features->band_rel_high = features->band_power_high * inv;
 }
 
 float FCISignalProcessor::computeQuality(float* signal, size_t length) {
@@ -308,20 +364,6 @@ float FCISignalProcessor::computeImpedance(float stimulus_amp, float response_am
     return response_amp / stimulus_current_ua;
 }
 
-void FCISignalProcessor::updateRunningStats(float value) {
-    _total_samples++;
-    
-    // Welford's online algorithm for running mean and variance
-    float delta = value - _running_mean;
-    _running_mean += delta / _total_samples;
-    float delta2 = value - _running_mean;
-    float m2 = delta * delta2;
-    
-    if (_total_samples > 1) {
-        _running_std = sqrtf(m2 / (_total_samples - 1));
-    }
-}
-
 // ============================================================================
 // FCIStimulusGenerator Implementation
 // ============================================================================
@@ -0,0 +1,233 @@
+/**
+ * FCI SOS Implementation
+ *
+ * Design: the unit-cutoff analog prototype has N/2 conjugate pole pairs
+ *   Butterworth: p_k = -sin(t_k) + j cos(t_k)
+ *   Chebyshev I: p_k = -sinh(mu) sin(t_k) + j cosh(mu) cos(t_k)
+ * with t_k = (2k + 1) pi / 2N and mu = asinh(1 / eps) / N. Each pair is
+ * the section w^2 / (s^2 + a s + w^2), a = -2 Re(p), w^2 = |p|^2; the
+ * highpass uses s -> 1/s. With K = tan(pi fc / fs) (prewarping), the
+ * bilinear transform s = (1/K)(1 - z^-1)/(1 + z^-1) gives
+ *   a0 = 1 + aK + w^2 K^2, a1 = 2 (w^2 K^2 - 1), a2 = 1 - aK + w^2 K^2.
+ * Every section has unity gain at DC (lowpass) or Nyquist (highpass), so
+ * even-order Chebyshev passbands ripple between 0 and +ripple dB and a
+ * highpass + lowpass bandpass reads unity in mid-band.
+ *
+ * Q31: sums of products are formed in unsigned 64-bit arithmetic, so
+ * intermediate wrap-around cancels whenever the section output fits.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_sos.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ============================================================================
+// FCISOSFilter Implementation
+// ============================================================================
+
+FCISOSFilter::FCISOSFilter() {
+    clear();
+}
+
+void FCISOSFilter::clear() {
+    memset(_sections, 0, sizeof(_sections));
+    _count = 0;
+    reset();
+}
+
+void FCISOSFilter::reset() {
+    memset(_state, 0, sizeof(_state));
+    memset(_state_q31, 0, sizeof(_state_q31));
+}
+
+void FCISOSFilter::setSection(Section& s, double b0, double b1, double b2,
+                              double a0, double a1, double a2) {
+    s.b0 = (float)(b0 / a0);
+    s.b1 = (float)(b1 / a0);
+    s.b2 = (float)(b2 / a0);
+    s.a1 = (float)(a1 / a0);
+    s.a2 = (float)(a2 / a0);
+
+    // Smallest shift that puts every coefficient inside the Q31 range
+    const double c[5] = { b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0 };
+    double max_abs = 0;
+    for (int i = 0; i < 5; i++) {
+        if (fabs(c[i]) > max_abs) max_abs = fabs(c[i]);
+    }
+    uint8_t shift = 0;
+    while (shift < 30 && max_abs >= ldexp(1.0, shift)) shift++;
+    s.q_shift = shift;
+
+    int32_t* q[5] = { &s.qb0, &s.qb1, &s.qb2, &s.qa1, &s.qa2 };
+    for (int i = 0; i < 5; i++) {
+        double v = round(ldexp(c[i], 31 - shift));
+        if (v > INT32_MAX) v = INT32_MAX;
+        if (v < INT32_MIN) v = INT32_MIN;
+        *q[i] = (int32_t)v;
+    }
+}
+
+int FCISOSFilter::addPrototype(bool highpass, fci_filter_design_t design, int order,
+                               float cutoff_hz, float sample_rate, float ripple_db) {
+    if (order < 2 || (order & 1) || cutoff_hz <= 0 || cutoff_hz >= sample_rate / 2) {
+        return -1;
+    }
+    const size_t n_sections = order / 2;
+    if (_count + n_sections > FILTER_MAX_SECTIONS) {
+        return -1;
+    }
+
+    double sinh_mu = 1.0, cosh_mu = 1.0;  // Butterworth: poles on the unit circle
+    if (design == FILTER_DESIGN_CHEBYSHEV1) {
+        double eps = sqrt(pow(10.0, ripple_db / 10.0) - 1.0);
+        if (!(eps > 0)) {
+            return -1;
+        }
+        double mu = asinh(1.0 / eps) / order;
+        sinh_mu = sinh(mu);
+        cosh_mu = cosh(mu);
+    }
+
+    const double K = tan(M_PI * cutoff_hz / sample_rate);
+    const double KK = K * K;
+    const int first = (int)_count;
+
+    for (size_t k = 0; k < n_sections; k++) {
+        double theta = M_PI * (2.0 * k + 1.0) / (2.0 * order);
+        double re = -sinh_mu * sin(theta);
+        double im = cosh_mu * cos(theta);
+        double a = -2.0 * re;
+        double w2 = re * re + im * im;
+        if (highpass) {
+            a /= w2;
+            w2 = 1.0 / w2;
+        }
+
+        double a0 = 1.0 + a * K + w2 * KK;
+        double a1 = 2.0 * (w2 * KK - 1.0);
+        double a2 = 1.0 - a * K + w2 * KK;
+
+        if (highpass) {
+            setSection(_sections[_count], 1.0, -2.0, 1.0, a0, a1, a2);
+        } else {
+            double b = w2 * KK;
+            setSection(_sections[_count], b, 2.0 * b, b, a0, a1, a2);
+        }
+        _count++;
+    }
+    return first;
+}
+
+int FCISOSFilter::addLowpass(fci_filter_design_t design, int order, float cutoff_hz,
+                             float sample_rate, float ripple_db) {
+    return addPrototype(false, design, order, cutoff_hz, sample_rate, ripple_db);
+}
+
+int FCISOSFilter::addHighpass(fci_filter_design_t design, int order, float cutoff_hz,
+                              float sample_rate, float ripple_db) {
+    return addPrototype(true, design, order, cutoff_hz, sample_rate, ripple_db);
+}
+
+int FCISOSFilter::addNotch(float notch_hz, float q, float sample_rate) {
+    if (_count >= FILTER_MAX_SECTIONS) {
+        return -1;
+    }
+    if (!setNotch(_count, notch_hz, q, sample_rate)) {
+        return -1;
+    }
+    return (int)_count++;
+}
+
+bool FCISOSFilter::setNotch(size_t section, float notch_hz, float q, float sample_rate) {
+    if (section >= FILTER_MAX_SECTIONS || section > _count ||
+        notch_hz <= 0 || notch_hz >= sample_rate / 2 || q <= 0) {
+        return false;
+    }
+
+    // RBJ notch: zeros on the unit circle at w0, poles just inside
+    double w0 = 2.0 * M_PI * notch_hz / sample_rate;
+    double alpha = sin(w0) / (2.0 * q);
+    double c = -2.0 * cos(w0);
+    setSection(_sections[section], 1.0, c, 1.0, 1.0 + alpha, c, 1.0 - alpha);
+    return true;
+}
+
+void FCISOSFilter::process(const float* input, float* output, size_t frames) {
+    const size_t n = _count;
+
+    // State held locally for the whole buffer; sections fused per frame
+    float z[FILTER_MAX_SECTIONS][2][FCI_NUM_CHANNELS];
+    memcpy(z, _state, n * sizeof(z[0]));
+
+    for (size_t i = 0; i < frames; i++) {
+        float v[FCI_NUM_CHANNELS];
+        memcpy(v, input + i * FCI_NUM_CHANNELS, sizeof(v));
+
+        for (size_t s = 0; s < n; s++) {
+            const Section& c = _sections[s];
+            float* s1 = z[s][0];
+            float* s2 = z[s][1];
+            for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+                float in = v[ch];
+                float out = c.b0 * in + s1[ch];
+                s1[ch] = c.b1 * in - c.a1 * out + s2[ch];
+                s2[ch] = c.b2 * in - c.a2 * out;
+                v[ch] = out;
+            }
+        }
+
+        memcpy(output + i * FCI_NUM_CHANNELS, v, sizeof(v));
+    }
+
+    memcpy(_state, z, n * sizeof(z[0]));
+}
+
+void FCISOSFilter::processQ31(const int32_t* input, int32_t* output, size_t frames) {
+    const size_t n = _count;
+
+    int32_t z[FILTER_MAX_SECTIONS][4][FCI_NUM_CHANNELS];
+    memcpy(z, _state_q31, n * sizeof(z[0]));
+
+    for (size_t i = 0; i < frames; i++) {
+        int32_t v[FCI_NUM_CHANNELS];
+        memcpy(v, input + i * FCI_NUM_CHANNELS, sizeof(v));
+
+        for (size_t s = 0; s < n; s++) {
+            const Section& c = _sections[s];
+            const int out_shift = 31 - c.q_shift;
+            const uint64_t round_bit = (uint64_t)1 << (out_shift - 1);
+            int32_t* x1 = z[s][0];
+            int32_t* x2 = z[s][1];
+            int32_t* y1 = z[s][2];
+            int32_t* y2 = z[s][3];
+            for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+                int32_t in = v[ch];
+                uint64_t acc = (uint64_t)((int64_t)c.qb0 * in)
+                             + (uint64_t)((int64_t)c.qb1 * x1[ch])
+                             + (uint64_t)((int64_t)c.qb2 * x2[ch])
+                             - (uint64_t)((int64_t)c.qa1 * y1[ch])
+                             - (uint64_t)((int64_t)c.qa2 * y2[ch])
+                             + round_bit;
+                int64_t y = (int64_t)acc >> out_shift;
+                if (y > INT32_MAX) y = INT32_MAX;
+                if (y < INT32_MIN) y = INT32_MIN;
+
+                x2[ch] = x1[ch];
+                x1[ch] = in;
+                y2[ch] = y1[ch];
+                y1[ch] = (int32_t)y;
+                v[ch] = (int32_t)y;
+            }
+        }
+
+        memcpy(output + i * FCI_NUM_CHANNELS, v, sizeof(v));
+    }
+
+    memcpy(_state_q31, z, n * sizeof(z[0]));
+}
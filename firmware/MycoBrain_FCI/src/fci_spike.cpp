@@ -0,0 +1,159 @@
+/**
+ * FCI Spike Implementation
+ *
+ * Estimates start as plain running averages (weight 1/n) and switch to
+ * the fixed EW weight after one time constant, so the first threshold is
+ * usable without a long bias toward the zero initial state. An excursion
+ * longer than SPIKE_MAX_DURATION_MS is not a spike: the baseline jumps to
+ * the current sample and detection resumes from there.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_spike.h"
+#include <math.h>
+#include <string.h>
+
+// Gaussian sigma per unit of mean absolute deviation: sqrt(pi / 2)
+static const float SIGMA_PER_MAD = 1.2533141f;
+
+// ============================================================================
+// FCISpikeDetector Implementation
+// ============================================================================
+
+FCISpikeDetector::FCISpikeDetector() :
+    _alpha(0),
+    _warmup_samples(1),
+    _refractory_samples(0),
+    _min_samples(1),
+    _max_samples(UINT16_MAX - 1)
+{
+    reset();
+}
+
+bool FCISpikeDetector::begin(float sample_rate) {
+    if (sample_rate <= 0) {
+        return false;
+    }
+    const float per_ms = sample_rate / 1000.0f;
+
+    _warmup_samples = (uint32_t)ceilf(SPIKE_BASELINE_TAU_MS * per_ms);
+    if (_warmup_samples < 1) _warmup_samples = 1;
+    _alpha = 1.0f / _warmup_samples;
+
+    _refractory_samples = (uint32_t)ceilf(SPIKE_REFRACTORY_MS * per_ms);
+    _min_samples = (uint32_t)ceilf(SPIKE_MIN_DURATION_MS * per_ms);
+    if (_min_samples < 1) _min_samples = 1;
+    _max_samples = (uint32_t)ceilf(SPIKE_MAX_DURATION_MS * per_ms);
+    if (_max_samples > UINT16_MAX - 1) _max_samples = UINT16_MAX - 1;
+
+    reset();
+    return true;
+}
+
+void FCISpikeDetector::reset() {
+    memset(_ch, 0, sizeof(_ch));
+    _queue_head = 0;
+    _queue_count = 0;
+    _dropped = 0;
+    _detected = 0;
+}
+
+void FCISpikeDetector::process(const float* frames, size_t n_frames, uint32_t first_sample) {
+    const float k = SPIKE_THRESHOLD_SIGMA * SIGMA_PER_MAD;
+
+    for (size_t i = 0; i < n_frames; i++) {
+        const uint32_t t = first_sample + (uint32_t)i;
+        const float* frame = frames + i * FCI_NUM_CHANNELS;
+
+        for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+            Channel& c = _ch[ch];
+            const float x = frame[ch];
+            float dev = x - c.mean;
+            float a = fabsf(dev);
+            const int8_t sign = (dev < 0) ? -1 : 1;
+
+            if (c.open) {
+                if (sign == c.polarity && a >= c.onset_threshold * SPIKE_EXIT_RATIO) {
+                    // Still inside: extend, track the peak, stats frozen
+                    if (++c.width > _max_samples) {
+                        c.open = false;
+                        c.mean = x;
+                    } else if (a > c.peak) {
+                        c.peak = a;
+                        c.peak_sample = t;
+                    }
+                    continue;
+                }
+                closeSpike(ch);
+            }
+
+            // Onset: above threshold, estimates settled, refractory over
+            const float thr = k * c.mad;
+            if (c.seen >= _warmup_samples && thr > 0 && a > thr &&
+                (!c.has_last || t - c.last_peak >= _refractory_samples)) {
+                c.open = true;
+                c.polarity = sign;
+                c.width = 1;
+                c.peak = a;
+                c.peak_sample = t;
+                c.onset_threshold = thr;
+                continue;
+            }
+
+            // Baseline sample: update mean and mean absolute deviation
+            const float w = (c.seen < _warmup_samples) ? 1.0f / (c.seen + 1) : _alpha;
+            c.mean += w * dev;
+            c.mad += w * (a - c.mad);
+            if (c.seen < _warmup_samples) c.seen++;
+        }
+    }
+}
+
+void FCISpikeDetector::closeSpike(size_t channel) {
+    Channel& c = _ch[channel];
+    c.open = false;
+    if (c.width < _min_samples) {
+        return;
+    }
+
+    fci_spike_t event;
+    event.peak_sample = c.peak_sample;
+    event.width_samples = c.width;
+    event.channel = (uint8_t)channel;
+    event.polarity = c.polarity;
+    event.amplitude_uv = c.peak;
+    event.threshold_uv = c.onset_threshold;
+    push(event);
+
+    c.has_last = true;
+    c.last_peak = c.peak_sample;
+    _detected++;
+}
+
+void FCISpikeDetector::push(const fci_spike_t& event) {
+    if (_queue_count == SPIKE_EVENT_QUEUE) {
+        _dropped++;
+        return;
+    }
+    _queue[(_queue_head + _queue_count) % SPIKE_EVENT_QUEUE] = event;
+    _queue_count++;
+}
+
+bool FCISpikeDetector::pop(fci_spike_t* event) {
+    if (_queue_count == 0) {
+        return false;
+    }
+    *event = _queue[_queue_head];
+    _queue_head = (_queue_head + 1) % SPIKE_EVENT_QUEUE;
+    _queue_count--;
+    return true;
+}
+
+float FCISpikeDetector::baseline(size_t channel) const {
+    return (channel < FCI_NUM_CHANNELS) ? _ch[channel].mean : 0;
+}
+
+float FCISpikeDetector::threshold(size_t channel) const {
+    return (channel < FCI_NUM_CHANNELS) ? SPIKE_THRESHOLD_SIGMA * SIGMA_PER_MAD * _ch[channel].mad : 0;
+}
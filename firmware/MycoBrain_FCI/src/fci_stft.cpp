@@ -0,0 +1,167 @@
+/**
+ * FCI STFT Implementation
+ *
+ * Windowing in the frequency domain: the periodic Hamming window
+ * w[n] = 0.54 - 0.46 cos(2 pi n / N) has three non-zero DFT terms, so
+ *   X_w[k] = 0.54 X[k] - 0.23 (X[k-1] + X[k+1])
+ * exactly. Each hop therefore costs one copy of the ring, one real FFT
+ * and a few multiplies per kept bin. X[0] is taken as 0, which removes
+ * the frame mean (electrode offset) before windowing.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_stft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HAMMING_A0             0.54f
+#define HAMMING_A1_HALF        0.23f
+#define HAMMING_ENBW           1.363f  // Equivalent noise bandwidth (bins)
+
+// ============================================================================
+// FCISpectrogram Implementation
+// ============================================================================
+
+FCISpectrogram::FCISpectrogram() :
+    _sample_rate(ADC_SAMPLE_FREQ),
+    _frame_size(0),
+    _hop(STFT_HOP_SAMPLES),
+    _bin_hz(0),
+    _ring(nullptr),
+    _frame(nullptr),
+    _head(0),
+    _since_column(0),
+    _total_samples(0),
+    _first_bin(0),
+    _last_bin(0),
+    _band_mid_bin(0),
+    _band_high_bin(0),
+    _amp_scale(0)
+{
+    memset(&_column, 0, sizeof(_column));
+}
+
+FCISpectrogram::~FCISpectrogram() {
+    if (_ring) free(_ring);
+    if (_frame) free(_frame);
+}
+
+size_t FCISpectrogram::frequencyToBin(float hz) const {
+    // First bin at or above hz, clamped to the kept range
+    size_t bin = (size_t)ceilf(hz / _bin_hz);
+    if (bin < _first_bin) bin = _first_bin;
+    if (bin > _last_bin) bin = _last_bin;
+    return bin;
+}
+
+bool FCISpectrogram::begin(float sample_rate, size_t frame_size, size_t hop) {
+    if (!_fft.begin(frame_size)) {
+        return false;
+    }
+
+    if (_ring) free(_ring);
+    if (_frame) free(_frame);
+    _ring = (float*)malloc(frame_size * sizeof(float));
+    _frame = (float*)malloc(frame_size * sizeof(float));
+    if (!_ring || !_frame) {
+        return false;
+    }
+    memset(_ring, 0, frame_size * sizeof(float));
+
+    _sample_rate = sample_rate;
+    _frame_size = frame_size;
+    _bin_hz = sample_rate / frame_size;
+    _head = 0;
+    _since_column = 0;
+    _total_samples = 0;
+    if (!setHop(hop)) {
+        return false;
+    }
+
+    // Kept bins: FREQ_BAND_LOW..FREQ_BAND_MAX, never DC or Nyquist
+    _first_bin = (size_t)ceilf(FREQ_BAND_LOW / _bin_hz);
+    if (_first_bin < 1) _first_bin = 1;
+    _last_bin = (size_t)floorf(FREQ_BAND_MAX / _bin_hz) + 1;
+    if (_last_bin > frame_size / 2) _last_bin = frame_size / 2;
+    if (_first_bin > _last_bin) _first_bin = _last_bin;
+    _band_mid_bin = frequencyToBin(FREQ_BAND_MID);
+    _band_high_bin = frequencyToBin(FREQ_BAND_HIGH);
+
+    // Sinusoid amplitude = 2 |X_w| / sum(w), sum(w) = 0.54 N
+    _amp_scale = 2.0f / (HAMMING_A0 * frame_size);
+
+    memset(&_column, 0, sizeof(_column));
+    return true;
+}
+
+bool FCISpectrogram::setHop(size_t hop) {
+    if (hop < 1 || (_frame_size && hop > _frame_size)) {
+        return false;
+    }
+    _hop = hop;
+    return true;
+}
+
+bool FCISpectrogram::addSample(float value_uv) {
+    if (!_ring) return false;
+
+    _ring[_head] = value_uv;
+    _head = (_head + 1) & (_frame_size - 1);
+    _total_samples++;
+    _since_column++;
+
+    // First column once a full frame is in, then every hop
+    if (_total_samples < _frame_size || _since_column < _hop) {
+        return false;
+    }
+    _since_column = 0;
+    computeColumn();
+    return true;
+}
+
+void FCISpectrogram::computeColumn() {
+    // Unroll the ring oldest-first: [head, N) then [0, head)
+    const size_t tail = _frame_size - _head;
+    memcpy(_frame, _ring + _head, tail * sizeof(float));
+    memcpy(_frame + tail, _ring, _head * sizeof(float));
+    _fft.forward(_frame);
+
+    // Packed spectrum accessors (X[0] dropped: mean removal)
+    const size_t nyquist = _frame_size / 2;
+    auto re = [&](size_t k) -> float {
+        if (k == 0) return 0.0f;
+        return (k == nyquist) ? _frame[1] : _frame[2 * k];
+    };
+    auto im = [&](size_t k) -> float {
+        return (k == 0 || k == nyquist) ? 0.0f : _frame[2 * k + 1];
+    };
+
+    float band_sum[3] = { 0, 0, 0 };
+    size_t n_bins = 0;
+
+    for (size_t k = _first_bin; k < _last_bin; k++) {
+        float wr = HAMMING_A0 * re(k) - HAMMING_A1_HALF * (re(k - 1) + re(k + 1));
+        float wi = HAMMING_A0 * im(k) - HAMMING_A1_HALF * (im(k - 1) + im(k + 1));
+        float amp_sq = (wr * wr + wi * wi) * _amp_scale * _amp_scale;
+
+        int band = (k < _band_mid_bin) ? 0 : (k < _band_high_bin) ? 1 : 2;
+        band_sum[band] += amp_sq;
+
+        if (n_bins < STFT_MAX_BINS) {
+            float db = 10.0f * log10f(amp_sq + 1e-12f);
+            float code = roundf((db - STFT_DB_FLOOR) / STFT_DB_STEP);
+            if (code < 0) code = 0;
+            if (code > 255) code = 255;
+            _column.bins[n_bins++] = (uint8_t)code;
+        }
+    }
+
+    _column.end_sample = _total_samples - 1;
+    _column.n_bins = (uint8_t)n_bins;
+    // Band amplitude of an equivalent sinusoid: correct for window leakage
+    _column.band_low_db = 10.0f * log10f(band_sum[0] / HAMMING_ENBW + 1e-12f);
+    _column.band_bio_db = 10.0f * log10f(band_sum[1] / HAMMING_ENBW + 1e-12f);
+    _column.band_high_db = 10.0f * log10f(band_sum[2] / HAMMING_ENBW + 1e-12f);
+}
@@ -0,0 +1,168 @@
+/**
+ * FCI Tones Implementation
+ *
+ * With S(n) = sum_{k=0..N-1} x(n-k) e^{jwk}, a tone A cos(wm + p) gives
+ * S(n) = (A/2) N e^{j(wn + p)}: amplitude 2|S| / N and the phase at the
+ * newest sample. w is snapped to a whole number of periods per window
+ * (wN = 2 pi c), so e^{jwN} = 1 and DC and every other multiple of fs / N
+ * cancel exactly. The recursion never forgets rounding errors (they
+ * random-walk), so each tracker is periodically recomputed exactly.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_tones.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ============================================================================
+// FCIToneBank Implementation
+// ============================================================================
+
+FCIToneBank::FCIToneBank() :
+    _sample_rate(ADC_SAMPLE_FREQ),
+    _history(nullptr),
+    _history_mask(0),
+    _head(0)
+{
+    memset(_trackers, 0, sizeof(_trackers));
+}
+
+FCIToneBank::~FCIToneBank() {
+    if (_history) free(_history);
+}
+
+bool FCIToneBank::begin(float sample_rate, size_t history) {
+    if (history < 2 || (history & (history - 1)) != 0) {
+        return false;
+    }
+    if (_history) free(_history);
+    _history = (float*)malloc(history * sizeof(float));
+    if (!_history) {
+        return false;
+    }
+    memset(_history, 0, history * sizeof(float));
+    _history_mask = history - 1;
+    _head = 0;
+    _sample_rate = sample_rate;
+    clear();
+    return true;
+}
+
+void FCIToneBank::clear() {
+    memset(_trackers, 0, sizeof(_trackers));
+}
+
+int FCIToneBank::addTone(float freq_hz, float window_s) {
+    for (size_t i = 0; i < TONE_MAX_TRACKERS; i++) {
+        if (!_trackers[i].active) {
+            return setTone(i, freq_hz, window_s) ? (int)i : -1;
+        }
+    }
+    return -1;
+}
+
+bool FCIToneBank::setTone(size_t slot, float freq_hz, float window_s) {
+    if (slot >= TONE_MAX_TRACKERS || !_history) return false;
+    Tracker& t = _trackers[slot];
+    memset(&t, 0, sizeof(t));
+    if (freq_hz <= 0) {
+        return true;  // Slot freed
+    }
+    if (freq_hz >= _sample_rate / 2) {
+        return false;
+    }
+
+    // Whole periods closest to the target window, within the delay line
+    const size_t max_window = _history_mask + 1;
+    const float period = _sample_rate / freq_hz;
+    float cycles = roundf(window_s * freq_hz);
+    if (cycles < 1) cycles = 1;
+    while (cycles > 1 && roundf(cycles * period) > max_window) cycles -= 1;
+    size_t n = (size_t)roundf(cycles * period);
+    if (n < 2 || n > max_window) {
+        return false;
+    }
+
+    // Snap to exactly `cycles` periods in n samples
+    const double w = 2.0 * M_PI * cycles / n;
+    t.freq_hz = (float)(cycles * _sample_rate / n);
+    t.window = n;
+    t.rot_re = (float)cos(w);
+    t.rot_im = (float)sin(w);
+    t.amp_scale = 2.0f / n;
+    t.active = true;
+    return true;
+}
+
+void FCIToneBank::addSample(float value_uv) {
+    if (!_history) return;
+
+    for (size_t i = 0; i < TONE_MAX_TRACKERS; i++) {
+        Tracker& t = _trackers[i];
+        if (!t.active) continue;
+
+        // x(n - N); zero until this tone's window has filled
+        float old = 0;
+        if (t.seen >= t.window) {
+            old = _history[(_head - t.window) & _history_mask];
+        } else {
+            t.seen++;
+        }
+        float s_re = t.rot_re * t.s_re - t.rot_im * t.s_im + value_uv - old;
+        float s_im = t.rot_im * t.s_re + t.rot_re * t.s_im;
+        t.s_re = s_re;
+        t.s_im = s_im;
+        t.since_refresh++;
+    }
+
+    _history[_head] = value_uv;
+    _head = (_head + 1) & _history_mask;
+
+    for (size_t i = 0; i < TONE_MAX_TRACKERS; i++) {
+        Tracker& t = _trackers[i];
+        if (t.active && t.since_refresh >= t.window * TONE_REFRESH_WINDOWS) {
+            refresh(t);
+        }
+    }
+}
+
+void FCIToneBank::refresh(Tracker& t) {
+    // S(n) = sum x(n-k) e^{jwk}, newest sample first; the twiddle is
+    // rotated in float, which stays well inside the drift being removed
+    float s_re = 0, s_im = 0;
+    float w_re = 1.0f, w_im = 0.0f;
+    size_t idx = _head - 1;
+    for (size_t k = 0; k < t.window; k++, idx--) {
+        float x = _history[idx & _history_mask];
+        s_re += x * w_re;
+        s_im += x * w_im;
+        float next_re = w_re * t.rot_re - w_im * t.rot_im;
+        w_im = w_re * t.rot_im + w_im * t.rot_re;
+        w_re = next_re;
+    }
+    t.s_re = s_re;
+    t.s_im = s_im;
+    t.since_refresh = 0;
+}
+
+bool FCIToneBank::getTone(size_t slot, fci_tone_t* out) const {
+    if (slot >= TONE_MAX_TRACKERS) return false;
+    const Tracker& t = _trackers[slot];
+    if (!t.active || t.seen < t.window) return false;
+
+    out->freq_hz = t.freq_hz;
+    out->amplitude_uv = t.amp_scale * sqrtf(t.s_re * t.s_re + t.s_im * t.s_im);
+    out->phase_rad = atan2f(t.s_im, t.s_re);
+    return true;
+}
+
+size_t FCIToneBank::windowSamples(size_t slot) const {
+    if (slot >= TONE_MAX_TRACKERS || !_trackers[slot].active) return 0;
+    return _trackers[slot].window;
+}
@@ -0,0 +1,159 @@
+/**
+ * FCI Welch PSD Implementation
+ *
+ * PSD[k] = c_k |X_w[k]|^2 / (fs * sum(w^2)), c_k = 2 except DC and
+ * Nyquist, averaged over segments. Hann segments at 50% overlap are
+ * nearly uncorrelated, and the steady-state exponential average with
+ * weight 1/K keeps about 1/(2K - 1) of a single periodogram's variance.
+ *
+ * (c) 2026 Mycosoft Labs
+ */
+
+#include "fci_welch.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ============================================================================
+// FCIWelchPSD Implementation
+// ============================================================================
+
+FCIWelchPSD::FCIWelchPSD() :
+    _sample_rate(ADC_SAMPLE_FREQ),
+    _segment_size(0),
+    _hop(0),
+    _averages(1),
+    _bin_hz(0),
+    _psd_scale(0),
+    _ring(nullptr),
+    _window(nullptr),
+    _frame(nullptr),
+    _psd(nullptr),
+    _head(0),
+    _filled(0),
+    _since_segment(0),
+    _segments(0)
+{
+}
+
+FCIWelchPSD::~FCIWelchPSD() {
+    if (_ring) free(_ring);
+    if (_window) free(_window);
+    if (_frame) free(_frame);
+    if (_psd) free(_psd);
+}
+
+bool FCIWelchPSD::begin(float sample_rate, size_t segment_size, size_t hop, size_t averages) {
+    if (hop < 1 || hop > segment_size || averages < 1) {
+        return false;
+    }
+    if (!_fft.begin(segment_size)) {
+        return false;
+    }
+
+    if (_ring) free(_ring);
+    if (_window) free(_window);
+    if (_frame) free(_frame);
+    if (_psd) free(_psd);
+    _ring = (float*)malloc(segment_size * sizeof(float));
+    _window = (float*)malloc(segment_size * sizeof(float));
+    _frame = (float*)malloc(segment_size * sizeof(float));
+    _psd = (float*)malloc((segment_size / 2 + 1) * sizeof(float));
+    if (!_ring || !_window || !_frame || !_psd) {
+        return false;
+    }
+
+    _sample_rate = sample_rate;
+    _segment_size = segment_size;
+    _hop = hop;
+    _averages = averages;
+    _bin_hz = sample_rate / segment_size;
+
+    // Periodic Hann: w(n) = 0.5 - 0.5 cos(2πn / N)
+    float sum_sq = 0;
+    for (size_t i = 0; i < segment_size; i++) {
+        _window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / segment_size);
+        sum_sq += _window[i] * _window[i];
+    }
+    _psd_scale = 1.0f / (sample_rate * sum_sq);
+
+    reset();
+    return true;
+}
+
+void FCIWelchPSD::reset() {
+    if (!_ring) return;
+    memset(_ring, 0, _segment_size * sizeof(float));
+    memset(_psd, 0, bins() * sizeof(float));
+    _head = 0;
+    _filled = 0;
+    _since_segment = 0;
+    _segments = 0;
+}
+
+size_t FCIWelchPSD::addSamples(const float* samples, size_t length) {
+    if (!_ring) return 0;
+
+    size_t added = 0;
+    const size_t mask = _segment_size - 1;
+    for (size_t i = 0; i < length; i++) {
+        _ring[_head] = samples[i];
+        _head = (_head + 1) & mask;
+        if (_filled < _segment_size) _filled++;
+        _since_segment++;
+
+        // First segment once the ring is full, then every hop
+        if (_filled == _segment_size && _since_segment >= _hop) {
+            _since_segment = 0;
+            addSegment();
+            added++;
+        }
+    }
+    return added;
+}
+
+void FCIWelchPSD::addSegment() {
+    // Window while unrolling the ring oldest-first
+    const size_t tail = _segment_size - _head;
+    for (size_t i = 0; i < tail; i++) {
+        _frame[i] = _ring[_head + i] * _window[i];
+    }
+    for (size_t i = 0; i < _head; i++) {
+        _frame[tail + i] = _ring[i] * _window[tail + i];
+    }
+    _fft.forward(_frame);
+
+    // Running mean: exact for the first `averages` segments, then
+    // exponential with the same weight
+    if (_segments < _averages) _segments++;
+    const float alpha = 1.0f / _segments;
+    const size_t nyquist = _segment_size / 2;
+
+    float p0 = _frame[0] * _frame[0] * _psd_scale;
+    float pn = _frame[1] * _frame[1] * _psd_scale;
+    _psd[0] += alpha * (p0 - _psd[0]);
+    _psd[nyquist] += alpha * (pn - _psd[nyquist]);
+    for (size_t k = 1; k < nyquist; k++) {
+        float re = _frame[2 * k], im = _frame[2 * k + 1];
+        float p = 2.0f * (re * re + im * im) * _psd_scale;
+        _psd[k] += alpha * (p - _psd[k]);
+    }
+}
+
+float FCIWelchPSD::bandPower(float f_lo, float f_hi) const {
+    if (!_psd || _segments == 0) return 0;
+
+    size_t k0 = (size_t)ceilf(f_lo / _bin_hz);
+    size_t k1 = (size_t)ceilf(f_hi / _bin_hz);
+    if (k1 > bins()) k1 = bins();
+
+    float sum = 0;
+    for (size_t k = k0; k < k1; k++) {
+        sum += _psd[k];
+    }
+    return sum * _bin_hz;
+}
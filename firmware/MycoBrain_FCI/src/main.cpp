@@ -23,10 +23,14 @@
 #include <Adafruit_ADS1X15.h>
 #include <Adafruit_BME680.h>
 #include <Adafruit_NeoPixel.h>
-#include <arduinoFFT.h>
+#include <esp_timer.h>
 
 #include "fci_config.h"
 #include "fci_signal.h"
+#include "fci_stft.h"
+#include "fci_history.h"
+#include "fci_ring.h"
+#include "fci_pipeline.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
@@ -38,6 +42,8 @@ Adafruit_NeoPixel pixel(1, NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800);
 WebSocketsClient webSocket;
 FCISignalProcessor signalProcessor;
 FCIStimulusGenerator stimulator;
+FCISpectrogram spectrogram;
+FCIFeatureHistory featureHistory;        // Tiered feature history (PSRAM)
 
 // Device identity
 char deviceId[16];
@@ -56,54 +62,173 @@ const char* API_KEY = "mcr_fci_device_key";  // Will be provisioned
 // SIGNAL BUFFERS
 // ============================================================================
 
-// Raw sample buffer (circular)
-volatile int16_t sampleBuffer[ADC_BUFFER_SIZE];
-volatile size_t sampleWriteIndex = 0;
-volatile size_t sampleReadIndex = 0;
-volatile bool bufferReady = false;
+// Timestamped frames: acquisition task -> DSP task (lock-free SPSC)
+FCIFrameRing sampleRing;
 
-// Processing buffer
-float processingBuffer[FFT_SAMPLES];
-float frequencyBuffer[FFT_SAMPLES];
+// Tone bank slot following the stimulus frequency (-1 = none, DSP task)
+int stimulusToneSlot = -1;
 
-// FFT objects
-ArduinoFFT<float> FFT = ArduinoFFT<float>(processingBuffer, frequencyBuffer, FFT_SAMPLES, FFT_SAMPLE_FREQ, true);
+// Spectrogram columns waiting to be sent (encoder task)
+fci_spectrogram_column_t spectrogramColumns[STFT_COLUMNS_PER_MSG];
+size_t spectrogramCount = 0;
 
 // ============================================================================
 // TELEMETRY STATE
 // ============================================================================
 
-fci_telemetry_t currentTelemetry;
-fci_features_t currentFeatures;
-uint32_t lastTelemetryTime = 0;
+fci_telemetry_t currentTelemetry;        // Environment: loop(); counts: DSP task
+fci_features_t channelFeatures[FCI_NUM_CHANNELS];  // DSP task
+fci_features_t& currentFeatures = channelFeatures[ADC_CHANNEL_BIO_DIFF];  // Primary pair
+uint32_t lastTelemetryTime = 0;          // Encoder task
 uint32_t lastEnvReadTime = 0;
 uint32_t bootTime = 0;
-bool wsConnected = false;
+volatile bool wsConnected = false;       // Written by the network task
 
 // ============================================================================
-// SAMPLING TIMER (Hardware timer for precise sampling)
+// PIPELINE (Tasks, queues, ping-pong DSP output blocks)
+// ============================================================================
+
+// DSP output for one PIPE_BLOCK_FRAMES period, handed to the encoder
+typedef struct {
+    bool has_features;                   // processBuffer() ran in this block
+    uint32_t features_time_s;            // deviceSeconds() when it did
+    fci_features_t features[FCI_NUM_CHANNELS];
+    uint32_t sample_count;
+    uint8_t spectral_mode;
+    bool tone_valid[TONE_MAX_TRACKERS];
+    fci_tone_t tones[TONE_MAX_TRACKERS];
+    int stimulus_tone_slot;
+    bool slow_valid[DECIM_STAGES];
+    fci_slow_features_t slow[DECIM_STAGES];
+    float spike_threshold[FCI_NUM_CHANNELS];
+    uint32_t spikes_detected;
+    uint32_t spikes_dropped;
+    size_t n_spikes;
+    fci_spike_t spikes[SPIKE_EVENT_QUEUE];
+    uint16_t stft_hop;
+    size_t n_columns;
+    fci_spectrogram_column_t columns[PIPE_BLOCK_FRAMES];  // One per frame at most (hop 1)
+} dsp_block_t;
+
+// Encoder input: a filled block, a calibration result or a history query
+typedef enum {
+    JOB_BLOCK,
+    JOB_CALIBRATION,
+    JOB_HISTORY
+} encoder_job_type_t;
+
+typedef struct {
+    encoder_job_type_t type;
+    uint8_t slot;                        // JOB_BLOCK: dspBlocks index
+    float baseline_uv;                   // JOB_CALIBRATION
+    float noise_floor_uv;
+    char* text;                          // JOB_HISTORY: command JSON (heap)
+} encoder_job_t;
+
+// Network input: one serialized message (heap, freed by the network task)
+typedef struct {
+    char* json;
+    size_t length;
+    bool http_fallback;                  // POST over HTTP while the socket is down
+} net_message_t;
+
+TaskHandle_t dspTask = NULL;
+TaskHandle_t encoderTask = NULL;
+TaskHandle_t networkTask = NULL;
+QueueHandle_t freeBlockQueue = NULL;     // Encoder -> DSP: released slots
+QueueHandle_t encoderQueue = NULL;       // DSP/network -> encoder: jobs
+QueueHandle_t commandQueue = NULL;       // Network -> DSP: command JSON (heap)
+QueueHandle_t netQueue = NULL;           // Encoder -> network: messages
+dsp_block_t dspBlocks[PIPE_BLOCK_SLOTS];
+dsp_block_t dspStaging;                  // DSP task: block being collected
+volatile uint32_t spectrogramDrops = 0;  // DSP task: columns lost, staging full
+dsp_block_t latestBlock;                 // Encoder task: newest snapshot
+FCIStageStats stageStats[STAGE_COUNT];
+
+// Calibration runs inside the DSP task on the live frames
+volatile bool calibrating = false;
+int calibrationCount = 0;
+float calibrationSum = 0;
+float calibrationSumSq = 0;
+
+// ============================================================================
+// ACQUISITION (Hardware timer tick -> task -> ADS1115 ALERT/RDY)
 // ============================================================================
 
 hw_timer_t* sampleTimer = NULL;
 portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t acqTask = NULL;
+SemaphoreHandle_t adcReady = NULL;
+volatile int64_t sampleTickUs = 0;       // esp_timer time of the last tick
+
+// Acquisition counters (written by the acquisition task only)
+volatile uint32_t acqFrames = 0;
+volatile uint32_t acqMissedTicks = 0;    // Ticks that arrived mid-frame
+volatile uint32_t acqAdcTimeouts = 0;    // Conversions without ALERT/RDY
 
 void IRAM_ATTR onSampleTimer() {
+    // No I2C here: timestamp the tick and wake the acquisition task
     portENTER_CRITICAL_ISR(&timerMux);
+    sampleTickUs = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&timerMux);
     
-    // Read differential bioelectric signal (A0-A1)
-    // Note: This is blocking in ISR but ADS1115 is fast enough at 128 SPS
-    int16_t raw = ads.readADC_Differential_0_1();
-    
-    // Store in circular buffer
-    sampleBuffer[sampleWriteIndex] = raw;
-    sampleWriteIndex = (sampleWriteIndex + 1) % ADC_BUFFER_SIZE;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(acqTask, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void IRAM_ATTR onAdcReady() {
+    // ALERT/RDY falling edge: conversion result is ready
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(adcReady, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void acquisitionTask(void* param) {
+    // Bioelectric (A0-A1) and reference (A2-A3), indexed by ADC_CHANNEL_*
+    static const uint16_t pairMux[FCI_NUM_CHANNELS] = {
+        ADS1X15_REG_CONFIG_MUX_DIFF_0_1, ADS1X15_REG_CONFIG_MUX_DIFF_2_3
+    };
     
-    // Check if buffer is full
-    if (sampleWriteIndex == 0) {
-        bufferReady = true;
+    for (;;) {
+        // Pending tick count: more than one means ticks were missed
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        stageStats[STAGE_ACQUIRE].enter(esp_timer_get_time());
+        stageStats[STAGE_ACQUIRE].queueLevel(ticks);
+        if (ticks > 1) {
+            acqMissedTicks += ticks - 1;
+            stageStats[STAGE_ACQUIRE].drop(ticks - 1);
+        }
+        
+        fci_frame_t frame;
+        portENTER_CRITICAL(&timerMux);
+        frame.timestamp_us = sampleTickUs;
+        portEXIT_CRITICAL(&timerMux);
+        
+        // Each pair: start a single-shot conversion, block (not spin)
+        // until ALERT/RDY signals completion, then read the result
+        bool ok = true;
+        for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+            xSemaphoreTake(adcReady, 0);  // Discard a stale edge
+            ads.startADCReading(pairMux[ch], false);
+            if (xSemaphoreTake(adcReady, pdMS_TO_TICKS(ACQ_RDY_TIMEOUT_MS)) != pdTRUE) {
+                acqAdcTimeouts++;
+                ok = false;
+                break;
+            }
+            frame.raw[ch] = ads.getLastConversionResults();
+        }
+        
+        if (ok) {
+            // Full ring: dropped and counted (reported as the DSP stage's drops)
+            if (!sampleRing.push(frame)) {
+                stageStats[STAGE_DSP].drop();
+            }
+            acqFrames++;
+            xTaskNotifyGive(dspTask);
+        }
+        stageStats[STAGE_ACQUIRE].leave(esp_timer_get_time());
     }
-    
-    portEXIT_CRITICAL_ISR(&timerMux);
 }
 
 // ============================================================================
@@ -115,15 +240,11 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
         case WStype_DISCONNECTED:
             Serial.println("[WS] Disconnected");
             wsConnected = false;
-            pixel.setPixelColor(0, pixel.Color(255, 165, 0)); // Orange
-            pixel.show();
             break;
             
         case WStype_CONNECTED:
             Serial.printf("[WS] Connected to %s\n", payload);
             wsConnected = true;
-            pixel.setPixelColor(0, pixel.Color(0, 255, 0)); // Green
-            pixel.show();
             // Subscribe to device command channel
             {
                 JsonDocument doc;
@@ -155,14 +276,46 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
 }
 
 void handleWebSocketMessage(char* payload, size_t length) {
+    // Network task: hand the command to the stage owning the state it
+    // touches; history queries to the encoder, everything else to DSP
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
+    DeserializationError error = deserializeJson(doc, payload, length);
     
     if (error) {
         Serial.printf("[WS] JSON parse error: %s\n", error.c_str());
         return;
     }
     
+    const char* action = doc["action"] | "";
+    char* text = (char*)malloc(length + 1);
+    if (!text) {
+        return;
+    }
+    memcpy(text, payload, length);
+    text[length] = '\0';
+    
+    if (strcmp(action, "history") == 0) {
+        encoder_job_t job = {};
+        job.type = JOB_HISTORY;
+        job.text = text;
+        if (xQueueSend(encoderQueue, &job, 0) != pdTRUE) {
+            free(text);
+            stageStats[STAGE_ENCODE].drop();
+            Serial.println("[WS] History query dropped (encoder queue full)");
+        }
+    } else if (xQueueSend(commandQueue, &text, 0) != pdTRUE) {
+        free(text);
+        Serial.printf("[WS] Command '%s' dropped (queue full)\n", action);
+    }
+}
+
+void handleDspCommand(const char* text) {
+    // DSP task: owns the processor, spectrogram, stimulator and calibration
+    JsonDocument doc;
+    if (deserializeJson(doc, text)) {
+        return;
+    }
+    
     const char* action = doc["action"] | "";
     
     if (strcmp(action, "stimulus") == 0) {
@@ -179,12 +332,21 @@ void handleWebSocketMessage(char* payload, size_t length) {
         
         Serial.printf("[STIM] Starting %s stimulus: %.1f µV @ %.1f Hz for %u ms\n",
                       waveform, amplitude, frequency, duration);
-        stimulator.startStimulus(wf, amplitude, frequency, duration);
+        if (stimulator.startStimulus(wf, amplitude, frequency, duration) &&
+            wf != STIM_WAVEFORM_DC && frequency > 0) {
+            // Track the response at the stimulus frequency
+            FCIToneBank& tones = signalProcessor.tones();
+            if (stimulusToneSlot < 0) {
+                stimulusToneSlot = tones.addTone(frequency);
+            } else if (!tones.setTone(stimulusToneSlot, frequency)) {
+                stimulusToneSlot = -1;
+            }
+        }
         
     } else if (strcmp(action, "calibrate") == 0) {
         // Handle calibration command
         Serial.println("[CAL] Starting calibration...");
-        performCalibration();
+        startCalibration();
         
     } else if (strcmp(action, "config") == 0) {
         // Handle configuration update
@@ -192,22 +354,73 @@ void handleWebSocketMessage(char* payload, size_t length) {
             // Would need to restart timer with new rate
             Serial.printf("[CFG] Sample rate update requested: %d\n", (int)doc["sample_rate"]);
         }
+        if (doc.containsKey("notch_hz")) {
+            // Power line notch: 50 (Europe/Asia) or 60 (Americas)
+            float hz = doc["notch_hz"];
+            bool ok = (hz == NOTCH_FREQ_50HZ || hz == NOTCH_FREQ_60HZ) &&
+                      signalProcessor.setNotchFrequency(hz);
+            Serial.printf("[CFG] Notch %.0f Hz: %s\n", hz, ok ? "OK" : "rejected");
+        }
+        if (doc.containsKey("spectral_mode")) {
+            // "fft", "tones" or "both"
+            const char* mode = doc["spectral_mode"] | "both";
+            uint8_t m = SPECTRAL_MODE_BOTH;
+            if (strcmp(mode, "fft") == 0) m = SPECTRAL_MODE_FFT;
+            else if (strcmp(mode, "tones") == 0) m = SPECTRAL_MODE_TONES;
+            signalProcessor.setSpectralMode(m);
+            Serial.printf("[CFG] Spectral mode: %s\n", mode);
+        }
+        if (doc.containsKey("tones")) {
+            // Replace the tracked tone set, e.g. [50, 60, 4.0]
+            FCIToneBank& tones = signalProcessor.tones();
+            tones.clear();
+            stimulusToneSlot = -1;
+            for (JsonVariant f : doc["tones"].as<JsonArray>()) {
+                if (tones.addTone(f.as<float>()) < 0) {
+                    Serial.printf("[CFG] Tone %.2f Hz rejected\n", f.as<float>());
+                }
+            }
+        }
+        if (doc.containsKey("stft_hop")) {
+            // Spectrogram overlap: hop = frame/2 (50%), frame/4 (75%), ...
+            int hop = doc["stft_hop"];
+            bool ok = hop > 0 && spectrogram.setHop((size_t)hop);
+            Serial.printf("[CFG] STFT hop %d samples: %s\n", hop, ok ? "OK" : "rejected");
+        }
     }
 }
 
+void handleHistoryQuery(const char* text) {
+    // Encoder task: owns the feature history
+    JsonDocument doc;
+    if (deserializeJson(doc, text)) {
+        return;
+    }
+    
+    // Bulk backfill: "last_s" or "from_s"/"to_s" (device seconds),
+    // optional "tier" (raw/minute/hour/day/auto) and "max_points"
+    uint32_t now_s = deviceSeconds();
+    uint32_t to_s = doc["to_s"] | now_s;
+    uint32_t from_s = doc["from_s"] | 0;
+    if (doc.containsKey("last_s")) {
+        uint32_t last_s = doc["last_s"];
+        from_s = (last_s < to_s) ? to_s - last_s : 0;
+    }
+    const char* tier = doc["tier"] | "auto";
+    size_t maxPoints = doc["max_points"] | HISTORY_DEFAULT_POINTS;
+    sendHistory(doc["request_id"] | "", from_s, to_s, tier, maxPoints);
+}
+
 // ============================================================================
 // TELEMETRY FUNCTIONS
 // ============================================================================
 
-void sendTelemetry() {
-    // Build telemetry JSON
-    JsonDocument doc;
-    
+void fillEnvelopeHeader(JsonDocument& doc, const char* stream, const char* message_type, int ttl_seconds) {
     // Envelope header (Mycorrhizae Protocol format)
     doc["id"] = generateUUID();
-    doc["channel"] = String("device.") + deviceId + ".telemetry";
+    doc["channel"] = String("device.") + deviceId + "." + stream;
     doc["timestamp"] = getISOTimestamp();
-    doc["ttl_seconds"] = 3600;
+    doc["ttl_seconds"] = ttl_seconds;
     
     // Source identification
     JsonObject source = doc["source"].to<JsonObject>();
@@ -216,22 +429,110 @@ void sendTelemetry() {
     source["device_serial"] = macAddress;
     source["firmware"] = FCI_FIRMWARE_VERSION;
     
-    doc["message_type"] = "fci_telemetry";
+    doc["message_type"] = message_type;
+}
+
+bool queueMessage(JsonDocument& doc, bool httpFallback, TickType_t wait) {
+    // Encoder -> network: serialized once into a heap buffer the network
+    // task sends and frees
+    net_message_t msg;
+    msg.length = measureJson(doc);
+    msg.json = (char*)malloc(msg.length + 1);
+    msg.http_fallback = httpFallback;
+    if (!msg.json) {
+        stageStats[STAGE_NETWORK].drop();
+        return false;
+    }
+    serializeJson(doc, msg.json, msg.length + 1);
+    
+    if (xQueueSend(netQueue, &msg, wait) != pdTRUE) {
+        free(msg.json);
+        stageStats[STAGE_NETWORK].drop();
+        return false;
+    }
+    return true;
+}
+
+void sendTelemetry(const dsp_block_t& block) {
+    // Build telemetry JSON from the newest DSP block
+    JsonDocument doc;
+    fillEnvelopeHeader(doc, "telemetry", "fci_telemetry", 3600);
     
     // Payload - bioelectric features
     JsonObject payload = doc["payload"].to<JsonObject>();
     
+    const fci_features_t& primary = block.features[ADC_CHANNEL_BIO_DIFF];
     JsonObject bio = payload["bioelectric"].to<JsonObject>();
-    bio["amplitude_uv"] = currentFeatures.amplitude_uv;
-    bio["rms_uv"] = currentFeatures.rms_uv;
-    bio["mean_uv"] = currentFeatures.mean_uv;
-    bio["std_uv"] = currentFeatures.std_uv;
-    bio["dominant_freq_hz"] = currentFeatures.dominant_freq_hz;
-    bio["total_power"] = currentFeatures.total_power;
-    bio["snr_db"] = currentFeatures.snr_db;
-    bio["pattern"] = patternToString(currentFeatures.pattern);
-    bio["pattern_confidence"] = currentFeatures.pattern_confidence;
-    bio["sample_count"] = currentTelemetry.sample_count;
+    bio["amplitude_uv"] = primary.amplitude_uv;
+    bio["rms_uv"] = primary.rms_uv;
+    bio["mean_uv"] = primary.mean_uv;
+    bio["std_uv"] = primary.std_uv;
+    bio["dominant_freq_hz"] = primary.dominant_freq_hz;
+    bio["total_power"] = primary.total_power;
+    bio["snr_db"] = primary.snr_db;
+    bio["pattern"] = patternToString(primary.pattern);
+    bio["pattern_confidence"] = primary.pattern_confidence;
+    bio["sample_count"] = block.sample_count;
+    
+    // Welch band powers: absolute (µV²) and fraction of 0.1 Hz..Nyquist
+    JsonObject bands = bio["bands"].to<JsonObject>();
+    JsonObject low = bands["low"].to<JsonObject>();
+    low["power_uv2"] = primary.band_power_low;
+    low["rel"] = primary.band_rel_low;
+    JsonObject bioBand = bands["bio"].to<JsonObject>();
+    bioBand["power_uv2"] = primary.band_power_bio;
+    bioBand["rel"] = primary.band_rel_bio;
+    JsonObject high = bands["high"].to<JsonObject>();
+    high["power_uv2"] = primary.band_power_high;
+    high["rel"] = primary.band_rel_high;
+    
+    // Tracked tones: amplitude and phase at the newest sample
+    if (block.spectral_mode & SPECTRAL_MODE_TONES) {
+        JsonArray toneArr = bio["tones"].to<JsonArray>();
+        for (size_t i = 0; i < TONE_MAX_TRACKERS; i++) {
+            if (!block.tone_valid[i]) continue;
+            const fci_tone_t& tone = block.tones[i];
+            JsonObject t = toneArr.add<JsonObject>();
+            t["freq_hz"] = tone.freq_hz;
+            t["amplitude_uv"] = tone.amplitude_uv;
+            t["phase_rad"] = tone.phase_rad;
+            t["stimulus"] = ((int)i == block.stimulus_tone_slot);
+        }
+    }
+    
+    // Ultra-low-frequency stages (1 Hz, 1/min, 1/h), once analyzed
+    JsonArray slow = bio["slow"].to<JsonArray>();
+    for (size_t i = 0; i < DECIM_STAGES; i++) {
+        if (!block.slow_valid[i]) continue;
+        const fci_slow_features_t& sf = block.slow[i];
+        JsonObject st = slow.add<JsonObject>();
+        st["rate_hz"] = sf.rate_hz;
+        st["samples"] = sf.samples;
+        st["mean_uv"] = sf.mean_uv;
+        st["std_uv"] = sf.std_uv;
+        st["min_uv"] = sf.min_uv;
+        st["max_uv"] = sf.max_uv;
+        st["slope_uv_per_h"] = sf.slope_uv_per_h;
+        st["period_s"] = sf.dominant_period_s;
+        st["period_amp_uv"] = sf.dominant_amp_uv;
+        st["period_rel"] = sf.dominant_rel;
+    }
+    
+    // Per-channel summary (the fields above are the primary pair)
+    JsonArray channels = bio["channels"].to<JsonArray>();
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        const fci_features_t& f = block.features[ch];
+        JsonObject c = channels.add<JsonObject>();
+        c["channel"] = ch;
+        c["amplitude_uv"] = f.amplitude_uv;
+        c["rms_uv"] = f.rms_uv;
+        c["mean_uv"] = f.mean_uv;
+        c["dominant_freq_hz"] = f.dominant_freq_hz;
+        c["snr_db"] = f.snr_db;
+        c["band_rel_bio"] = f.band_rel_bio;
+        c["pattern"] = patternToString(f.pattern);
+        c["spike_threshold_uv"] = block.spike_threshold[ch];
+    }
     
     // Environmental data
     JsonObject env = payload["environment"].to<JsonObject>();
@@ -247,19 +548,221 @@ void sendTelemetry() {
     status["impedance_ohms"] = currentTelemetry.impedance_ohms;
     status["stimulus_active"] = stimulator.isActive();
     
-    // Serialize and send
-    String jsonStr;
-    serializeJson(doc, jsonStr);
+    // Acquisition health: every counter but frames should stay at 0
+    JsonObject acq = status["acquisition"].to<JsonObject>();
+    acq["frames"] = acqFrames;
+    acq["missed_ticks"] = acqMissedTicks;
+    acq["adc_timeouts"] = acqAdcTimeouts;
+    acq["ring_overruns"] = sampleRing.overruns();
+    acq["ring_high_water"] = sampleRing.highWater();
+    acq["ring_capacity"] = sampleRing.capacity();
     
-    if (wsConnected) {
-        webSocket.sendTXT(jsonStr);
-    } else {
-        // Fallback to HTTP POST
-        sendHTTPTelemetry(jsonStr);
+    // Pipeline stages: load and input queue of each task
+    JsonArray pipeline = status["pipeline"].to<JsonArray>();
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        fci_stage_stats_t st;
+        stageStats[i].snapshot(&st);
+        JsonObject stage = pipeline.add<JsonObject>();
+        stage["stage"] = stageStats[i].name();
+        stage["busy_pct"] = st.busy_pct;
+        stage["runs_per_s"] = st.runs_per_s;
+        stage["max_run_us"] = st.max_run_us;
+        stage["queue"] = st.queue_now;
+        stage["queue_peak"] = st.queue_peak;
+        stage["queue_capacity"] = st.queue_capacity;
+        stage["drops"] = st.drops;
     }
+    // Spectrogram columns lost while the encoder held every block slot
+    // (also in the encode stage's drops)
+    status["spectrogram_drops"] = spectrogramDrops;
+    
+    // Sent over HTTP POST while the socket is down
+    queueMessage(doc, true, 0);
 }
 
-void sendHTTPTelemetry(const String& json) {
+void sendHistory(const char* requestId, uint32_t from_s, uint32_t to_s,
+                 const char* tierName, size_t maxPoints) {
+    // Bulk transfer: WebSocket only, one request answered in pages
+    if (!wsConnected) {
+        Serial.println("[HIST] Query dropped (offline)");
+        return;
+    }
+    
+    fci_history_tier_t tier = featureHistory.selectTier(from_s, to_s, maxPoints);
+    for (size_t t = 0; t < HISTORY_TIER_COUNT; t++) {
+        if (strcmp(tierName, FCIFeatureHistory::tierName((fci_history_tier_t)t)) == 0) {
+            tier = (fci_history_tier_t)t;
+        }
+    }
+    const bool raw = (tier == HISTORY_TIER_RAW);
+    const size_t total = featureHistory.count(tier, from_s, to_s);
+    const size_t pages = (total + HISTORY_POINTS_PER_MSG - 1) / HISTORY_POINTS_PER_MSG;
+    
+    const size_t recordSize = raw ? sizeof(fci_history_raw_t) : sizeof(fci_history_bucket_t);
+    uint8_t* records = (uint8_t*)malloc(recordSize * HISTORY_POINTS_PER_MSG);
+    if (!records) {
+        Serial.println("[HIST] Out of memory");
+        return;
+    }
+    Serial.printf("[HIST] %s tier, %u records in %u pages\n",
+                  FCIFeatureHistory::tierName(tier), (unsigned)total, (unsigned)pages);
+    
+    // Columnar pages: t_s[] plus one array per metric
+    size_t sent = 0;
+    for (size_t page = 0; page == 0 || page < pages; page++) {
+        size_t n = raw
+            ? featureHistory.queryRaw(from_s, to_s, sent, (fci_history_raw_t*)records, HISTORY_POINTS_PER_MSG)
+            : featureHistory.queryBuckets(tier, from_s, to_s, sent, (fci_history_bucket_t*)records, HISTORY_POINTS_PER_MSG);
+        sent += n;
+        
+        JsonDocument doc;
+        fillEnvelopeHeader(doc, "history", "fci_history", 300);
+        JsonObject payload = doc["payload"].to<JsonObject>();
+        payload["request_id"] = requestId;
+        payload["tier"] = FCIFeatureHistory::tierName(tier);
+        payload["bucket_s"] = featureHistory.bucketSeconds(tier);
+        payload["from_s"] = from_s;
+        payload["to_s"] = to_s;
+        payload["now_s"] = deviceSeconds();
+        payload["page"] = page;
+        payload["pages"] = pages;
+        payload["total"] = total;
+        
+        JsonArray times = payload["t_s"].to<JsonArray>();
+        if (raw) {
+            const fci_history_raw_t* rec = (const fci_history_raw_t*)records;
+            JsonObject values = payload["values"].to<JsonObject>();
+            JsonArray cols[HISTORY_METRICS];
+            for (size_t m = 0; m < HISTORY_METRICS; m++) {
+                cols[m] = values[FCIFeatureHistory::metricName(m)].to<JsonArray>();
+            }
+            JsonArray patterns = payload["pattern"].to<JsonArray>();
+            for (size_t i = 0; i < n; i++) {
+                float v[HISTORY_METRICS];
+                FCIFeatureHistory::metrics(&rec[i].features, v);
+                times.add(rec[i].t_s);
+                for (size_t m = 0; m < HISTORY_METRICS; m++) cols[m].add(v[m]);
+                patterns.add(patternToString(rec[i].features.pattern));
+            }
+        } else {
+            const fci_history_bucket_t* rec = (const fci_history_bucket_t*)records;
+            JsonArray counts = payload["count"].to<JsonArray>();
+            JsonObject mins = payload["min"].to<JsonObject>();
+            JsonObject maxs = payload["max"].to<JsonObject>();
+            JsonObject means = payload["mean"].to<JsonObject>();
+            for (size_t m = 0; m < HISTORY_METRICS; m++) {
+                const char* name = FCIFeatureHistory::metricName(m);
+                JsonArray lo = mins[name].to<JsonArray>();
+                JsonArray hi = maxs[name].to<JsonArray>();
+                JsonArray avg = means[name].to<JsonArray>();
+                for (size_t i = 0; i < n; i++) {
+                    lo.add(rec[i].min[m]);
+                    hi.add(rec[i].max[m]);
+                    avg.add(rec[i].mean[m]);
+                }
+            }
+            for (size_t i = 0; i < n; i++) {
+                times.add(rec[i].t_s);
+                counts.add(rec[i].count);
+            }
+        }
+        
+        // Bulk pages wait for queue space rather than being dropped. If the
+        // network stays stalled past that, stop and mark where the answer
+        // ends so the client never takes a partial answer for the whole
+        if (!queueMessage(doc, false, pdMS_TO_TICKS(PIPE_BULK_WAIT_MS))) {
+            Serial.printf("[HIST] Truncated at page %u of %u\n", (unsigned)page, (unsigned)pages);
+            JsonDocument end;
+            fillEnvelopeHeader(end, "history", "fci_history", 300);
+            JsonObject p = end["payload"].to<JsonObject>();
+            p["request_id"] = requestId;
+            p["tier"] = FCIFeatureHistory::tierName(tier);
+            p["page"] = page;
+            p["pages"] = pages;
+            p["total"] = total;
+            p["truncated"] = true;
+            p["error"] = "network queue full";
+            queueMessage(end, false, pdMS_TO_TICKS(PIPE_BULK_WAIT_MS));
+            break;
+        }
+    }
+    free(records);
+}
+
+void sendSpikes(const dsp_block_t& block) {
+    // Streaming events: WebSocket only, dropped while offline
+    if (!wsConnected || block.n_spikes == 0) {
+        return;
+    }
+    
+    JsonDocument doc;
+    fillEnvelopeHeader(doc, "spikes", "fci_spikes", 300);
+    
+    // Columnar events: sample[i] is the peak's frame index since boot
+    // (same counter as spectrogram end_sample), time = sample / sample_rate
+    JsonObject payload = doc["payload"].to<JsonObject>();
+    payload["sample_rate"] = ADC_SAMPLE_FREQ;
+    payload["detected"] = block.spikes_detected;
+    payload["dropped"] = block.spikes_dropped;
+    JsonArray sample = payload["sample"].to<JsonArray>();
+    JsonArray channel = payload["channel"].to<JsonArray>();
+    JsonArray polarity = payload["polarity"].to<JsonArray>();
+    JsonArray amplitude = payload["amplitude_uv"].to<JsonArray>();
+    JsonArray width = payload["width_ms"].to<JsonArray>();
+    JsonArray threshold = payload["threshold_uv"].to<JsonArray>();
+    for (size_t i = 0; i < block.n_spikes; i++) {
+        const fci_spike_t& ev = block.spikes[i];
+        sample.add(ev.peak_sample);
+        channel.add(ev.channel);
+        polarity.add(ev.polarity);
+        amplitude.add(ev.amplitude_uv);
+        width.add(ev.width_samples * 1000.0f / ADC_SAMPLE_FREQ);
+        threshold.add(ev.threshold_uv);
+    }
+    
+    queueMessage(doc, false, 0);
+}
+
+void sendSpectrogram(uint16_t hop) {
+    // Streaming data: WebSocket only, batches are dropped while offline
+    if (!wsConnected || spectrogramCount == 0) {
+        spectrogramCount = 0;
+        return;
+    }
+    
+    JsonDocument doc;
+    fillEnvelopeHeader(doc, "spectrogram", "fci_spectrogram", 60);
+    
+    // Column layout: bins[i] is the log-magnitude code of f0_hz + i * df_hz,
+    // dB re 1 µV = db_floor + code * db_step
+    JsonObject payload = doc["payload"].to<JsonObject>();
+    payload["sample_rate"] = spectrogram.sampleRate();
+    payload["frame"] = spectrogram.frameSize();
+    payload["hop"] = hop;
+    payload["f0_hz"] = spectrogram.binFrequency(0);
+    payload["df_hz"] = spectrogram.binHz();
+    payload["db_floor"] = STFT_DB_FLOOR;
+    payload["db_step"] = STFT_DB_STEP;
+    
+    JsonArray columns = payload["columns"].to<JsonArray>();
+    for (size_t c = 0; c < spectrogramCount; c++) {
+        const fci_spectrogram_column_t& col = spectrogramColumns[c];
+        JsonObject obj = columns.add<JsonObject>();
+        obj["end_sample"] = col.end_sample;
+        JsonArray bins = obj["bins"].to<JsonArray>();
+        for (size_t i = 0; i < col.n_bins; i++) {
+            bins.add(col.bins[i]);
+        }
+        obj["low_db"] = col.band_low_db;
+        obj["bio_db"] = col.band_bio_db;
+        obj["high_db"] = col.band_high_db;
+    }
+    spectrogramCount = 0;
+    
+    queueMessage(doc, false, 0);
+}
+
+void sendHTTPTelemetry(const char* json, size_t length) {
     HTTPClient http;
     
     String url = String("http://") + MYCORRHIZAE_URL + ":" + MYCORRHIZAE_PORT +
@@ -269,7 +772,7 @@ void sendHTTPTelemetry(const String& json) {
     http.addHeader("Content-Type", "application/json");
     http.addHeader("X-API-Key", API_KEY);
     
-    int httpCode = http.POST(json);
+    int httpCode = http.POST((uint8_t*)json, length);
     
     if (httpCode > 0) {
         if (httpCode != HTTP_CODE_OK && httpCode != HTTP_CODE_CREATED) {
@@ -350,51 +853,60 @@ const char* patternToString(fci_pattern_t pattern) {
 // CALIBRATION
 // ============================================================================
 
-void performCalibration() {
+// Collected from the live frames by the DSP task (the acquisition task
+// owns the ADC); the status LED shows yellow meanwhile
+const int CAL_SAMPLES = 1000;
+
+void startCalibration() {
+    // DSP task. Disconnect mycelium (user should ensure electrodes are shorted)
     Serial.println("[CAL] Calibrating ADC...");
-    
-    // Disconnect mycelium (user should ensure electrodes are shorted)
-    pixel.setPixelColor(0, pixel.Color(255, 255, 0)); // Yellow
-    pixel.show();
-    
-    // Collect baseline samples
-    float sum = 0;
-    float sumSq = 0;
-    const int CAL_SAMPLES = 1000;
-    
-    for (int i = 0; i < CAL_SAMPLES; i++) {
-        int16_t raw = ads.readADC_Differential_0_1();
-        float uv = signalProcessor.rawToMicrovolts(raw);
-        sum += uv;
-        sumSq += uv * uv;
-        delay(1);
+    calibrationCount = 0;
+    calibrationSum = 0;
+    calibrationSumSq = 0;
+    calibrating = true;
+}
+
+void calibrationFrame(const int16_t* raw) {
+    // DSP task: one frame of the primary pair per call
+    float uv = signalProcessor.rawToMicrovolts(raw[ADC_CHANNEL_BIO_DIFF]);
+    calibrationSum += uv;
+    calibrationSumSq += uv * uv;
+    if (++calibrationCount < CAL_SAMPLES) {
+        return;
     }
     
-    float mean = sum / CAL_SAMPLES;
-    float variance = (sumSq / CAL_SAMPLES) - (mean * mean);
+    float mean = calibrationSum / CAL_SAMPLES;
+    float variance = (calibrationSumSq / CAL_SAMPLES) - (mean * mean);
     float noise_floor = sqrt(variance);
+    calibrating = false;
     
     Serial.printf("[CAL] Baseline: %.2f µV, Noise floor: %.2f µV RMS\n", mean, noise_floor);
     
     // Store calibration values
     // TODO: Save to EEPROM/Preferences
     
-    pixel.setPixelColor(0, pixel.Color(0, 255, 0)); // Green
-    pixel.show();
-    
-    // Send calibration result to server
+    // Result message is built by the encoder
+    encoder_job_t job = {};
+    job.type = JOB_CALIBRATION;
+    job.baseline_uv = mean;
+    job.noise_floor_uv = noise_floor;
+    if (xQueueSend(encoderQueue, &job, 0) != pdTRUE) {
+        stageStats[STAGE_ENCODE].drop();
+    }
+}
+
+void sendCalibration(float baseline_uv, float noise_floor_uv) {
+    // Encoder task: send calibration result to server
+    if (!wsConnected) {
+        return;
+    }
     JsonDocument doc;
     doc["action"] = "calibration_complete";
     doc["device_id"] = deviceId;
-    doc["baseline_uv"] = mean;
-    doc["noise_floor_uv"] = noise_floor;
+    doc["baseline_uv"] = baseline_uv;
+    doc["noise_floor_uv"] = noise_floor_uv;
     doc["timestamp"] = getISOTimestamp();
-    
-    String msg;
-    serializeJson(doc, msg);
-    if (wsConnected) {
-        webSocket.sendTXT(msg);
-    }
+    queueMessage(doc, false, 0);
 }
 
 // ============================================================================
@@ -414,6 +926,11 @@ String generateUUID() {
     return String(uuid);
 }
 
+uint32_t deviceSeconds() {
+    // 64-bit microsecond timer: unlike millis(), no wrap after 49 days
+    return (uint32_t)(esp_timer_get_time() / 1000000ULL);
+}
+
 String getISOTimestamp() {
     // Get time from NTP or use uptime-based timestamp
     // For now, use a placeholder format
@@ -450,6 +967,13 @@ void pulseStatusLED() {
     brightness += direction;
     if (brightness >= 250 || brightness <= 5) direction = -direction;
     
+    // Solid yellow while calibrating (electrodes shorted)
+    if (calibrating) {
+        pixel.setPixelColor(0, pixel.Color(255, 255, 0));
+        pixel.show();
+        return;
+    }
+    
     // Color based on pattern
     switch (currentFeatures.pattern) {
         case PATTERN_GROWTH:
@@ -471,6 +995,211 @@ void pulseStatusLED() {
     pixel.show();
 }
 
+// ============================================================================
+// PIPELINE TASKS (DSP on core 1, encoder and network on core 0)
+// ============================================================================
+
+void processFrame(const fci_frame_t& frame) {
+    // DSP task: one frame from the acquisition ring
+    const int16_t* raw = frame.raw;
+    if (calibrating) {
+        calibrationFrame(raw);
+    }
+    
+    // Streaming spectrogram of the primary pair: a column every hop
+    // (part of the FFT path). Staging fills up only while publishBlock()
+    // finds no free slot; columns past that are dropped and counted
+    if ((signalProcessor.getSpectralMode() & SPECTRAL_MODE_FFT) &&
+        spectrogram.addSample(signalProcessor.rawToMicrovolts(raw[ADC_CHANNEL_BIO_DIFF]))) {
+        if (dspStaging.n_columns < PIPE_BLOCK_FRAMES) {
+            dspStaging.columns[dspStaging.n_columns++] = spectrogram.column();
+        } else {
+            spectrogramDrops++;
+            stageStats[STAGE_ENCODE].drop();
+        }
+    }
+    
+    // Block features: processBuffer() once per full buffer
+    if (!signalProcessor.addFrame(raw, (uint32_t)(frame.timestamp_us / 1000))) {
+        return;
+    }
+    
+    // Process signal and extract features for every channel
+    if (signalProcessor.processBuffer(channelFeatures)) {
+        // Detect pattern
+        for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+            channelFeatures[ch].pattern = detectSignalPattern(&channelFeatures[ch]);
+        }
+        currentTelemetry.sample_count += FFT_SAMPLES;
+        dspStaging.has_features = true;
+        dspStaging.features_time_s = deviceSeconds();
+        
+        // Debug output
+        Serial.printf("[BIO] Amp: %.2f µV | Freq: %.2f Hz | Pattern: %s (%.0f%%)\n",
+                      currentFeatures.amplitude_uv,
+                      currentFeatures.dominant_freq_hz,
+                      patternToString(currentFeatures.pattern),
+                      currentFeatures.pattern_confidence * 100);
+    }
+}
+
+bool publishBlock() {
+    // DSP task: snapshot into a free ping-pong slot and hand it to the
+    // encoder. No free slot = encoder behind: keep collecting, retry later
+    uint8_t slot;
+    if (xQueueReceive(freeBlockQueue, &slot, 0) != pdTRUE) {
+        stageStats[STAGE_ENCODE].drop();
+        return false;
+    }
+    
+    dsp_block_t& block = dspStaging;
+    memcpy(block.features, channelFeatures, sizeof(block.features));
+    block.sample_count = currentTelemetry.sample_count;
+    block.spectral_mode = signalProcessor.getSpectralMode();
+    block.stft_hop = (uint16_t)spectrogram.hop();
+    
+    const FCIToneBank& tones = signalProcessor.tones();
+    for (size_t i = 0; i < TONE_MAX_TRACKERS; i++) {
+        block.tone_valid[i] = tones.getTone(i, &block.tones[i]);
+    }
+    block.stimulus_tone_slot = stimulusToneSlot;
+    
+    const FCIMultiRate& slow = signalProcessor.slowBands();
+    for (size_t i = 0; i < DECIM_STAGES; i++) {
+        block.slow_valid[i] = slow.getFeatures(i, &block.slow[i]);
+    }
+    
+    FCISpikeDetector& spikes = signalProcessor.spikes();
+    block.n_spikes = 0;
+    while (block.n_spikes < SPIKE_EVENT_QUEUE && spikes.pop(&block.spikes[block.n_spikes])) {
+        block.n_spikes++;
+    }
+    for (size_t ch = 0; ch < FCI_NUM_CHANNELS; ch++) {
+        block.spike_threshold[ch] = spikes.threshold(ch);
+    }
+    block.spikes_detected = spikes.detected();
+    block.spikes_dropped = spikes.dropped();
+    
+    dspBlocks[slot] = block;
+    block.has_features = false;
+    block.n_columns = 0;
+    
+    encoder_job_t job = {};
+    job.type = JOB_BLOCK;
+    job.slot = slot;
+    if (xQueueSend(encoderQueue, &job, 0) != pdTRUE) {
+        xQueueSend(freeBlockQueue, &slot, 0);
+        stageStats[STAGE_ENCODE].drop();
+    }
+    return true;
+}
+
+void processingTask(void* param) {
+    size_t blockFrames = 0;
+    
+    for (;;) {
+        // Woken per frame; short timeout while a stimulus is playing
+        ulTaskNotifyTake(pdTRUE, stimulator.isActive() ? 1 : pdMS_TO_TICKS(PIPE_DSP_IDLE_MS));
+        stageStats[STAGE_DSP].enter(esp_timer_get_time());
+        stageStats[STAGE_DSP].queueLevel(sampleRing.size());
+        
+        // Commands apply between frames, never mid-buffer
+        char* text;
+        while (xQueueReceive(commandQueue, &text, 0) == pdTRUE) {
+            handleDspCommand(text);
+            free(text);
+        }
+        
+        fci_frame_t frame;
+        while (sampleRing.pop(&frame)) {
+            processFrame(frame);
+            if (++blockFrames >= PIPE_BLOCK_FRAMES) {
+                blockFrames = 0;
+                publishBlock();
+            }
+        }
+        
+        stimulator.update();
+        stageStats[STAGE_DSP].leave(esp_timer_get_time());
+    }
+}
+
+void consumeBlock(const dsp_block_t& block) {
+    // Encoder task: history, spike events and spectrogram batches
+    if (block.has_features) {
+        featureHistory.add(block.features_time_s, &block.features[ADC_CHANNEL_BIO_DIFF]);
+    }
+    sendSpikes(block);
+    
+    for (size_t c = 0; c < block.n_columns; c++) {
+        spectrogramColumns[spectrogramCount++] = block.columns[c];
+        if (spectrogramCount == STFT_COLUMNS_PER_MSG) {
+            sendSpectrogram(block.stft_hop);
+        }
+    }
+    latestBlock = block;
+}
+
+void encodingTask(void* param) {
+    for (;;) {
+        // Wait for a job, at most until the next telemetry is due
+        uint32_t sinceTelemetry = millis() - lastTelemetryTime;
+        TickType_t wait = (sinceTelemetry < TELEMETRY_INTERVAL_MS)
+            ? pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS - sinceTelemetry) : 0;
+        encoder_job_t job;
+        bool have = xQueueReceive(encoderQueue, &job, wait) == pdTRUE;
+        stageStats[STAGE_ENCODE].enter(esp_timer_get_time());
+        stageStats[STAGE_ENCODE].queueLevel(uxQueueMessagesWaiting(encoderQueue) + (have ? 1 : 0));
+        
+        if (have) {
+            switch (job.type) {
+                case JOB_BLOCK:
+                    consumeBlock(dspBlocks[job.slot]);
+                    xQueueSend(freeBlockQueue, &job.slot, 0);
+                    break;
+                case JOB_CALIBRATION:
+                    sendCalibration(job.baseline_uv, job.noise_floor_uv);
+                    break;
+                case JOB_HISTORY:
+                    handleHistoryQuery(job.text);
+                    free(job.text);
+                    break;
+            }
+        }
+        
+        uint32_t now = millis();
+        if (now - lastTelemetryTime >= TELEMETRY_INTERVAL_MS) {
+            lastTelemetryTime = now;
+            sendTelemetry(latestBlock);
+        }
+        stageStats[STAGE_ENCODE].leave(esp_timer_get_time());
+    }
+}
+
+void networkingTask(void* param) {
+    for (;;) {
+        net_message_t msg;
+        bool have = xQueueReceive(netQueue, &msg, pdMS_TO_TICKS(PIPE_NET_POLL_MS)) == pdTRUE;
+        stageStats[STAGE_NETWORK].enter(esp_timer_get_time());
+        stageStats[STAGE_NETWORK].queueLevel(uxQueueMessagesWaiting(netQueue) + (have ? 1 : 0));
+        
+        // WebSocket maintenance; incoming commands arrive via webSocketEvent()
+        webSocket.loop();
+        
+        while (have) {
+            if (wsConnected) {
+                webSocket.sendTXT(msg.json, msg.length);
+            } else if (msg.http_fallback) {
+                // Blocking POST stalls only this task
+                sendHTTPTelemetry(msg.json, msg.length);
+            }
+            free(msg.json);
+            have = xQueueReceive(netQueue, &msg, 0) == pdTRUE;
+        }
+        stageStats[STAGE_NETWORK].leave(esp_timer_get_time());
+    }
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
@@ -507,8 +1236,14 @@ void setup() {
     // Configure ADC for bioelectric signals
     // Gain 16 = ±256mV range, 7.8125 µV resolution - perfect for mycelium
     ads.setGain(GAIN_SIXTEEN);
-    ads.setDataRate(RATE_ADS1115_128SPS);
-    Serial.println("OK (Gain 16x, 128 SPS)");
+    // Two pairs per 7.8 ms sample period: 475 SPS conversions (~2.1 ms each)
+    ads.setDataRate(RATE_ADS1115_475SPS);
+    
+    // Conversion-ready on ALERT/RDY (set up by each startADCReading())
+    adcReady = xSemaphoreCreateBinary();
+    pinMode(ADS1115_ALERT_PIN, INPUT_PULLUP);
+    attachInterrupt(ADS1115_ALERT_PIN, onAdcReady, FALLING);
+    Serial.printf("OK (Gain 16x, %d pairs @ %d Hz)\n", FCI_NUM_CHANNELS, ADC_SAMPLE_RATE);
     
     // Initialize BME688 (environmental sensor)
     Serial.print("[INIT] BME688... ");
@@ -532,6 +1267,24 @@ void setup() {
     }
     Serial.println("OK");
     
+    // Initialize feature history (PSRAM)
+    Serial.print("[INIT] Feature History... ");
+    if (!featureHistory.begin()) {
+        Serial.println("FAILED (history queries disabled)");
+    } else {
+        Serial.printf("OK (%u raw, %u/%u/%u min/hour/day buckets)\n",
+                      HISTORY_RAW_RECORDS, HISTORY_MINUTE_RECORDS,
+                      HISTORY_HOUR_RECORDS, HISTORY_DAY_RECORDS);
+    }
+    
+    // Initialize streaming spectrogram
+    Serial.print("[INIT] Spectrogram... ");
+    if (!spectrogram.begin(ADC_SAMPLE_FREQ, STFT_FRAME_SAMPLES, STFT_HOP_SAMPLES)) {
+        Serial.println("FAILED!");
+    } else {
+        Serial.printf("OK (%d-sample frames, hop %d)\n", STFT_FRAME_SAMPLES, STFT_HOP_SAMPLES);
+    }
+    
     // Initialize stimulus generator
     Serial.print("[INIT] Stimulus Generator... ");
     if (!stimulator.begin()) {
@@ -571,6 +1324,50 @@ void setup() {
         setStatusLED(255, 165, 0); // Orange
     }
     
+    // Pipeline queues: ping-pong DSP blocks start out free
+    freeBlockQueue = xQueueCreate(PIPE_BLOCK_SLOTS, sizeof(uint8_t));
+    encoderQueue = xQueueCreate(PIPE_ENCODER_QUEUE, sizeof(encoder_job_t));
+    commandQueue = xQueueCreate(PIPE_COMMAND_QUEUE, sizeof(char*));
+    netQueue = xQueueCreate(PIPE_NET_QUEUE, sizeof(net_message_t));
+    if (!freeBlockQueue || !encoderQueue || !commandQueue || !netQueue) {
+        Serial.println("[INIT] Pipeline queues FAILED!");
+        setStatusLED(255, 0, 0);
+        while(1) delay(100);
+    }
+    for (uint8_t slot = 0; slot < PIPE_BLOCK_SLOTS; slot++) {
+        xQueueSend(freeBlockQueue, &slot, 0);
+    }
+    
+    int64_t now_us = esp_timer_get_time();
+    stageStats[STAGE_ACQUIRE].begin("acquire", 0, now_us);
+    stageStats[STAGE_DSP].begin("dsp", sampleRing.capacity(), now_us);
+    stageStats[STAGE_ENCODE].begin("encode", PIPE_ENCODER_QUEUE, now_us);
+    stageStats[STAGE_NETWORK].begin("network", PIPE_NET_QUEUE, now_us);
+    
+    // Consumers before producers: the acquisition task notifies the DSP
+    // task, the timer ISR notifies the acquisition task
+    Serial.print("[INIT] Pipeline Tasks... ");
+    if (xTaskCreatePinnedToCore(networkingTask, "fci_net", PIPE_NET_STACK, NULL,
+                                PIPE_NET_PRIORITY, &networkTask, PIPE_NET_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(encodingTask, "fci_enc", PIPE_ENCODER_STACK, NULL,
+                                PIPE_ENCODER_PRIORITY, &encoderTask, PIPE_ENCODER_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(processingTask, "fci_dsp", PIPE_DSP_STACK, NULL,
+                                PIPE_DSP_PRIORITY, &dspTask, PIPE_DSP_CORE) != pdPASS) {
+        Serial.println("FAILED!");
+        setStatusLED(255, 0, 0);
+        while(1) delay(100);
+    }
+    Serial.printf("OK (dsp core %d, encoder/network core %d)\n", PIPE_DSP_CORE, PIPE_NET_CORE);
+    
+    Serial.print("[INIT] Acquisition Task... ");
+    if (xTaskCreatePinnedToCore(acquisitionTask, "fci_acq", ACQ_TASK_STACK, NULL,
+                                ACQ_TASK_PRIORITY, &acqTask, ACQ_TASK_CORE) != pdPASS) {
+        Serial.println("FAILED!");
+        setStatusLED(255, 0, 0);
+        while(1) delay(100);
+    }
+    Serial.printf("OK (core %d, priority %d)\n", ACQ_TASK_CORE, ACQ_TASK_PRIORITY);
+    
     // Initialize sampling timer (128 Hz)
     Serial.print("[INIT] Sample Timer... ");
     uint32_t timer_period_us = 1000000 / ADC_SAMPLE_RATE; // ~7812 µs for 128 Hz
@@ -587,39 +1384,10 @@ void setup() {
 // ============================================================================
 
 void loop() {
+    // Housekeeping only: acquisition, DSP, encoding and networking run in
+    // their own tasks (see PIPELINE TASKS)
     uint32_t now = millis();
     
-    // WebSocket maintenance
-    webSocket.loop();
-    
-    // Check if sample buffer is ready for processing
-    if (bufferReady) {
-        bufferReady = false;
-        
-        // Copy samples to processing buffer
-        portENTER_CRITICAL(&timerMux);
-        for (size_t i = 0; i < FFT_SAMPLES; i++) {
-            size_t idx = (sampleReadIndex + i) % ADC_BUFFER_SIZE;
-            processingBuffer[i] = signalProcessor.rawToMicrovolts(sampleBuffer[idx]);
-        }
-        sampleReadIndex = (sampleReadIndex + FFT_SAMPLES) % ADC_BUFFER_SIZE;
-        portEXIT_CRITICAL(&timerMux);
-        
-        // Process signal and extract features
-        if (signalProcessor.processBuffer(&currentFeatures)) {
-            // Detect pattern
-            currentFeatures.pattern = detectSignalPattern(&currentFeatures);
-            currentTelemetry.sample_count += FFT_SAMPLES;
-            
-            // Debug output
-            Serial.printf("[BIO] Amp: %.2f µV | Freq: %.2f Hz | Pattern: %s (%.0f%%)\n",
-                          currentFeatures.amplitude_uv,
-                          currentFeatures.dominant_freq_hz,
-                          patternToString(currentFeatures.pattern),
-                          currentFeatures.pattern_confidence * 100);
-        }
-    }
-    
     // Read environmental sensors periodically
     if (now - lastEnvReadTime >= ENV_SAMPLE_INTERVAL_MS) {
         lastEnvReadTime = now;
@@ -632,18 +1400,8 @@ void loop() {
         }
     }
     
-    // Send telemetry
-    if (now - lastTelemetryTime >= TELEMETRY_INTERVAL_MS) {
-        lastTelemetryTime = now;
-        sendTelemetry();
-    }
-    
-    // Update stimulus generator
-    stimulator.update();
-    
-    // Update status LED
+    // Update status LED (sole owner of the pixel once the tasks run)
     pulseStatusLED();
     
-    // Small delay to prevent watchdog issues
-    delay(1);
+    delay(PIPE_LED_FRAME_MS);
 }
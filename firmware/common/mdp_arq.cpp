@@ -0,0 +1,108 @@
+#include "mdp_arq.h"
+
+#include <string.h>
+
+void mdp_arq_init(mdp_arq_t* q, mdp_arq_slot_t* slots, uint8_t nslots,
+                  uint8_t* pool, uint16_t slot_cap, const mdp_arq_cfg_t* cfg,
+                  mdp_arq_send_fn send, void* ctx) {
+  memset(q, 0, sizeof(*q));
+  q->slots = slots;
+  q->nslots = nslots;
+  q->slot_cap = slot_cap;
+  q->cfg = *cfg;
+  q->send = send;
+  q->ctx = ctx;
+  for (uint8_t i = 0; i < nslots; i++) {
+    memset(&slots[i], 0, sizeof(slots[i]));
+    slots[i].payload = pool + (size_t)i * slot_cap;
+  }
+}
+
+void mdp_arq_reset(mdp_arq_t* q) {
+  for (uint8_t i = 0; i < q->nslots; i++) q->slots[i].used = false;
+  q->peer_ack = 0;
+}
+
+bool mdp_arq_send(mdp_arq_t* q, const uint8_t* payload, uint16_t len,
+                  uint32_t seq, uint32_t now_ms) {
+  if (len > q->slot_cap) { q->stats.queue_full++; return false; }
+  mdp_arq_slot_t* it = nullptr;
+  for (uint8_t i = 0; i < q->nslots; i++) {
+    if (!q->slots[i].used) { it = &q->slots[i]; break; }
+  }
+  if (!it) { q->stats.queue_full++; return false; }
+
+  memcpy(it->payload, payload, len);
+  it->len = len;
+  it->seq = seq;
+  it->used = true;
+  it->sends = 1;
+  it->first_ms = now_ms;
+  it->last_ms = now_ms;
+  q->stats.sent++;
+  (void)q->send(q->ctx, it->payload, it->len);
+  return true;
+}
+
+void mdp_arq_on_ack(mdp_arq_t* q, uint32_t ack) {
+  if (ack > q->peer_ack) q->peer_ack = ack;
+  for (uint8_t i = 0; i < q->nslots; i++) {
+    mdp_arq_slot_t* it = &q->slots[i];
+    if (!it->used || it->seq == 0 || it->seq > q->peer_ack) continue;
+    it->used = false;
+    q->stats.acked++;
+    if (q->on_acked) q->on_acked(q->ctx, it);
+  }
+}
+
+void mdp_arq_pump(mdp_arq_t* q, uint32_t now_ms) {
+  for (uint8_t i = 0; i < q->nslots; i++) {
+    mdp_arq_slot_t* it = &q->slots[i];
+    if (!it->used) continue;
+    if ((uint32_t)(now_ms - it->last_ms) < q->cfg.rto_ms) continue;
+    if (it->sends > q->cfg.max_retries) {
+      it->used = false;
+      q->stats.expired++;
+      continue;
+    }
+    (void)q->send(q->ctx, it->payload, it->len);
+    it->last_ms = now_ms;
+    it->sends++;
+    q->stats.retransmits++;
+  }
+}
+
+uint8_t mdp_arq_in_flight(const mdp_arq_t* q) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < q->nslots; i++) n += q->slots[i].used ? 1 : 0;
+  return n;
+}
+
+uint32_t mdp_arq_next_due(const mdp_arq_t* q, uint32_t now_ms) {
+  uint32_t best = UINT32_MAX;
+  for (uint8_t i = 0; i < q->nslots; i++) {
+    const mdp_arq_slot_t* it = &q->slots[i];
+    if (!it->used) continue;
+    uint32_t age = now_ms - it->last_ms;
+    uint32_t due = age >= q->cfg.rto_ms ? 0 : q->cfg.rto_ms - age;
+    if (due < best) best = due;
+  }
+  return best;
+}
+
+void mdp_arq_rx_init(mdp_arq_rx_t* rx) {
+  memset(rx, 0, sizeof(*rx));
+}
+
+mdp_arq_rx_result_t mdp_arq_rx_accept(mdp_arq_rx_t* rx, uint32_t seq) {
+  if (seq == rx->last_inorder + 1) {
+    rx->last_inorder = seq;
+    return MDP_ARQ_RX_NEW;
+  }
+  if (seq <= rx->last_inorder) {
+    rx->dups++;
+    return MDP_ARQ_RX_DUP;
+  }
+  rx->gaps++;
+  return MDP_ARQ_RX_GAP;
+}
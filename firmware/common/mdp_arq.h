@@ -0,0 +1,107 @@
+#ifndef MDP_ARQ_H
+#define MDP_ARQ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cumulative-ACK retransmit queue shared by Side-A, Side-B and the gateway.
+// Transport- and header-agnostic: the caller owns sequence numbering, framing
+// and the clock (millis() on device, virtual time on host), so the same code
+// runs under tools/host/mdp_arq_bench against an emulated link.
+//
+// Each queued payload is sent once immediately, then every rto_ms until the
+// peer's cumulative ack covers its seq or it has been sent max_retries + 1
+// times.
+
+typedef struct {
+  uint32_t rto_ms;
+  uint8_t  max_retries;
+} mdp_arq_cfg_t;
+
+typedef struct {
+  uint32_t sent;          // first transmissions
+  uint32_t retransmits;
+  uint32_t acked;
+  uint32_t expired;       // gave up after max_retries
+  uint32_t queue_full;    // mdp_arq_send() rejected, nothing sent
+} mdp_arq_stats_t;
+
+typedef struct {
+  uint8_t* payload;
+  uint16_t len;
+  bool     used;
+  uint8_t  sends;
+  uint32_t seq;
+  uint32_t first_ms;
+  uint32_t last_ms;
+} mdp_arq_slot_t;
+
+typedef bool (*mdp_arq_send_fn)(void* ctx, const uint8_t* payload, uint16_t len);
+// Called once per slot freed by an ack, before the slot is reused.
+typedef void (*mdp_arq_acked_fn)(void* ctx, const mdp_arq_slot_t* slot);
+
+typedef struct {
+  mdp_arq_slot_t*  slots;
+  uint8_t          nslots;
+  uint16_t         slot_cap;
+  mdp_arq_cfg_t    cfg;
+  uint32_t         peer_ack;
+  mdp_arq_send_fn  send;
+  mdp_arq_acked_fn on_acked;   // optional
+  void*            ctx;
+  mdp_arq_stats_t  stats;
+} mdp_arq_t;
+
+// pool must hold nslots * slot_cap bytes.
+void mdp_arq_init(mdp_arq_t* q, mdp_arq_slot_t* slots, uint8_t nslots,
+                  uint8_t* pool, uint16_t slot_cap, const mdp_arq_cfg_t* cfg,
+                  mdp_arq_send_fn send, void* ctx);
+
+// Drop everything in flight and forget the peer's ack (reboot / link reset).
+void mdp_arq_reset(mdp_arq_t* q);
+
+// Transmit now and keep for retransmission. Returns false (and sends nothing)
+// if the payload does not fit a slot or every slot is in flight.
+bool mdp_arq_send(mdp_arq_t* q, const uint8_t* payload, uint16_t len,
+                  uint32_t seq, uint32_t now_ms);
+
+// Apply a cumulative ack from the peer; frees every slot with seq <= ack.
+void mdp_arq_on_ack(mdp_arq_t* q, uint32_t ack);
+
+// Retransmit or expire whatever is due.
+void mdp_arq_pump(mdp_arq_t* q, uint32_t now_ms);
+
+uint8_t mdp_arq_in_flight(const mdp_arq_t* q);
+
+// Milliseconds until mdp_arq_pump() has work, or UINT32_MAX when idle.
+uint32_t mdp_arq_next_due(const mdp_arq_t* q, uint32_t now_ms);
+
+// Receive side: MDP v1 in-order tracking for the peer's sequence space.
+// last_inorder, the cumulative ack sent back, advances only on
+// seq == last_inorder + 1. The result just classifies the frame; v1 receivers
+// act on every frame, duplicates and out-of-order ones included.
+typedef enum {
+  MDP_ARQ_RX_NEW = 0,   // seq == last_inorder + 1, now advanced
+  MDP_ARQ_RX_DUP = 1,   // seq <= last_inorder
+  MDP_ARQ_RX_GAP = 2,   // ahead of a missing seq
+} mdp_arq_rx_result_t;
+
+typedef struct {
+  uint32_t last_inorder;
+  uint32_t dups;
+  uint32_t gaps;
+} mdp_arq_rx_t;
+
+void mdp_arq_rx_init(mdp_arq_rx_t* rx);
+mdp_arq_rx_result_t mdp_arq_rx_accept(mdp_arq_rx_t* rx, uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
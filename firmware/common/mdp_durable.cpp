@@ -0,0 +1,181 @@
+#include "mdp_durable.h"
+
+#include <string.h>
+
+#define CODEC_RAW 0u
+#define CODEC_LZ4 1u
+#define REC_HDR   3u
+
+// One message of a batch at off: seq u32, len u16, payload.
+static bool entry(const uint8_t* b, uint16_t bLen, uint16_t off,
+                  uint32_t* seq, const uint8_t** p, uint16_t* len) {
+  if ((size_t)off + MDP_DURABLE_ENTRY_HDR > bLen) return false;
+  memcpy(seq, b + off, sizeof(*seq));
+  memcpy(len, b + off + 4, sizeof(*len));
+  if ((size_t)off + MDP_DURABLE_ENTRY_HDR + *len > bLen) return false;
+  *p = b + off + MDP_DURABLE_ENTRY_HDR;
+  return true;
+}
+
+// Append b[0, len) as one record tagged with its last seq. Splits at a
+// message boundary if it does not fit a record after compression.
+static bool commit(mdp_durable_t* d, const uint8_t* b, uint16_t len) {
+  uint32_t seq = 0;
+  const uint8_t* p;
+  uint16_t plen, off = 0, mid = 0;
+  while (entry(b, len, off, &seq, &p, &plen)) {
+    off += MDP_DURABLE_ENTRY_HDR + plen;
+    if (off < len && (mid == 0 || off <= len / 2)) mid = off;
+  }
+
+  size_t body = 0;
+  d->rec[0] = CODEC_LZ4;
+  if (d->cfg.compress) {
+    body = mdp_lz4_compress(b, len, d->rec + REC_HDR, sizeof(d->rec) - REC_HDR, d->lz4_table);
+  }
+  if (body == 0 || body >= len) {
+    if (len > sizeof(d->rec) - REC_HDR) {
+      if (mid == 0) return false;
+      d->stats.splits++;
+      return commit(d, b, mid) && commit(d, b + mid, len - mid);
+    }
+    memcpy(d->rec + REC_HDR, b, len);
+    body = len;
+    d->rec[0] = CODEC_RAW;
+  }
+  d->rec[1] = (uint8_t)(len & 0xFF);
+  d->rec[2] = (uint8_t)(len >> 8);
+  if (!mdp_flashlog_append(&d->log, d->rec, (uint16_t)(REC_HDR + body), seq)) return false;
+  d->stats.flushes++;
+  d->stats.raw_bytes += len;
+  d->stats.packed_bytes += (uint32_t)(REC_HDR + body);
+  return true;
+}
+
+static uint16_t unpack(const uint8_t* rec, uint16_t len, uint8_t* out, uint16_t cap) {
+  if (len < REC_HDR) return 0;
+  const uint16_t raw = (uint16_t)(rec[1] | (rec[2] << 8));
+  if (raw > cap) return 0;
+  if (rec[0] == CODEC_RAW) {
+    if (len - REC_HDR != raw) return 0;
+    memcpy(out, rec + REC_HDR, raw);
+    return raw;
+  }
+  if (rec[0] == CODEC_LZ4) {
+    return mdp_lz4_decompress(rec + REC_HDR, len - REC_HDR, out, cap) == (int)raw ? raw : 0;
+  }
+  return 0;
+}
+
+bool mdp_durable_mount(mdp_durable_t* d, const mdp_flash_t* flash, const mdp_durable_cfg_t* cfg) {
+  d->cfg = *cfg;
+  if (d->cfg.batch_bytes == 0 || d->cfg.batch_bytes > MDP_DURABLE_BATCH_MAX) {
+    d->cfg.batch_bytes = MDP_DURABLE_BATCH_MAX;
+  }
+  d->batch_len = 0;
+  d->replay_len = 0;
+  d->replay_off = 0;
+  d->sent = 0;
+  memset(&d->stats, 0, sizeof(d->stats));
+  return mdp_flashlog_mount(&d->log, flash, d->scratch, sizeof(d->scratch));
+}
+
+uint32_t mdp_durable_last_seq(const mdp_durable_t* d) {
+  return d->log.last_seq;
+}
+
+// Messages the peer has already acked are left out; if that is all of them,
+// a bodiless record still carries the last seq and is retired straight away.
+// The batch is only dropped once it is on flash.
+bool mdp_durable_flush(mdp_durable_t* d, uint32_t acked) {
+  if (!d->log.ready) return false;
+  if (d->batch_len == 0) return true;
+  uint32_t seq = 0;
+  const uint8_t* p;
+  uint16_t plen, off = 0, start = 0;
+  while (entry(d->batch, d->batch_len, off, &seq, &p, &plen)) {
+    off += MDP_DURABLE_ENTRY_HDR + plen;
+    if (seq <= acked) start = off;
+  }
+  bool ok;
+  if (start < d->batch_len) {
+    ok = commit(d, d->batch + start, (uint16_t)(d->batch_len - start));
+  } else {
+    const uint8_t mark[REC_HDR] = { CODEC_RAW, 0, 0 };
+    ok = mdp_flashlog_append(&d->log, mark, sizeof(mark), seq);
+    if (ok) {
+      d->stats.marks++;
+      mdp_flashlog_ack(&d->log, acked);
+    }
+  }
+  if (!ok) {
+    d->stats.flush_failed++;
+    return false;
+  }
+  d->batch_len = 0;
+  return true;
+}
+
+bool mdp_durable_enqueue(mdp_durable_t* d, const uint8_t* payload, uint16_t len, uint32_t seq,
+                         uint32_t now_ms, uint32_t acked) {
+  if (!d->log.ready || len == 0) return false;
+  const size_t need = MDP_DURABLE_ENTRY_HDR + (size_t)len;
+  if (need > d->cfg.batch_bytes) return false;
+  if (d->batch_len + need > d->cfg.batch_bytes && !mdp_durable_flush(d, acked)) return false;
+  if (d->batch_len == 0) d->batch_ms = now_ms;
+  uint8_t* e = d->batch + d->batch_len;
+  memcpy(e, &seq, sizeof(seq));
+  memcpy(e + 4, &len, sizeof(len));
+  memcpy(e + MDP_DURABLE_ENTRY_HDR, payload, len);
+  d->batch_len = (uint16_t)(d->batch_len + need);
+  d->stats.enqueued++;
+  return true;
+}
+
+void mdp_durable_poll(mdp_durable_t* d, uint32_t now_ms, uint32_t acked) {
+  if (!d->log.ready) return;
+  if (d->batch_len && (uint32_t)(now_ms - d->batch_ms) >= d->cfg.flush_ms &&
+      !mdp_durable_flush(d, acked)) {
+    d->batch_ms = now_ms;
+  }
+  (void)mdp_flashlog_maintain(&d->log);
+}
+
+void mdp_durable_ack(mdp_durable_t* d, uint32_t ack) {
+  mdp_flashlog_ack(&d->log, ack);
+}
+
+uint16_t mdp_durable_next(mdp_durable_t* d, const uint8_t** p, uint32_t* seq) {
+  if (!d->log.ready) return 0;
+  uint16_t len;
+  for (;;) {
+    while (entry(d->replay, d->replay_len, d->replay_off, seq, p, &len)) {
+      if (*seq > d->sent) return len;
+      d->replay_off = (uint16_t)(d->replay_off + MDP_DURABLE_ENTRY_HDR + len);
+    }
+    uint32_t last = 0;
+    const uint16_t recLen = mdp_flashlog_peek(&d->log, d->rec, sizeof(d->rec), &last);
+    if (recLen == 0) break;
+    mdp_flashlog_skip(&d->log);
+    d->replay_off = 0;
+    d->replay_len = last > d->sent ? unpack(d->rec, recLen, d->replay, sizeof(d->replay)) : 0;
+  }
+
+  uint16_t off = 0;
+  while (entry(d->batch, d->batch_len, off, seq, p, &len)) {
+    if (*seq > d->sent) return len;
+    off = (uint16_t)(off + MDP_DURABLE_ENTRY_HDR + len);
+  }
+  return 0;
+}
+
+void mdp_durable_sent(mdp_durable_t* d, uint32_t seq) {
+  if (seq > d->sent) d->sent = seq;
+}
+
+void mdp_durable_rewind(mdp_durable_t* d, uint32_t acked) {
+  d->sent = acked;
+  d->replay_len = 0;
+  d->replay_off = 0;
+  mdp_flashlog_rewind(&d->log);
+}
@@ -0,0 +1,98 @@
+#ifndef MDP_DURABLE_H
+#define MDP_DURABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "mdp_flashlog.h"
+#include "mdp_lz4.h"
+#include "mdp_storage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Durable replay queue for sequenced MDP messages (Side-A telemetry) on top
+// of mdp_flashlog. Messages are group-committed: an open batch in RAM
+// (seq u32, len u16, payload per message) is packed into one flash record
+// when it fills or its oldest message is flush_ms old. Record body: codec u8,
+// raw len u16, then the batch (LZ4 block or raw). The record is tagged with
+// the batch's last seq, so the log retires it once the peer acks the batch.
+//
+// Messages are handed out in seq order for sending (mdp_durable_next/_sent):
+// unacked flash records from the replay cursor first (everything pending
+// after a boot), then the open batch. Live sends need not wait for a flush.
+
+#define MDP_DURABLE_BATCH_MAX  6144u
+#define MDP_DURABLE_RECORD_MAX 4064u   // one record per 4 KB sector at most
+#define MDP_DURABLE_ENTRY_HDR  6u
+
+typedef struct {
+  uint16_t batch_bytes;    // flush when the open batch would exceed this
+  uint32_t flush_ms;       // flush when the oldest batched message is this old
+  bool     compress;
+} mdp_durable_cfg_t;
+
+typedef struct {
+  uint32_t enqueued;
+  uint32_t flushes;        // records written with a body
+  uint32_t marks;          // bodiless records: whole batch already acked
+  uint32_t splits;         // batches that needed more than one record
+  uint32_t flush_failed;   // flushes that could not write; the batch was kept
+  uint32_t raw_bytes;      // batch bytes persisted
+  uint32_t packed_bytes;   // record bytes written for them
+} mdp_durable_stats_t;
+
+typedef struct {
+  mdp_flashlog_t      log;
+  mdp_durable_cfg_t   cfg;
+  uint8_t             batch[MDP_DURABLE_BATCH_MAX];
+  uint16_t            batch_len;
+  uint32_t            batch_ms;
+  uint8_t             rec[MDP_DURABLE_RECORD_MAX];
+  uint8_t             replay[MDP_DURABLE_BATCH_MAX];
+  uint16_t            replay_len;
+  uint16_t            replay_off;
+  uint8_t             scratch[MDP_FLASHLOG_HDR_BYTES + MDP_DURABLE_RECORD_MAX];
+  uint16_t            lz4_table[MDP_LZ4_HASH_ENTRIES];
+  uint32_t            sent;        // newest seq handed out
+  mdp_durable_stats_t stats;
+} mdp_durable_t;
+
+bool mdp_durable_mount(mdp_durable_t* d, const mdp_flash_t* flash, const mdp_durable_cfg_t* cfg);
+
+// Seq of the newest persisted message, 0 if none (for restoring tx_seq).
+uint32_t mdp_durable_last_seq(const mdp_durable_t* d);
+
+// Add to the open batch, flushing first if it is full. acked = peer's
+// cumulative ack, so already delivered messages are not persisted. False if
+// the batch is full and could not be flushed.
+bool mdp_durable_enqueue(mdp_durable_t* d, const uint8_t* payload, uint16_t len, uint32_t seq,
+                         uint32_t now_ms, uint32_t acked);
+
+// Persist the open batch now (e.g. before a reboot). False if it could not
+// be written: the batch stays open and the next flush retries it.
+bool mdp_durable_flush(mdp_durable_t* d, uint32_t acked);
+
+// Time-triggered flush (retried flush_ms later if it fails) and erase-ahead;
+// call from the idle loop.
+void mdp_durable_poll(mdp_durable_t* d, uint32_t now_ms, uint32_t acked);
+
+void mdp_durable_ack(mdp_durable_t* d, uint32_t ack);
+
+// Next message after the last one handed out, or 0 if none. *p stays valid
+// until the next call into this module.
+uint16_t mdp_durable_next(mdp_durable_t* d, const uint8_t** p, uint32_t* seq);
+
+// The message returned by mdp_durable_next() was handed to the transport.
+void mdp_durable_sent(mdp_durable_t* d, uint32_t seq);
+
+// Hand out everything after acked again (the transport gave up on some).
+void mdp_durable_rewind(mdp_durable_t* d, uint32_t acked);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,308 @@
+#include "mdp_flashlog.h"
+
+#include <string.h>
+
+#define SEC_MAGIC      0x4C50444Du   // "MDPL"
+#define REC_MAGIC      0xA55Au
+#define STATE_PENDING  0xFFFFFFFFu
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t seq_inv;
+  uint32_t rsv;
+} sec_hdr_t;
+
+typedef struct {
+  uint16_t magic;
+  uint16_t len;
+  uint32_t seq;
+  uint32_t crc;      // over len, seq, payload
+  uint32_t state;    // STATE_PENDING until acked; excluded from crc
+} rec_hdr_t;
+
+static_assert(sizeof(sec_hdr_t) == MDP_FLASHLOG_HDR_BYTES, "sector header size");
+static_assert(sizeof(rec_hdr_t) == MDP_FLASHLOG_HDR_BYTES, "record header size");
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, size_t n) {
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+static uint32_t rec_crc(const rec_hdr_t* h, const uint8_t* payload) {
+  uint32_t c = crc32_update(0, (const uint8_t*)&h->len, sizeof(h->len));
+  c = crc32_update(c, (const uint8_t*)&h->seq, sizeof(h->seq));
+  return crc32_update(c, payload, h->len);
+}
+
+uint32_t mdp_flashlog_record_bytes(uint16_t len) {
+  return MDP_FLASHLOG_HDR_BYTES + (((uint32_t)len + MDP_FLASHLOG_ALIGN - 1) & ~(MDP_FLASHLOG_ALIGN - 1));
+}
+
+static uint32_t abs_off(const mdp_flashlog_t* log, mdp_flashlog_pos_t p) {
+  return p.sector * log->io.sector_size + p.off;
+}
+
+static uint32_t next_sector(const mdp_flashlog_t* log, uint32_t s) {
+  return (s + 1) % log->io.sectors;
+}
+
+static bool pos_eq(mdp_flashlog_pos_t a, mdp_flashlog_pos_t b) {
+  return a.sector == b.sector && a.off == b.off;
+}
+
+static bool program(mdp_flashlog_t* log, uint32_t off, const void* buf, size_t len) {
+  log->stats.programs++;
+  log->stats.bytes_written += (uint32_t)len;
+  return log->io.write(log->io.ctx, off, buf, len);
+}
+
+static bool read_sec_hdr(const mdp_flashlog_t* log, uint32_t s, uint32_t* seq) {
+  sec_hdr_t h;
+  if (!log->io.read(log->io.ctx, s * log->io.sector_size, &h, sizeof(h))) return false;
+  if (h.magic != SEC_MAGIC || h.seq_inv != ~h.seq) return false;
+  *seq = h.seq;
+  return true;
+}
+
+// Record header at p, or false if this sector holds no more records.
+static bool rec_at(const mdp_flashlog_t* log, mdp_flashlog_pos_t p, rec_hdr_t* h) {
+  const uint32_t ss = log->io.sector_size;
+  if (p.off + MDP_FLASHLOG_HDR_BYTES > ss) return false;
+  if (!log->io.read(log->io.ctx, abs_off(log, p), h, sizeof(*h))) return false;
+  if (h->magic != REC_MAGIC) return false;
+  return mdp_flashlog_record_bytes(h->len) <= ss - p.off;
+}
+
+// Move *p forward to the next record at or after it, crossing into later
+// sectors. False once it reaches the head.
+static bool seek(const mdp_flashlog_t* log, mdp_flashlog_pos_t* p, rec_hdr_t* h) {
+  for (uint32_t n = 0; n <= log->io.sectors; n++) {
+    if (pos_eq(*p, log->head)) return false;
+    if (rec_at(log, *p, h)) return true;
+    if (p->sector == log->head.sector) return false;
+    p->sector = next_sector(log, p->sector);
+    p->off = MDP_FLASHLOG_HDR_BYTES;
+  }
+  return false;
+}
+
+static bool retire(mdp_flashlog_t* log, mdp_flashlog_pos_t p) {
+  const uint32_t zero = 0;
+  return program(log, abs_off(log, p) + offsetof(rec_hdr_t, state), &zero, sizeof(zero));
+}
+
+// Erase the sector after the head. If the ring is full that is the oldest
+// live sector, and whatever is still pending there is dropped.
+static bool erase_spare(mdp_flashlog_t* log) {
+  const uint32_t s = next_sector(log, log->head.sector);
+  if (s == log->first) {
+    mdp_flashlog_pos_t p = { s, MDP_FLASHLOG_HDR_BYTES };
+    rec_hdr_t h;
+    while (rec_at(log, p, &h)) {
+      if (h.state == STATE_PENDING) {
+        log->pending--;
+        log->stats.dropped++;
+      }
+      p.off += mdp_flashlog_record_bytes(h.len);
+    }
+    const mdp_flashlog_pos_t after = { next_sector(log, s), MDP_FLASHLOG_HDR_BYTES };
+    if (log->tail.sector == s) log->tail = after;
+    if (log->cursor.sector == s) log->cursor = after;
+    log->first = after.sector;
+  }
+  log->stats.erases++;
+  if (!log->io.erase(log->io.ctx, s * log->io.sector_size)) return false;
+  log->spare_dirty = false;
+  return true;
+}
+
+static bool open_sector(mdp_flashlog_t* log, uint32_t s, uint32_t seq) {
+  const sec_hdr_t h = { SEC_MAGIC, seq, ~seq, 0xFFFFFFFFu };
+  if (!program(log, s * log->io.sector_size, &h, sizeof(h))) return false;
+  log->head_seq = seq;
+  log->head.sector = s;
+  log->head.off = MDP_FLASHLOG_HDR_BYTES;
+  log->spare_dirty = true;
+  return true;
+}
+
+static bool format(mdp_flashlog_t* log) {
+  log->stats.erases++;
+  if (!log->io.erase(log->io.ctx, 0)) return false;
+  log->first = 0;
+  if (!open_sector(log, 0, 1)) return false;
+  log->tail = log->head;
+  log->cursor = log->head;
+  log->ready = true;
+  return true;
+}
+
+bool mdp_flashlog_mount(mdp_flashlog_t* log, const mdp_flash_t* io,
+                        uint8_t* scratch, uint16_t scratch_cap) {
+  memset(log, 0, sizeof(*log));
+  log->io = *io;
+  log->scratch = scratch;
+  log->scratch_cap = scratch_cap;
+  const uint32_t n = io->sectors;
+  const uint32_t ss = io->sector_size;
+  if (n < 3 || ss < 4 * MDP_FLASHLOG_HDR_BYTES || ss % MDP_FLASHLOG_ALIGN) return false;
+
+  // Head: the sector with the newest seq (serial-number compare).
+  bool any = false;
+  uint32_t head = 0, headSeq = 0;
+  for (uint32_t s = 0; s < n; s++) {
+    uint32_t seq;
+    if (!read_sec_hdr(log, s, &seq)) continue;
+    if (!any || (int32_t)(seq - headSeq) > 0) {
+      head = s;
+      headSeq = seq;
+      any = true;
+    }
+  }
+  if (!any) return format(log);
+
+  // Oldest live sector: walk back while seqs stay consecutive. The spare
+  // keeps at most n - 1 sectors live.
+  uint32_t first = head;
+  for (uint32_t k = 1; k + 1 < n; k++) {
+    const uint32_t s = (head + n - k) % n;
+    uint32_t seq;
+    if (!read_sec_hdr(log, s, &seq) || seq != headSeq - k) break;
+    first = s;
+  }
+  log->first = first;
+  log->head_seq = headSeq;
+  log->head.sector = head;
+  log->head.off = ss;   // provisional, so the scan runs to the end of the head sector
+
+  // Scan records oldest to newest.
+  mdp_flashlog_pos_t p = { first, MDP_FLASHLOG_HDR_BYTES };
+  mdp_flashlog_pos_t end = { head, MDP_FLASHLOG_HDR_BYTES };
+  bool tailSet = false;
+  rec_hdr_t h;
+  while (seek(log, &p, &h)) {
+    const uint32_t sz = mdp_flashlog_record_bytes(h.len);
+    bool ok = sz <= scratch_cap &&
+              io->read(io->ctx, abs_off(log, p) + MDP_FLASHLOG_HDR_BYTES, scratch, h.len) &&
+              rec_crc(&h, scratch) == h.crc;
+    if (!ok) {
+      // Torn by power loss mid-append. Retire it so later passes skip it.
+      if (h.state == STATE_PENDING) {
+        log->stats.torn++;
+        (void)retire(log, p);
+      }
+    } else {
+      if (h.state == STATE_PENDING) {
+        if (!tailSet) log->tail = p;
+        tailSet = true;
+        log->pending++;
+      }
+      log->last_seq = h.seq;
+    }
+    p.off += sz;
+    if (p.sector == head) end = p;
+  }
+
+  // Appends resume where the head sector's records stop, unless a header was
+  // torn so badly its length is unusable: then the rest of the sector is not
+  // known to be erased and the next append opens a new one.
+  log->head = end;
+  if (end.off + MDP_FLASHLOG_HDR_BYTES <= ss) {
+    uint8_t probe[MDP_FLASHLOG_HDR_BYTES];
+    if (!io->read(io->ctx, abs_off(log, end), probe, sizeof(probe))) return false;
+    for (size_t i = 0; i < sizeof(probe); i++) {
+      if (probe[i] != 0xFF) { log->head.off = ss; break; }
+    }
+  }
+  if (!tailSet) log->tail = log->head;
+  log->cursor = log->tail;
+  log->spare_dirty = true;
+  log->ready = true;
+  return true;
+}
+
+bool mdp_flashlog_append(mdp_flashlog_t* log, const uint8_t* payload, uint16_t len,
+                         uint32_t seq) {
+  if (!log->ready || !payload || len == 0) return false;
+  const uint32_t sz = mdp_flashlog_record_bytes(len);
+  if (sz > log->scratch_cap || sz > log->io.sector_size - MDP_FLASHLOG_HDR_BYTES) return false;
+
+  if (log->head.off + sz > log->io.sector_size) {
+    const uint32_t s = next_sector(log, log->head.sector);
+    if (log->spare_dirty && !erase_spare(log)) return false;
+    if (!open_sector(log, s, log->head_seq + 1)) return false;
+  }
+
+  rec_hdr_t h;
+  h.magic = REC_MAGIC;
+  h.len = len;
+  h.seq = seq;
+  h.crc = rec_crc(&h, payload);
+  h.state = STATE_PENDING;
+  memcpy(log->scratch, &h, sizeof(h));
+  memcpy(log->scratch + sizeof(h), payload, len);
+  memset(log->scratch + sizeof(h) + len, 0xFF, sz - sizeof(h) - len);
+  if (!program(log, abs_off(log, log->head), log->scratch, sz)) return false;
+
+  if (log->pending == 0) {
+    if (pos_eq(log->cursor, log->tail)) log->cursor = log->head;
+    log->tail = log->head;
+  }
+  log->head.off += sz;
+  log->pending++;
+  log->last_seq = seq;
+  log->stats.appends++;
+  return true;
+}
+
+void mdp_flashlog_ack(mdp_flashlog_t* log, uint32_t ack) {
+  if (!log->ready) return;
+  rec_hdr_t h, c;
+  while (seek(log, &log->tail, &h)) {
+    (void)seek(log, &log->cursor, &c);
+    if (h.state == STATE_PENDING) {
+      if (h.seq == 0 || h.seq > ack) break;
+      (void)retire(log, log->tail);
+      log->pending--;
+      log->stats.acked++;
+    }
+    const bool carry = pos_eq(log->cursor, log->tail);
+    log->tail.off += mdp_flashlog_record_bytes(h.len);
+    if (carry) log->cursor = log->tail;
+  }
+}
+
+uint16_t mdp_flashlog_peek(mdp_flashlog_t* log, uint8_t* buf, uint16_t cap, uint32_t* seq) {
+  if (!log->ready) return 0;
+  rec_hdr_t h;
+  while (seek(log, &log->cursor, &h)) {
+    if (h.state == STATE_PENDING && h.len <= cap &&
+        log->io.read(log->io.ctx, abs_off(log, log->cursor) + MDP_FLASHLOG_HDR_BYTES, buf, h.len)) {
+      *seq = h.seq;
+      return h.len;
+    }
+    log->cursor.off += mdp_flashlog_record_bytes(h.len);
+  }
+  return 0;
+}
+
+void mdp_flashlog_skip(mdp_flashlog_t* log) {
+  rec_hdr_t h;
+  if (log->ready && seek(log, &log->cursor, &h)) {
+    log->cursor.off += mdp_flashlog_record_bytes(h.len);
+  }
+}
+
+void mdp_flashlog_rewind(mdp_flashlog_t* log) {
+  log->cursor = log->tail;
+}
+
+bool mdp_flashlog_maintain(mdp_flashlog_t* log) {
+  if (!log->ready || !log->spare_dirty) return false;
+  return erase_spare(log);
+}
@@ -0,0 +1,104 @@
+#ifndef MDP_FLASHLOG_H
+#define MDP_FLASHLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "mdp_storage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Append-only record log over a raw NOR flash region (Side-A durable replay
+// queue). The region is a ring of erase sectors; each holds a 16-byte sector
+// header and then records packed back to back:
+//
+//   sector header  magic, sector seq, ~sector seq, reserved
+//   record header  magic u16, len u16, seq u32, crc32 u32, state u32
+//   payload        len bytes, padded to MDP_FLASHLOG_ALIGN
+//
+// A record is programmed with one write (header first, so a torn write always
+// leaves a header whose CRC fails) and never straddles a sector. Acking a
+// record clears its state word in place (1 -> 0 bits, no erase), so enqueue
+// and ack each cost a single program and no metadata is rewritten.
+//
+// Mount scans the sector headers for the newest sector seq (the head) and
+// walks back over consecutive seqs to find the oldest live sector, then scans
+// records to rebuild tail, pending count and the write offset.
+//
+// The sector after the head is kept erased. mdp_flashlog_maintain() erases it
+// ahead of time from the idle loop so appends never wait on an erase, unless
+// the log rolls faster than maintain() runs. Erasing it discards any records
+// still pending there (oldest first), which is how a full log makes room.
+
+#define MDP_FLASHLOG_ALIGN     16u
+#define MDP_FLASHLOG_HDR_BYTES 16u
+
+typedef struct {
+  uint32_t sector;
+  uint32_t off;            // byte offset inside the sector
+} mdp_flashlog_pos_t;
+
+typedef struct {
+  uint32_t appends;
+  uint32_t acked;
+  uint32_t dropped;        // pending records discarded to make room
+  uint32_t erases;
+  uint32_t programs;       // write() calls
+  uint32_t bytes_written;
+  uint32_t torn;           // bad records found (and retired) at mount
+} mdp_flashlog_stats_t;
+
+typedef struct {
+  mdp_flash_t        io;
+  uint8_t*           scratch;      // record assembly buffer
+  uint16_t           scratch_cap;
+  bool               ready;
+  bool               spare_dirty;  // sector after head not erased yet
+  uint32_t           first;        // oldest live sector
+  uint32_t           head_seq;     // sector seq of the head sector
+  mdp_flashlog_pos_t head;         // next write position
+  mdp_flashlog_pos_t tail;         // oldest record that may still be pending
+  mdp_flashlog_pos_t cursor;       // next record to hand out (replay)
+  uint32_t           pending;
+  uint32_t           last_seq;     // seq of the newest record, 0 if none
+  mdp_flashlog_stats_t stats;
+} mdp_flashlog_t;
+
+// Mount an existing log, or format a blank/foreign region (>= 3 sectors).
+// scratch bounds the largest record: payload <= scratch_cap -
+// MDP_FLASHLOG_HDR_BYTES. The cursor starts at the tail, so everything
+// pending is replayed.
+bool mdp_flashlog_mount(mdp_flashlog_t* log, const mdp_flash_t* io,
+                        uint8_t* scratch, uint16_t scratch_cap);
+
+// Append one record. False if it cannot fit a sector or the flash failed.
+bool mdp_flashlog_append(mdp_flashlog_t* log, const uint8_t* payload, uint16_t len,
+                         uint32_t seq);
+
+// Mark pending records acked from the tail while their seq <= ack.
+void mdp_flashlog_ack(mdp_flashlog_t* log, uint32_t ack);
+
+// Copy the record at the cursor (skipping acked ones) into buf. Returns its
+// length, or 0 when the cursor has caught up with the head.
+uint16_t mdp_flashlog_peek(mdp_flashlog_t* log, uint8_t* buf, uint16_t cap, uint32_t* seq);
+
+// Move the cursor past the record returned by the last peek.
+void mdp_flashlog_skip(mdp_flashlog_t* log);
+
+// Hand everything pending out again from the tail.
+void mdp_flashlog_rewind(mdp_flashlog_t* log);
+
+// Erase-ahead; call from the idle loop. Returns true if it erased a sector.
+bool mdp_flashlog_maintain(mdp_flashlog_t* log);
+
+// Bytes a record of len occupies in flash.
+uint32_t mdp_flashlog_record_bytes(uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+#include "mdp_lz4.h"
+
+#include <string.h>
+
+#define MIN_MATCH     4u
+#define LAST_LITERALS 5u    // the block always ends in at least this many literals
+#define MF_LIMIT      12u   // no match may start closer than this to the end
+#define MAX_OFFSET    65535u
+
+static uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t hash4(uint32_t v) {
+  return (v * 2654435761u) >> (32 - MDP_LZ4_HASH_LOG);
+}
+
+// Length field continuation bytes: 255 255 ... rest.
+static bool put_len(uint8_t** op, const uint8_t* end, size_t len) {
+  while (len >= 255) {
+    if (*op >= end) return false;
+    *(*op)++ = 255;
+    len -= 255;
+  }
+  if (*op >= end) return false;
+  *(*op)++ = (uint8_t)len;
+  return true;
+}
+
+static bool put_seq(uint8_t** op, const uint8_t* end, const uint8_t* lit, size_t litLen,
+                    size_t offset, size_t matchLen) {
+  uint8_t* token = *op;
+  if (*op >= end) return false;
+  (*op)++;
+  *token = (uint8_t)((litLen >= 15 ? 15 : litLen) << 4);
+  if (litLen >= 15 && !put_len(op, end, litLen - 15)) return false;
+  if ((size_t)(end - *op) < litLen) return false;
+  memcpy(*op, lit, litLen);
+  *op += litLen;
+  if (matchLen == 0) return true;   // last sequence: literals only
+
+  if (end - *op < 2) return false;
+  *(*op)++ = (uint8_t)(offset & 0xFF);
+  *(*op)++ = (uint8_t)(offset >> 8);
+  const size_t ml = matchLen - MIN_MATCH;
+  *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+  if (ml >= 15 && !put_len(op, end, ml - 15)) return false;
+  return true;
+}
+
+size_t mdp_lz4_compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap,
+                        uint16_t* table) {
+  if (n > MDP_LZ4_MAX_INPUT) return 0;
+  uint8_t* op = dst;
+  const uint8_t* end = dst + cap;
+  size_t anchor = 0;
+
+  if (n >= MF_LIMIT + 1) {
+    memset(table, 0, MDP_LZ4_HASH_ENTRIES * sizeof(uint16_t));
+    const size_t limit = n - MF_LIMIT;
+    const size_t matchEnd = n - LAST_LITERALS;
+    size_t ip = 1;   // so an empty slot (0) always refers to an earlier position
+    while (ip < limit) {
+      const uint32_t v = read32(src + ip);
+      const uint32_t h = hash4(v);
+      const size_t ref = table[h];
+      table[h] = (uint16_t)ip;
+      if (ip - ref > MAX_OFFSET || read32(src + ref) != v) {
+        ip++;
+        continue;
+      }
+      size_t len = MIN_MATCH;
+      while (ip + len < matchEnd && src[ref + len] == src[ip + len]) len++;
+      if (!put_seq(&op, end, src + anchor, ip - anchor, ip - ref, len)) return 0;
+      ip += len;
+      anchor = ip;
+    }
+  }
+  if (!put_seq(&op, end, src + anchor, n - anchor, 0, 0)) return 0;
+  return (size_t)(op - dst);
+}
+
+int mdp_lz4_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap) {
+  const uint8_t* ip = src;
+  const uint8_t* const iend = src + n;
+  size_t op = 0;
+
+  while (ip < iend) {
+    const uint8_t token = *ip++;
+    size_t lit = token >> 4;
+    if (lit == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend) return -1;
+        b = *ip++;
+        lit += b;
+      } while (b == 255);
+    }
+    if ((size_t)(iend - ip) < lit || cap - op < lit) return -1;
+    memcpy(dst + op, ip, lit);
+    ip += lit;
+    op += lit;
+    if (ip == iend) break;
+
+    if (iend - ip < 2) return -1;
+    const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > op) return -1;
+    size_t len = token & 15u;
+    if (len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend) return -1;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    len += MIN_MATCH;
+    if (cap - op < len) return -1;
+    // Byte copy: the match may overlap what it is producing.
+    const uint8_t* m = dst + op - offset;
+    for (size_t i = 0; i < len; i++) dst[op + i] = m[i];
+    op += len;
+  }
+  return (int)op;
+}
@@ -0,0 +1,38 @@
+#ifndef MDP_LZ4_H
+#define MDP_LZ4_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LZ4 block format (no frame header), greedy single-probe matcher. Small
+// enough for the Side-A durable log, where batches of near-identical JSON
+// telemetry envelopes compress well; output decodes with stock LZ4 tools.
+//
+// The compressor needs a caller-owned hash table of MDP_LZ4_HASH_ENTRIES
+// slots (8 KB), so nothing large lands on the stack. Inputs are limited to
+// 64 KB (match positions are 16-bit).
+
+#define MDP_LZ4_HASH_LOG     12
+#define MDP_LZ4_HASH_ENTRIES (1u << MDP_LZ4_HASH_LOG)
+#define MDP_LZ4_MAX_INPUT    65535u
+
+// Worst case for incompressible input.
+#define MDP_LZ4_BOUND(n) ((n) + (n) / 255u + 16u)
+
+// Returns the compressed size, or 0 if src is too long or dst too small.
+size_t mdp_lz4_compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap,
+                        uint16_t* table);
+
+// Returns the decompressed size, or -1 on malformed input or overflow.
+int mdp_lz4_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
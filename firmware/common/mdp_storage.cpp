@@ -0,0 +1,9 @@
+#include "mdp_storage.h"
+
+#include <string.h>
+
+bool mdp_kv_put_if_changed(const mdp_kv_t* kv, const char* key, const void* buf, size_t len,
+                           void* scratch) {
+  if (kv->get(kv->ctx, key, scratch, len) == len && memcmp(scratch, buf, len) == 0) return false;
+  return kv->set(kv->ctx, key, buf, len);
+}
@@ -0,0 +1,45 @@
+#ifndef MDP_STORAGE_H
+#define MDP_STORAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Storage HAL for the firmware's persistence paths, so the same code runs on
+// device (esp_partition / Preferences) and on host against the NOR and NVS
+// emulators in tools/host (mdp_storage_bench).
+
+// Raw NOR region. Program can only clear bits (1 -> 0); erase sets a whole
+// sector back to 0xFF. Offsets are bytes from the start of the region.
+typedef struct {
+  bool (*read)(void* ctx, uint32_t off, void* buf, size_t len);
+  bool (*write)(void* ctx, uint32_t off, const void* buf, size_t len);
+  bool (*erase)(void* ctx, uint32_t off);      // one sector at off
+  void*    ctx;
+  uint32_t sector_size;
+  uint32_t sectors;
+} mdp_flash_t;
+
+// Small key/value blobs (NVS on device).
+typedef struct {
+  // Bytes stored under key, copied up to cap; 0 if missing.
+  size_t (*get)(void* ctx, const char* key, void* buf, size_t cap);
+  bool   (*set)(void* ctx, const char* key, const void* buf, size_t len);
+  void*  ctx;
+} mdp_kv_t;
+
+// Write only if the stored blob differs, so periodic saves of unchanged
+// state cost a read instead of flash wear. scratch must hold len bytes.
+// Returns true if it wrote.
+bool mdp_kv_put_if_changed(const mdp_kv_t* kv, const char* key, const void* buf, size_t len,
+                           void* scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
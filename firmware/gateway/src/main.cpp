@@ -5,6 +5,7 @@
 
 #include <mdp_types.h>
 #include <mdp_utils.h>
+#include <mdp_arq.h>
 
 namespace cfg {
 constexpr uint32_t USB_BAUD = 115200;
@@ -15,6 +16,7 @@ constexpr size_t MAX_PAYLOAD = 900;
 // LoRa reliability
 constexpr uint32_t LORA_RTO_MS = 1800;
 constexpr uint8_t  MAX_RETRIES = 5;
+constexpr uint8_t  TX_SLOTS    = 4;
 
 // ===== SX1262 pin map (authoritative) =====
 constexpr int LORA_RST  = 7;
@@ -31,8 +33,7 @@ constexpr float LORA_FREQ_MHZ = 915.0;
 SX1262 radio = new Module(cfg::LORA_NSS, cfg::LORA_DIO1, cfg::LORA_RST, cfg::LORA_BUSY);
 
 static uint32_t gw_tx_seq = 1;
-static uint32_t ack_from_b = 0;
-static uint32_t last_inorder_b = 0;
+static mdp_arq_rx_t rx_b;
 
 static bool loraInit() {
   SPI.begin(cfg::LORA_SCK, cfg::LORA_MISO, cfg::LORA_MOSI, cfg::LORA_NSS);
@@ -64,7 +65,7 @@ static void sendAckToB(bool requestAckBack=false) {
   h->version = MDP_VER;
   h->msg_type = MDP_ACK;
   h->seq = gw_tx_seq++;
-  h->ack = last_inorder_b;
+  h->ack = rx_b.last_inorder;
   h->flags = IS_ACK | (requestAckBack ? ACK_REQUESTED : 0);
   h->src = EP_GATEWAY;
   h->dst = EP_SIDE_B;
@@ -72,31 +73,17 @@ static void sendAckToB(bool requestAckBack=false) {
   (void)loraSendMdp(out, sizeof(out));
 }
 
-// Simple command retransmit queue
-struct TxItem {
-  bool used=false;
-  uint32_t seq=0;
-  uint16_t len=0;
-  uint8_t payload[cfg::MAX_PAYLOAD];
-  uint32_t lastSend=0;
-  uint8_t retries=0;
-};
-static TxItem txq[4];
-
-static TxItem* txAlloc(){ for(auto &it:txq){ if(!it.used){ it.used=true; it.retries=0; it.lastSend=0; return &it; } } return nullptr; }
-static void txFreeAcked(uint32_t ackVal){ for(auto &it:txq){ if(it.used && it.seq && it.seq<=ackVal) it.used=false; } }
-static void txEnqueue(const uint8_t* payload, uint16_t len, uint32_t seq){ auto* it=txAlloc(); if(!it) return; it->seq=seq; it->len=len; memcpy(it->payload,payload,len); }
-static void txPump(uint32_t now){
-  for(auto &it:txq){
-    if(!it.used) continue;
-    if(ack_from_b >= it.seq){ it.used=false; continue; }
-    if(it.lastSend==0 || now-it.lastSend>=cfg::LORA_RTO_MS){
-      if(it.retries > cfg::MAX_RETRIES){ it.used=false; continue; }
-      (void)loraSendMdp(it.payload, it.len);
-      it.lastSend = now;
-      it.retries++;
-    }
-  }
+// Command retransmit queue (sends immediately, then every LORA_RTO_MS)
+static mdp_arq_slot_t tx_slots[cfg::TX_SLOTS];
+static uint8_t tx_pool[cfg::TX_SLOTS][cfg::MAX_PAYLOAD];
+static mdp_arq_t txq;
+
+static bool txSendLoRa(void*, const uint8_t* payload, uint16_t len) { return loraSendMdp(payload, len); }
+
+static void txInit() {
+  const mdp_arq_cfg_t c = { cfg::LORA_RTO_MS, cfg::MAX_RETRIES };
+  mdp_arq_init(&txq, tx_slots, cfg::TX_SLOTS, &tx_pool[0][0], cfg::MAX_PAYLOAD, &c, txSendLoRa, nullptr);
+  mdp_arq_rx_init(&rx_b);
 }
 
 static uint8_t lora_rx[cfg::MAX_FRAME];
@@ -106,10 +93,9 @@ static void handleFromB(const uint8_t* p, uint16_t len) {
   auto* h = (const mdp_hdr_v1_t*)p;
   if (h->magic != MDP_MAGIC || h->version != MDP_VER) return;
 
-  ack_from_b = max(ack_from_b, h->ack);
-  txFreeAcked(ack_from_b);
+  mdp_arq_on_ack(&txq, h->ack);
 
-  if (h->seq == last_inorder_b + 1) last_inorder_b = h->seq;
+  (void)mdp_arq_rx_accept(&rx_b, h->seq);
   if (h->flags & ACK_REQUESTED) sendAckToB(false);
 
   StaticJsonDocument<512> doc;
@@ -166,7 +152,7 @@ static void usbPoll() {
       cmd->hdr.version = MDP_VER;
       cmd->hdr.msg_type = MDP_COMMAND;
       cmd->hdr.seq = gw_tx_seq++;
-      cmd->hdr.ack = last_inorder_b;
+      cmd->hdr.ack = rx_b.last_inorder;
       cmd->hdr.flags = ACK_REQUESTED;
       cmd->hdr.src = EP_GATEWAY;
       cmd->hdr.dst = dst;
@@ -184,10 +170,12 @@ static void usbPoll() {
       cmd->cmd_len = cmd_len;
 
       uint16_t total = (uint16_t)(sizeof(mdp_cmd_v1_t) + cmd_len);
-      txEnqueue(out, total, cmd->hdr.seq);
-      (void)loraSendMdp(out, total);
+      bool queued = mdp_arq_send(&txq, out, total, cmd->hdr.seq, millis());
+      if (!queued) gw_tx_seq--;  // never sent: don't leave a gap in B's view
 
-      Serial.print("{\"sent\":true,\"seq\":");
+      Serial.print("{\"sent\":");
+      Serial.print(queued ? "true" : "false");
+      Serial.print(",\"seq\":");
       Serial.print(cmd->hdr.seq);
       Serial.println("}");
 
@@ -202,6 +190,7 @@ void setup() {
   Serial.begin(cfg::USB_BAUD);
   delay(50);
 
+  txInit();
   (void)loraInit();
   Serial.println("{\"side\":\"gateway\",\"mdp\":1,\"status\":\"ready\"}");
 }
@@ -210,5 +199,5 @@ void loop() {
   uint32_t now = millis();
   loraPoll();
   usbPoll();
-  txPump(now);
+  mdp_arq_pump(&txq, now);
 }
\ No newline at end of file
@@ -11,8 +11,16 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Preferences.h>
-#include <mbedtls/sha256.h>
-#include <time.h>
+#include <sys/time.h>
+#include <esp_random.h>
+#include <esp_partition.h>
+
+#include <mdp_arq.h>
+#include <mdp_durable.h>
+#include <mdp_storage.h>
+#include <myco_envelope.h>
+#include <monocypher.h>
+#include <optional/monocypher-ed25519.h>
 
 // NeoPixel and Buzzer modules (Side A peripherals)
 #include "config.h"
@@ -140,6 +148,7 @@ constexpr size_t MAX_FRAME   = 1024;    // encoded + crc
 // Reliability
 constexpr uint32_t RTO_MS = 120;        // UART local link
 constexpr uint8_t  MAX_RETRIES = 8;
+constexpr uint8_t  TX_SLOTS    = 6;
 } // namespace cfg
 
 // ==============================
@@ -257,13 +266,20 @@ static BusFound found[4] = {};
 static BmeCandidate bme_on_bus[4] = {};
 
 static Preferences prefs;
-static Preferences durablePrefs;
 
 // ==============================
 //  Device Identity (role/config)
 // ==============================
 static char deviceRole[32] = CONFIG_DEVICE_ROLE_DEFAULT;
 static char deviceDisplayName[64] = CONFIG_DEVICE_DISPLAY_NAME_DEFAULT;
+// Envelope deviceId (d): fixed per chip, from the factory eFuse MAC. Role and
+// display name can change at runtime, so they are not signed into each
+// envelope; the ready line maps device_id to them.
+static char deviceId[24];
+
+static void loadDeviceId() {
+  snprintf(deviceId, sizeof(deviceId), "MYCOBRAIN-%012llX", (unsigned long long)ESP.getEfuseMac());
+}
 
 static void loadDeviceIdentity() {
   if (!cfg::USE_NVS) return;
@@ -312,18 +328,19 @@ static bool mos_state[3] = {false,false,false};
 //  Envelope + durable replay
 // ==============================
 namespace durable_cfg {
-constexpr int QUEUE_CAPACITY = 8;
-constexpr size_t SLOT_BYTES = cfg::MAX_PAYLOAD;
-static const char* NVS_NS = "myco_a_q";
-static const char* KEY_HEAD = "head";
-static const char* KEY_TAIL = "tail";
-static const char* KEY_COUNT = "count";
-static const char* KEY_TXSEQ = "txseq";
-}
-
-static uint8_t durableHead = 0;
-static uint8_t durableTail = 0;
-static uint8_t durableCount = 0;
+// Raw data partition holding the replay log (see partitions_side_a.csv).
+static const char* PART_LABEL = "mdplog";
+// Group commit: batch up to BATCH_BYTES, or FLUSH_MS for the oldest message.
+constexpr uint16_t BATCH_BYTES = 6144;
+constexpr uint32_t FLUSH_MS = 10000;
+// How long setup() waits for Side-B's cumulative ack before resuming tx_seq
+// after the log alone (see txSeqSync()).
+constexpr uint32_t SEQ_SYNC_MS = 1000;
+}
+
+static const esp_partition_t* durablePart = nullptr;
+static mdp_flash_t durableFlash;
+static mdp_durable_t durable;
 static bool durableReady = false;
 
 static void toHex(const uint8_t* data, size_t len, char* outHex, size_t outHexCap) {
@@ -334,164 +351,110 @@ static void toHex(const uint8_t* data, size_t len, char* outHex, size_t outHexCa
   if (pos < outHexCap) outHex[pos] = '\0';
 }
 
-static bool base64Encode(const uint8_t* src, size_t len, char* out, size_t outCap) {
-  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  size_t outLen = 4 * ((len + 2) / 3);
-  if (outLen + 1 > outCap) return false;
-  size_t j = 0;
-  for (size_t i = 0; i < len; i += 3) {
-    uint32_t a = src[i];
-    uint32_t b = (i + 1 < len) ? src[i + 1] : 0;
-    uint32_t c = (i + 2 < len) ? src[i + 2] : 0;
-    uint32_t triple = (a << 16) | (b << 8) | c;
-
-    out[j++] = table[(triple >> 18) & 0x3F];
-    out[j++] = table[(triple >> 12) & 0x3F];
-    out[j++] = (i + 1 < len) ? table[(triple >> 6) & 0x3F] : '=';
-    out[j++] = (i + 2 < len) ? table[triple & 0x3F] : '=';
+// Device signing key (Ed25519, Monocypher layout: seed || public key). It is
+// generated on first boot and kept in NVS; the public key is printed in the
+// ready line so the gateway can enroll it.
+static const char* KEY_SIGN_SK = "ed_sk";
+static uint8_t signSk[64];
+static uint8_t signPk[32];
+static bool signKeyReady = false;
+static uint8_t bootNonce[12];   // msg_id = bootNonce || seq (LE)
+
+// False when NVS holds no key and a new one could not be stored. Nothing is
+// signed then: an all-zero key would let anyone forge telemetry, and a key
+// that changes every boot could never be enrolled.
+static bool loadSigningKey() {
+  esp_fill_random(bootNonce, sizeof(bootNonce));
+  if (!prefs.begin(cfg::NVS_NS, false)) return false;
+  if (prefs.getBytes(KEY_SIGN_SK, signSk, sizeof(signSk)) == sizeof(signSk)) {
+    memcpy(signPk, signSk + 32, sizeof(signPk));
+    prefs.end();
+    return true;
   }
-  out[j] = '\0';
-  return true;
+  uint8_t seed[32];
+  esp_fill_random(seed, sizeof(seed));
+  crypto_ed25519_key_pair(signSk, signPk, seed);   // wipes seed
+  bool stored = prefs.putBytes(KEY_SIGN_SK, signSk, sizeof(signSk)) == sizeof(signSk);
+  prefs.end();
+  if (!stored) {
+    crypto_wipe(signSk, sizeof(signSk));
+    crypto_wipe(signPk, sizeof(signPk));
+  }
+  return stored;
 }
 
-static void sha256Bytes(const uint8_t* data, size_t len, uint8_t out[32]) {
-  mbedtls_sha256_context ctx;
-  mbedtls_sha256_init(&ctx);
-  mbedtls_sha256_starts_ret(&ctx, 0);
-  mbedtls_sha256_update_ret(&ctx, data, len);
-  mbedtls_sha256_finish_ret(&ctx, out);
-  mbedtls_sha256_free(&ctx);
-}
+// Sensor/unit codes for the readings (see spec/sensor_codes.md).
+enum : uint16_t {
+  SID_AI1 = 20, SID_MOS1 = 30,
+  UNIT_V = 9, UNIT_BOOL = 10
+};
+// Volts as 1e-4 V integers, straight from the ADC counts.
+static constexpr uint32_t ADC_VREF_E4 = (uint32_t)(cfg::ADC_VREF * 10000.0f + 0.5f);
 
+// MycoEnvelope v1 (deterministic CBOR, BLAKE2b-256 + Ed25519), ~250 bytes.
 static bool buildTelemetryEnvelope(uint32_t now, uint32_t seq, uint8_t* out, uint16_t* outLen) {
-  if (!out || !outLen) return false;
-  // Unsigned envelope body (stable key order) with device identity.
-  char unsignedBody[768];
-  
-  // Build display name JSON field (null if empty)
-  char dispNameField[96] = "";
-  if (deviceDisplayName[0] != '\0') {
-    snprintf(dispNameField, sizeof(dispNameField), ",\"device_display_name\":\"%s\"", deviceDisplayName);
+  if (!out || !outLen || !signKeyReady) return false;
+  myco_reading_t r[7];
+  for (int i = 0; i < 4; i++) {
+    r[i].sid = (uint16_t)(SID_AI1 + i);
+    r[i].vi = (int32_t)(((uint32_t)ai_counts[i] * ADC_VREF_E4 + cfg::ADC_MAX / 2) / cfg::ADC_MAX);
+    r[i].vs = 4;
+    r[i].unit = UNIT_V;
+    r[i].quality = 0;
   }
-  
-  int unsignedN = snprintf(
-    unsignedBody, sizeof(unsignedBody),
-    "{\"hdr\":{\"deviceId\":\"mycobrain-side-a\",\"device_role\":\"%s\"%s,\"proto\":\"uart\",\"msgId\":\"%08lu\"},"
-    "\"ts\":{\"utc\":\"%lu\",\"mono_ms\":%lu},"
-    "\"seq\":%lu,"
-    "\"pack\":["
-      "{\"id\":\"ai1\",\"v\":%.4f,\"u\":\"V\"},"
-      "{\"id\":\"ai2\",\"v\":%.4f,\"u\":\"V\"},"
-      "{\"id\":\"ai3\",\"v\":%.4f,\"u\":\"V\"},"
-      "{\"id\":\"ai4\",\"v\":%.4f,\"u\":\"V\"},"
-      "{\"id\":\"mos1\",\"v\":%d,\"u\":\"bool\"},"
-      "{\"id\":\"mos2\",\"v\":%d,\"u\":\"bool\"},"
-      "{\"id\":\"mos3\",\"v\":%d,\"u\":\"bool\"}"
-    "],"
-    "\"meta\":{\"schema\":\"mycosoft.v1\",\"units\":\"si\"}}",
-    deviceRole, dispNameField,
-    (unsigned long)seq,
-    (unsigned long)(time(nullptr)),
-    (unsigned long)now,
-    (unsigned long)seq,
-    ai_volts[0], ai_volts[1], ai_volts[2], ai_volts[3],
-    mos_state[0] ? 1 : 0, mos_state[1] ? 1 : 0, mos_state[2] ? 1 : 0
-  );
-  if (unsignedN <= 0 || (size_t)unsignedN >= sizeof(unsignedBody)) return false;
-
-  uint8_t hashRaw[32];
-  sha256Bytes((const uint8_t*)unsignedBody, (size_t)unsignedN, hashRaw);
-  char hashHex[65];
-  toHex(hashRaw, sizeof(hashRaw), hashHex, sizeof(hashHex));
-
-  // Device-side placeholder signature for local bring-up:
-  // Once secure key provisioning lands, replace with real ed25519 signature.
-  char sigB64[96];
-  if (!base64Encode(hashRaw, sizeof(hashRaw), sigB64, sizeof(sigB64))) return false;
-
-  int finalN = snprintf(
-    (char*)out, cfg::MAX_PAYLOAD,
-    "%s,\"hash\":\"sha256:%s\",\"sig\":\"ed25519:%s\"}",
-    unsignedBody, hashHex, sigB64
-  );
-  if (finalN <= 0 || finalN >= (int)cfg::MAX_PAYLOAD) return false;
-
-  *outLen = (uint16_t)finalN;
+  for (int i = 0; i < 3; i++) {
+    r[4 + i].sid = (uint16_t)(SID_MOS1 + i);
+    r[4 + i].vi = mos_state[i] ? 1 : 0;
+    r[4 + i].vs = 0;
+    r[4 + i].unit = UNIT_BOOL;
+    r[4 + i].quality = 0;
+  }
+
+  uint8_t msgId[16];
+  memcpy(msgId, bootNonce, sizeof(bootNonce));
+  memcpy(msgId + 12, &seq, 4);
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  int64_t epochMs = (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+
+  size_t n = 0;
+  if (myco_build_envelope_cbor(out, cfg::MAX_PAYLOAD - sizeof(mdp_hdr_v1_t), &n,
+                               deviceId, MYCO_PROTO_OTHER, msgId,
+                               epochMs, seq, now, nullptr, r, 7, signSk) != 0) {
+    return false;
+  }
+  *outLen = (uint16_t)n;
   return true;
 }
 
-static void durableLoadMeta() {
-  durableHead = durablePrefs.getUChar(durable_cfg::KEY_HEAD, 0);
-  durableTail = durablePrefs.getUChar(durable_cfg::KEY_TAIL, 0);
-  durableCount = durablePrefs.getUChar(durable_cfg::KEY_COUNT, 0);
+static bool durableFlashRead(void* ctx, uint32_t off, void* buf, size_t len) {
+  return esp_partition_read((const esp_partition_t*)ctx, off, buf, len) == ESP_OK;
 }
 
-static void durableSaveMeta() {
-  if (!durableReady) return;
-  durablePrefs.putUChar(durable_cfg::KEY_HEAD, durableHead);
-  durablePrefs.putUChar(durable_cfg::KEY_TAIL, durableTail);
-  durablePrefs.putUChar(durable_cfg::KEY_COUNT, durableCount);
+static bool durableFlashWrite(void* ctx, uint32_t off, const void* buf, size_t len) {
+  return esp_partition_write((const esp_partition_t*)ctx, off, buf, len) == ESP_OK;
 }
 
-static int durableEnqueue(const uint8_t* payload, uint16_t len, uint32_t seq) {
-  if (!durableReady) return -1;
-  if (!payload || len == 0 || len > durable_cfg::SLOT_BYTES) return -1;
-  if (durableCount >= durable_cfg::QUEUE_CAPACITY) {
-    durableTail = (uint8_t)((durableTail + 1) % durable_cfg::QUEUE_CAPACITY);
-    durableCount--;
-  }
-  int slot = durableHead;
-  char kSeq[8], kLen[8], kDat[8];
-  snprintf(kSeq, sizeof(kSeq), "q%u_s", (unsigned)slot);
-  snprintf(kLen, sizeof(kLen), "q%u_l", (unsigned)slot);
-  snprintf(kDat, sizeof(kDat), "q%u_d", (unsigned)slot);
-  durablePrefs.putULong(kSeq, seq);
-  durablePrefs.putUShort(kLen, len);
-  durablePrefs.putBytes(kDat, payload, len);
-  durableHead = (uint8_t)((durableHead + 1) % durable_cfg::QUEUE_CAPACITY);
-  durableCount++;
-  durableSaveMeta();
-  return slot;
+static bool durableFlashErase(void* ctx, uint32_t off) {
+  return esp_partition_erase_range((const esp_partition_t*)ctx, off, SPI_FLASH_SEC_SIZE) == ESP_OK;
 }
 
-static void durableAck(uint32_t ackSeq) {
-  if (!durableReady) return;
-  while (durableCount > 0) {
-    char kSeq[8];
-    snprintf(kSeq, sizeof(kSeq), "q%u_s", (unsigned)durableTail);
-    uint32_t slotSeq = durablePrefs.getULong(kSeq, 0);
-    if (slotSeq == 0 || slotSeq > ackSeq) break;
-    durableTail = (uint8_t)((durableTail + 1) % durable_cfg::QUEUE_CAPACITY);
-    durableCount--;
-  }
-  durableSaveMeta();
+static bool durableInit() {
+  durablePart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                         durable_cfg::PART_LABEL);
+  if (!durablePart) return false;
+  durableFlash = {
+    durableFlashRead, durableFlashWrite, durableFlashErase, (void*)durablePart,
+    SPI_FLASH_SEC_SIZE, (uint32_t)(durablePart->size / SPI_FLASH_SEC_SIZE)
+  };
+  const mdp_durable_cfg_t c = { durable_cfg::BATCH_BYTES, durable_cfg::FLUSH_MS, true };
+  return mdp_durable_mount(&durable, &durableFlash, &c);
 }
 
-static void txEnqueue(const uint8_t* payload, uint16_t len, uint32_t seq, bool ackReq);
-static void uartSendCOBS(const uint8_t* payload, uint16_t len);
-
-static void durableReplayInit() {
+static void durableAck(uint32_t ackSeq) {
   if (!durableReady) return;
-  // Re-enqueue any durable messages that weren't acked before reboot.
-  for (uint8_t i = 0; i < durableCount; i++) {
-    uint8_t slot = (uint8_t)((durableTail + i) % durable_cfg::QUEUE_CAPACITY);
-    char kLen[8], kDat[8];
-    snprintf(kLen, sizeof(kLen), "q%u_l", (unsigned)slot);
-    snprintf(kDat, sizeof(kDat), "q%u_d", (unsigned)slot);
-    uint16_t len = durablePrefs.getUShort(kLen, 0);
-    if (len == 0 || len > durable_cfg::SLOT_BYTES) continue;
-    uint8_t buf[cfg::MAX_PAYLOAD];
-    size_t got = durablePrefs.getBytes(kDat, buf, len);
-    if (got != len) continue;
-
-    // Extract MDP header to recover seq.
-    if (len < sizeof(mdp_hdr_v1_t)) continue;
-    auto* hdr = (const mdp_hdr_v1_t*)buf;
-    if (hdr->magic != cfg::MDP_MAGIC || hdr->version != cfg::MDP_VER) continue;
-
-    txEnqueue(buf, len, hdr->seq, true);
-    uartSendCOBS(buf, len);
-  }
+  mdp_durable_ack(&durable, ackSeq);
 }
 
 static bool i2cReadReg_HW(TwoWire& bus, uint8_t addr, uint8_t reg, uint8_t& outVal) {
@@ -527,38 +490,51 @@ static BmeCandidate findBmeCandidateOnBus_HW(TwoWire& bus, const BusFound& f) {
   return c;
 }
 
+// NVS blobs behind the storage HAL; ctx is the Preferences namespace.
+static size_t nvsKvGet(void* ctx, const char* key, void* buf, size_t cap) {
+  if (!prefs.begin((const char*)ctx, true)) return 0;
+  size_t n = prefs.getBytesLength(key);
+  if (n && n <= cap) n = prefs.getBytes(key, buf, cap);
+  prefs.end();
+  return n;
+}
+
+static bool nvsKvSet(void* ctx, const char* key, const void* buf, size_t len) {
+  if (!prefs.begin((const char*)ctx, false)) return false;
+  size_t n = prefs.putBytes(key, buf, len);
+  prefs.end();
+  return n == len;
+}
+
+static const mdp_kv_t nvsKv = { nvsKvGet, nvsKvSet, (void*)cfg::NVS_NS };
+
+// Scan results as one blob, rewritten only when they change (the scan runs
+// every I2C_RESCAN_MS).
+struct ScanCache {
+  uint8_t version;
+  BusFound found[4];
+  BmeCandidate bme[4];
+};
+static constexpr uint8_t SCAN_CACHE_VERSION = 1;
+static const char* KEY_SCAN_CACHE = "scan";
+
 static void saveScanToNVS() {
   if (!cfg::USE_NVS) return;
-  if (!prefs.begin(cfg::NVS_NS, false)) return;
-  for (int b = 0; b < 4; b++) {
-    char keyCnt[16]; snprintf(keyCnt, sizeof(keyCnt), "b%d_cnt", b);
-    prefs.putUChar(keyCnt, found[b].count);
-    for (int i = 0; i < 16; i++) {
-      char keyA[16]; snprintf(keyA, sizeof(keyA), "b%d_a%02d", b, i);
-      prefs.putUChar(keyA, found[b].addrs[i]);
-    }
-    char kA[16], kC[16]; snprintf(kA, sizeof(kA), "b%d_bme_a", b); snprintf(kC, sizeof(kC), "b%d_bme_c", b);
-    prefs.putUChar(kA, bme_on_bus[b].present ? bme_on_bus[b].addr : 0);
-    prefs.putUChar(kC, bme_on_bus[b].present ? bme_on_bus[b].chip_id : 0);
-  }
-  prefs.end();
+  static ScanCache c, stored;
+  memset(&c, 0, sizeof(c));
+  c.version = SCAN_CACHE_VERSION;
+  memcpy(c.found, found, sizeof(c.found));
+  memcpy(c.bme, bme_on_bus, sizeof(c.bme));
+  (void)mdp_kv_put_if_changed(&nvsKv, KEY_SCAN_CACHE, &c, sizeof(c), &stored);
 }
 
 static void loadScanFromNVS() {
   if (!cfg::USE_NVS) return;
-  if (!prefs.begin(cfg::NVS_NS, true)) return;
-  for (int b = 0; b < 4; b++) {
-    char keyCnt[16]; snprintf(keyCnt, sizeof(keyCnt), "b%d_cnt", b);
-    found[b].count = prefs.getUChar(keyCnt, 0);
-    for (int i = 0; i < 16; i++) {
-      char keyA[16]; snprintf(keyA, sizeof(keyA), "b%d_a%02d", b, i);
-      found[b].addrs[i] = prefs.getUChar(keyA, 0);
-    }
-    char kA[16], kC[16]; snprintf(kA, sizeof(kA), "b%d_bme_a", b); snprintf(kC, sizeof(kC), "b%d_bme_c", b);
-    uint8_t a = prefs.getUChar(kA, 0), c = prefs.getUChar(kC, 0);
-    bme_on_bus[b].present = (a != 0); bme_on_bus[b].addr = a; bme_on_bus[b].chip_id = c;
-  }
-  prefs.end();
+  ScanCache c;
+  if (nvsKv.get(nvsKv.ctx, KEY_SCAN_CACHE, &c, sizeof(c)) != sizeof(c)) return;
+  if (c.version != SCAN_CACHE_VERSION) return;
+  memcpy(found, c.found, sizeof(c.found));
+  memcpy(bme_on_bus, c.bme, sizeof(c.bme));
 }
 
 static void scanAllI2C() {
@@ -596,20 +572,13 @@ static void setMosfet(int idx, bool on) {
 // ==============================
 //       MDP TX queue (reliable)
 // ==============================
-struct TxItem {
-  bool used=false;
-  uint32_t seq=0;
-  uint8_t  payload[cfg::MAX_PAYLOAD];
-  uint16_t len=0;
-  uint32_t lastSend=0;
-  uint8_t retries=0;
-  bool ackRequested=false;
-};
-
-static TxItem txq[6];
+static mdp_arq_slot_t tx_slots[cfg::TX_SLOTS];
+static uint8_t tx_pool[cfg::TX_SLOTS][cfg::MAX_PAYLOAD];
+static mdp_arq_t txq;                       // peer ack (acknowledging our seq) lives in txq.peer_ack
 static uint32_t tx_seq = 1;                 // our seq space
-static uint32_t peer_last_inorder = 0;      // last seq we have received from peer (Side-B)
-static uint32_t peer_ackd_us = 0;           // last ack from peer acknowledging our seq
+static bool tx_seq_synced = false;          // tx_seq checked against Side-B's ack this boot
+static uint32_t tx_seq_sync_start = 0;
+static mdp_arq_rx_t peer_rx;                // last seq we have received in order from peer (Side-B)
 static uint32_t telemetryPeriod = cfg::TELEMETRY_PERIOD_MS;
 
 static void uartSendCOBS(const uint8_t* payload, uint16_t len) {
@@ -627,49 +596,116 @@ static void uartSendCOBS(const uint8_t* payload, uint16_t len) {
   Serial2.write((uint8_t)0x00);
 }
 
-static TxItem* txAlloc() {
-  for (auto &it : txq) if (!it.used) { it.used=true; it.retries=0; it.lastSend=0; return &it; }
-  return nullptr;
+static bool txSendCOBS(void*, const uint8_t* payload, uint16_t len) {
+  uartSendCOBS(payload, len);
+  return true;
+}
+
+static void txInit() {
+  const mdp_arq_cfg_t c = { cfg::RTO_MS, cfg::MAX_RETRIES };
+  mdp_arq_init(&txq, tx_slots, cfg::TX_SLOTS, &tx_pool[0][0], cfg::MAX_PAYLOAD, &c, txSendCOBS, nullptr);
+  mdp_arq_rx_init(&peer_rx);
 }
 
-static void txFreeAcked(uint32_t ackVal) {
-  // cumulative ack: free all items with seq <= ackVal
-  for (auto &it : txq) {
-    if (it.used && it.seq != 0 && it.seq <= ackVal) it.used=false;
+// After a boot tx_seq resumes past the newest logged record, but seqs sent
+// from a batch that a power cut lost may already have reached Side-B. Its
+// cumulative ack says how far it got, so the first frame from Side-B moves
+// tx_seq past that: no seq is reused and none is skipped, which a v1
+// receiver could never ack past. Nothing sequenced goes out until then, or
+// until SEQ_SYNC_MS passes without an answer (Side-B down; seqs continue
+// after the log).
+static void txSeqSync(uint32_t peerAck) {
+  if (tx_seq_synced) return;
+  if (peerAck >= tx_seq) tx_seq = peerAck + 1;
+  tx_seq_synced = true;
+}
+
+static bool txSeqReady() {
+  if (!tx_seq_synced && (uint32_t)(millis() - tx_seq_sync_start) >= durable_cfg::SEQ_SYNC_MS) {
+    tx_seq_synced = true;
   }
-  // Mirror delivery progress into the durable replay queue.
-  durableAck(ackVal);
+  return tx_seq_synced;
+}
+
+// Send now and retransmit every RTO_MS until Side-B's cumulative ack covers seq.
+static bool txSend(const uint8_t* payload, uint16_t len, uint32_t seq) {
+  return mdp_arq_send(&txq, payload, len, seq, millis());
+}
+
+static bool durableEnqueue(const uint8_t* payload, uint16_t len, uint32_t seq) {
+  if (!durableReady) return false;
+  return mdp_durable_enqueue(&durable, payload, len, seq, millis(), txq.peer_ack);
+}
+
+static bool durableFlush() {
+  return !durableReady || mdp_durable_flush(&durable, txq.peer_ack);
 }
 
-static void txEnqueue(const uint8_t* payload, uint16_t len, uint32_t seq, bool ackReq) {
-  TxItem* it = txAlloc();
-  if (!it) return;
-  it->seq = seq;
-  it->len = len;
-  it->ackRequested = ackReq;
-  memcpy(it->payload, payload, len);
+static void buildAckOnly(uint8_t* out, uint32_t seq, bool requestAckBack) {
+  auto* h = (mdp_hdr_v1_t*)out;
+  h->magic = cfg::MDP_MAGIC;
+  h->version = cfg::MDP_VER;
+  h->msg_type = MDP_ACK;
+  h->seq = seq;
+  h->ack = peer_rx.last_inorder;      // cumulative ack for peer
+  h->flags = IS_ACK | (requestAckBack ? ACK_REQUESTED : 0);
+  h->src = cfg::EP_SIDE_A;
+  h->dst = cfg::EP_SIDE_B;
+  h->rsv = 0;
 }
 
-static void txTrySend(TxItem& it, uint32_t now, bool force=false) {
-  if (!it.used) return;
-  if (!force) {
-    if (it.lastSend != 0 && (now - it.lastSend) < cfg::RTO_MS) return;
+// Feed logged messages to the retransmit queue in seq order as slots free
+// up. If the queue gave up on a message (link down), stop feeding until it
+// drains and resend from the oldest unacked, so an outage never skips part
+// of the backlog.
+//
+// A seq that is no longer in the log (a full log discards its oldest
+// records; a power cut loses the open batch) would be a hole Side-B's
+// cumulative ack never gets past. It goes out as an ACK-only frame instead,
+// which Side-B counts in order and otherwise ignores.
+static void durablePump() {
+  static uint32_t expiredSeen = 0;
+  static uint32_t fedThrough = 0;           // highest seq handed to txq
+  if (!durableReady || !txSeqReady()) return;
+  if (txq.stats.expired != expiredSeen) {
+    if (mdp_arq_in_flight(&txq) != 0) return;
+    expiredSeen = txq.stats.expired;
+    mdp_durable_rewind(&durable, txq.peer_ack);
+    fedThrough = txq.peer_ack;
+  }
+  if (fedThrough < txq.peer_ack) fedThrough = txq.peer_ack;
+  while (mdp_arq_in_flight(&txq) < cfg::TX_SLOTS) {
+    const uint8_t* p;
+    uint32_t seq = 0;
+    uint16_t len = mdp_durable_next(&durable, &p, &seq);
+    if (len == 0) break;
+    if (fedThrough != 0 && seq > fedThrough + 1) {
+      uint8_t hole[sizeof(mdp_hdr_v1_t)];
+      buildAckOnly(hole, fedThrough + 1, true);
+      if (!txSend(hole, sizeof(hole), fedThrough + 1)) break;
+      fedThrough++;
+      continue;
+    }
+    if (!txSend(p, len, seq)) break;
+    mdp_durable_sent(&durable, seq);
+    if (seq > fedThrough) fedThrough = seq;
   }
-  if (it.retries > cfg::MAX_RETRIES) { it.used=false; return; }
-  uartSendCOBS(it.payload, it.len);
-  it.lastSend = now;
-  it.retries++;
-}
-
-static void txPump(uint32_t now) {
-  // resend any unacked reliable messages
-  for (auto &it : txq) {
-    if (!it.used) continue;
-    // If peer already acked this seq, free it.
-    if (peer_ackd_us >= it.seq) { it.used=false; continue; }
-    // only retransmit if ACK was requested (telemetry can be best-effort)
-    if (it.ackRequested) txTrySend(it, now, false);
+}
+
+// Every message that takes a seq goes through here. With the flash log it is
+// logged and sent by durablePump() in seq order, so a rewind after an outage
+// resends it with the telemetry around it and Side-B never sees a hole.
+// Nothing is sent and no seq is consumed when it cannot be queued.
+static bool txSendSequenced(const uint8_t* payload, uint16_t len, uint32_t seq) {
+  if (durableReady) {
+    if (!durableEnqueue(payload, len, seq)) return false;
+    tx_seq++;
+    durablePump();
+    return true;
   }
+  if (!txSend(payload, len, seq)) return false;
+  tx_seq++;
+  return true;
 }
 
 // ==============================
@@ -681,7 +717,7 @@ static size_t rxLen = 0;
 static uint8_t decBuf[cfg::MAX_FRAME];
 static size_t decLen = 0;
 
-static void mdpSendAckOnly(uint32_t now);
+static void mdpSendAckOnly(uint32_t now, bool requestAckBack = false);
 
 static void handleMdpPayload(const uint8_t* p, uint16_t len) {
   if (len < sizeof(mdp_hdr_v1_t)) return;
@@ -689,18 +725,15 @@ static void handleMdpPayload(const uint8_t* p, uint16_t len) {
 
   if (hdr->magic != cfg::MDP_MAGIC || hdr->version != cfg::MDP_VER) return;
 
-  // Update our view of peer ack (acks our outbound seq space)
-  peer_ackd_us = max(peer_ackd_us, hdr->ack);
-  txFreeAcked(peer_ackd_us);
+  // Update our view of peer ack (acks our outbound seq space), and mirror
+  // delivery progress into the durable replay queue.
+  mdp_arq_on_ack(&txq, hdr->ack);
+  durableAck(txq.peer_ack);
+  txSeqSync(hdr->ack);
 
-  // Sequence / in-order tracking (simple cumulative)
-  if (hdr->seq == peer_last_inorder + 1) {
-    peer_last_inorder = hdr->seq;
-  } else if (hdr->seq <= peer_last_inorder) {
-    // duplicate; ok
-  } else {
-    // out-of-order: accept but do not advance in-order (v1 keeps it simple)
-  }
+  // Sequence / in-order tracking (simple cumulative). Duplicates and
+  // out-of-order frames are accepted but do not advance it (v1 keeps it simple).
+  (void)mdp_arq_rx_accept(&peer_rx, hdr->seq);
 
   // If peer requests ACK, respond quickly
   if (hdr->flags & ACK_REQUESTED) mdpSendAckOnly(millis());
@@ -757,6 +790,8 @@ static void handleMdpPayload(const uint8_t* p, uint16_t len) {
         break;
 
       case CMD_REBOOT:
+        // Unflushed telemetry would be lost; report instead of restarting.
+        if (!durableFlush()) { status = -4; break; }
         ESP.restart();
         break;
 
@@ -841,11 +876,12 @@ static void handleMdpPayload(const uint8_t* p, uint16_t len) {
     e->hdr.magic = cfg::MDP_MAGIC;
     e->hdr.version = cfg::MDP_VER;
     e->hdr.msg_type = MDP_EVENT;
-    e->hdr.seq = tx_seq++;
-    e->hdr.ack = peer_last_inorder;
+    e->hdr.seq = tx_seq;
+    e->hdr.ack = peer_rx.last_inorder;
     e->hdr.flags = ACK_REQUESTED;
     e->hdr.src = cfg::EP_SIDE_A;
     e->hdr.dst = cmd->hdr.src;
+    e->hdr.rsv = 0;
 
     e->evt_type = EVT_CMD_RESULT;
     e->cmd_id = cmd->cmd_id;
@@ -853,8 +889,7 @@ static void handleMdpPayload(const uint8_t* p, uint16_t len) {
     e->evt_len = sizeof(uint16_t) + sizeof(int16_t); // cmd_id + status
 
     uint16_t total = sizeof(mdp_evt_cmd_result_v1_t);
-    txEnqueue(out, total, e->hdr.seq, true);
-    uartSendCOBS(out, total);
+    (void)txSendSequenced(out, total, e->hdr.seq);
   }
 }
 
@@ -885,38 +920,28 @@ static void rxPollCOBS() {
 // ==============================
 //   MDP message builders/senders
 // ==============================
-static void mdpSendAckOnly(uint32_t now) {
+// ACK-only frames are unsequenced (seq 0, which Side-B files as a duplicate)
+// and sent once: they are not logged, so a replay after a reboot or an
+// outage could not resend them and a seq they took would stay a hole at
+// Side-B. A lost ACK is recovered when Side-B retransmits.
+static void mdpSendAckOnly(uint32_t now, bool requestAckBack) {
   uint8_t out[sizeof(mdp_hdr_v1_t)];
-  auto* h = (mdp_hdr_v1_t*)out;
-  h->magic = cfg::MDP_MAGIC;
-  h->version = cfg::MDP_VER;
-  h->msg_type = MDP_ACK;
-  h->seq = tx_seq++;                 // ack-only still has seq in our space
-  h->ack = peer_last_inorder;         // cumulative ack for peer
-  h->flags = IS_ACK;
-  h->src = cfg::EP_SIDE_A;
-  h->dst = cfg::EP_SIDE_B;
-  h->rsv = 0;
-
-  // ACK-only is reliable-ish but low cost: request ack to keep both seq spaces tight
-  h->flags |= ACK_REQUESTED;
-
-  txEnqueue(out, sizeof(out), h->seq, true);
+  buildAckOnly(out, 0, requestAckBack);
   uartSendCOBS(out, sizeof(out));
 }
 
 static void sendTelemetry(uint32_t now) {
-  // Build deterministic envelope payload (JSON for bring-up; CBOR in later revision)
+  // Signed MycoEnvelope v1 (CBOR) payload
   uint8_t out[cfg::MAX_PAYLOAD];
   uint16_t envLen = 0;
+  if (!txSeqReady()) return;
 
   auto* h = (mdp_hdr_v1_t*)out;
   h->magic = cfg::MDP_MAGIC;
   h->version = cfg::MDP_VER;
   h->msg_type = MDP_TELEMETRY;
-  h->seq = tx_seq++;
-  if (durableReady) durablePrefs.putULong(durable_cfg::KEY_TXSEQ, tx_seq);
-  h->ack = peer_last_inorder;
+  h->seq = tx_seq;
+  h->ack = peer_rx.last_inorder;
   h->flags = ACK_REQUESTED;     // request ACK so durability can advance
   h->src = cfg::EP_SIDE_A;
   h->dst = cfg::EP_SIDE_B;
@@ -925,10 +950,9 @@ static void sendTelemetry(uint32_t now) {
   if (!buildTelemetryEnvelope(now, h->seq, out + sizeof(mdp_hdr_v1_t), &envLen)) return;
   uint16_t total = (uint16_t)(sizeof(mdp_hdr_v1_t) + envLen);
 
-  // Persist and enqueue for replay across reboot.
-  (void)durableEnqueue(out, total, h->seq);
-  txEnqueue(out, total, h->seq, true);
-  uartSendCOBS(out, total);
+  // Telemetry is regenerated every period, so when the log or queue is full
+  // this sample is skipped without consuming a seq (which would stall Side-B).
+  (void)txSendSequenced(out, total, h->seq);
 }
 
 // ==============================
@@ -941,17 +965,20 @@ void setup() {
   delay(50);
 
   Serial2.begin(cfg::LINK_BAUD, SERIAL_8N1, cfg::PIN_RX2, cfg::PIN_TX2);
+  txInit();
 
-  // Durable queue NVS (survives reboot/power loss)
-  if (durablePrefs.begin(durable_cfg::NVS_NS, false)) {
-    durableReady = true;
-    durableLoadMeta();
-    tx_seq = durablePrefs.getULong(durable_cfg::KEY_TXSEQ, tx_seq);
-    durableReplayInit();
-  }
+  // Durable replay log on raw flash (survives reboot/power loss). Unacked
+  // records are replayed by durablePump() from the loop. tx_seq resumes
+  // after the log, then after Side-B's ack once it answers this ACK request.
+  durableReady = durableInit();
+  if (durableReady) tx_seq = mdp_durable_last_seq(&durable) + 1;
+  tx_seq_sync_start = millis();
+  mdpSendAckOnly(tx_seq_sync_start, true);
 
   // Load device identity (role, display name) from NVS
+  loadDeviceId();
   loadDeviceIdentity();
+  signKeyReady = loadSigningKey();
 
   // Initialize NeoPixel and Buzzer (Side A peripherals)
   Pixel::init();
@@ -976,16 +1003,20 @@ void setup() {
   lastTelem = millis();
   lastScan  = millis();
 
-  // Status with device identity for service parsing
-  char statusJson[256];
+  // Status with device identity for service parsing. Without a signing key
+  // no telemetry is sent, and the status says so.
+  char pkHex[65] = "";
+  if (signKeyReady) toHex(signPk, sizeof(signPk), pkHex, sizeof(pkHex));
+  const char* status = signKeyReady ? "ready" : "no_signing_key";
+  char statusJson[384];
   if (deviceDisplayName[0] != '\0') {
     snprintf(statusJson, sizeof(statusJson),
-      "{\"side\":\"A\",\"mdp\":\"v1\",\"device_role\":\"%s\",\"device_display_name\":\"%s\",\"status\":\"ready\"}",
-      deviceRole, deviceDisplayName);
+      "{\"side\":\"A\",\"mdp\":\"v1\",\"device_id\":\"%s\",\"device_role\":\"%s\",\"device_display_name\":\"%s\",\"ed25519_pk\":\"%s\",\"status\":\"%s\"}",
+      deviceId, deviceRole, deviceDisplayName, pkHex, status);
   } else {
     snprintf(statusJson, sizeof(statusJson),
-      "{\"side\":\"A\",\"mdp\":\"v1\",\"device_role\":\"%s\",\"status\":\"ready\"}",
-      deviceRole);
+      "{\"side\":\"A\",\"mdp\":\"v1\",\"device_id\":\"%s\",\"device_role\":\"%s\",\"ed25519_pk\":\"%s\",\"status\":\"%s\"}",
+      deviceId, deviceRole, pkHex, status);
   }
   Serial.println(statusJson);
 }
@@ -1010,5 +1041,7 @@ void loop() {
     sendTelemetry(now);
   }
 
-  txPump(now);
+  mdp_arq_pump(&txq, now);
+  if (durableReady) mdp_durable_poll(&durable, now, txq.peer_ack);
+  durablePump();
 }
@@ -31,6 +31,7 @@
 
 #include <mdp_types.h>
 #include <mdp_utils.h>
+#include <mdp_arq.h>
 
 namespace cfg {
 constexpr uint32_t USB_BAUD = 115200;
@@ -49,6 +50,7 @@ constexpr uint32_t UART_RTO_MS = 120;
 constexpr uint32_t LORA_RTO_MS = 1800;
 constexpr uint32_t WIFI_RTO_MS = 500;
 constexpr uint8_t  MAX_RETRIES = 5;
+constexpr uint8_t  TX_SLOTS    = 8;   // per link
 
 // ===== SX1262 pin map (authoritative) =====
 // SX_Reset  -> GPIO7
@@ -353,107 +355,75 @@ static void uartSendMdp(const uint8_t* payload, uint16_t len) {
 }
 
 // ---------- Reliability queues ----------
-struct TxItem {
-  bool used=false;
-  bool viaLoRa=false;
-  uint32_t seq=0;
-  uint16_t len=0;
-  uint8_t  payload[cfg::MAX_PAYLOAD];
-  uint32_t lastSend=0;
-  uint8_t retries=0;
-  uint32_t rto=0;
-};
+// One retransmit queue per link; b_tx_seq is shared by both links.
+static mdp_arq_slot_t tx_slots_a[cfg::TX_SLOTS];
+static mdp_arq_slot_t tx_slots_gw[cfg::TX_SLOTS];
+static uint8_t tx_pool_a[cfg::TX_SLOTS][cfg::MAX_PAYLOAD];
+static uint8_t tx_pool_gw[cfg::TX_SLOTS][cfg::MAX_PAYLOAD];
+static mdp_arq_t txq_a;
+static mdp_arq_t txq_gw;
 
-static TxItem txq[8];
 static uint32_t b_tx_seq = 1;
-static uint32_t ack_from_a = 0;
-static uint32_t ack_from_gw = 0;
-static uint32_t last_inorder_a = 0;
-static uint32_t last_inorder_gw = 0;
-
-static TxItem* txAlloc() {
-  for (auto &it: txq) {
-    if (!it.used) {
-      it.used = true;
-      it.retries = 0;
-      it.lastSend = 0;
-      return &it;
-    }
-  }
-  return nullptr;
-}
-
-static void txFreeAcked(bool viaLoRa, uint32_t ackVal) {
-  for (auto &it: txq) {
-    if (it.used && it.viaLoRa == viaLoRa && it.seq != 0 && it.seq <= ackVal) {
-      it.used = false;
-    }
-  }
+static mdp_arq_rx_t rx_a;
+static mdp_arq_rx_t rx_gw;
+
+static bool txSendUart(void*, const uint8_t* payload, uint16_t len) { uartSendMdp(payload, len); return true; }
+static bool txSendLoRa(void*, const uint8_t* payload, uint16_t len) { return loraSendMdp(payload, len); }
+
+static void txInit() {
+  const mdp_arq_cfg_t uart = { cfg::UART_RTO_MS, cfg::MAX_RETRIES };
+  const mdp_arq_cfg_t lora = { cfg::LORA_RTO_MS, cfg::MAX_RETRIES };
+  mdp_arq_init(&txq_a, tx_slots_a, cfg::TX_SLOTS, &tx_pool_a[0][0], cfg::MAX_PAYLOAD, &uart, txSendUart, nullptr);
+  mdp_arq_init(&txq_gw, tx_slots_gw, cfg::TX_SLOTS, &tx_pool_gw[0][0], cfg::MAX_PAYLOAD, &lora, txSendLoRa, nullptr);
+  mdp_arq_rx_init(&rx_a);
+  mdp_arq_rx_init(&rx_gw);
 }
 
-static void txEnqueue(bool viaLoRa, const uint8_t* payload, uint16_t len, uint32_t seq, uint32_t rto) {
-  TxItem* it = txAlloc();
-  if (!it) return;
-  it->viaLoRa = viaLoRa;
-  it->seq = seq;
-  it->len = len;
-  it->rto = rto;
-  memcpy(it->payload, payload, len);
-}
-
-static void txSendNow(TxItem& it, uint32_t now) {
-  if (!it.used) return;
-  if (it.retries > cfg::MAX_RETRIES) { it.used = false; return; }
-  if (it.viaLoRa) (void)loraSendMdp(it.payload, it.len);
-  else uartSendMdp(it.payload, it.len);
-  it.lastSend = now;
-  it.retries++;
-}
-
-static void txPump(uint32_t now) {
-  for (auto &it: txq) {
-    if (!it.used) continue;
-    uint32_t acked = it.viaLoRa ? ack_from_gw : ack_from_a;
-    if (acked >= it.seq) { it.used = false; continue; }
-    if (it.lastSend == 0 || (now - it.lastSend) >= it.rto) {
-      txSendNow(it, now);
-    }
-  }
+// Re-address a received message and send it reliably on the other link.
+static void forwardReliable(const uint8_t* p, uint16_t len, uint8_t dst,
+                            mdp_arq_t* q, const mdp_arq_rx_t* rx) {
+  uint8_t out[cfg::MAX_PAYLOAD];
+  if (len > sizeof(out)) return;
+  memcpy(out, p, len);
+
+  auto* oh = (mdp_hdr_v1_t*)out;
+  oh->src = EP_SIDE_B;
+  oh->dst = dst;
+  oh->seq = b_tx_seq;
+  oh->ack = rx->last_inorder;
+  oh->flags |= ACK_REQUESTED;
+
+  if (mdp_arq_send(q, out, len, oh->seq, millis())) b_tx_seq++;
 }
 
 // ---------- ACK builders ----------
-static void sendAckToA(bool requestAckBack=false) {
-  uint8_t out[sizeof(mdp_hdr_v1_t)];
+// ACK-only frames take a seq like any other and are queued for retransmission;
+// with the queue full they still go out once.
+static void buildAck(uint8_t* out, uint8_t dst, uint32_t seq, uint32_t ack, bool requestAckBack) {
   auto* h = (mdp_hdr_v1_t*)out;
   h->magic = MDP_MAGIC;
   h->version = MDP_VER;
   h->msg_type = MDP_ACK;
-  h->seq = b_tx_seq++;
-  h->ack = last_inorder_a;
+  h->seq = seq;
+  h->ack = ack;
   h->flags = IS_ACK | (requestAckBack ? ACK_REQUESTED : 0);
   h->src = EP_SIDE_B;
-  h->dst = EP_SIDE_A;
+  h->dst = dst;
   h->rsv = 0;
+}
 
-  txEnqueue(false, out, sizeof(out), h->seq, cfg::UART_RTO_MS);
-  uartSendMdp(out, sizeof(out));
+static void sendAckToA(bool requestAckBack=false) {
+  uint8_t out[sizeof(mdp_hdr_v1_t)];
+  uint32_t seq = b_tx_seq++;
+  buildAck(out, EP_SIDE_A, seq, rx_a.last_inorder, requestAckBack);
+  if (!mdp_arq_send(&txq_a, out, sizeof(out), seq, millis())) uartSendMdp(out, sizeof(out));
 }
 
 static void sendAckToGW(bool requestAckBack=false) {
   uint8_t out[sizeof(mdp_hdr_v1_t)];
-  auto* h = (mdp_hdr_v1_t*)out;
-  h->magic = MDP_MAGIC;
-  h->version = MDP_VER;
-  h->msg_type = MDP_ACK;
-  h->seq = b_tx_seq++;
-  h->ack = last_inorder_gw;
-  h->flags = IS_ACK | (requestAckBack ? ACK_REQUESTED : 0);
-  h->src = EP_SIDE_B;
-  h->dst = EP_GATEWAY;
-  h->rsv = 0;
-
-  txEnqueue(true, out, sizeof(out), h->seq, cfg::LORA_RTO_MS);
-  (void)loraSendMdp(out, sizeof(out));
+  uint32_t seq = b_tx_seq++;
+  buildAck(out, EP_GATEWAY, seq, rx_gw.last_inorder, requestAckBack);
+  if (!mdp_arq_send(&txq_gw, out, sizeof(out), seq, millis())) (void)loraSendMdp(out, sizeof(out));
 }
 
 // ---------- UART RX (COBS framed) ----------
@@ -466,43 +436,14 @@ static void handleFromA(const uint8_t* p, uint16_t len) {
   auto* h = (const mdp_hdr_v1_t*)p;
   if (h->magic != MDP_MAGIC || h->version != MDP_VER) return;
 
-  ack_from_a = max(ack_from_a, h->ack);
-  txFreeAcked(false, ack_from_a);
+  mdp_arq_on_ack(&txq_a, h->ack);
 
-  if (h->seq == last_inorder_a + 1) last_inorder_a = h->seq;
+  (void)mdp_arq_rx_accept(&rx_a, h->seq);
   if (h->flags & ACK_REQUESTED) sendAckToA(false);
 
-  // Forward telemetry reliably (LoRa can be lossy; this enables replay/ack).
-  if (h->msg_type == MDP_TELEMETRY) {
-    uint8_t out[cfg::MAX_PAYLOAD];
-    if (len > sizeof(out)) return;
-    memcpy(out, p, len);
-    auto* oh = (mdp_hdr_v1_t*)out;
-    oh->src = EP_SIDE_B;
-    oh->dst = EP_GATEWAY;
-    oh->seq = b_tx_seq++;
-    oh->ack = last_inorder_gw;
-    oh->flags |= ACK_REQUESTED;
-    txEnqueue(true, out, len, oh->seq, cfg::LORA_RTO_MS);
-    (void)loraSendMdp(out, len);
-    return;
-  }
-
-  // Forward events reliably
-  if (h->msg_type == MDP_EVENT) {
-    uint8_t out[cfg::MAX_PAYLOAD];
-    if (len > sizeof(out)) return;
-    memcpy(out, p, len);
-
-    auto* oh = (mdp_hdr_v1_t*)out;
-    oh->src = EP_SIDE_B;
-    oh->dst = EP_GATEWAY;
-    oh->seq = b_tx_seq++;
-    oh->ack = last_inorder_gw;
-    oh->flags |= ACK_REQUESTED;
-
-    txEnqueue(true, out, len, oh->seq, cfg::LORA_RTO_MS);
-    (void)loraSendMdp(out, len);
+  // Forward telemetry and events reliably (LoRa can be lossy; this enables replay/ack).
+  if (h->msg_type == MDP_TELEMETRY || h->msg_type == MDP_EVENT) {
+    forwardReliable(p, len, EP_GATEWAY, &txq_gw, &rx_gw);
   }
 }
 
@@ -532,27 +473,14 @@ static void handleFromGW(const uint8_t* p, uint16_t len) {
   auto* h = (const mdp_hdr_v1_t*)p;
   if (h->magic != MDP_MAGIC || h->version != MDP_VER) return;
 
-  ack_from_gw = max(ack_from_gw, h->ack);
-  txFreeAcked(true, ack_from_gw);
+  mdp_arq_on_ack(&txq_gw, h->ack);
 
-  if (h->seq == last_inorder_gw + 1) last_inorder_gw = h->seq;
+  (void)mdp_arq_rx_accept(&rx_gw, h->seq);
   if (h->flags & ACK_REQUESTED) sendAckToGW(false);
 
   // Commands from gateway -> forward reliably to Side-A
   if (h->msg_type == MDP_COMMAND) {
-    uint8_t out[cfg::MAX_PAYLOAD];
-    if (len > sizeof(out)) return;
-    memcpy(out, p, len);
-
-    auto* oh = (mdp_hdr_v1_t*)out;
-    oh->src = EP_SIDE_B;
-    oh->dst = EP_SIDE_A;
-    oh->seq = b_tx_seq++;
-    oh->ack = last_inorder_a;
-    oh->flags |= ACK_REQUESTED;
-
-    txEnqueue(false, out, len, oh->seq, cfg::UART_RTO_MS);
-    uartSendMdp(out, len);
+    forwardReliable(p, len, EP_SIDE_A, &txq_a, &rx_a);
   }
 }
 
@@ -582,6 +510,7 @@ void setup() {
 
   // UART to Side-A (always enabled)
   Serial2.begin(cfg::UART_BAUD, SERIAL_8N1, cfg::PIN_B_RX2, cfg::PIN_B_TX2);
+  txInit();
   
   // Initialize enabled communication modules
 #if ENABLE_LORA
@@ -634,5 +563,6 @@ void loop() {
 #endif
 
   // Reliability queue pump
-  txPump(now);
+  mdp_arq_pump(&txq_a, now);
+  mdp_arq_pump(&txq_gw, now);
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+// bench_verify.c : checks the C envelope verifier against the spec test
+// vectors, then reports parse / verify throughput in envelopes per second, to
+// size edge gateways that verify before forwarding, and compares one-by-one
+// with batch signature verification at batch sizes 1..256.
+//
+//   cc -O2 -o bench_verify bench_verify.c myco_envelope.c myco_cbor.c
+//      myco_ed25519_batch.c myco_crypto_monocypher.c
+//      monocypher.c optional/monocypher-ed25519.c
+//   ./bench_verify ../../spec/myco-envelope-test-vectors-FEB09-2026.json [readings]
+//
+// Only the cbor_* vectors apply (the others are JSON-form envelopes and acks).
+// Exit status is non-zero if any of them disagrees with its "expected" block.
+#define _POSIX_C_SOURCE 199309L
+#include "myco_envelope.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_ENVELOPES 64
+#define BENCH_CAP       2048
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Minimal field lookup for the vectors file (pretty-printed JSON we control):
+// finds "key": within [p, end) and returns a pointer to the value.
+static const char *field(const char *p, const char *end, const char *key) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const size_t n = strlen(pat);
+    for (; p && p + n <= end; p++) {
+        if (memcmp(p, pat, n) == 0) {
+            p += n;
+            while (p < end && (*p == ' ' || *p == '\n')) p++;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static size_t hex_decode(const char *s, uint8_t *out, size_t cap) {
+    size_t n = 0;
+    if (!s || *s != '"') return 0;
+    s++;
+    while (s[0] != '"' && s[1] != '"' && n < cap) {
+        unsigned v;
+        if (sscanf(s, "%2x", &v) != 1) return 0;
+        out[n++] = (uint8_t)v;
+        s += 2;
+    }
+    return n;
+}
+
+static int flag(const char *p, const char *end, const char *key) {
+    const char *v = field(p, end, key);
+    return v && strncmp(v, "true", 4) == 0;
+}
+
+static int check_vectors(const char *txt, size_t len, uint8_t sk64[64]) {
+    const char *end = txt + len;
+    int pass = 0, fail = 0, skipped = 0;
+
+    const char *k = field(txt, end, "cbor_test_key");
+    if (!k || hex_decode(field(k, end, "secret_key_hex"), sk64, 64) != 64) {
+        fprintf(stderr, "no cbor_test_key in vectors file\n");
+        return -1;
+    }
+
+    const char *from = field(txt, end, "vectors");
+    const char *v;
+    while (from && (v = field(from, end, "name")) != NULL) {
+        const char *next = field(v, end, "name");
+        const char *vend = next ? next : end;
+        char name[64] = {0};
+        sscanf(v, "\"%63[^\"]\"", name);
+
+        static uint8_t buf[BENCH_CAP];
+        uint8_t pk[32];
+        const char *hex = field(v, vend, "cbor_hex");
+        from = v;
+        if (!hex) {
+            skipped++;
+            continue;
+        }
+        const size_t n = hex_decode(hex, buf, sizeof(buf));
+        hex_decode(field(v, vend, "public_key_hex"), pk, 32);
+
+        const int rc = myco_envelope_verify(buf, n, pk, NULL);
+        const int structure = rc != MYCO_VERIFY_MALFORMED && rc != MYCO_VERIFY_NONCANONICAL &&
+                              rc != MYCO_VERIFY_MISSING;
+        const int hash = structure && rc != MYCO_VERIFY_HASH;
+        const int sig = rc == MYCO_VERIFY_OK;
+        const char *want_err = field(v, vend, "error_prefix");
+        const char *got_err = myco_verify_strerror(rc);
+        int ok = structure == flag(v, vend, "structure_valid") &&
+                 hash == flag(v, vend, "hash_valid") &&
+                 sig == flag(v, vend, "signature_valid");
+        if (want_err && strncmp(want_err + 1, got_err, strlen(got_err)) != 0) ok = 0;
+
+        printf("%-4s %-32s %s\n", ok ? "ok" : "FAIL", name, got_err);
+        if (ok) pass++;
+        else fail++;
+    }
+    printf("vectors: %d pass, %d fail, %d non-CBOR skipped\n", pass, fail, skipped);
+    return fail;
+}
+
+typedef int (*bench_fn)(const uint8_t *buf, size_t len, const uint8_t pk[32]);
+
+static int do_parse(const uint8_t *buf, size_t len, const uint8_t pk[32]) {
+    (void)pk;
+    myco_envelope_view_t v;
+    return myco_envelope_parse(buf, len, &v);
+}
+
+static int do_verify(const uint8_t *buf, size_t len, const uint8_t pk[32]) {
+    return myco_envelope_verify(buf, len, pk, NULL);
+}
+
+static myco_root_cache_t root_cache;
+
+static int do_verify_cached(const uint8_t *buf, size_t len, const uint8_t pk[32]) {
+    return myco_envelope_verify_cached(buf, len, pk, &root_cache, NULL);
+}
+
+static void bench(const char *label, bench_fn fn, uint8_t (*bufs)[BENCH_CAP],
+                  const size_t *lens, const uint8_t pk[32]) {
+    size_t done = 0;
+    const double t0 = now_s();
+    double t = t0;
+    while (t - t0 < 1.0) {
+        for (size_t i = 0; i < BENCH_ENVELOPES; i++) {
+            if (fn(bufs[i], lens[i], pk) != MYCO_VERIFY_OK) {
+                printf("%-14s failed on envelope %zu\n", label, i);
+                return;
+            }
+        }
+        done += BENCH_ENVELOPES;
+        t = now_s();
+    }
+    printf("%-14s %10.0f env/s  (%zu bytes avg)\n", label, (double)done / (t - t0),
+           (lens[0] + lens[BENCH_ENVELOPES - 1]) / 2);
+}
+
+// n envelopes (cycling through the signed set) verified one by one, then with
+// myco_envelope_verify_batch(); reports microseconds per envelope for each.
+#define BENCH_BATCH_MAX 256
+
+static void bench_batch(uint8_t (*bufs)[BENCH_CAP], const size_t *lens, const uint8_t pk[32]) {
+    static myco_ed25519_batch_t work;
+    const uint8_t *b[BENCH_BATCH_MAX], *pks[BENCH_BATCH_MAX];
+    size_t l[BENCH_BATCH_MAX];
+    int rcs[BENCH_BATCH_MAX];
+    for (size_t i = 0; i < BENCH_BATCH_MAX; i++) {
+        b[i] = bufs[i % BENCH_ENVELOPES];
+        l[i] = lens[i % BENCH_ENVELOPES];
+        pks[i] = pk;
+    }
+
+    printf("%-6s %12s %12s %8s\n", "batch", "single us", "batch us", "speedup");
+    for (size_t n = 1; n <= BENCH_BATCH_MAX; n *= 2) {
+        double us[2];
+        for (int mode = 0; mode < 2; mode++) {
+            size_t done = 0;
+            const double t0 = now_s();
+            double t = t0;
+            while (t - t0 < 0.5) {
+                size_t good = 0;
+                if (mode == 0) {
+                    for (size_t i = 0; i < n; i++) good += myco_envelope_verify(b[i], l[i], pk, NULL) == MYCO_VERIFY_OK;
+                } else {
+                    good = myco_envelope_verify_batch(&work, b, l, pks, n, rcs);
+                }
+                if (good != n) {
+                    printf("batch of %zu: %zu of %zu verified\n", n, good, n);
+                    return;
+                }
+                done += n;
+                t = now_s();
+            }
+            us[mode] = (t - t0) * 1e6 / (double)done;
+        }
+        printf("%-6zu %12.1f %12.1f %7.2fx\n", n, us[0], us[1], us[0] / us[1]);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <test-vectors.json> [readings per envelope]\n", argv[0]);
+        return 2;
+    }
+    const size_t n_readings = argc > 2 ? (size_t)atoi(argv[2]) : 8;
+
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 2;
+    }
+    fseek(f, 0, SEEK_END);
+    const long flen = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *txt = (char *)malloc((size_t)flen + 1);
+    if (!txt || fread(txt, 1, (size_t)flen, f) != (size_t)flen) return 2;
+    txt[flen] = 0;
+    fclose(f);
+
+    uint8_t sk64[64];
+    const int failed = check_vectors(txt, (size_t)flen, sk64);
+    free(txt);
+    if (failed < 0) return 2;
+    const uint8_t *pk = sk64 + 32;
+
+    // Throughput on envelopes of n_readings readings, signed singly and in
+    // batches of MYCO_BATCH_MAX.
+    static uint8_t single[BENCH_ENVELOPES][BENCH_CAP], batch[BENCH_ENVELOPES][BENCH_CAP];
+    size_t single_len[BENCH_ENVELOPES], batch_len[BENCH_ENVELOPES];
+    static myco_reading_t rs[BENCH_ENVELOPES][64];
+    uint8_t ids[BENCH_ENVELOPES][16];
+    myco_envelope_fields_t fs[BENCH_ENVELOPES];
+    const size_t nr = n_readings > 64 ? 64 : n_readings;
+    for (size_t i = 0; i < BENCH_ENVELOPES; i++) {
+        for (size_t j = 0; j < nr; j++) {
+            rs[i][j] = (myco_reading_t){ .sid = (uint16_t)j, .vi = (int32_t)(i * 131 + j * 7),
+                                         .vs = 2, .unit = 1, .quality = 0 };
+        }
+        memset(ids[i], (int)i, 16);
+        fs[i] = (myco_envelope_fields_t){ "myco-gw-bench", MYCO_PROTO_MQTT, ids[i],
+                                          1770624000000LL + (int64_t)i * 100, (uint32_t)i,
+                                          (uint64_t)i * 100, NULL, rs[i], nr, NULL, 0 };
+        if (myco_build_envelope_cbor(single[i], BENCH_CAP, &single_len[i], fs[i].device_id,
+                                     fs[i].proto, fs[i].msg_id_16, fs[i].epoch_ms, fs[i].seq,
+                                     fs[i].mono_ms, NULL, rs[i], nr, sk64)) {
+            fprintf(stderr, "build failed\n");
+            return 2;
+        }
+    }
+    for (size_t i = 0; i < BENCH_ENVELOPES; i += MYCO_BATCH_MAX) {
+        uint8_t *outs[MYCO_BATCH_MAX];
+        const size_t n = BENCH_ENVELOPES - i < MYCO_BATCH_MAX ? BENCH_ENVELOPES - i : MYCO_BATCH_MAX;
+        for (size_t j = 0; j < n; j++) outs[j] = batch[i + j];
+        if (myco_build_envelope_batch_cbor(outs, BENCH_CAP, &batch_len[i], &fs[i], n, sk64)) {
+            fprintf(stderr, "batch build failed\n");
+            return 2;
+        }
+    }
+
+    printf("%zu readings per envelope\n", nr);
+    bench("parse", do_parse, single, single_len, pk);
+    bench("verify", do_verify, single, single_len, pk);
+    bench("verify batch", do_verify, batch, batch_len, pk);
+    bench("batch + cache", do_verify_cached, batch, batch_len, pk);
+    bench_batch(single, single_len, pk);
+    return failed ? 1 : 0;
+}
@@ -3,7 +3,8 @@
 #include <string.h>
 
 // --- CRYPTO HOOKS (Monocypher example) ---
-// Uncomment if you integrate Monocypher.
+// Uncomment if you integrate Monocypher (or link myco_crypto_monocypher.c
+// instead of the stubs below).
 //
 // #include "monocypher.h"
 // #include "optional/monocypher-ed25519.h"
@@ -11,12 +12,30 @@
 // void myco_hash256(uint8_t out32[32], const uint8_t *msg, size_t msg_len) {
 //     crypto_blake2b(out32, 32, msg, msg_len);
 // }
+// void myco_hash256_init(myco_hash256_ctx_t *ctx) {
+//     crypto_blake2b_init((crypto_blake2b_ctx *)ctx, 32);
+// }
+// void myco_hash256_update(myco_hash256_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+//     crypto_blake2b_update((crypto_blake2b_ctx *)ctx, msg, msg_len);
+// }
+// void myco_hash256_final(myco_hash256_ctx_t *ctx, uint8_t out32[32]) {
+//     crypto_blake2b_final((crypto_blake2b_ctx *)ctx, out32);
+// }
 // void myco_ed25519_sign(uint8_t sig64[64], const uint8_t sk64[64], const uint8_t *msg, size_t msg_len) {
 //     crypto_ed25519_sign(sig64, sk64, msg, msg_len);
 // }
 // int myco_ed25519_verify(const uint8_t pk32[32], const uint8_t *msg, size_t msg_len, const uint8_t sig64[64]) {
 //     return crypto_ed25519_check(sig64, pk32, msg, msg_len) == 0 ? 1 : 0;
 // }
+// void myco_sha512_init(myco_sha512_ctx_t *ctx) {
+//     crypto_sha512_init((crypto_sha512_ctx *)ctx);
+// }
+// void myco_sha512_update(myco_sha512_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+//     crypto_sha512_update((crypto_sha512_ctx *)ctx, msg, msg_len);
+// }
+// void myco_sha512_final(myco_sha512_ctx_t *ctx, uint8_t out64[64]) {
+//     crypto_sha512_final((crypto_sha512_ctx *)ctx, out64);
+// }
 
 // Dummy stubs so this compiles as-is.
 // Replace with real crypto.
@@ -24,6 +43,16 @@ void myco_hash256(uint8_t out32[32], const uint8_t *msg, size_t msg_len) {
     (void)msg; (void)msg_len;
     memset(out32, 0xAA, 32);
 }
+void myco_hash256_init(myco_hash256_ctx_t *ctx) {
+    (void)ctx;
+}
+void myco_hash256_update(myco_hash256_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+    (void)ctx; (void)msg; (void)msg_len;
+}
+void myco_hash256_final(myco_hash256_ctx_t *ctx, uint8_t out32[32]) {
+    (void)ctx;
+    memset(out32, 0xAA, 32);
+}
 void myco_ed25519_sign(uint8_t sig64[64], const uint8_t sk64[64], const uint8_t *msg, size_t msg_len) {
     (void)sk64; (void)msg; (void)msg_len;
     memset(sig64, 0xBB, 64);
@@ -32,6 +61,17 @@ int myco_ed25519_verify(const uint8_t pk32[32], const uint8_t *msg, size_t msg_l
     (void)pk32; (void)msg; (void)msg_len; (void)sig64;
     return 1;
 }
+// Only myco_ed25519_batch.c calls these.
+void myco_sha512_init(myco_sha512_ctx_t *ctx) {
+    (void)ctx;
+}
+void myco_sha512_update(myco_sha512_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+    (void)ctx; (void)msg; (void)msg_len;
+}
+void myco_sha512_final(myco_sha512_ctx_t *ctx, uint8_t out64[64]) {
+    (void)ctx;
+    memset(out64, 0xCC, 64);
+}
 
 int main(void) {
     uint8_t msg_id[16] = {0};
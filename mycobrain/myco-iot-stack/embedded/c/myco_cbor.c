@@ -3,6 +3,10 @@
 
 static int put_u8(myco_cbor_t *w, uint8_t v) {
     if (w->err) return w->err;
+    if (!w->buf) {
+        w->len += 1;
+        return 0;
+    }
     if (w->len + 1 > w->cap) return (w->err = -1);
     w->buf[w->len++] = v;
     return 0;
@@ -10,6 +14,10 @@ static int put_u8(myco_cbor_t *w, uint8_t v) {
 
 static int put_bytes(myco_cbor_t *w, const uint8_t *p, size_t n) {
     if (w->err) return w->err;
+    if (!w->buf) {
+        w->len += n;
+        return 0;
+    }
     if (w->len + n > w->cap) return (w->err = -1);
     memcpy(w->buf + w->len, p, n);
     w->len += n;
@@ -55,6 +63,20 @@ void myco_cbor_init(myco_cbor_t *w, uint8_t *buf, size_t cap) {
     w->cap = cap;
     w->len = 0;
     w->err = 0;
+    w->tap = NULL;
+    w->tap_ctx = NULL;
+    w->tapped = 0;
+}
+
+void myco_cbor_set_tap(myco_cbor_t *w, myco_cbor_tap_fn fn, void *ctx) {
+    w->tap = fn;
+    w->tap_ctx = ctx;
+    w->tapped = w->len;
+}
+
+void myco_cbor_flush_tap(myco_cbor_t *w) {
+    if (w->tap && w->len > w->tapped) w->tap(w->tap_ctx, w->buf + w->tapped, w->len - w->tapped);
+    w->tapped = w->len;
 }
 
 int myco_cbor_put_uint(myco_cbor_t *w, uint64_t v) { return put_type_val(w, 0, v); }
@@ -79,5 +101,164 @@ int myco_cbor_put_tstr(myco_cbor_t *w, const char *s) {
     return put_bytes(w, (const uint8_t*)s, n);
 }
 
+uint8_t *myco_cbor_put_bstr_space(myco_cbor_t *w, size_t n) {
+    if (put_type_val(w, 2, n)) return NULL;
+    if (!w->buf) {
+        w->len += n;
+        return NULL;
+    }
+    if (w->len + n > w->cap) {
+        w->err = -1;
+        return NULL;
+    }
+    uint8_t *p = w->buf + w->len;
+    w->len += n;
+    return p;
+}
+
 int myco_cbor_put_array(myco_cbor_t *w, size_t n) { return put_type_val(w, 4, n); }
 int myco_cbor_put_map(myco_cbor_t *w, size_t n) { return put_type_val(w, 5, n); }
+int myco_cbor_put_tag(myco_cbor_t *w, uint64_t tag) { return put_type_val(w, 6, tag); }
+
+// ---- Reader ----
+
+void myco_cbor_reader_init(myco_cbor_reader_t *r, const uint8_t *buf, size_t len) {
+    r->buf = buf;
+    r->len = len;
+    r->pos = 0;
+    r->err = 0;
+}
+
+static int read_head(myco_cbor_reader_t *r, myco_cbor_item_t *it, size_t *next) {
+    if (r->err) return r->err;
+    size_t pos = r->pos;
+    if (pos >= r->len) return (r->err = MYCO_CBOR_ERR_TRUNCATED);
+    const uint8_t ib = r->buf[pos++];
+    const uint8_t major = (uint8_t)(ib >> 5);
+    const uint8_t ai = (uint8_t)(ib & 31);
+    uint64_t val;
+    if (ai < 24) {
+        val = ai;
+    } else if (ai <= 27) {
+        const size_t n = (size_t)1 << (ai - 24);
+        if (r->len - pos < n) return (r->err = MYCO_CBOR_ERR_TRUNCATED);
+        val = 0;
+        for (size_t i = 0; i < n; i++) val = (val << 8) | r->buf[pos + i];
+        pos += n;
+        // Shortest form only (RFC 8949 section 4.2.1).
+        const uint64_t min = n == 1 ? 24 : n == 2 ? 0x100 : n == 4 ? 0x10000 : 0x100000000ull;
+        if (val < min) return (r->err = MYCO_CBOR_ERR_NONCANONICAL);
+    } else if (ai == 31) {
+        return (r->err = MYCO_CBOR_ERR_NONCANONICAL);
+    } else {
+        return (r->err = MYCO_CBOR_ERR_UNSUPPORTED); // reserved 28..30
+    }
+
+    if (major == 7 && (ai > 23 || val < 20 || val > 22)) {
+        return (r->err = MYCO_CBOR_ERR_UNSUPPORTED);
+    }
+
+    it->major = major;
+    it->val = val;
+    it->off = r->pos;
+    it->p = NULL;
+    if (major == 2 || major == 3) {
+        if (val > r->len - pos) return (r->err = MYCO_CBOR_ERR_TRUNCATED);
+        it->p = r->buf + pos;
+        pos += (size_t)val;
+    } else if ((major == 4 || major == 5) && val > r->len - pos) {
+        // Every child takes at least one byte: reject absurd counts up front.
+        return (r->err = MYCO_CBOR_ERR_TRUNCATED);
+    }
+    *next = pos;
+    return 0;
+}
+
+int myco_cbor_read(myco_cbor_reader_t *r, myco_cbor_item_t *it) {
+    size_t next;
+    int rc = read_head(r, it, &next);
+    if (rc) return rc;
+    r->pos = next;
+    return 0;
+}
+
+int myco_cbor_peek(myco_cbor_reader_t *r, myco_cbor_item_t *it) {
+    size_t next;
+    return read_head(r, it, &next);
+}
+
+int myco_cbor_skip(myco_cbor_reader_t *r) {
+    uint64_t pending = 1;
+    while (pending) {
+        myco_cbor_item_t it;
+        int rc = myco_cbor_read(r, &it);
+        if (rc) return rc;
+        pending--;
+        if (it.major == 4) pending += it.val;
+        else if (it.major == 5) pending += 2 * it.val;
+        else if (it.major == 6) pending += 1;
+    }
+    return 0;
+}
+
+static int read_typed(myco_cbor_reader_t *r, uint8_t major, myco_cbor_item_t *it) {
+    int rc = myco_cbor_peek(r, it);
+    if (rc) return rc;
+    if (it->major != major) return (r->err = MYCO_CBOR_ERR_TYPE);
+    return myco_cbor_read(r, it);
+}
+
+int myco_cbor_read_uint(myco_cbor_reader_t *r, uint64_t *v) {
+    myco_cbor_item_t it;
+    int rc = read_typed(r, 0, &it);
+    if (rc) return rc;
+    *v = it.val;
+    return 0;
+}
+
+int myco_cbor_read_int(myco_cbor_reader_t *r, int64_t *v) {
+    myco_cbor_item_t it;
+    int rc = myco_cbor_peek(r, &it);
+    if (rc) return rc;
+    if ((it.major != 0 && it.major != 1) || it.val > (uint64_t)INT64_MAX) {
+        return (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    myco_cbor_read(r, &it);
+    // CBOR negative integer N is encoded as -1 - n
+    *v = it.major == 0 ? (int64_t)it.val : -1 - (int64_t)it.val;
+    return 0;
+}
+
+int myco_cbor_read_bstr(myco_cbor_reader_t *r, const uint8_t **p, size_t *n) {
+    myco_cbor_item_t it;
+    int rc = read_typed(r, 2, &it);
+    if (rc) return rc;
+    *p = it.p;
+    *n = (size_t)it.val;
+    return 0;
+}
+
+int myco_cbor_read_tstr(myco_cbor_reader_t *r, const char **p, size_t *n) {
+    myco_cbor_item_t it;
+    int rc = read_typed(r, 3, &it);
+    if (rc) return rc;
+    *p = (const char *)it.p;
+    *n = (size_t)it.val;
+    return 0;
+}
+
+int myco_cbor_read_array(myco_cbor_reader_t *r, size_t *n) {
+    myco_cbor_item_t it;
+    int rc = read_typed(r, 4, &it);
+    if (rc) return rc;
+    *n = (size_t)it.val;
+    return 0;
+}
+
+int myco_cbor_read_map(myco_cbor_reader_t *r, size_t *n) {
+    myco_cbor_item_t it;
+    int rc = read_typed(r, 5, &it);
+    if (rc) return rc;
+    *n = (size_t)it.val;
+    return 0;
+}
@@ -6,28 +6,102 @@
 extern "C" {
 #endif
 
+// Sees every emitted byte exactly once, in order (e.g. a running hash).
+typedef void (*myco_cbor_tap_fn)(void *ctx, const uint8_t *p, size_t n);
+
 typedef struct {
     uint8_t *buf;
     size_t cap;
     size_t len;
     int err; // 0=ok, <0 error
+    myco_cbor_tap_fn tap; // optional
+    void *tap_ctx;
+    size_t tapped;        // bytes already passed to tap
 } myco_cbor_t;
 
+// With buf == NULL the writer only counts: len grows by what would have been
+// written and cap is ignored. Pointer arguments (string payloads) may then be
+// NULL too.
 void myco_cbor_init(myco_cbor_t *w, uint8_t *buf, size_t cap);
 
+// Bytes are handed to the tap in chunks, on myco_cbor_flush_tap(): call it at
+// natural boundaries (per array element, end of body) so the tap runs on data
+// still in cache, in a few calls rather than one per item.
+void myco_cbor_set_tap(myco_cbor_t *w, myco_cbor_tap_fn fn, void *ctx);
+void myco_cbor_flush_tap(myco_cbor_t *w);
+
 int myco_cbor_put_uint(myco_cbor_t *w, uint64_t v);
 int myco_cbor_put_int(myco_cbor_t *w, int64_t v);
 int myco_cbor_put_bstr(myco_cbor_t *w, const uint8_t *p, size_t n);
 int myco_cbor_put_tstr(myco_cbor_t *w, const char *s);
 
+// Write a bstr head for n bytes and return where its payload goes, so large
+// payloads can be produced in place. NULL (and w->err set) if it doesn't fit;
+// always NULL when counting.
+uint8_t *myco_cbor_put_bstr_space(myco_cbor_t *w, size_t n);
+
 // definite-length containers
 int myco_cbor_put_array(myco_cbor_t *w, size_t n);
 int myco_cbor_put_map(myco_cbor_t *w, size_t n);
 
+// tag head; the tagged item follows
+int myco_cbor_put_tag(myco_cbor_t *w, uint64_t tag);
+
 // utility
 static inline size_t myco_cbor_len(const myco_cbor_t *w) { return w->len; }
 static inline int myco_cbor_err(const myco_cbor_t *w) { return w->err; }
 
+// ---- Reader ----
+//
+// Walks CBOR in place: no allocation, strings come back as spans into the
+// input. Only deterministic encoding is accepted (shortest-form heads,
+// definite lengths), which is what the envelope spec requires and what lets a
+// verifier hash spans of the input instead of re-encoding. Floats and other
+// simple values other than false/true/null are rejected.
+//
+// Errors are sticky like the writer's: once r->err is set every call fails.
+
+#define MYCO_CBOR_ERR_TRUNCATED    -1
+#define MYCO_CBOR_ERR_TYPE         -2   // item is not of the requested type
+#define MYCO_CBOR_ERR_NONCANONICAL -3   // non-shortest head, indefinite length
+#define MYCO_CBOR_ERR_UNSUPPORTED  -4   // float / reserved simple value
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    int err; // 0=ok, <0 error
+} myco_cbor_reader_t;
+
+typedef struct {
+    uint8_t major;       // 0..7
+    uint64_t val;        // int value, string length, item count, tag or simple value
+    const uint8_t *p;    // strings: payload (inside the input)
+    size_t off;          // offset of the item's head in the input
+} myco_cbor_item_t;
+
+void myco_cbor_reader_init(myco_cbor_reader_t *r, const uint8_t *buf, size_t len);
+
+// Read one head. Strings are consumed whole (payload in it->p); arrays, maps
+// and tags leave the reader at their first child.
+int myco_cbor_read(myco_cbor_reader_t *r, myco_cbor_item_t *it);
+
+// Read one head without consuming it.
+int myco_cbor_peek(myco_cbor_reader_t *r, myco_cbor_item_t *it);
+
+// Skip one complete data item, children included.
+int myco_cbor_skip(myco_cbor_reader_t *r);
+
+int myco_cbor_read_uint(myco_cbor_reader_t *r, uint64_t *v);
+int myco_cbor_read_int(myco_cbor_reader_t *r, int64_t *v);
+int myco_cbor_read_bstr(myco_cbor_reader_t *r, const uint8_t **p, size_t *n);
+int myco_cbor_read_tstr(myco_cbor_reader_t *r, const char **p, size_t *n);
+int myco_cbor_read_array(myco_cbor_reader_t *r, size_t *n);
+int myco_cbor_read_map(myco_cbor_reader_t *r, size_t *n);
+
+static inline size_t myco_cbor_pos(const myco_cbor_reader_t *r) { return r->pos; }
+static inline int myco_cbor_reader_err(const myco_cbor_reader_t *r) { return r->err; }
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,47 @@
+// Crypto hooks (myco_envelope.h) bound to Monocypher 4.x.
+// Add monocypher.c and optional/monocypher-ed25519.c to the build.
+#include "myco_envelope.h"
+#include "monocypher.h"
+#include "optional/monocypher-ed25519.h"
+
+// myco_hash256_ctx_t is opaque storage for crypto_blake2b_ctx.
+typedef char myco_hash_ctx_fits[sizeof(crypto_blake2b_ctx) <= sizeof(myco_hash256_ctx_t) ? 1 : -1];
+
+void myco_hash256(uint8_t out32[32], const uint8_t *msg, size_t msg_len) {
+    crypto_blake2b(out32, 32, msg, msg_len);
+}
+
+void myco_hash256_init(myco_hash256_ctx_t *ctx) {
+    crypto_blake2b_init((crypto_blake2b_ctx *)ctx, 32);
+}
+
+void myco_hash256_update(myco_hash256_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+    crypto_blake2b_update((crypto_blake2b_ctx *)ctx, msg, msg_len);
+}
+
+void myco_hash256_final(myco_hash256_ctx_t *ctx, uint8_t out32[32]) {
+    crypto_blake2b_final((crypto_blake2b_ctx *)ctx, out32);
+}
+
+void myco_ed25519_sign(uint8_t sig64[64], const uint8_t sk64[64], const uint8_t *msg, size_t msg_len) {
+    crypto_ed25519_sign(sig64, sk64, msg, msg_len);
+}
+
+int myco_ed25519_verify(const uint8_t pk32[32], const uint8_t *msg, size_t msg_len, const uint8_t sig64[64]) {
+    return crypto_ed25519_check(sig64, pk32, msg, msg_len) == 0 ? 1 : 0;
+}
+
+// myco_sha512_ctx_t is opaque storage for crypto_sha512_ctx.
+typedef char myco_sha512_ctx_fits[sizeof(crypto_sha512_ctx) <= sizeof(myco_sha512_ctx_t) ? 1 : -1];
+
+void myco_sha512_init(myco_sha512_ctx_t *ctx) {
+    crypto_sha512_init((crypto_sha512_ctx *)ctx);
+}
+
+void myco_sha512_update(myco_sha512_ctx_t *ctx, const uint8_t *msg, size_t msg_len) {
+    crypto_sha512_update((crypto_sha512_ctx *)ctx, msg, msg_len);
+}
+
+void myco_sha512_final(myco_sha512_ctx_t *ctx, uint8_t out64[64]) {
+    crypto_sha512_final((crypto_sha512_ctx *)ctx, out64);
+}
@@ -0,0 +1,761 @@
+// Batch Ed25519 verification for gateways (see myco_envelope.h).
+//
+// Portable C99: field elements use the ref10 layout (10 signed limbs of
+// 26/25 bits, 64-bit products), points use extended twisted Edwards
+// coordinates. Everything here is variable time, which is fine for
+// verification: signatures and public keys are public.
+#include "myco_envelope.h"
+#include <string.h>
+
+typedef int32_t fe[10];
+
+typedef struct { fe X, Y, Z, T; } ge;               // x = X/Z, y = Y/Z, T = XY/Z
+typedef struct { fe YpX, YmX, Z2, T2d; } ge_cached; // Y+X, Y-X, 2Z, 2dT
+typedef struct { fe ypx, ymx, xy2d; } ge_niels;     // affine: y+x, y-x, 2dxy
+
+// ---- Field arithmetic mod p = 2^255 - 19 ----
+
+static const uint8_t D_BYTES[32] = {
+    0xa3, 0x78, 0x59, 0x13, 0xca, 0x4d, 0xeb, 0x75, 0xab, 0xd8, 0x41, 0x41, 0x4d, 0x0a, 0x70, 0x00,
+    0x98, 0xe8, 0x79, 0x77, 0x79, 0x40, 0xc7, 0x8c, 0x73, 0xfe, 0x6f, 0x2b, 0xee, 0x6c, 0x03, 0x52
+};
+static const uint8_t SQRTM1_BYTES[32] = {
+    0xb0, 0xa0, 0x0e, 0x4a, 0x27, 0x1b, 0xee, 0xc4, 0x78, 0xe4, 0x2f, 0xad, 0x06, 0x18, 0x43, 0x2f,
+    0xa7, 0xd7, 0xfb, 0x3d, 0x99, 0x00, 0x4d, 0x2b, 0x0b, 0xdf, 0xc1, 0x4f, 0x80, 0x24, 0x83, 0x2b
+};
+static const uint8_t B_BYTES[32] = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+#define LIMB_BITS(i) (((i) & 1) ? 25 : 26)
+
+static void fe_0(fe h) { memset(h, 0, sizeof(fe)); }
+static void fe_1(fe h) { fe_0(h); h[0] = 1; }
+
+// Bring every limb back to its nominal width with rounding carries, so limbs
+// end up within +-2^25 (even) / +-2^24 (odd). t is the unreduced result.
+#define CARRY(i, s) do { \
+        const int64_t c = (t[i] + ((int64_t)1 << ((s) - 1))) >> (s); \
+        t[i] -= c * ((int64_t)1 << (s)); \
+        t[(i) + 1] += c; \
+    } while (0)
+
+static void fe_carry_wide(fe h, int64_t t[10]) {
+    CARRY(0, 26); CARRY(1, 25); CARRY(2, 26); CARRY(3, 25); CARRY(4, 26);
+    CARRY(5, 25); CARRY(6, 26); CARRY(7, 25); CARRY(8, 26);
+    const int64_t c = (t[9] + ((int64_t)1 << 24)) >> 25;
+    t[9] -= c * ((int64_t)1 << 25);
+    t[0] += 19 * c;
+    CARRY(0, 26);
+    for (int i = 0; i < 10; i++) h[i] = (int32_t)t[i];
+}
+
+static void fe_carry(fe h) {
+    int64_t t[10];
+    for (int i = 0; i < 10; i++) t[i] = h[i];
+    fe_carry_wide(h, t);
+}
+
+// add/sub/neg do not carry: sums of up to three carried elements (|limb| <=
+// 2^27) are still safe inputs to fe_mul / fe_sq, whose 64-bit accumulators
+// stay below 2^63 for that bound. The point formulas below never go further.
+static void fe_add(fe h, const fe f, const fe g) {
+    for (int i = 0; i < 10; i++) h[i] = f[i] + g[i];
+}
+
+static void fe_sub(fe h, const fe f, const fe g) {
+    for (int i = 0; i < 10; i++) h[i] = f[i] - g[i];
+}
+
+static void fe_neg(fe h, const fe f) {
+    for (int i = 0; i < 10; i++) h[i] = -f[i];
+}
+
+// Limb i sits at bit ceil(25.5 i): a product of two odd limbs lands half a
+// bit high (x2), and anything past 2^255 folds back as x19 (ref10).
+static void fe_mul(fe h, const fe f, const fe g) {
+    const int64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    const int64_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+    const int64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+    const int64_t g5 = g[5], g6 = g[6], g7 = g[7], g8 = g[8], g9 = g[9];
+    const int64_t f1_2 = 2 * f1, f3_2 = 2 * f3, f5_2 = 2 * f5, f7_2 = 2 * f7, f9_2 = 2 * f9;
+    const int64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3, g4_19 = 19 * g4;
+    const int64_t g5_19 = 19 * g5, g6_19 = 19 * g6, g7_19 = 19 * g7, g8_19 = 19 * g8;
+    const int64_t g9_19 = 19 * g9;
+    int64_t t[10];
+    t[0] = f0 * g0 + f1_2 * g9_19 + f2 * g8_19 + f3_2 * g7_19 + f4 * g6_19 + f5_2 * g5_19 + f6 * g4_19 + f7_2 * g3_19 + f8 * g2_19 + f9_2 * g1_19;
+    t[1] = f0 * g1 + f1 * g0 + f2 * g9_19 + f3 * g8_19 + f4 * g7_19 + f5 * g6_19 + f6 * g5_19 + f7 * g4_19 + f8 * g3_19 + f9 * g2_19;
+    t[2] = f0 * g2 + f1_2 * g1 + f2 * g0 + f3_2 * g9_19 + f4 * g8_19 + f5_2 * g7_19 + f6 * g6_19 + f7_2 * g5_19 + f8 * g4_19 + f9_2 * g3_19;
+    t[3] = f0 * g3 + f1 * g2 + f2 * g1 + f3 * g0 + f4 * g9_19 + f5 * g8_19 + f6 * g7_19 + f7 * g6_19 + f8 * g5_19 + f9 * g4_19;
+    t[4] = f0 * g4 + f1_2 * g3 + f2 * g2 + f3_2 * g1 + f4 * g0 + f5_2 * g9_19 + f6 * g8_19 + f7_2 * g7_19 + f8 * g6_19 + f9_2 * g5_19;
+    t[5] = f0 * g5 + f1 * g4 + f2 * g3 + f3 * g2 + f4 * g1 + f5 * g0 + f6 * g9_19 + f7 * g8_19 + f8 * g7_19 + f9 * g6_19;
+    t[6] = f0 * g6 + f1_2 * g5 + f2 * g4 + f3_2 * g3 + f4 * g2 + f5_2 * g1 + f6 * g0 + f7_2 * g9_19 + f8 * g8_19 + f9_2 * g7_19;
+    t[7] = f0 * g7 + f1 * g6 + f2 * g5 + f3 * g4 + f4 * g3 + f5 * g2 + f6 * g1 + f7 * g0 + f8 * g9_19 + f9 * g8_19;
+    t[8] = f0 * g8 + f1_2 * g7 + f2 * g6 + f3_2 * g5 + f4 * g4 + f5_2 * g3 + f6 * g2 + f7_2 * g1 + f8 * g0 + f9_2 * g9_19;
+    t[9] = f0 * g9 + f1 * g8 + f2 * g7 + f3 * g6 + f4 * g5 + f5 * g4 + f6 * g3 + f7 * g2 + f8 * g1 + f9 * g0;
+    fe_carry_wide(h, t);
+}
+
+static void fe_sq(fe h, const fe f) {
+    const int64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    const int64_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+    const int64_t f0_2 = 2 * f0, f1_2 = 2 * f1, f2_2 = 2 * f2, f3_2 = 2 * f3;
+    const int64_t f4_2 = 2 * f4, f5_2 = 2 * f5, f6_2 = 2 * f6, f7_2 = 2 * f7;
+    const int64_t f5_38 = 38 * f5, f6_19 = 19 * f6, f7_38 = 38 * f7;
+    const int64_t f8_19 = 19 * f8, f9_38 = 38 * f9;
+    int64_t t[10];
+    t[0] = f0 * f0 + f1_2 * f9_38 + f2_2 * f8_19 + f3_2 * f7_38 + f4_2 * f6_19 + f5 * f5_38;
+    t[1] = f0_2 * f1 + f2 * f9_38 + f3_2 * f8_19 + f4 * f7_38 + f5_2 * f6_19;
+    t[2] = f0_2 * f2 + f1_2 * f1 + f3_2 * f9_38 + f4_2 * f8_19 + f5_2 * f7_38 + f6 * f6_19;
+    t[3] = f0_2 * f3 + f1_2 * f2 + f4 * f9_38 + f5_2 * f8_19 + f6 * f7_38;
+    t[4] = f0_2 * f4 + f1_2 * f3_2 + f2 * f2 + f5_2 * f9_38 + f6_2 * f8_19 + f7 * f7_38;
+    t[5] = f0_2 * f5 + f1_2 * f4 + f2_2 * f3 + f6 * f9_38 + f7_2 * f8_19;
+    t[6] = f0_2 * f6 + f1_2 * f5_2 + f2_2 * f4 + f3_2 * f3 + f7_2 * f9_38 + f8 * f8_19;
+    t[7] = f0_2 * f7 + f1_2 * f6 + f2_2 * f5 + f3_2 * f4 + f8 * f9_38;
+    t[8] = f0_2 * f8 + f1_2 * f7_2 + f2_2 * f6 + f3_2 * f5_2 + f4 * f4 + f9 * f9_38;
+    t[9] = f0_2 * f9 + f1_2 * f8 + f2_2 * f7 + f3_2 * f6 + f4_2 * f5;
+    fe_carry_wide(h, t);
+}
+
+static void fe_sq_n(fe h, const fe f, int n) {
+    fe_sq(h, f);
+    for (int i = 1; i < n; i++) fe_sq(h, h);
+}
+
+// Bit 255 is ignored; values >= p are accepted here (see ge_decode).
+static void fe_frombytes(fe h, const uint8_t s[32]) {
+    uint64_t acc = 0;
+    int bits = 0;
+    size_t o = 0;
+    for (int i = 0; i < 10; i++) {
+        const int w = LIMB_BITS(i);
+        while (bits < w) {
+            acc |= (uint64_t)s[o++] << bits;
+            bits += 8;
+        }
+        h[i] = (int32_t)(acc & (((uint64_t)1 << w) - 1));
+        acc >>= w;
+        bits -= w;
+    }
+}
+
+// Canonical encoding (fully reduced mod p).
+static void fe_tobytes(uint8_t s[32], const fe f) {
+    int32_t h[10];
+    memcpy(h, f, sizeof(h));
+    fe_carry(h);
+    // q = 1 if h >= p, else 0.
+    int32_t q = (19 * h[9] + ((int32_t)1 << 24)) >> 25;
+    for (int i = 0; i < 10; i++) q = (h[i] + q) >> LIMB_BITS(i);
+    h[0] += 19 * q;
+    for (int i = 0; i < 9; i++) {
+        const int32_t c = h[i] >> LIMB_BITS(i);
+        h[i + 1] += c;
+        h[i] -= c * ((int32_t)1 << LIMB_BITS(i));
+    }
+    h[9] &= ((int32_t)1 << 25) - 1;
+
+    uint64_t acc = 0;
+    int bits = 0;
+    size_t o = 0;
+    for (int i = 0; i < 10; i++) {
+        acc |= (uint64_t)(uint32_t)h[i] << bits;
+        bits += LIMB_BITS(i);
+        while (bits >= 8) {
+            s[o++] = (uint8_t)acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    s[o] = (uint8_t)acc;
+}
+
+static int fe_iszero(const fe f) {
+    uint8_t s[32];
+    fe_tobytes(s, f);
+    uint8_t acc = 0;
+    for (int i = 0; i < 32; i++) acc |= s[i];
+    return acc == 0;
+}
+
+static int fe_isnegative(const fe f) {
+    uint8_t s[32];
+    fe_tobytes(s, f);
+    return s[0] & 1;
+}
+
+static int fe_eq(const fe f, const fe g) {
+    fe d;
+    fe_sub(d, f, g);
+    return fe_iszero(d);
+}
+
+// z^(2^250 - 1) and z^11: the shared prefix of the inversion and square
+// root addition chains (ref10).
+static void fe_pow_prefix(fe out, fe z11, const fe z) {
+    fe t0, t1, t2;
+    fe_sq(t0, z);                    // 2
+    fe_sq_n(t1, t0, 2);              // 8
+    fe_mul(t1, z, t1);               // 9
+    fe_mul(z11, t0, t1);             // 11
+    fe_sq(t0, z11);                  // 22
+    fe_mul(t1, t1, t0);              // 2^5 - 1
+    fe_sq_n(t0, t1, 5);
+    fe_mul(t1, t0, t1);              // 2^10 - 1
+    fe_sq_n(t0, t1, 10);
+    fe_mul(t0, t0, t1);              // 2^20 - 1
+    fe_sq_n(t2, t0, 20);
+    fe_mul(t0, t2, t0);              // 2^40 - 1
+    fe_sq_n(t0, t0, 10);
+    fe_mul(t1, t0, t1);              // 2^50 - 1
+    fe_sq_n(t0, t1, 50);
+    fe_mul(t0, t0, t1);              // 2^100 - 1
+    fe_sq_n(t2, t0, 100);
+    fe_mul(t0, t2, t0);              // 2^200 - 1
+    fe_sq_n(t0, t0, 50);
+    fe_mul(out, t0, t1);             // 2^250 - 1
+}
+
+// z^(2^252 - 3) = z^((p - 5) / 8)
+static void fe_pow22523(fe out, const fe z) {
+    fe t, z11;
+    fe_pow_prefix(t, z11, z);
+    fe_sq_n(t, t, 2);
+    fe_mul(out, t, z);
+}
+
+// ---- Group ----
+
+typedef struct {
+    fe d, d2, sqrtm1;
+} curve_consts;
+
+static void curve_init(curve_consts *k) {
+    fe_frombytes(k->d, D_BYTES);
+    fe_add(k->d2, k->d, k->d);
+    fe_frombytes(k->sqrtm1, SQRTM1_BYTES);
+}
+
+static void ge_identity(ge *p) {
+    fe_0(p->X);
+    fe_1(p->Y);
+    fe_1(p->Z);
+    fe_0(p->T);
+}
+
+// RFC 8032 5.1.3. Returns 1 ok, 0 not a point, -1 non-canonical y (left to
+// the single verifier, which decides those by its own rules).
+static int ge_decode(ge *p, const uint8_t s[32], const curve_consts *k) {
+    fe u, v, v3, vxx, check;
+    fe_frombytes(p->Y, s);
+    uint8_t canon[32];
+    fe_tobytes(canon, p->Y);
+    canon[31] |= (uint8_t)(s[31] & 0x80);
+    if (memcmp(canon, s, 32) != 0) return -1;
+
+    fe_1(p->Z);
+    fe_sq(u, p->Y);
+    fe_mul(v, u, k->d);
+    fe_sub(u, u, p->Z);              // u = y^2 - 1
+    fe_add(v, v, p->Z);              // v = d y^2 + 1
+
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v);               // v^3
+    fe_sq(p->X, v3);
+    fe_mul(p->X, p->X, v);
+    fe_mul(p->X, p->X, u);           // u v^7
+    fe_pow22523(p->X, p->X);
+    fe_mul(p->X, p->X, v3);
+    fe_mul(p->X, p->X, u);           // x = u v^3 (u v^7)^((p-5)/8)
+
+    fe_sq(vxx, p->X);
+    fe_mul(vxx, vxx, v);
+    if (!fe_eq(vxx, u)) {
+        fe_add(check, vxx, u);
+        if (!fe_iszero(check)) return 0;
+        fe_mul(p->X, p->X, k->sqrtm1);
+    }
+    const int sign = s[31] >> 7;
+    if (fe_iszero(p->X) && sign) return 0;
+    if (fe_isnegative(p->X) != sign) fe_neg(p->X, p->X);
+    fe_mul(p->T, p->X, p->Y);
+    return 1;
+}
+
+static void ge_to_cached(ge_cached *c, const ge *p, const curve_consts *k) {
+    fe_add(c->YpX, p->Y, p->X);
+    fe_sub(c->YmX, p->Y, p->X);
+    fe_add(c->Z2, p->Z, p->Z);
+    fe_mul(c->T2d, p->T, k->d2);
+}
+
+// Decoded points are affine (Z = 1), which makes additions of them cheaper.
+static void ge_to_niels(ge_niels *n, const ge *p, const curve_consts *k) {
+    fe_add(n->ypx, p->Y, p->X);
+    fe_carry(n->ypx);
+    fe_sub(n->ymx, p->Y, p->X);
+    fe_carry(n->ymx);
+    fe_mul(n->xy2d, p->T, k->d2);
+}
+
+// add-2008-hwcd-3 (a = -1): r = p + q.
+static void ge_add(ge *r, const ge *p, const ge_cached *q) {
+    fe a, b, c, d, e, f, g, h;
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, q->YmX);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, q->YpX);
+    fe_mul(c, p->T, q->T2d);
+    fe_mul(d, p->Z, q->Z2);
+    fe_sub(e, b, a);
+    fe_add(h, b, a);
+    fe_sub(f, d, c);
+    fe_add(g, d, c);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+// Same with an affine q (Z2 = 1, one multiplication less); neg subtracts q
+// (swap y+x / y-x, negate 2dxy).
+static void ge_madd(ge *r, const ge *p, const ge_niels *q, int neg) {
+    fe a, b, c, d, e, f, g, h;
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, neg ? q->ypx : q->ymx);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, neg ? q->ymx : q->ypx);
+    fe_mul(c, p->T, q->xy2d);
+    fe_add(d, p->Z, p->Z);
+    fe_sub(e, b, a);
+    fe_add(h, b, a);
+    if (neg) {
+        fe_add(f, d, c);
+        fe_sub(g, d, c);
+    } else {
+        fe_sub(f, d, c);
+        fe_add(g, d, c);
+    }
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+// r = +-q in extended coordinates, scaled by 4: (4x, 4y, 4, 4xy).
+static void ge_from_niels(ge *r, const ge_niels *q, int neg) {
+    fe e, h;
+    fe_sub(e, q->ypx, q->ymx);       // 2x
+    if (neg) fe_neg(e, e);
+    fe_add(h, q->ypx, q->ymx);       // 2y
+    fe_add(r->X, e, e);
+    fe_carry(r->X);
+    fe_add(r->Y, h, h);
+    fe_carry(r->Y);
+    fe_0(r->Z);
+    r->Z[0] = 4;
+    fe_mul(r->T, e, h);
+}
+
+// dbl-2008-hwcd (a = -1); T of the input is not used.
+static void ge_dbl(ge *r, const ge *p) {
+    fe a, b, c, e, g, f, h;
+    fe_sq(a, p->X);
+    fe_sq(b, p->Y);
+    fe_sq(c, p->Z);
+    fe_add(c, c, c);
+    fe_add(e, p->X, p->Y);
+    fe_sq(e, e);
+    fe_sub(e, e, a);
+    fe_sub(e, e, b);
+    fe_sub(g, b, a);                 // G = -A + B
+    fe_sub(f, g, c);
+    fe_add(h, a, b);
+    fe_neg(h, h);                    // H = -A - B
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+static int ge_is_identity(const ge *p) {
+    return fe_iszero(p->X) && fe_eq(p->Y, p->Z);
+}
+
+// ---- Scalars mod L = 2^252 + 27742317777372353535851937790883648493 ----
+
+static const int64_t L_LIMBS[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+// Reduce a 64-limb little-endian number (limbs may exceed a byte) mod L
+// (TweetNaCl's modL).
+static void sc_reduce_limbs(uint8_t r[32], int64_t x[64]) {
+    int64_t carry;
+    for (int i = 63; i >= 32; --i) {
+        int j;
+        carry = 0;
+        for (j = i - 32; j < i - 12; ++j) {
+            x[j] += carry - 16 * x[i] * L_LIMBS[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    carry = 0;
+    for (int j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * L_LIMBS[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (int j = 0; j < 32; j++) x[j] -= carry * L_LIMBS[j];
+    for (int i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+static void sc_reduce64(uint8_t r[32], const uint8_t s[64]) {
+    int64_t x[64];
+    for (int i = 0; i < 64; i++) x[i] = s[i];
+    sc_reduce_limbs(r, x);
+}
+
+// r = a * b mod L, a being a_len bytes (<= 32).
+static void sc_mul(uint8_t r[32], const uint8_t *a, size_t a_len, const uint8_t b[32]) {
+    int64_t x[64] = {0};
+    for (size_t i = 0; i < a_len; i++) {
+        for (size_t j = 0; j < 32; j++) x[i + j] += (int64_t)a[i] * b[j];
+    }
+    sc_reduce_limbs(r, x);
+}
+
+// r = a + b mod L, a and b reduced.
+static void sc_add(uint8_t r[32], const uint8_t a[32], const uint8_t b[32]) {
+    uint8_t t[32];
+    int carry = 0, borrow = 0;
+    for (int i = 0; i < 32; i++) {
+        const int v = a[i] + b[i] + carry;
+        r[i] = (uint8_t)v;
+        carry = v >> 8;
+    }
+    // a + b < 2L < 2^254: no carry out; subtract L once if r >= L.
+    for (int i = 0; i < 32; i++) {
+        const int v = r[i] - (int)L_LIMBS[i] - borrow;
+        borrow = v < 0;
+        t[i] = (uint8_t)(v + (borrow ? 256 : 0));
+    }
+    if (!borrow) memcpy(r, t, 32);
+}
+
+// r = -a mod L, a reduced.
+static void sc_neg(uint8_t r[32], const uint8_t a[32]) {
+    uint8_t zero = 0;
+    for (int i = 0; i < 32; i++) zero |= a[i];
+    if (!zero) {
+        memset(r, 0, 32);
+        return;
+    }
+    int borrow = 0;
+    for (int i = 0; i < 32; i++) {
+        const int v = (int)L_LIMBS[i] - a[i] - borrow;
+        borrow = v < 0;
+        r[i] = (uint8_t)(v + (borrow ? 256 : 0));
+    }
+}
+
+static int sc_is_canonical(const uint8_t s[32]) {
+    for (int i = 31; i >= 0; i--) {
+        if (s[i] < L_LIMBS[i]) return 1;
+        if (s[i] > L_LIMBS[i]) return 0;
+    }
+    return 0;
+}
+
+// ---- Multi-scalar multiplication ----
+
+#define MSM_POINTS  (2 * MYCO_ED25519_BATCH_MAX + 1)
+#define MSM_C_MIN   4
+#define MSM_C_MAX   6
+#define MSM_WINDOWS ((256 + MSM_C_MIN - 1) / MSM_C_MIN)
+#define MSM_BUCKETS (1 << (MSM_C_MAX - 1))
+
+typedef struct {
+    ge_niels  pt[MSM_POINTS];        // R_i at 2i, A_i at 2i + 1, B last
+    uint8_t   sc[MSM_POINTS][32];    // z_i, z_i k_i (B's is set per check)
+    uint8_t   zs[MYCO_ED25519_BATCH_MAX][32];   // z_i s_i
+    uint16_t  item[MYCO_ED25519_BATCH_MAX];     // batch slot -> caller index
+    int8_t    dig[MSM_POINTS][MSM_WINDOWS];
+    ge        bucket[MSM_BUCKETS];
+    curve_consts k;
+} batch_work;
+
+typedef char batch_work_fits[sizeof(batch_work) <= sizeof(myco_ed25519_batch_t) ? 1 : -1];
+
+// Signed radix-2^c digits in [-2^(c-1), 2^(c-1)). Scalars are < 2^253, so
+// ceil(256 / c) windows absorb the last carry.
+static void recode(int8_t *dig, const uint8_t s[32], int c) {
+    const int windows = (256 + c - 1) / c;
+    int carry = 0;
+    for (int w = 0; w < windows; w++) {
+        const int bit = w * c;
+        const int byte = bit >> 3;
+        uint32_t raw = s[byte];
+        if (byte + 1 < 32) raw |= (uint32_t)s[byte + 1] << 8;
+        int v = (int)((raw >> (bit & 7)) & ((1u << c) - 1)) + carry;
+        carry = v >= (1 << (c - 1));
+        if (carry) v -= 1 << c;
+        dig[w] = (int8_t)v;
+    }
+}
+
+// Window width minimising windows * (points + buckets).
+static int msm_width(size_t points) {
+    int best = MSM_C_MIN;
+    size_t best_cost = (size_t)-1;
+    for (int c = MSM_C_MIN; c <= MSM_C_MAX; c++) {
+        const size_t cost = (size_t)((256 + c - 1) / c) * (points + ((size_t)1 << (c - 1)));
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// out = sum sc[p] * pt[p] over the listed points (bucket method).
+static void msm(ge *out, batch_work *bw, const uint16_t *pts, size_t n_pts) {
+    const int c = msm_width(n_pts);
+    const int windows = (256 + c - 1) / c;
+    const int n_buckets = 1 << (c - 1);
+    for (size_t i = 0; i < n_pts; i++) recode(bw->dig[pts[i]], bw->sc[pts[i]], c);
+
+    ge_identity(out);
+    int started = 0;
+    for (int w = windows - 1; w >= 0; w--) {
+        if (started) {
+            for (int i = 0; i < c; i++) ge_dbl(out, out);
+        }
+
+        uint64_t used = 0;
+        for (size_t i = 0; i < n_pts; i++) {
+            const int d = bw->dig[pts[i]][w];
+            if (d == 0) continue;
+            const int b = (d > 0 ? d : -d) - 1;
+            if ((used >> b) & 1u) {
+                ge_madd(&bw->bucket[b], &bw->bucket[b], &bw->pt[pts[i]], d < 0);
+            } else {
+                ge_from_niels(&bw->bucket[b], &bw->pt[pts[i]], d < 0);
+                used |= (uint64_t)1 << b;
+            }
+        }
+        if (!used) continue;
+
+        // sum (b + 1) * bucket[b] as a running sum from the top bucket down.
+        ge run, sum;
+        ge_cached tmp;
+        int have_run = 0, have_sum = 0;
+        for (int b = n_buckets - 1; b >= 0; b--) {
+            if ((used >> b) & 1u) {
+                if (have_run) {
+                    ge_to_cached(&tmp, &bw->bucket[b], &bw->k);
+                    ge_add(&run, &run, &tmp);
+                } else {
+                    run = bw->bucket[b];
+                    have_run = 1;
+                }
+            }
+            if (!have_run) continue;
+            if (have_sum) {
+                ge_to_cached(&tmp, &run, &bw->k);
+                ge_add(&sum, &sum, &tmp);
+            } else {
+                sum = run;
+                have_sum = 1;
+            }
+        }
+        ge_to_cached(&tmp, &sum, &bw->k);
+        ge_add(out, out, &tmp);
+        started = 1;
+    }
+}
+
+// Check the batch equation over slots [lo, hi).
+static int batch_check(batch_work *bw, size_t lo, size_t hi) {
+    uint16_t pts[MSM_POINTS];
+    size_t n_pts = 0;
+    uint8_t sum[32] = {0};
+    for (size_t i = lo; i < hi; i++) {
+        pts[n_pts++] = (uint16_t)(2 * i);
+        pts[n_pts++] = (uint16_t)(2 * i + 1);
+        sc_add(sum, sum, bw->zs[i]);
+    }
+    pts[n_pts++] = MSM_POINTS - 1;
+    sc_neg(bw->sc[MSM_POINTS - 1], sum);
+
+    ge q;
+    msm(&q, bw, pts, n_pts);
+    for (int i = 0; i < 3; i++) ge_dbl(&q, &q);
+    return ge_is_identity(&q);
+}
+
+#define BATCH_LEAF 4   // below this, failing groups are checked one by one
+#define BATCH_MIN  8   // smaller chunks do not amortize the decode + MSM setup
+
+typedef struct {
+    const uint8_t *const *pks;
+    const uint8_t *const *msgs;
+    const size_t *msg_lens;
+    const uint8_t *const *sigs;
+    uint8_t *ok;
+} batch_args;
+
+static void verify_single(const batch_args *a, size_t j) {
+    a->ok[j] = (uint8_t)myco_ed25519_verify(a->pks[j], a->msgs[j], a->msg_lens[j], a->sigs[j]);
+}
+
+static void batch_accept(batch_work *bw, const batch_args *a, size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) a->ok[bw->item[i]] = 1;
+}
+
+// Bisect a failing range until the bad signatures are isolated.
+static void batch_locate(batch_work *bw, const batch_args *a, size_t lo, size_t hi) {
+    if (hi - lo <= BATCH_LEAF) {
+        for (size_t i = lo; i < hi; i++) verify_single(a, bw->item[i]);
+        return;
+    }
+    const size_t mid = lo + (hi - lo) / 2;
+    if (batch_check(bw, lo, mid)) batch_accept(bw, a, lo, mid);
+    else batch_locate(bw, a, lo, mid);
+    if (batch_check(bw, mid, hi)) batch_accept(bw, a, mid, hi);
+    else batch_locate(bw, a, mid, hi);
+}
+
+static void verify_chunk(batch_work *bw, const batch_args *a, size_t first, size_t n) {
+    if (n < BATCH_MIN) {
+        for (size_t j = first; j < first + n; j++) verify_single(a, j);
+        return;
+    }
+    // k_i = SHA-512(R || A || M) mod L; anything that cannot enter the batch
+    // is decided here.
+    uint8_t k[MYCO_ED25519_BATCH_MAX][32];
+    size_t m = 0;
+    for (size_t j = first; j < first + n; j++) {
+        const uint8_t *sig = a->sigs[j];
+        ge r, pa;
+        a->ok[j] = 0;
+        if (!sc_is_canonical(sig + 32)) continue;
+        const int rr = ge_decode(&r, sig, &bw->k);
+        const int ra = ge_decode(&pa, a->pks[j], &bw->k);
+        if (rr == 0 || ra == 0) continue;
+        if (rr < 0 || ra < 0) {
+            verify_single(a, j);
+            continue;
+        }
+        ge_to_niels(&bw->pt[2 * m], &r, &bw->k);
+        ge_to_niels(&bw->pt[2 * m + 1], &pa, &bw->k);
+
+        uint8_t hk[64];
+        myco_sha512_ctx_t hc;
+        myco_sha512_init(&hc);
+        myco_sha512_update(&hc, sig, 32);
+        myco_sha512_update(&hc, a->pks[j], 32);
+        myco_sha512_update(&hc, a->msgs[j], a->msg_lens[j]);
+        myco_sha512_final(&hc, hk);
+        sc_reduce64(k[m], hk);
+        bw->item[m++] = (uint16_t)j;
+    }
+    if (m == 0) return;
+    if (m < BATCH_LEAF) {
+        for (size_t i = 0; i < m; i++) verify_single(a, bw->item[i]);
+        return;
+    }
+
+    // z_i: 128-bit coefficients from a hash over the whole batch, so no
+    // signature can be chosen to cancel against the others.
+    uint8_t seed[32];
+    myco_hash256_ctx_t hc;
+    myco_hash256_init(&hc);
+    for (size_t i = 0; i < m; i++) {
+        const size_t j = bw->item[i];
+        myco_hash256_update(&hc, a->pks[j], 32);
+        myco_hash256_update(&hc, a->sigs[j], 64);
+        myco_hash256_update(&hc, k[i], 32);
+    }
+    myco_hash256_final(&hc, seed);
+
+    for (size_t i = 0; i < m; i++) {
+        uint8_t in[32 + 4], z[32];
+        memcpy(in, seed, 32);
+        in[32] = (uint8_t)i;
+        in[33] = (uint8_t)(i >> 8);
+        in[34] = in[35] = 0;
+        myco_hash256(z, in, sizeof(in));
+        z[0] |= 1;                   // never zero
+        memset(bw->sc[2 * i], 0, 32);
+        memcpy(bw->sc[2 * i], z, 16);
+        sc_mul(bw->sc[2 * i + 1], z, 16, k[i]);
+        sc_mul(bw->zs[i], z, 16, a->sigs[bw->item[i]] + 32);
+    }
+
+    if (batch_check(bw, 0, m)) batch_accept(bw, a, 0, m);
+    else batch_locate(bw, a, 0, m);
+}
+
+size_t myco_ed25519_verify_batch(
+    myco_ed25519_batch_t *work,
+    const uint8_t *const pks[], const uint8_t *const msgs[], const size_t msg_lens[],
+    const uint8_t *const sigs[], size_t n, uint8_t ok[]
+) {
+    batch_work *bw = (batch_work *)work;
+    const batch_args a = { pks, msgs, msg_lens, sigs, ok };
+    curve_init(&bw->k);
+    ge b;
+    ge_decode(&b, B_BYTES, &bw->k);
+    ge_to_niels(&bw->pt[MSM_POINTS - 1], &b, &bw->k);
+
+    for (size_t first = 0; first < n; first += MYCO_ED25519_BATCH_MAX) {
+        const size_t chunk = n - first < MYCO_ED25519_BATCH_MAX ? n - first : MYCO_ED25519_BATCH_MAX;
+        verify_chunk(bw, &a, first, chunk);
+    }
+    size_t good = 0;
+    for (size_t i = 0; i < n; i++) good += ok[i];
+    return good;
+}
+
+size_t myco_envelope_verify_batch(
+    myco_ed25519_batch_t *work,
+    const uint8_t *const bufs[], const size_t lens[], const uint8_t *const pks[],
+    size_t n, int rcs[]
+) {
+    uint8_t msg[MYCO_ED25519_BATCH_MAX][MYCO_SIGNED_MSG_MAX];
+    size_t msg_len[MYCO_ED25519_BATCH_MAX];
+    const uint8_t *t_pk[MYCO_ED25519_BATCH_MAX], *t_msg[MYCO_ED25519_BATCH_MAX];
+    const uint8_t *t_sig[MYCO_ED25519_BATCH_MAX];
+    size_t t_env[MYCO_ED25519_BATCH_MAX];
+    uint8_t ok[MYCO_ED25519_BATCH_MAX];
+
+    size_t good = 0;
+    for (size_t first = 0; first < n; first += MYCO_ED25519_BATCH_MAX) {
+        const size_t end = n - first < MYCO_ED25519_BATCH_MAX ? n : first + MYCO_ED25519_BATCH_MAX;
+        size_t m = 0;
+        for (size_t i = first; i < end; i++) {
+            myco_envelope_view_t v;
+            rcs[i] = myco_envelope_prepare(bufs[i], lens[i], &v, msg[m], &msg_len[m]);
+            if (rcs[i]) continue;
+            t_pk[m] = pks[i];
+            t_msg[m] = msg[m];
+            t_sig[m] = v.z;
+            t_env[m++] = i;
+        }
+        myco_ed25519_verify_batch(work, t_pk, t_msg, msg_len, t_sig, m, ok);
+        for (size_t i = 0; i < m; i++) {
+            rcs[t_env[i]] = ok[i] ? MYCO_VERIFY_OK : MYCO_VERIFY_SIGNATURE;
+            good += ok[i];
+        }
+    }
+    return good;
+}
@@ -37,10 +37,74 @@ static void encode_geo(myco_cbor_t *w, const myco_geo_t *geo) {
     myco_cbor_put_uint(w, G_ACC); myco_cbor_put_uint(w, geo->acc_m);
 }
 
-static void encode_readings(myco_cbor_t *w, const myco_reading_t *rs, size_t n) {
-    myco_cbor_put_uint(w, K_R);
-    myco_cbor_put_array(w, n);
+// Block reading keys (spec 2, block readings). A block has no R_VI; that is
+// what tells it apart from a single reading.
+#define B_T0 5
+#define B_DT 6
+#define B_DE 7
+#define B_VA 8
+
+// RFC 8746 typed arrays
+#define TAG_SINT16_LE 77
+#define TAG_SINT32_LE 78
+
+// Bytes per stored value: 2 if every stored value fits int16, else 4, or 0
+// if a difference overflows int32 (delta only).
+static int stored_width(const int32_t *v, size_t n, int delta) {
+    int width = 2;
+    int64_t prev = 0;
     for (size_t i = 0; i < n; i++) {
+        const int64_t s = delta ? (int64_t)v[i] - prev : v[i];
+        if (s < INT32_MIN || s > INT32_MAX) return 0;
+        if (s < INT16_MIN || s > INT16_MAX) width = 4;
+        prev = v[i];
+    }
+    return width;
+}
+
+static void encode_block(myco_cbor_t *w, const myco_block_t *b) {
+    int delta = b->delta != 0;
+    int width = stored_width(b->values, b->n_values, delta);
+    if (width == 0) {
+        delta = 0;
+        width = stored_width(b->values, b->n_values, 0);
+    }
+
+    // map size = 8
+    myco_cbor_put_map(w, 8);
+    myco_cbor_put_uint(w, R_ID); myco_cbor_put_uint(w, b->sid);
+    myco_cbor_put_uint(w, R_VS); myco_cbor_put_uint(w, b->vs);
+    myco_cbor_put_uint(w, R_U);  myco_cbor_put_uint(w, b->unit);
+    myco_cbor_put_uint(w, R_Q);  myco_cbor_put_uint(w, b->quality);
+    myco_cbor_put_uint(w, B_T0); myco_cbor_put_int(w, b->t0_us);
+    myco_cbor_put_uint(w, B_DT); myco_cbor_put_uint(w, b->period_us);
+    myco_cbor_put_uint(w, B_DE); myco_cbor_put_uint(w, (uint64_t)delta);
+    myco_cbor_put_uint(w, B_VA);
+    myco_cbor_put_tag(w, width == 2 ? TAG_SINT16_LE : TAG_SINT32_LE);
+
+    // Values go straight into the output, little-endian.
+    uint8_t *p = myco_cbor_put_bstr_space(w, b->n_values * (size_t)width);
+    if (!p) return;
+    uint32_t prev = 0;
+    for (size_t i = 0; i < b->n_values; i++) {
+        const uint32_t v = (uint32_t)b->values[i];
+        const uint32_t s = delta ? v - prev : v;
+        prev = v;
+        *p++ = (uint8_t)s;
+        *p++ = (uint8_t)(s >> 8);
+        if (width == 4) {
+            *p++ = (uint8_t)(s >> 16);
+            *p++ = (uint8_t)(s >> 24);
+        }
+    }
+    myco_cbor_flush_tap(w);
+}
+
+static void encode_readings(myco_cbor_t *w, const myco_envelope_fields_t *f) {
+    const myco_reading_t *rs = f->readings;
+    myco_cbor_put_uint(w, K_R);
+    myco_cbor_put_array(w, f->n_readings + f->n_blocks);
+    for (size_t i = 0; i < f->n_readings; i++) {
         // map size = 5
         myco_cbor_put_map(w, 5);
         myco_cbor_put_uint(w, R_ID); myco_cbor_put_uint(w, rs[i].sid);
@@ -48,45 +112,116 @@ static void encode_readings(myco_cbor_t *w, const myco_reading_t *rs, size_t n)
         myco_cbor_put_uint(w, R_VS); myco_cbor_put_uint(w, rs[i].vs);
         myco_cbor_put_uint(w, R_U);  myco_cbor_put_uint(w, rs[i].unit);
         myco_cbor_put_uint(w, R_Q);  myco_cbor_put_uint(w, rs[i].quality);
+        myco_cbor_flush_tap(w);
     }
+    for (size_t i = 0; i < f->n_blocks; i++) encode_block(w, &f->blocks[i]);
 }
 
-static int encode_unsigned(
-    uint8_t *buf, size_t cap, size_t *len,
-    const char *device_id, uint8_t proto, const uint8_t msg_id_16[16],
-    int64_t epoch_ms, uint32_t seq, uint64_t mono_ms,
-    const myco_geo_t *geo,
-    const myco_reading_t *readings, size_t n_readings
-) {
-    myco_cbor_t w;
-    myco_cbor_init(&w, buf, cap);
+// Merkle proof keys (inside x, batch mode)
+#define X_MI 0
+#define X_MN 1
+#define X_MP 2
 
-    // map entries:
-    // v,d,p,m,t,s,n,(g?),r,(x?)
-    size_t map_n = 8; // v,d,p,m,t,s,n,r
-    if (geo && geo->has_fix) map_n += 1;
+#if MYCO_BATCH_MAX > (1 << MYCO_BATCH_DEPTH)
+#error "MYCO_BATCH_MAX exceeds MYCO_BATCH_DEPTH"
+#endif
 
-    myco_cbor_put_map(&w, map_n);
+// Unsigned envelope U (spec section 3): map header + v,d,p,m,t,s,n,(g),r.
+static void encode_unsigned(myco_cbor_t *w, size_t map_n, const myco_envelope_fields_t *f) {
+    myco_cbor_put_map(w, map_n);
 
     // keys MUST be added in ascending order for determinism.
 
-    myco_cbor_put_uint(&w, K_V); myco_cbor_put_uint(&w, 1);
-    myco_cbor_put_uint(&w, K_D); myco_cbor_put_tstr(&w, device_id);
-    myco_cbor_put_uint(&w, K_P); myco_cbor_put_uint(&w, proto);
-    myco_cbor_put_uint(&w, K_M); myco_cbor_put_bstr(&w, msg_id_16, 16);
-    myco_cbor_put_uint(&w, K_T); myco_cbor_put_int(&w, epoch_ms);
-    myco_cbor_put_uint(&w, K_S); myco_cbor_put_uint(&w, seq);
-    myco_cbor_put_uint(&w, K_N); myco_cbor_put_uint(&w, mono_ms);
+    myco_cbor_put_uint(w, K_V); myco_cbor_put_uint(w, 1);
+    myco_cbor_put_uint(w, K_D); myco_cbor_put_tstr(w, f->device_id);
+    myco_cbor_put_uint(w, K_P); myco_cbor_put_uint(w, f->proto);
+    myco_cbor_put_uint(w, K_M); myco_cbor_put_bstr(w, f->msg_id_16, 16);
+    myco_cbor_put_uint(w, K_T); myco_cbor_put_int(w, f->epoch_ms);
+    myco_cbor_put_uint(w, K_S); myco_cbor_put_uint(w, f->seq);
+    myco_cbor_put_uint(w, K_N); myco_cbor_put_uint(w, f->mono_ms);
 
-    if (geo && geo->has_fix) {
-        encode_geo(&w, geo);
+    if (f->geo && f->geo->has_fix) {
+        encode_geo(w, f->geo);
     }
 
-    encode_readings(&w, readings, n_readings);
+    encode_readings(w, f);
+}
 
-    if (myco_cbor_err(&w)) return -1;
-    *len = myco_cbor_len(&w);
-    return 0;
+static void hash_tap(void *ctx, const uint8_t *p, size_t n) {
+    myco_hash256_update((myco_hash256_ctx_t *)ctx, p, n);
+}
+
+static size_t u_entries(const myco_envelope_fields_t *f) {
+    size_t map_n = 8; // v,d,p,m,t,s,n,r
+    if (f->geo && f->geo->has_fix) map_n += 1; // g
+    return map_n;
+}
+
+// Encode U once into w, hashing (BLAKE2b-256) each chunk as it is written.
+// Returns U's map entry count, or 0 if the buffer is too small.
+static size_t encode_hashed(myco_cbor_t *w, const myco_envelope_fields_t *f, uint8_t h[32]) {
+    const size_t map_n = u_entries(f);
+
+    myco_hash256_ctx_t hctx;
+    myco_hash256_init(&hctx);
+    myco_cbor_set_tap(w, hash_tap, &hctx);
+    encode_unsigned(w, map_n, f);
+    if (myco_cbor_err(w)) return 0;
+    myco_cbor_flush_tap(w);
+    myco_cbor_set_tap(w, NULL, NULL);
+    myco_hash256_final(&hctx, h);
+    return map_n;
+}
+
+// Batch proof x (spec 3.1): leaf index, leaf count, sibling path.
+static void encode_proof(myco_cbor_t *w, size_t index, size_t count,
+                         const uint8_t *const *sib, size_t n_sib) {
+    myco_cbor_put_uint(w, K_X);
+    myco_cbor_put_map(w, 3);
+    myco_cbor_put_uint(w, X_MI); myco_cbor_put_uint(w, index);
+    myco_cbor_put_uint(w, X_MN); myco_cbor_put_uint(w, count);
+    myco_cbor_put_uint(w, X_MP); myco_cbor_put_array(w, n_sib);
+    for (size_t k = 0; k < n_sib; k++) myco_cbor_put_bstr(w, sib ? sib[k] : NULL, 32);
+}
+
+static void encode_hz(myco_cbor_t *w, const uint8_t h[32], const uint8_t sig[64]) {
+    myco_cbor_put_uint(w, K_H); myco_cbor_put_bstr(w, h, 32);
+    myco_cbor_put_uint(w, K_Z); myco_cbor_put_bstr(w, sig, 64);
+}
+
+// Sibling path length of leaf index in a batch of count.
+static size_t proof_len(size_t index, size_t count) {
+    size_t n = 0;
+    for (size_t width = count; width > 1; width = (width + 1) / 2, index >>= 1) {
+        if ((index ^ 1u) < width) n++;
+    }
+    return n;
+}
+
+// Size pass: the same encoders on a counting writer. Nothing is hashed or
+// signed; h and z only contribute their (fixed) encoded size.
+static size_t signed_size(const myco_envelope_fields_t *f, int batched, size_t index, size_t count) {
+    myco_cbor_t w;
+    myco_cbor_init(&w, NULL, 0);
+    encode_unsigned(&w, u_entries(f), f);
+    if (batched) encode_proof(&w, index, count, NULL, proof_len(index, count));
+    encode_hz(&w, NULL, NULL);
+    return myco_cbor_len(&w);
+}
+
+size_t myco_envelope_size(const myco_envelope_fields_t *f) {
+    return signed_size(f, 0, 0, 1);
+}
+
+size_t myco_envelope_batch_size(const myco_envelope_fields_t *f, size_t index, size_t count) {
+    return signed_size(f, 1, index, count);
+}
+
+// Turn U into the signed envelope by patching the map header to count the
+// entries appended after r. Every appended key (9..11) sorts after every key
+// in U, and the count stays <= 23, so the header is one byte either way.
+static void patch_map_header(uint8_t *buf, size_t map_n) {
+    buf[0] = (uint8_t)((5u << 5) | map_n);
 }
 
 int myco_build_envelope_cbor(
@@ -102,24 +237,29 @@ int myco_build_envelope_cbor(
     size_t n_readings,
     const uint8_t sk64[64]
 ) {
-    // 1) Encode unsigned envelope into temp buffer
-    //    (worst-case: use out_cap, but a temp buffer is safer for partial builds).
-    if (out_cap < 128) return -2;
-
-    // For simplicity in embedded, we reuse out_buf as temp.
-    // If you need to keep out_buf clean, allocate a separate temp buffer.
-    size_t unsigned_len = 0;
-    int rc = encode_unsigned(out_buf, out_cap, &unsigned_len,
-                             device_id, proto, msg_id_16,
-                             epoch_ms, seq, mono_ms,
-                             geo, readings, n_readings);
-    if (rc) return rc;
+    const myco_envelope_fields_t f = {
+        device_id, proto, msg_id_16, epoch_ms, seq, mono_ms, geo, readings, n_readings, NULL, 0
+    };
+    return myco_build_envelope_fields_cbor(out_buf, out_cap, out_len, &f, sk64);
+}
 
-    // 2) Hash unsigned bytes (BLAKE2b-256)
+int myco_build_envelope_fields_cbor(
+    uint8_t *out_buf, size_t out_cap, size_t *out_len,
+    const myco_envelope_fields_t *f,
+    const uint8_t sk64[64]
+) {
+    // 1) Encode the unsigned envelope once, straight into out_buf. The
+    //    writer flags overflow; only then is the size pass run, to report it.
+    myco_cbor_t w;
+    myco_cbor_init(&w, out_buf, out_cap);
     uint8_t h[32];
-    myco_hash256(h, out_buf, unsigned_len);
+    size_t map_n = encode_hashed(&w, f, h);
+    if (map_n == 0) {
+        *out_len = myco_envelope_size(f);
+        return -2;
+    }
 
-    // 3) Sign ("MYCO1" || h)
+    // 2) Sign ("MYCO1" || h)
     uint8_t msg_to_sign[5 + 32];
     memcpy(msg_to_sign, "MYCO1", 5);
     memcpy(msg_to_sign + 5, h, 32);
@@ -127,34 +267,483 @@ int myco_build_envelope_cbor(
     uint8_t sig[64];
     myco_ed25519_sign(sig, sk64, msg_to_sign, sizeof(msg_to_sign));
 
-    // 4) Encode full signed envelope
-    // Re-encode from scratch to include h and z.
-    uint8_t *final_buf = out_buf;
-    myco_cbor_t w;
-    myco_cbor_init(&w, final_buf, out_cap);
+    // 3) Append h and z.
+    patch_map_header(out_buf, map_n + 2);
+    encode_hz(&w, h, sig);
+
+    *out_len = myco_cbor_err(&w) ? myco_envelope_size(f) : myco_cbor_len(&w);
+    return myco_cbor_err(&w) ? -2 : 0;
+}
 
-    size_t map_n = 10; // v,d,p,m,t,s,n,r,h,z
-    if (geo && geo->has_fix) map_n += 1; // g
-    myco_cbor_put_map(&w, map_n);
+// ---- Merkle batch (spec section 3.1) ----
 
-    myco_cbor_put_uint(&w, K_V); myco_cbor_put_uint(&w, 1);
-    myco_cbor_put_uint(&w, K_D); myco_cbor_put_tstr(&w, device_id);
-    myco_cbor_put_uint(&w, K_P); myco_cbor_put_uint(&w, proto);
-    myco_cbor_put_uint(&w, K_M); myco_cbor_put_bstr(&w, msg_id_16, 16);
-    myco_cbor_put_uint(&w, K_T); myco_cbor_put_int(&w, epoch_ms);
-    myco_cbor_put_uint(&w, K_S); myco_cbor_put_uint(&w, seq);
-    myco_cbor_put_uint(&w, K_N); myco_cbor_put_uint(&w, mono_ms);
+// Interior node = BLAKE2b-256(0x01 || left || right). Leaves are the
+// envelopes' h values; a node without a sibling is carried up unchanged.
+static void merkle_node(uint8_t out[32], const uint8_t l[32], const uint8_t r[32]) {
+    uint8_t buf[1 + 64];
+    buf[0] = 0x01;
+    memcpy(buf + 1, l, 32);
+    memcpy(buf + 33, r, 32);
+    myco_hash256(out, buf, sizeof(buf));
+}
+
+static void batch_sign_msg(uint8_t msg[6 + 32], const uint8_t root[32]) {
+    memcpy(msg, "MYCO1B", 6);
+    memcpy(msg + 6, root, 32);
+}
 
-    if (geo && geo->has_fix) {
-        encode_geo(&w, geo);
+int myco_build_envelope_batch_cbor(
+    uint8_t *const out_bufs[], size_t out_cap, size_t out_lens[],
+    const myco_envelope_fields_t *envs, size_t n,
+    const uint8_t sk64[64]
+) {
+    if (n == 0 || n > MYCO_BATCH_MAX) return -4;
+
+    // Levels stored back to back: n leaves, then ceil(n/2), ... , 1 root.
+    uint8_t tree[2 * MYCO_BATCH_MAX][32];
+    size_t map_n[MYCO_BATCH_MAX];
+    myco_cbor_t w[MYCO_BATCH_MAX];
+
+    // 1) Encode each U once, hashing it into its leaf.
+    for (size_t i = 0; i < n; i++) {
+        myco_cbor_init(&w[i], out_bufs[i], out_cap);
+        map_n[i] = encode_hashed(&w[i], &envs[i], tree[i]);
+        if (map_n[i] == 0) {
+            out_lens[i] = myco_envelope_batch_size(&envs[i], i, n);
+            return -2;
+        }
     }
 
-    encode_readings(&w, readings, n_readings);
+    // 2) Build the tree and sign the root once.
+    size_t base = 0, width = n;
+    while (width > 1) {
+        const size_t next = base + width;
+        for (size_t k = 0; k < width; k += 2) {
+            if (k + 1 < width) merkle_node(tree[next + k / 2], tree[base + k], tree[base + k + 1]);
+            else memcpy(tree[next + k / 2], tree[base + k], 32);
+        }
+        base = next;
+        width = (width + 1) / 2;
+    }
 
-    myco_cbor_put_uint(&w, K_H); myco_cbor_put_bstr(&w, h, 32);
-    myco_cbor_put_uint(&w, K_Z); myco_cbor_put_bstr(&w, sig, 64);
+    uint8_t msg_to_sign[6 + 32];
+    batch_sign_msg(msg_to_sign, tree[base]);
+    uint8_t sig[64];
+    myco_ed25519_sign(sig, sk64, msg_to_sign, sizeof(msg_to_sign));
+
+    // 3) Append x (index, count, sibling path), h and z to each envelope.
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *sib[MYCO_BATCH_DEPTH];
+        size_t n_sib = 0, idx = i;
+        base = 0;
+        width = n;
+        while (width > 1) {
+            const size_t s = idx ^ 1u;
+            if (s < width) sib[n_sib++] = tree[base + s];
+            base += width;
+            width = (width + 1) / 2;
+            idx >>= 1;
+        }
 
-    if (myco_cbor_err(&w)) return -3;
-    *out_len = myco_cbor_len(&w);
+        patch_map_header(out_bufs[i], map_n[i] + 3);
+        encode_proof(&w[i], i, n, sib, n_sib);
+        encode_hz(&w[i], tree[i], sig);
+
+        if (myco_cbor_err(&w[i])) {
+            out_lens[i] = myco_envelope_batch_size(&envs[i], i, n);
+            return -2;
+        }
+        out_lens[i] = myco_cbor_len(&w[i]);
+    }
     return 0;
 }
+
+int myco_merkle_root(
+    uint8_t root[32], const uint8_t h[32],
+    uint32_t index, uint32_t count,
+    const uint8_t (*proof)[32], size_t n_proof
+) {
+    if (count == 0 || index >= count) return 0;
+    uint8_t acc[32];
+    memcpy(acc, h, 32);
+    size_t p = 0;
+    uint32_t width = count;
+    while (width > 1) {
+        if (index & 1u) {
+            if (p >= n_proof) return 0;
+            merkle_node(acc, proof[p++], acc);
+        } else if (index + 1 < width) {
+            if (p >= n_proof) return 0;
+            merkle_node(acc, acc, proof[p++]);
+        }
+        width = (width + 1) / 2;
+        index >>= 1;
+    }
+    if (p != n_proof) return 0;
+    memcpy(root, acc, 32);
+    return 1;
+}
+
+int myco_verify_batch_proof(
+    const uint8_t h[32], uint32_t index, uint32_t count,
+    const uint8_t (*proof)[32], size_t n_proof,
+    const uint8_t pk32[32], const uint8_t sig64[64]
+) {
+    uint8_t root[32];
+    if (!myco_merkle_root(root, h, index, count, proof, n_proof)) return 0;
+    uint8_t msg[6 + 32];
+    batch_sign_msg(msg, root);
+    return myco_ed25519_verify(pk32, msg, sizeof(msg), sig64);
+}
+
+// ---- Verifier ----
+
+// Map a CBOR reader failure onto the verifier's codes.
+static int reader_rc(const myco_cbor_reader_t *r) {
+    switch (myco_cbor_reader_err(r)) {
+    case MYCO_CBOR_ERR_NONCANONICAL: return MYCO_VERIFY_NONCANONICAL;
+    case MYCO_CBOR_ERR_TYPE:         return MYCO_VERIFY_MISSING;
+    default:                         return MYCO_VERIFY_MALFORMED;
+    }
+}
+
+static int parse_geo(myco_cbor_reader_t *r, myco_geo_t *geo) {
+    size_t n;
+    uint64_t k, acc;
+    int64_t lat, lon;
+    if (myco_cbor_read_map(r, &n)) return reader_rc(r);
+    if (n != 3) return MYCO_VERIFY_MISSING;
+    if (myco_cbor_read_uint(r, &k) || k != G_LAT || myco_cbor_read_int(r, &lat) ||
+        myco_cbor_read_uint(r, &k) || k != G_LON || myco_cbor_read_int(r, &lon) ||
+        myco_cbor_read_uint(r, &k) || k != G_ACC || myco_cbor_read_uint(r, &acc)) {
+        return myco_cbor_reader_err(r) ? reader_rc(r) : MYCO_VERIFY_MISSING;
+    }
+    if (lat < INT32_MIN || lat > INT32_MAX || lon < INT32_MIN || lon > INT32_MAX || acc > 0xFFFF) {
+        return MYCO_VERIFY_MISSING;
+    }
+    geo->has_fix = 1;
+    geo->lat_e7 = (int32_t)lat;
+    geo->lon_e7 = (int32_t)lon;
+    geo->acc_m = (uint16_t)acc;
+    return MYCO_VERIFY_OK;
+}
+
+// x: keys 0..2 are the batch proof (spec 3.1); other metadata is skipped.
+static int parse_x(myco_cbor_reader_t *r, myco_envelope_view_t *v) {
+    size_t n;
+    if (myco_cbor_read_map(r, &n)) return reader_rc(r);
+    uint32_t seen = 0;
+    int64_t last = -1;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k, val;
+        if (myco_cbor_read_uint(r, &k)) return reader_rc(r);
+        if ((int64_t)k <= last) return MYCO_VERIFY_NONCANONICAL;
+        last = (int64_t)k;
+        if (k == X_MI || k == X_MN) {
+            if (myco_cbor_read_uint(r, &val)) return reader_rc(r);
+            if (val > UINT32_MAX) return MYCO_VERIFY_MISSING;
+            if (k == X_MI) v->batch_index = (uint32_t)val;
+            else v->batch_count = (uint32_t)val;
+        } else if (k == X_MP) {
+            size_t np;
+            if (myco_cbor_read_array(r, &np)) return reader_rc(r);
+            v->n_proof = np;
+            for (size_t j = 0; j < np; j++) {
+                const uint8_t *p;
+                size_t len;
+                if (myco_cbor_read_bstr(r, &p, &len)) return reader_rc(r);
+                if (len != 32) return MYCO_VERIFY_MISSING;
+                if (j == 0) v->proof = p;
+            }
+        } else if (myco_cbor_skip(r)) {
+            return reader_rc(r);
+        }
+        if (k < 32) seen |= 1u << k;
+    }
+    v->batched = (seen >> X_MP) & 1u;
+    if (v->batched && (seen & 3u) != 3u) return MYCO_VERIFY_MISSING;
+    return MYCO_VERIFY_OK;
+}
+
+int myco_envelope_parse(const uint8_t *buf, size_t len, myco_envelope_view_t *v) {
+    memset(v, 0, sizeof(*v));
+    myco_cbor_reader_t r;
+    myco_cbor_reader_init(&r, buf, len);
+
+    size_t n;
+    if (myco_cbor_read_map(&r, &n)) return reader_rc(&r);
+    const size_t body = myco_cbor_pos(&r);
+    size_t x_off = 0, h_off = 0;
+    uint32_t seen = 0;
+    int64_t last = -1;
+
+    for (size_t i = 0; i < n; i++) {
+        const size_t key_off = myco_cbor_pos(&r);
+        uint64_t k, u;
+        const uint8_t *p;
+        size_t plen;
+        int rc = MYCO_VERIFY_OK;
+
+        if (myco_cbor_read_uint(&r, &k)) {
+            // Keys are unsigned integers; anything else is not an envelope.
+            return myco_cbor_reader_err(&r) == MYCO_CBOR_ERR_TYPE ? MYCO_VERIFY_MALFORMED : reader_rc(&r);
+        }
+        if (k > K_Z) return MYCO_VERIFY_MALFORMED;
+        if ((int64_t)k <= last) return MYCO_VERIFY_NONCANONICAL;
+        last = (int64_t)k;
+
+        switch (k) {
+        case K_V:
+            if (myco_cbor_read_uint(&r, &u)) return reader_rc(&r);
+            if (u != 1) return MYCO_VERIFY_MALFORMED;
+            break;
+        case K_D:
+            if (myco_cbor_read_tstr(&r, &v->device_id, &v->device_id_len)) return reader_rc(&r);
+            break;
+        case K_P:
+            if (myco_cbor_read_uint(&r, &u)) return reader_rc(&r);
+            if (u > 0xFF) return MYCO_VERIFY_MISSING;
+            v->proto = (uint8_t)u;
+            break;
+        case K_M:
+            if (myco_cbor_read_bstr(&r, &v->msg_id, &plen)) return reader_rc(&r);
+            if (plen != 16) return MYCO_VERIFY_MISSING;
+            break;
+        case K_T:
+            if (myco_cbor_read_int(&r, &v->epoch_ms)) return reader_rc(&r);
+            break;
+        case K_S:
+            if (myco_cbor_read_uint(&r, &u)) return reader_rc(&r);
+            if (u > UINT32_MAX) return MYCO_VERIFY_MISSING;
+            v->seq = (uint32_t)u;
+            break;
+        case K_N:
+            if (myco_cbor_read_uint(&r, &v->mono_ms)) return reader_rc(&r);
+            break;
+        case K_G:
+            rc = parse_geo(&r, &v->geo);
+            break;
+        case K_R:
+            if (myco_cbor_read_array(&r, &v->n_readings)) return reader_rc(&r);
+            v->readings = buf + myco_cbor_pos(&r);
+            for (size_t j = 0; j < v->n_readings; j++) {
+                if (myco_cbor_skip(&r)) return reader_rc(&r);
+            }
+            v->readings_len = (size_t)(buf + myco_cbor_pos(&r) - v->readings);
+            break;
+        case K_X:
+            x_off = key_off;
+            rc = parse_x(&r, v);
+            break;
+        case K_H:
+            h_off = key_off;
+            if (myco_cbor_read_bstr(&r, &v->h, &plen)) return reader_rc(&r);
+            if (plen != 32) return MYCO_VERIFY_MISSING;
+            break;
+        case K_Z:
+            if (myco_cbor_read_bstr(&r, &p, &plen)) return reader_rc(&r);
+            if (plen != 64) return MYCO_VERIFY_MISSING;
+            v->z = p;
+            break;
+        }
+        if (rc) return rc;
+        seen |= 1u << k;
+    }
+    if (myco_cbor_pos(&r) != len) return MYCO_VERIFY_MALFORMED;
+
+    const uint32_t required = (1u << K_V) | (1u << K_D) | (1u << K_P) | (1u << K_M) |
+                              (1u << K_T) | (1u << K_S) | (1u << K_N) | (1u << K_R) |
+                              (1u << K_H) | (1u << K_Z);
+    if ((seen & required) != required) return MYCO_VERIFY_MISSING;
+
+    // U: everything before h, minus x when x is the batch proof. At most 11
+    // entries, so the header is one byte.
+    const size_t u_end = v->batched ? x_off : h_off;
+    const size_t u_n = n - 2 - (v->batched ? 1 : 0);
+    v->u_head = (uint8_t)((5u << 5) | u_n);
+    v->u_body = buf + body;
+    v->u_body_len = u_end - body;
+    return MYCO_VERIFY_OK;
+}
+
+int myco_envelope_verify(const uint8_t *buf, size_t len, const uint8_t pk32[32],
+                         myco_envelope_view_t *v) {
+    return myco_envelope_verify_cached(buf, len, pk32, NULL, v);
+}
+
+int myco_envelope_prepare(const uint8_t *buf, size_t len, myco_envelope_view_t *v,
+                          uint8_t msg[MYCO_SIGNED_MSG_MAX], size_t *msg_len) {
+    int rc = myco_envelope_parse(buf, len, v);
+    if (rc) return rc;
+
+    uint8_t h[32];
+    myco_hash256_ctx_t hctx;
+    myco_hash256_init(&hctx);
+    myco_hash256_update(&hctx, &v->u_head, 1);
+    myco_hash256_update(&hctx, v->u_body, v->u_body_len);
+    myco_hash256_final(&hctx, h);
+    if (memcmp(h, v->h, 32) != 0) return MYCO_VERIFY_HASH;
+
+    if (!v->batched) {
+        memcpy(msg, "MYCO1", 5);
+        memcpy(msg + 5, h, 32);
+        *msg_len = 5 + 32;
+        return MYCO_VERIFY_OK;
+    }
+
+    // Proof entries are canonical bstr(32): 2-byte head + 32 bytes apart.
+    if (v->n_proof > MYCO_BATCH_DEPTH) return MYCO_VERIFY_PROOF;
+    uint8_t proof[MYCO_BATCH_DEPTH][32];
+    for (size_t i = 0; i < v->n_proof; i++) memcpy(proof[i], v->proof + i * 34, 32);
+    uint8_t root[32];
+    if (!myco_merkle_root(root, h, v->batch_index, v->batch_count,
+                          (const uint8_t (*)[32])proof, v->n_proof)) {
+        return MYCO_VERIFY_PROOF;
+    }
+    batch_sign_msg(msg, root);
+    *msg_len = 6 + 32;
+    return MYCO_VERIFY_OK;
+}
+
+int myco_envelope_verify_cached(const uint8_t *buf, size_t len, const uint8_t pk32[32],
+                                myco_root_cache_t *cache, myco_envelope_view_t *v) {
+    myco_envelope_view_t local;
+    if (!v) v = &local;
+    uint8_t msg[MYCO_SIGNED_MSG_MAX];
+    size_t msg_len;
+    int rc = myco_envelope_prepare(buf, len, v, msg, &msg_len);
+    if (rc) return rc;
+    if (!v->batched || !cache) {
+        return myco_ed25519_verify(pk32, msg, msg_len, v->z) ? MYCO_VERIFY_OK : MYCO_VERIFY_SIGNATURE;
+    }
+
+    uint8_t key[32];
+    myco_hash256_ctx_t hctx;
+    myco_hash256_init(&hctx);
+    myco_hash256_update(&hctx, pk32, 32);
+    myco_hash256_update(&hctx, msg, msg_len);
+    myco_hash256_update(&hctx, v->z, 64);
+    myco_hash256_final(&hctx, key);
+    for (uint8_t i = 0; i < MYCO_ROOT_CACHE_N; i++) {
+        if (((cache->valid >> i) & 1u) && memcmp(cache->key[i], key, 32) == 0) return MYCO_VERIFY_OK;
+    }
+    if (!myco_ed25519_verify(pk32, msg, msg_len, v->z)) return MYCO_VERIFY_SIGNATURE;
+    memcpy(cache->key[cache->next], key, 32);
+    cache->valid |= (uint8_t)(1u << cache->next);
+    cache->next = (uint8_t)((cache->next + 1) % MYCO_ROOT_CACHE_N);
+    return MYCO_VERIFY_OK;
+}
+
+int myco_envelope_read_reading(myco_cbor_reader_t *r, myco_reading_t *out) {
+    size_t n;
+    uint64_t k, sid, vs, unit, q;
+    int64_t vi;
+    if (myco_cbor_read_map(r, &n)) return r->err;
+    if (n != 5) return (r->err = MYCO_CBOR_ERR_TYPE);
+    if (myco_cbor_read_uint(r, &k) || k != R_ID || myco_cbor_read_uint(r, &sid) ||
+        myco_cbor_read_uint(r, &k) || k != R_VI || myco_cbor_read_int(r, &vi) ||
+        myco_cbor_read_uint(r, &k) || k != R_VS || myco_cbor_read_uint(r, &vs) ||
+        myco_cbor_read_uint(r, &k) || k != R_U  || myco_cbor_read_uint(r, &unit) ||
+        myco_cbor_read_uint(r, &k) || k != R_Q  || myco_cbor_read_uint(r, &q)) {
+        return r->err ? r->err : (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    if (sid > 0xFFFF || vi < INT32_MIN || vi > INT32_MAX || vs > 0xFF || unit > 0xFFFF || q > 0xFF) {
+        return (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    out->sid = (uint16_t)sid;
+    out->vi = (int32_t)vi;
+    out->vs = (uint8_t)vs;
+    out->unit = (uint16_t)unit;
+    out->quality = (uint8_t)q;
+    return 0;
+}
+
+int myco_envelope_next_is_block(const myco_cbor_reader_t *r) {
+    myco_cbor_reader_t p = *r;
+    size_t n;
+    uint64_t k;
+    if (myco_cbor_read_map(&p, &n) || n < 2 || myco_cbor_read_uint(&p, &k) || k != R_ID ||
+        myco_cbor_skip(&p) || myco_cbor_read_uint(&p, &k)) {
+        return 0;
+    }
+    return k != R_VI;
+}
+
+static int32_t load_le(const uint8_t *p, uint8_t size) {
+    if (size == 2) return (int16_t)(uint16_t)(p[0] | (uint16_t)p[1] << 8);
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+int myco_envelope_read_block(myco_cbor_reader_t *r, myco_block_view_t *out) {
+    size_t n, len;
+    uint64_t k, sid, vs, unit, q, dt, de;
+    int64_t t0;
+    myco_cbor_item_t tag;
+    const uint8_t *p;
+    if (myco_cbor_read_map(r, &n)) return r->err;
+    if (n != 8) return (r->err = MYCO_CBOR_ERR_TYPE);
+    if (myco_cbor_read_uint(r, &k) || k != R_ID || myco_cbor_read_uint(r, &sid) ||
+        myco_cbor_read_uint(r, &k) || k != R_VS || myco_cbor_read_uint(r, &vs) ||
+        myco_cbor_read_uint(r, &k) || k != R_U  || myco_cbor_read_uint(r, &unit) ||
+        myco_cbor_read_uint(r, &k) || k != R_Q  || myco_cbor_read_uint(r, &q) ||
+        myco_cbor_read_uint(r, &k) || k != B_T0 || myco_cbor_read_int(r, &t0) ||
+        myco_cbor_read_uint(r, &k) || k != B_DT || myco_cbor_read_uint(r, &dt) ||
+        myco_cbor_read_uint(r, &k) || k != B_DE || myco_cbor_read_uint(r, &de) ||
+        myco_cbor_read_uint(r, &k) || k != B_VA || myco_cbor_read(r, &tag)) {
+        return r->err ? r->err : (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    if (tag.major != 6 || (tag.val != TAG_SINT16_LE && tag.val != TAG_SINT32_LE)) {
+        return (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    if (myco_cbor_read_bstr(r, &p, &len)) return r->err;
+    const uint8_t size = tag.val == TAG_SINT16_LE ? 2 : 4;
+    if (len % size || sid > 0xFFFF || vs > 0xFF || unit > 0xFFFF || q > 0xFF ||
+        dt > UINT32_MAX || de > 1) {
+        return (r->err = MYCO_CBOR_ERR_TYPE);
+    }
+    // int32 only when some stored value needs it, so a block has one encoding.
+    if (size == 4) {
+        size_t i = 0;
+        while (i < len && load_le(p + i, 4) >= INT16_MIN && load_le(p + i, 4) <= INT16_MAX) i += 4;
+        if (i == len) return (r->err = MYCO_CBOR_ERR_NONCANONICAL);
+    }
+    out->sid = (uint16_t)sid;
+    out->vs = (uint8_t)vs;
+    out->unit = (uint16_t)unit;
+    out->quality = (uint8_t)q;
+    out->t0_us = t0;
+    out->period_us = (uint32_t)dt;
+    out->delta = (uint8_t)de;
+    out->elem_size = size;
+    out->data = p;
+    out->n_values = len / size;
+    return 0;
+}
+
+int myco_block_values(const myco_block_view_t *b, int32_t *out) {
+    int64_t acc = 0;
+    for (size_t i = 0; i < b->n_values; i++) {
+        const int32_t s = load_le(b->data + i * b->elem_size, b->elem_size);
+        if (!b->delta) {
+            out[i] = s;
+            continue;
+        }
+        acc += s;
+        if (acc < INT32_MIN || acc > INT32_MAX) return MYCO_CBOR_ERR_TYPE;
+        out[i] = (int32_t)acc;
+    }
+    return 0;
+}
+
+const char *myco_verify_strerror(int rc) {
+    switch (rc) {
+    case MYCO_VERIFY_OK:           return "ok";
+    case MYCO_VERIFY_MALFORMED:    return "malformed";
+    case MYCO_VERIFY_NONCANONICAL: return "non_canonical";
+    case MYCO_VERIFY_MISSING:      return "missing_keys";
+    case MYCO_VERIFY_HASH:         return "hash_mismatch";
+    case MYCO_VERIFY_PROOF:        return "bad_batch_proof";
+    case MYCO_VERIFY_SIGNATURE:    return "bad_signature";
+    default:                       return "unknown";
+    }
+}
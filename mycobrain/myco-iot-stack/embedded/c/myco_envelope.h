@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
+#include "myco_cbor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,24 @@ typedef struct {
     uint8_t  quality; // 0=ok
 } myco_reading_t;
 
+// A block of samples from one sensor at a fixed rate (spec: block reading).
+// One sid / unit / scale header, then the values as an RFC 8746 typed array:
+// int16 little-endian when every stored value fits, else int32. With delta
+// set, value[0] is stored as is and then value[i] - value[i-1], which keeps
+// slowly varying signals in int16; if a difference overflows int32 the block
+// is stored plain (and says so).
+typedef struct {
+    uint16_t       sid;
+    uint8_t        vs;        // decimal places of every value
+    uint16_t       unit;
+    uint8_t        quality;   // whole block
+    int64_t        t0_us;     // first sample, epoch microseconds
+    uint32_t       period_us;
+    uint8_t        delta;
+    const int32_t *values;
+    size_t         n_values;
+} myco_block_t;
+
 typedef struct {
     int has_fix;
     int32_t lat_e7;
@@ -31,18 +50,51 @@ typedef struct {
     uint16_t acc_m;
 } myco_geo_t;
 
+// Envelope fields (everything in U except the map header).
+typedef struct {
+    const char           *device_id;
+    uint8_t               proto;
+    const uint8_t        *msg_id_16;
+    int64_t               epoch_ms;
+    uint32_t              seq;
+    uint64_t              mono_ms;
+    const myco_geo_t     *geo;          // can be NULL or has_fix=0
+    const myco_reading_t *readings;
+    size_t                n_readings;
+    const myco_block_t   *blocks;       // follow the readings in r; may be NULL
+    size_t                n_blocks;
+} myco_envelope_fields_t;
+
 // Crypto hooks (implement with Monocypher or any other library)
 //
 // - hash256(out32, msg, msg_len): BLAKE2b-256
+// - hash256_init/update/final: the same hash, incrementally. The envelope
+//   builder hashes the body while it is being encoded. ctx is opaque storage
+//   for the library's state (Monocypher's crypto_blake2b_ctx fits).
 // - ed25519_sign(sig64, sk64, msg, msg_len)
 // - ed25519_verify(pk32, msg, msg_len, sig64) -> 1=ok, 0=bad
 //
+typedef struct { uint64_t opaque[32]; } myco_hash256_ctx_t;
+
 void myco_hash256(uint8_t out32[32], const uint8_t *msg, size_t msg_len);
+void myco_hash256_init(myco_hash256_ctx_t *ctx);
+void myco_hash256_update(myco_hash256_ctx_t *ctx, const uint8_t *msg, size_t msg_len);
+void myco_hash256_final(myco_hash256_ctx_t *ctx, uint8_t out32[32]);
 void myco_ed25519_sign(uint8_t sig64[64], const uint8_t sk64[64], const uint8_t *msg, size_t msg_len);
 int  myco_ed25519_verify(const uint8_t pk32[32], const uint8_t *msg, size_t msg_len, const uint8_t sig64[64]);
 
+// SHA-512, incrementally. Only the batch verifier (myco_ed25519_batch.c) needs
+// it: Ed25519 hashes R || A || M with SHA-512, whatever hash256 is.
+typedef struct { uint64_t opaque[32]; } myco_sha512_ctx_t;
+
+void myco_sha512_init(myco_sha512_ctx_t *ctx);
+void myco_sha512_update(myco_sha512_ctx_t *ctx, const uint8_t *msg, size_t msg_len);
+void myco_sha512_final(myco_sha512_ctx_t *ctx, uint8_t out64[64]);
+
 // Build + sign envelope.
-// out_buf receives *signed envelope* CBOR bytes.
+// out_buf receives *signed envelope* CBOR bytes. The body is encoded once and
+// hashed as it is written; h and z are appended to it. Returns 0, or -2 if
+// out_cap is too small, with the size needed in *out_len.
 int myco_build_envelope_cbor(
     uint8_t       *out_buf, size_t out_cap, size_t *out_len,
     const char    *device_id,
@@ -57,6 +109,201 @@ int myco_build_envelope_cbor(
     const uint8_t  sk64[64]         // Ed25519 secret key
 );
 
+// Same, from a fields struct (needed for block readings).
+int myco_build_envelope_fields_cbor(
+    uint8_t *out_buf, size_t out_cap, size_t *out_len,
+    const myco_envelope_fields_t *f,
+    const uint8_t sk64[64]
+);
+
+// Exact size of the signed envelope the builders would produce, computed
+// without writing bytes, hashing or signing, so callers can allocate exactly,
+// pack envelopes into an MTU or decide on fragmentation first. Optional: the
+// builders do not call it unless the output overflowed.
+size_t myco_envelope_size(const myco_envelope_fields_t *f);
+// Same for envelope index of a batch of count (adds its proof in x).
+size_t myco_envelope_batch_size(const myco_envelope_fields_t *f, size_t index, size_t count);
+
+// Batch mode (spec section 3.1): build n envelopes, hash each into a leaf of
+// a Merkle tree and sign only the root ("MYCO1B" || root), so one Ed25519
+// signature covers the whole batch. Each envelope carries its leaf index, the
+// leaf count and the sibling path in x, plus the shared z.
+// Envelope i is written to out_bufs[i] (out_cap bytes each), its length to
+// out_lens[i]; on -2 out_lens[i] is the size the first envelope that did not
+// fit needs. Stack use grows with MYCO_BATCH_MAX (~2 KB at 16).
+#ifndef MYCO_BATCH_MAX
+#define MYCO_BATCH_MAX 16
+#endif
+#define MYCO_BATCH_DEPTH 8   // sibling path length bound (batches up to 256)
+
+int myco_build_envelope_batch_cbor(
+    uint8_t *const out_bufs[], size_t out_cap, size_t out_lens[],
+    const myco_envelope_fields_t *envs, size_t n,
+    const uint8_t sk64[64]
+);
+
+// Verifier side. The caller has already decoded the envelope and checked
+// h == BLAKE2b-256(U), where U excludes x as well as h and z.
+//
+// myco_merkle_root() folds the sibling path (x key 2) from leaf h at index
+// (x key 0) of count (x key 1) up to the root: 1=ok, 0=malformed proof.
+// Envelopes from one batch share a root, so a verifier can check the root
+// signature once and cache it.
+// myco_verify_batch_proof() does both steps: 1=valid, 0=invalid.
+int myco_merkle_root(
+    uint8_t root[32], const uint8_t h[32],
+    uint32_t index, uint32_t count,
+    const uint8_t (*proof)[32], size_t n_proof
+);
+int myco_verify_batch_proof(
+    const uint8_t h[32], uint32_t index, uint32_t count,
+    const uint8_t (*proof)[32], size_t n_proof,
+    const uint8_t pk32[32], const uint8_t sig64[64]
+);
+
+// ---- Verifier (gateways, tests) ----
+//
+// Parses a signed envelope in place with the CBOR reader and verifies it
+// without re-encoding: since the envelope must be deterministic CBOR with
+// ascending keys, U is U's map header followed by the input span from key 0
+// up to where x (batch mode), or h, starts. Only the one-byte header is
+// rebuilt; everything else is hashed straight from the input.
+
+enum {
+    MYCO_VERIFY_OK          = 0,
+    MYCO_VERIFY_MALFORMED   = -1,  // not CBOR, truncated, trailing bytes
+    MYCO_VERIFY_NONCANONICAL = -2, // keys out of order, non-shortest ints, ...
+    MYCO_VERIFY_MISSING     = -3,  // required key absent or of the wrong type
+    MYCO_VERIFY_HASH        = -4,  // h != BLAKE2b-256(U)
+    MYCO_VERIFY_PROOF       = -5,  // batch proof does not fold to a root
+    MYCO_VERIFY_SIGNATURE   = -6
+};
+
+typedef struct {
+    const char    *device_id;      // span, not NUL-terminated
+    size_t         device_id_len;
+    uint8_t        proto;
+    const uint8_t *msg_id;         // 16 bytes
+    int64_t        epoch_ms;
+    uint32_t       seq;
+    uint64_t       mono_ms;
+    myco_geo_t     geo;            // has_fix=0 when g is absent
+    const uint8_t *readings;       // span of r's elements (after the array head)
+    size_t         readings_len;
+    size_t         n_readings;
+    int            batched;        // x carries a Merkle proof
+    uint32_t       batch_index, batch_count;
+    const uint8_t *proof;          // n_proof canonical bstr(32) items, 34 bytes apart
+    size_t         n_proof;
+    const uint8_t *h;              // 32 bytes
+    const uint8_t *z;              // 64 bytes
+    uint8_t        u_head;         // U's map header
+    const uint8_t *u_body;         // U after its header
+    size_t         u_body_len;
+} myco_envelope_view_t;
+
+// Structure only: decode into v, no crypto. Returns MYCO_VERIFY_OK or one of
+// MALFORMED / NONCANONICAL / MISSING.
+int myco_envelope_parse(const uint8_t *buf, size_t len, myco_envelope_view_t *v);
+
+// Parse, then check h and z against pk32. v may be NULL.
+int myco_envelope_verify(const uint8_t *buf, size_t len, const uint8_t pk32[32],
+                         myco_envelope_view_t *v);
+
+// Same, remembering recently verified batch roots: envelopes of one batch
+// then cost one Ed25519 check between them instead of one each. An entry is
+// a hash of (pk, root, z), so a hit means this exact signature was already
+// verified for this key. Zero-initialise the cache before first use.
+#define MYCO_ROOT_CACHE_N 8
+typedef struct {
+    uint8_t key[MYCO_ROOT_CACHE_N][32];
+    uint8_t valid;      // bit i: key[i] in use
+    uint8_t next;       // round-robin victim
+} myco_root_cache_t;
+
+int myco_envelope_verify_cached(const uint8_t *buf, size_t len, const uint8_t pk32[32],
+                                myco_root_cache_t *cache, myco_envelope_view_t *v);
+
+// Everything myco_envelope_verify() checks except the signature: parse, h and
+// the batch proof. On MYCO_VERIFY_OK, msg/msg_len is what z signs ("MYCO1" || h,
+// or "MYCO1B" || root), for callers that check signatures in bulk.
+#define MYCO_SIGNED_MSG_MAX (6 + 32)
+int myco_envelope_prepare(const uint8_t *buf, size_t len, myco_envelope_view_t *v,
+                          uint8_t msg[MYCO_SIGNED_MSG_MAX], size_t *msg_len);
+
+// ---- Batch signature verification (gateways, myco_ed25519_batch.c) ----
+//
+// myco_ed25519_verify_batch() checks n (pk, msg, sig) tuples together. It
+// decodes every R and A, weights each signature by a 128-bit coefficient z_i
+// derived by hashing the whole batch, and checks one multi-scalar equation
+//   [8]([sum z_i k_i] A_i + [sum z_i] R_i - [sum z_i s_i] B) == 0
+// with a bucket (Pippenger) multiplication. From about 32 signatures on that
+// costs under half of n single verifies; chunks under 8 are simply verified
+// one by one. If it fails, the batch is bisected and the small groups
+// that still fail are rechecked one by one with myco_ed25519_verify(), so
+// ok[i] names exactly the bad signatures. Encodings the batch equation cannot
+// judge exactly like a single verify (non-canonical points) also go to
+// myco_ed25519_verify(). The batch check is cofactored: it can only disagree
+// with a cofactorless single verify on signatures with small-order
+// components, which no honest signer produces.
+//
+// Batches larger than MYCO_ED25519_BATCH_MAX are split. work is scratch
+// space (~36 KB at 64); keep it static or on the heap, not on a small stack.
+// Returns the number of valid signatures.
+#ifndef MYCO_ED25519_BATCH_MAX
+#define MYCO_ED25519_BATCH_MAX 64
+#endif
+typedef struct { uint64_t opaque[MYCO_ED25519_BATCH_MAX * 60 + 700]; } myco_ed25519_batch_t;
+
+size_t myco_ed25519_verify_batch(
+    myco_ed25519_batch_t *work,
+    const uint8_t *const pks[], const uint8_t *const msgs[], const size_t msg_lens[],
+    const uint8_t *const sigs[], size_t n, uint8_t ok[]
+);
+
+// Verify n envelopes (envelope i against pks[i]) with one batch signature
+// check per MYCO_ED25519_BATCH_MAX envelopes. rcs[i] gets the same code
+// myco_envelope_verify() would return. Returns the number that are OK.
+size_t myco_envelope_verify_batch(
+    myco_ed25519_batch_t *work,
+    const uint8_t *const bufs[], const size_t lens[], const uint8_t *const pks[],
+    size_t n, int rcs[]
+);
+
+// Walk the readings of a parsed envelope (n_readings counts blocks too):
+//   myco_cbor_reader_t r;
+//   myco_cbor_reader_init(&r, v.readings, v.readings_len);
+//   for (size_t i = 0; i < v.n_readings; i++) {
+//       if (myco_envelope_next_is_block(&r)) myco_envelope_read_block(&r, &blk);
+//       else myco_envelope_read_reading(&r, &out);
+//   }
+// Both return 0, or a CBOR reader error (text sensor ids are reported as
+// TYPE, an int32 array whose values all fit int16 as NONCANONICAL).
+int myco_envelope_read_reading(myco_cbor_reader_t *r, myco_reading_t *out);
+
+typedef struct {
+    uint16_t       sid;
+    uint8_t        vs;
+    uint16_t       unit;
+    uint8_t        quality;
+    int64_t        t0_us;
+    uint32_t       period_us;
+    uint8_t        delta;
+    uint8_t        elem_size;   // 2 or 4
+    const uint8_t *data;        // n_values little-endian elements, in the input
+    size_t         n_values;
+} myco_block_view_t;
+
+// 1 if the next reading is a block (it has no vi), else 0.
+int myco_envelope_next_is_block(const myco_cbor_reader_t *r);
+int myco_envelope_read_block(myco_cbor_reader_t *r, myco_block_view_t *out);
+
+// Expand a block into out[n_values], undoing the delta coding. Returns 0, or
+// MYCO_CBOR_ERR_TYPE if a running sum leaves int32.
+int myco_block_values(const myco_block_view_t *b, int32_t *out);
+
+const char *myco_verify_strerror(int rc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@ import (
 	"context"
 	"crypto/ed25519"
 	"encoding/base64"
+	"encoding/binary"
 	"encoding/json"
 	"fmt"
 	"log"
@@ -139,12 +140,81 @@ func blake2b256(data []byte) []byte {
 	return sum[:]
 }
 
-func canonicalUnsignedCBOR(env Envelope) ([]byte, error) {
-	// clone without keys 10 and 11
+// batchProof is the Merkle inclusion proof carried in x by batch-signed
+// envelopes (spec 3.1).
+type batchProof struct {
+	index, count uint64
+	path         [][]byte
+}
+
+// batchProofOf returns the proof in x, or nil for a singly-signed envelope.
+func batchProofOf(env Envelope) (*batchProof, string) {
+	x, ok := env[uint64(9)].(map[any]any)
+	if !ok {
+		return nil, ""
+	}
+	pAny, ok := x[uint64(2)]
+	if !ok {
+		return nil, ""
+	}
+	idx, ok1 := x[uint64(0)].(uint64)
+	cnt, ok2 := x[uint64(1)].(uint64)
+	arr, ok3 := pAny.([]any)
+	if !ok1 || !ok2 || !ok3 {
+		return nil, "bad batch proof"
+	}
+	bp := &batchProof{index: idx, count: cnt}
+	for _, e := range arr {
+		b, ok := e.([]byte)
+		if !ok || len(b) != 32 {
+			return nil, "bad batch proof"
+		}
+		bp.path = append(bp.path, b)
+	}
+	return bp, ""
+}
+
+func merkleNode(l, r []byte) []byte {
+	buf := make([]byte, 0, 65)
+	buf = append(buf, 0x01)
+	buf = append(buf, l...)
+	buf = append(buf, r...)
+	return blake2b256(buf)
+}
+
+// root folds the sibling path from leaf h up to the batch root. A node with
+// no sibling is carried up and has no path entry.
+func (bp *batchProof) root(h []byte) ([]byte, bool) {
+	if bp.count == 0 || bp.index >= bp.count {
+		return nil, false
+	}
+	acc, idx, width, k := h, bp.index, bp.count, 0
+	for width > 1 {
+		if idx&1 == 1 {
+			if k >= len(bp.path) {
+				return nil, false
+			}
+			acc = merkleNode(bp.path[k], acc)
+			k++
+		} else if idx+1 < width {
+			if k >= len(bp.path) {
+				return nil, false
+			}
+			acc = merkleNode(acc, bp.path[k])
+			k++
+		}
+		idx >>= 1
+		width = (width + 1) / 2
+	}
+	return acc, k == len(bp.path)
+}
+
+func canonicalUnsignedCBOR(env Envelope, dropX bool) ([]byte, error) {
+	// clone without keys 10 and 11 (and 9 for batch-signed envelopes)
 	unsigned := make(map[any]any, len(env))
 	for k, v := range env {
 		if ki, ok := k.(uint64); ok {
-			if ki == 10 || ki == 11 {
+			if ki == 10 || ki == 11 || (dropX && ki == 9) {
 				continue
 			}
 		}
@@ -178,7 +248,12 @@ func verifyEnvelope(env Envelope, pubKey []byte) (bool, string) {
 		return false, "bad sig type/len"
 	}
 
-	unsignedBytes, err := canonicalUnsignedCBOR(env)
+	bp, reason := batchProofOf(env)
+	if reason != "" {
+		return false, reason
+	}
+
+	unsignedBytes, err := canonicalUnsignedCBOR(env, bp != nil)
 	if err != nil {
 		return false, "cbor re-encode failed"
 	}
@@ -188,6 +263,13 @@ func verifyEnvelope(env Envelope, pubKey []byte) (bool, string) {
 	}
 
 	msg := append([]byte("MYCO1"), h2...)
+	if bp != nil {
+		root, ok := bp.root(h2)
+		if !ok {
+			return false, "bad batch proof"
+		}
+		msg = append([]byte("MYCO1B"), root...)
+	}
 	if !ed25519.Verify(ed25519.PublicKey(pubKey), msg, sig) {
 		return false, "bad signature"
 	}
@@ -243,6 +325,12 @@ func toVerbose(env Envelope) map[string]any {
 				if !ok {
 					continue
 				}
+				if _, single := rm[uint64(1)]; !single {
+					if b := blockToVerbose(rm); b != nil {
+						pack = append(pack, b)
+					}
+					continue
+				}
 				sid := rm[uint64(0)]
 				vi := rm[uint64(1)]
 				vs := rm[uint64(2)]
@@ -293,6 +381,61 @@ func toVerbose(env Envelope) map[string]any {
 	}
 }
 
+// blockSamples expands va of a block reading (spec 2): an RFC 8746 typed
+// array, tag 77 (sint16 LE) or 78 (sint32 LE). With de = 1 the stored values
+// are deltas.
+func blockSamples(rm map[any]any) ([]int64, bool) {
+	tag, ok := rm[uint64(8)].(cbor.Tag)
+	if !ok || (tag.Number != 77 && tag.Number != 78) {
+		return nil, false
+	}
+	b, ok := tag.Content.([]byte)
+	if !ok {
+		return nil, false
+	}
+	size := 2
+	if tag.Number == 78 {
+		size = 4
+	}
+	de, _ := rm[uint64(7)].(uint64)
+	out := make([]int64, len(b)/size)
+	acc := int64(0)
+	for i := range out {
+		var s int64
+		if size == 2 {
+			s = int64(int16(binary.LittleEndian.Uint16(b[2*i:])))
+		} else {
+			s = int64(int32(binary.LittleEndian.Uint32(b[4*i:])))
+		}
+		if de == 1 {
+			acc += s
+			s = acc
+		}
+		out[i] = s
+	}
+	return out, true
+}
+
+func blockToVerbose(rm map[any]any) map[string]any {
+	vi, ok := blockSamples(rm)
+	if !ok {
+		return nil
+	}
+	vs, _ := rm[uint64(2)].(uint64)
+	t0, _ := rm[uint64(5)].(int64)
+	if u, ok := rm[uint64(5)].(uint64); ok {
+		t0 = int64(u)
+	}
+	v := make([]float64, len(vi))
+	for i, x := range vi {
+		v[i] = float64(x) / float64(pow10(int(vs)))
+	}
+	return map[string]any{
+		"id": rm[uint64(0)], "vs": rm[uint64(2)], "u": rm[uint64(3)], "q": rm[uint64(4)],
+		"t0_us": t0, "dt_us": rm[uint64(6)], "n": len(vi), "vi": vi, "v": v,
+	}
+}
+
 func pow10(n int) int64 {
 	p := int64(1)
 	for i := 0; i < n; i++ {
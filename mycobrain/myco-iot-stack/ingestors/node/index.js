@@ -58,6 +58,46 @@ function protoName(p) {
   }
 }
 
+/**
+ * Samples of a block reading (spec 2): va is an RFC 8746 typed array, tag 77
+ * (sint16 LE) or 78 (sint32 LE), decoded by cbor as a typed array or left as
+ * a Tagged byte string. With de = 1 the stored values are deltas.
+ */
+function blockSamples(va, de) {
+  let stored;
+  if (ArrayBuffer.isView(va)) {
+    stored = Array.from(va);
+  } else if (va && (va.tag === 77 || va.tag === 78)) {
+    const b = Buffer.from(va.value);
+    const size = va.tag === 77 ? 2 : 4;
+    stored = [];
+    for (let i = 0; i + size <= b.length; i += size) {
+      stored.push(size === 2 ? b.readInt16LE(i) : b.readInt32LE(i));
+    }
+  } else {
+    return [];
+  }
+  if (Number(de) !== 1) return stored;
+  let acc = 0;
+  return stored.map((d) => (acc += d));
+}
+
+function blockToVerbose(r) {
+  const vi = blockSamples(r[8], r[7]);
+  const scale = Math.pow(10, Number(r[2]));
+  return {
+    id: r[0],
+    vs: r[2],
+    u: r[3],
+    q: r[4],
+    t0_us: Number(r[5]),
+    dt_us: Number(r[6]),
+    n: vi.length,
+    vi,
+    v: vi.map((x) => x / scale),
+  };
+}
+
 /**
  * Convert compact numeric-key envelope to verbose object for storage/querying.
  * Keys follow spec/myco-envelope-v1.md
@@ -69,6 +109,7 @@ function toVerbose(env) {
   const lon = geo ? geo[1] / 1e7 : null;
 
   const pack = readings.map((r) => {
+    if (r[1] === undefined && r[8] !== undefined) return blockToVerbose(r);
     const sid = r[0];
     const vi = r[1];
     const vs = r[2];
@@ -101,23 +142,56 @@ function toVerbose(env) {
   };
 }
 
+function merkleNode(l, r) {
+  return blake2b256(Buffer.concat([Buffer.from([0x01]), Buffer.from(l), Buffer.from(r)]));
+}
+
+/**
+ * Fold a batch-signing proof (x = {0: index, 1: count, 2: [sibling...]},
+ * spec 3.1) from leaf h up to the root. Returns null if the proof is malformed,
+ * including any sibling that is not a 32-byte string.
+ */
+function merkleRoot(h, x) {
+  let idx = Number(x[0]);
+  let width = Number(x[1]);
+  const path = x[2];
+  if (!Array.isArray(path) || !(width > 0) || !(idx >= 0) || idx >= width) return null;
+  if (!path.every((s) => s instanceof Uint8Array && s.length === 32)) return null;
+  let acc = h;
+  let k = 0;
+  while (width > 1) {
+    if (idx % 2 === 1) {
+      if (k >= path.length) return null;
+      acc = merkleNode(path[k++], acc);
+    } else if (idx + 1 < width) {
+      if (k >= path.length) return null;
+      acc = merkleNode(acc, path[k++]);
+    }
+    idx = Math.floor(idx / 2);
+    width = Math.ceil(width / 2);
+  }
+  return k === path.length ? acc : null;
+}
+
 /**
  * Verify envelope:
- * 1) strip h/z
+ * 1) strip h/z (and x when it carries a batch proof)
  * 2) canonical CBOR encode
  * 3) blake2b-256 and compare with h
- * 4) verify Ed25519 over "MYCO1"||h
+ * 4) verify Ed25519 over "MYCO1"||h, or over "MYCO1B"||root for batches
  */
 async function verifyEnvelope(env, pubKeyU8) {
   const h = env[10];
   const sig = env[11];
   if (!h || !sig) return { ok: false, reason: "missing hash or signature" };
+  const x = env[9];
+  const batch = x && x[2] !== undefined;
 
   // Build unsigned object (shallow clone, excluding keys 10 and 11)
   const unsigned = {};
   for (const k of Object.keys(env)) {
     const kn = Number(k);
-    if (kn === 10 || kn === 11) continue;
+    if (kn === 10 || kn === 11 || (batch && kn === 9)) continue;
     unsigned[kn] = env[kn];
   }
 
@@ -128,7 +202,12 @@ async function verifyEnvelope(env, pubKeyU8) {
     return { ok: false, reason: "hash mismatch" };
   }
 
-  const msg = Buffer.concat([Buffer.from("MYCO1"), h2]);
+  let msg = Buffer.concat([Buffer.from("MYCO1"), h2]);
+  if (batch) {
+    const root = merkleRoot(h2, x);
+    if (!root) return { ok: false, reason: "bad batch proof" };
+    msg = Buffer.concat([Buffer.from("MYCO1B"), root]);
+  }
   const ok = await verify(new Uint8Array(sig), new Uint8Array(msg), pubKeyU8);
   return ok ? { ok: true } : { ok: false, reason: "bad signature" };
 }
@@ -0,0 +1,219 @@
+// fci_fft_bench — speed and accuracy of the FCI firmware's real FFT engine
+// (firmware/MycoBrain_FCI fci_fft) at the sizes the spectral features use.
+//
+//   fci_fft_bench
+//   fci_fft_bench --sizes 256,1024,4096 --ms 500
+//
+// For each size the same random signal (white noise plus two tones) goes
+// through:
+//   float     FCIRealFFT::forward (SSE2 / NEON / scalar butterflies)
+//   q15       FCIRealFFT::forwardQ15
+//   baseline  an n-point complex radix-2 FFT with split re/im arrays and
+//             recurrence twiddles, the way arduinoFFT computes it
+// and is checked against a double-precision DFT: float_err is the RMS error
+// relative to the RMS spectrum, q15_snr_db the SNR of the Q15 result (scaled
+// back by n). ns figures are the median of repeated timed batches; mflops
+// uses the usual 2.5 n log2(n) count for a real transform. One NDJSON line
+// per size.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <fci_fft.h>
+
+static double nowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static std::vector<double> parseList(const char* s) {
+  std::vector<double> v;
+  while (*s) {
+    char* end;
+    double x = strtod(s, &end);
+    if (end == s) break;
+    v.push_back(x);
+    s = *end == ',' ? end + 1 : end;
+  }
+  return v;
+}
+
+// arduinoFFT-style complex FFT: bit-reverse, then stages with the twiddle
+// advanced by a rotation recurrence. imag must be zeroed by the caller.
+static void baselineFFT(float* re, float* im, size_t n) {
+  for (size_t i = 0, j = 0; i < n - 1; i++) {
+    if (i < j) {
+      std::swap(re[i], re[j]);
+      std::swap(im[i], im[j]);
+    }
+    size_t k = n >> 1;
+    while (k <= j) { j -= k; k >>= 1; }
+    j += k;
+  }
+  double c = -1.0, s = 0.0;
+  for (size_t l2 = 1; l2 < n; l2 <<= 1) {
+    const size_t l1 = l2, step = l2 << 1;
+    double u1 = 1.0, u2 = 0.0;
+    for (size_t j = 0; j < l1; j++) {
+      for (size_t i = j; i < n; i += step) {
+        size_t i1 = i + l1;
+        float t1 = (float)(u1 * re[i1] - u2 * im[i1]);
+        float t2 = (float)(u1 * im[i1] + u2 * re[i1]);
+        re[i1] = re[i] - t1;
+        im[i1] = im[i] - t2;
+        re[i] += t1;
+        im[i] += t2;
+      }
+      double z = u1 * c - u2 * s;
+      u2 = u1 * s + u2 * c;
+      u1 = z;
+    }
+    s = -sqrt((1.0 - c) / 2.0);
+    c = sqrt((1.0 + c) / 2.0);
+  }
+}
+
+// Reference X[k], k = 0 .. n/2, in double.
+static void referenceDFT(const std::vector<float>& x, std::vector<double>& re, std::vector<double>& im) {
+  const size_t n = x.size();
+  re.assign(n / 2 + 1, 0.0);
+  im.assign(n / 2 + 1, 0.0);
+  for (size_t k = 0; k <= n / 2; k++) {
+    double sr = 0, si = 0;
+    for (size_t t = 0; t < n; t++) {
+      double a = -2.0 * M_PI * (double)((k * t) % n) / (double)n;
+      sr += x[t] * cos(a);
+      si += x[t] * sin(a);
+    }
+    re[k] = sr;
+    im[k] = si;
+  }
+}
+
+// Median ns per call of fn() over batches lasting ~ms in total.
+template <typename Fn>
+static double timeIt(Fn fn, double ms) {
+  size_t reps = 1;
+  for (;;) {
+    double t0 = nowNs();
+    for (size_t r = 0; r < reps; r++) fn();
+    if (nowNs() - t0 > 2e6 || reps > (1u << 24)) break;
+    reps <<= 1;
+  }
+  std::vector<double> per;
+  double start = nowNs();
+  while (per.size() < 5 || (nowNs() - start < ms * 1e6 && per.size() < 1000)) {
+    double t0 = nowNs();
+    for (size_t r = 0; r < reps; r++) fn();
+    per.push_back((nowNs() - t0) / (double)reps);
+  }
+  std::sort(per.begin(), per.end());
+  return per[per.size() / 2];
+}
+
+int main(int argc, char** argv) {
+  std::vector<double> sizes = { 256, 512, 1024, 2048, 4096 };
+  double ms = 300;
+  uint64_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--sizes") && v) { sizes = parseList(v); i++; }
+    else if (!strcmp(a, "--ms") && v) { ms = atof(v); i++; }
+    else if (!strcmp(a, "--seed") && v) { seed = strtoull(v, nullptr, 0); i++; }
+    else {
+      fprintf(stderr, "usage: %s [--sizes L] [--ms N] [--seed N]\n"
+                      "  L = comma-separated powers of 2 in [%d, %d]\n",
+              argv[0], FCI_FFT_MIN_SIZE, FCI_FFT_MAX_SIZE);
+      return 2;
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::normal_distribution<double> noise(0.0, 0.1);
+  int rc = 0;
+
+  for (double sd : sizes) {
+    const size_t n = (size_t)sd;
+    FCIRealFFT fft;
+    if (!fft.begin(n)) {
+      fprintf(stderr, "{\"error\":\"bad size\",\"n\":%zu}\n", n);
+      return 2;
+    }
+
+    // Tones at bins n/16 and n/5 + 0.3 (leaky), plus noise; |x| < 1
+    std::vector<float> x(n);
+    for (size_t t = 0; t < n; t++) {
+      double v = 0.4 * sin(2.0 * M_PI * (double)t / 16.0) +
+                 0.3 * cos(2.0 * M_PI * ((double)n / 5.0 + 0.3) * (double)t / (double)n) +
+                 noise(rng);
+      x[t] = (float)std::max(-0.99, std::min(0.99, v));
+    }
+    std::vector<double> rre, rim;
+    referenceDFT(x, rre, rim);
+    auto refAt = [&](size_t k, double* re, double* im) { *re = rre[k]; *im = rim[k]; };
+    auto packedAt = [&](const std::vector<double>& p, size_t k, double* re, double* im) {
+      if (k == 0) { *re = p[0]; *im = 0; }
+      else if (k == n / 2) { *re = p[1]; *im = 0; }
+      else { *re = p[2 * k]; *im = p[2 * k + 1]; }
+    };
+
+    // Accuracy
+    std::vector<float> buf(x);
+    fft.forward(buf.data());
+    std::vector<int16_t> q(n);
+    for (size_t t = 0; t < n; t++) q[t] = (int16_t)lround(x[t] * 32767.0);
+    std::vector<int16_t> qbuf(q);
+    fft.forwardQ15(qbuf.data());
+
+    std::vector<double> pf(buf.begin(), buf.end()), pq(n);
+    for (size_t t = 0; t < n; t++) pq[t] = (double)qbuf[t] * (double)n / 32767.0;
+    double sig = 0, errF = 0, errQ = 0;
+    for (size_t k = 0; k <= n / 2; k++) {
+      double r0, i0, r1, i1, r2, i2;
+      refAt(k, &r0, &i0);
+      packedAt(pf, k, &r1, &i1);
+      packedAt(pq, k, &r2, &i2);
+      sig += r0 * r0 + i0 * i0;
+      errF += (r1 - r0) * (r1 - r0) + (i1 - i0) * (i1 - i0);
+      errQ += (r2 - r0) * (r2 - r0) + (i2 - i0) * (i2 - i0);
+    }
+    const double floatErr = sqrt(errF / sig);
+    const double q15Snr = 10.0 * log10(sig / errQ);
+    if (floatErr > 1e-5 || q15Snr < 40.0) rc = 1;
+
+    // Speed
+    std::vector<float> work(n), re(n), im(n);
+    std::vector<int16_t> qwork(n);
+    double nsFloat = timeIt([&] {
+      memcpy(work.data(), x.data(), n * sizeof(float));
+      fft.forward(work.data());
+    }, ms);
+    double nsQ15 = timeIt([&] {
+      memcpy(qwork.data(), q.data(), n * sizeof(int16_t));
+      fft.forwardQ15(qwork.data());
+    }, ms);
+    double nsBase = timeIt([&] {
+      memcpy(re.data(), x.data(), n * sizeof(float));
+      memset(im.data(), 0, n * sizeof(float));
+      baselineFFT(re.data(), im.data(), n);
+    }, ms);
+
+    const double flops = 2.5 * (double)n * log2((double)n);
+    printf("{\"n\":%zu,\"backend\":\"%s\",\"float_ns\":%.0f,\"float_mflops\":%.0f,"
+           "\"q15_ns\":%.0f,\"baseline_ns\":%.0f,\"speedup\":%.2f,"
+           "\"float_err\":%.2e,\"q15_snr_db\":%.1f}\n",
+           n, fft.backend(), nsFloat, flops / nsFloat * 1e3, nsQ15, nsBase,
+           nsBase / nsFloat, floatErr, q15Snr);
+    fflush(stdout);
+  }
+  return rc;
+}
@@ -0,0 +1,480 @@
+// mdp_arq_bench — goodput, retransmission ratio and delivery latency of the
+// firmware's retransmit queue (firmware/common/mdp_arq) over an emulated
+// lossy link (mdp_link_emu).
+//
+//   mdp_arq_bench --preset side_b_lora --loss 0,0.05,0.1,0.2 --rto-ms 900,1800,3600
+//   mdp_arq_bench --preset side_a --burst 0.01 --burst-len 20 --seconds 600
+//
+// Endpoint A originates messages (--rate per second, --size bytes including
+// the 16-byte MDP header); endpoint B handles them exactly as the MDP v1
+// firmware receivers do and can send its own reliable traffic back
+// (--rev-rate):
+//   - every frame is acted on; the first copy of a seq counts as delivered,
+//     whatever its order;
+//   - the cumulative ack only advances in order, so a message the sender gave
+//     up on stalls it for good (reported as ack_stalled);
+//   - ACK-only frames take a seq. Side-A and Side-B queue them for
+//     retransmission (Side-A also asks for an ACK back); the gateway sends
+//     them once.
+// Frames are real COBS/CRC frames, so --corrupt exercises the CRC path.
+//
+// Presets mirror the firmware constants:
+//   side_a       Side-A -> Side-B over UART 115200, RTO 120 ms, 8 retries, 6 slots
+//   side_b_uart  Side-B -> Side-A commands over UART, RTO 120 ms, 5 retries, 8 slots
+//   side_b_lora  Side-B -> gateway over SX1262 SF9/125k/4:7, RTO 1800 ms, 8 slots
+//   side_b_wifi  Side-B -> gateway over UDP (WIFI_RTO_MS 500), 8 slots
+//   gateway      gateway -> Side-B commands over LoRa, RTO 1800 ms, 4 slots
+//
+// List-valued options (--rto-ms, --retries, --slots, --loss, --burst, --rate) are swept as a cartesian product; each combination prints one NDJSON
+// line on stdout. After --seconds of traffic the queues drain (no new
+// messages) so "lost" means given up on, not still in flight.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#include <mdp_arq.h>
+#include <mdp_types.h>
+#include <mdp_utils.h>
+
+#include "mdp_link_emu.h"
+#include "mdp_stats.h"
+
+static constexpr uint64_t MS = 1000000ull;
+static constexpr uint64_t SEC = 1000000000ull;
+static constexpr size_t MAX_PAYLOAD = 900;
+static constexpr size_t MAX_FRAME = 1200;
+
+// How an endpoint sends ACK-only frames (sendAckToA / sendAckToB / mdpSendAckOnly).
+enum AckMode : uint8_t {
+  ACK_ONCE,          // gateway: takes a seq, sent once
+  ACK_QUEUED,        // Side-B: takes a seq, retransmitted until acked
+  ACK_UNSEQ,         // Side-A: seq 0, sent once
+};
+
+struct Preset {
+  const char* name;
+  uint32_t rtoMs;
+  uint8_t  retries;
+  uint8_t  slots;
+  double   rate;          // A -> B messages/s
+  uint16_t size;
+  double   revRate;       // B -> A messages/s
+  uint16_t revSize;
+  uint8_t  epA, epB;
+  AckMode  ackA, ackB;
+  bool     lora;
+  uint32_t baud;
+  double   latencyMs, jitterMs;
+  double   loss;
+};
+
+static const Preset PRESETS[] = {
+  {"side_a",      120,  8, 6, 1.0,  560, 0.02, 24, EP_SIDE_A,  EP_SIDE_B,  ACK_UNSEQ,      ACK_QUEUED,     false, 115200, 0, 0,  0.001},
+  {"side_b_uart", 120,  5, 8, 0.05, 24,  1.0, 560, EP_SIDE_B,  EP_SIDE_A,  ACK_QUEUED,     ACK_UNSEQ,      false, 115200, 0, 0,  0.001},
+  {"side_b_lora", 1800, 5, 8, 0.2,  56,  0.02, 24, EP_SIDE_B,  EP_GATEWAY, ACK_QUEUED,     ACK_ONCE,       true,  0,      0, 0,  0.02},
+  {"side_b_wifi", 500,  5, 8, 1.0,  560, 0.02, 24, EP_SIDE_B,  EP_GATEWAY, ACK_QUEUED,     ACK_ONCE,       false, 0,      3, 30, 0.01},
+  {"gateway",     1800, 5, 4, 0.02, 24,  0.2,  56, EP_GATEWAY, EP_SIDE_B,  ACK_ONCE,       ACK_QUEUED,     true,  0,      0, 0,  0.02},
+};
+
+struct Run {
+  const Preset* p;
+  uint32_t rtoMs;
+  uint32_t retries;
+  uint32_t slots;
+  double   loss, lossBa;
+  double   burst, burstLen, burstLoss;
+  double   rate, revRate;
+  uint16_t size, revSize;
+  double   seconds;
+  bool     poisson;
+  MdpLinkDirCfg link;   // loss/GE fields filled per direction
+  bool     halfDuplex;
+  uint64_t seed;
+};
+
+struct Endpoint {
+  int      dir = 0;             // direction this endpoint transmits on
+  uint8_t  ep = 0, peerEp = 0;
+  uint32_t txSeq = 1;
+  AckMode  ackMode = ACK_ONCE;
+  mdp_arq_t q;
+  std::vector<mdp_arq_slot_t> slots;
+  std::vector<uint8_t> pool;
+  std::vector<uint64_t> slotOrigin;
+  mdp_arq_rx_t rx;
+  std::unordered_map<uint32_t, uint64_t> origin;   // seq -> originate time, until delivered
+
+  double   rate = 0;
+  uint16_t size = 0;
+  uint64_t nextMsg = UINT64_MAX;
+
+  uint64_t offered = 0, delivered = 0, deliveredBytes = 0;
+  uint64_t framesTx = 0, acksTx = 0, crcBad = 0;
+  uint64_t dupActed = 0;        // repeat copies of a message acted on again
+  MdpLatency delivery;          // originate -> first receipt at the peer
+  MdpLatency ackRtt;            // originate -> freed by the peer's cumulative ack
+};
+
+static struct {
+  MdpLinkEmu* link = nullptr;
+  Endpoint e[2];
+  uint64_t now = 0;
+  uint64_t rng = 0;
+} g;
+
+static double rndU() {
+  uint64_t x = g.rng;
+  x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+  g.rng = x;
+  return (double)((x * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint32_t nowMs() { return (uint32_t)(g.now / MS); }
+
+static void sendRaw(Endpoint& e, const uint8_t* payload, uint16_t len) {
+  static uint8_t frame[MAX_FRAME];
+  size_t n = mdp_build_frame(payload, len, frame, sizeof(frame));
+  if (!n) return;
+  e.framesTx++;
+  g.link->send(e.dir, g.now, frame, n);
+}
+
+static bool arqSend(void* ctx, const uint8_t* payload, uint16_t len) {
+  sendRaw(*(Endpoint*)ctx, payload, len);
+  return true;
+}
+
+static void arqAcked(void* ctx, const mdp_arq_slot_t* it) {
+  Endpoint& e = *(Endpoint*)ctx;
+  if (((const mdp_hdr_v1_t*)it->payload)->msg_type == MDP_ACK) return;
+  e.ackRtt.add(g.now - e.slotOrigin[(size_t)(it - e.slots.data())]);
+}
+
+static void fillHdr(mdp_hdr_v1_t* h, uint8_t type, uint32_t seq, uint32_t ack, uint8_t flags,
+                    uint8_t src, uint8_t dst) {
+  h->magic = MDP_MAGIC;
+  h->version = MDP_VER;
+  h->msg_type = type;
+  h->seq = seq;
+  h->ack = ack;
+  h->flags = flags;
+  h->src = src;
+  h->dst = dst;
+  h->rsv = 0;
+}
+
+static void originate(Endpoint& e) {
+  uint8_t out[MAX_PAYLOAD];
+  auto* h = (mdp_hdr_v1_t*)out;
+  fillHdr(h, MDP_TELEMETRY, e.txSeq, e.rx.last_inorder, ACK_REQUESTED, e.ep, e.peerEp);
+  uint16_t len = e.size < sizeof(*h) ? (uint16_t)sizeof(*h) : e.size;
+  for (uint16_t i = sizeof(*h); i < len; i++) {
+    // Some zeros so COBS overhead is realistic.
+    out[i] = (i % 7 == 0) ? 0 : (uint8_t)(e.txSeq * 31u + i);
+  }
+  e.offered++;
+  // Like the firmware: a rejected message is skipped without consuming a seq.
+  if (!mdp_arq_send(&e.q, out, len, e.txSeq, nowMs())) return;
+  for (size_t i = 0; i < e.slots.size(); i++) {
+    if (e.slots[i].used && e.slots[i].seq == e.txSeq) e.slotOrigin[i] = g.now;
+  }
+  e.origin[e.txSeq] = g.now;
+  e.txSeq++;
+}
+
+static void sendAck(Endpoint& e) {
+  uint8_t out[sizeof(mdp_hdr_v1_t)];
+  uint32_t seq = e.ackMode == ACK_UNSEQ ? 0 : e.txSeq++;
+  fillHdr((mdp_hdr_v1_t*)out, MDP_ACK, seq, e.rx.last_inorder, IS_ACK, e.ep, e.peerEp);
+  e.acksTx++;
+  if (e.ackMode != ACK_QUEUED || !mdp_arq_send(&e.q, out, sizeof(out), seq, nowMs())) {
+    sendRaw(e, out, sizeof(out));
+  }
+}
+
+// Firmware receive path (handleFromA / handleFromGW / handleMdpPayload).
+static void onFrame(Endpoint& self, Endpoint& peer, const uint8_t* frame, size_t len) {
+  static uint8_t p[MAX_FRAME];
+  size_t plen = mdp_decode_frame(frame, len, p, sizeof(p));
+  if (plen < sizeof(mdp_hdr_v1_t)) { self.crcBad++; return; }
+  auto* h = (const mdp_hdr_v1_t*)p;
+  if (h->magic != MDP_MAGIC || h->version != MDP_VER) { self.crcBad++; return; }
+
+  mdp_arq_on_ack(&self.q, h->ack);
+
+  (void)mdp_arq_rx_accept(&self.rx, h->seq);
+  if (h->flags & ACK_REQUESTED) sendAck(self);
+  if (h->msg_type == MDP_ACK) return;
+
+  auto it = peer.origin.find(h->seq);
+  if (it == peer.origin.end()) { self.dupActed++; return; }
+  peer.delivery.add(g.now - it->second);
+  peer.delivered++;
+  peer.deliveredBytes += plen;
+  peer.origin.erase(it);
+}
+
+static uint64_t interArrival(double rate, bool poisson) {
+  if (rate <= 0) return UINT64_MAX;
+  double s = poisson ? -log(1.0 - rndU()) / rate : 1.0 / rate;
+  return (uint64_t)(s * 1e9);
+}
+
+static void initEndpoint(Endpoint& e, int dir, uint8_t ep, uint8_t peerEp, AckMode ackMode,
+                         const Run& r, double rate, uint16_t size) {
+  e = Endpoint();
+  e.dir = dir;
+  e.ep = ep;
+  e.peerEp = peerEp;
+  e.ackMode = ackMode;
+  e.rate = rate;
+  e.size = size > MAX_PAYLOAD ? (uint16_t)MAX_PAYLOAD : size;
+  e.slots.resize(r.slots);
+  e.pool.resize((size_t)r.slots * MAX_PAYLOAD);
+  e.slotOrigin.resize(r.slots);
+  const mdp_arq_cfg_t c = { r.rtoMs, (uint8_t)r.retries };
+  mdp_arq_init(&e.q, e.slots.data(), (uint8_t)r.slots, e.pool.data(), MAX_PAYLOAD, &c, arqSend, &e);
+  e.q.on_acked = arqAcked;
+  mdp_arq_rx_init(&e.rx);
+}
+
+static void printDir(const char* key, const MdpLinkDirStats& s, double secs) {
+  printf("\"%s\":{\"frames\":%llu,\"delivered\":%llu,\"lost\":%llu,\"lost_burst\":%llu,"
+         "\"collided\":%llu,\"queue_drop\":%llu,\"oversize\":%llu,\"overflow\":%llu,\"corrupted\":%llu,"
+         "\"duplicated\":%llu,\"reordered\":%llu,\"util_pct\":%.2f}",
+         key, (unsigned long long)s.offered, (unsigned long long)s.delivered,
+         (unsigned long long)s.lost, (unsigned long long)s.lost_burst,
+         (unsigned long long)s.collided, (unsigned long long)s.queue_drop,
+         (unsigned long long)s.oversize, (unsigned long long)s.overflow,
+         (unsigned long long)s.corrupted,
+         (unsigned long long)s.duplicated, (unsigned long long)s.reordered,
+         secs > 0 ? 100.0 * (double)s.air_ns / 1e9 / secs : 0.0);
+}
+
+static void runOne(const Run& r) {
+  MdpLinkDirCfg ab = r.link, ba = r.link;
+  ab.loss = r.loss;
+  ba.loss = r.lossBa >= 0 ? r.lossBa : r.loss;
+  ab.ge_p_gb = ba.ge_p_gb = r.burst;
+  ab.ge_p_bg = ba.ge_p_bg = r.burstLen > 1 ? 1.0 / r.burstLen : 1.0;
+  ab.ge_loss_bad = ba.ge_loss_bad = r.burstLoss;
+  MdpLinkEmu link(ab, ba, r.halfDuplex, r.seed);
+  g.link = &link;
+  g.now = 0;
+  g.rng = r.seed * 0x9E3779B97F4A7C15ull + 1;
+
+  Endpoint& a = g.e[0];
+  Endpoint& b = g.e[1];
+  initEndpoint(a, 0, r.p->epA, r.p->epB, r.p->ackA, r, r.rate, r.size);
+  initEndpoint(b, 1, r.p->epB, r.p->epA, r.p->ackB, r, r.revRate, r.revSize);
+  a.nextMsg = interArrival(a.rate, r.poisson) / 2;
+  b.nextMsg = interArrival(b.rate, r.poisson) / 2 + 7 * MS;
+
+  const uint64_t stopAt = (uint64_t)(r.seconds * 1e9);
+  const uint64_t drainAt = stopAt + (uint64_t)(r.retries + 2) * r.rtoMs * MS + 5 * SEC;
+  std::vector<uint8_t> frame;
+
+  for (;;) {
+    uint64_t t = link.nextDelivery();
+    for (Endpoint* e : {&a, &b}) {
+      if (e->nextMsg < t) t = e->nextMsg;
+      uint32_t due = mdp_arq_next_due(&e->q, nowMs());
+      if (due != UINT32_MAX) {
+        uint64_t td = ((uint64_t)nowMs() + due) * MS;
+        if (td < g.now) td = g.now;
+        if (td < t) t = td;
+      }
+    }
+    if (t == UINT64_MAX || t > drainAt) break;
+    g.now = t;
+
+    int dir;
+    while (link.poll(g.now, &dir, &frame)) {
+      if (dir == 0) onFrame(b, a, frame.data(), frame.size());
+      else onFrame(a, b, frame.data(), frame.size());
+    }
+    for (Endpoint* e : {&a, &b}) {
+      if (e->nextMsg <= g.now) {
+        if (g.now < stopAt) {
+          originate(*e);
+          e->nextMsg = g.now + interArrival(e->rate, r.poisson);
+        } else {
+          e->nextMsg = UINT64_MAX;
+        }
+      }
+      mdp_arq_pump(&e->q, nowMs());
+    }
+  }
+
+  const MdpLinkDirStats& sab = link.stats(0);
+  const MdpLinkDirStats& sba = link.stats(1);
+  double secs = r.seconds;
+  // Queued messages never delivered (origin entries go on first receipt), and
+  // seqs the peer's cumulative ack never reached.
+  uint64_t lost = a.origin.size();
+  uint32_t stalled = a.txSeq - 1 > b.rx.last_inorder ? a.txSeq - 1 - b.rx.last_inorder : 0;
+  uint64_t airBytes = sab.bytes + sba.bytes;
+
+  printf("{\"preset\":\"%s\",\"rto_ms\":%u,\"retries\":%u,\"slots\":%u,"
+         "\"loss\":%.4f,\"loss_ba\":%.4f,\"burst\":%.4f,\"burst_len\":%.1f,\"rate\":%.3f,"
+         "\"size\":%u,\"seconds\":%.0f,",
+         r.p->name, r.rtoMs, r.retries, r.slots, ab.loss, ba.loss, r.burst,
+         r.burstLen, r.rate, a.size, secs);
+  printf("\"offered\":%llu,\"queue_full\":%llu,\"delivered\":%llu,\"delivery_pct\":%.3f,"
+         "\"lost\":%llu,\"expired\":%u,\"ack_stalled\":%u,\"goodput_bps\":%.1f,"
+         "\"efficiency_pct\":%.2f,\"retx_ratio\":%.4f,\"frames_per_msg\":%.3f,"
+         "\"rx_dups\":%u,\"rx_gaps\":%u,\"dup_acted\":%llu,\"crc_bad\":%llu,",
+         (unsigned long long)a.offered, (unsigned long long)a.q.stats.queue_full,
+         (unsigned long long)a.delivered,
+         a.offered ? 100.0 * (double)a.delivered / (double)a.offered : 0.0,
+         (unsigned long long)lost, a.q.stats.expired, stalled,
+         secs > 0 ? (double)a.deliveredBytes * 8.0 / secs : 0.0,
+         airBytes ? 100.0 * (double)(a.deliveredBytes + b.deliveredBytes) / (double)airBytes : 0.0,
+         a.q.stats.sent ? (double)a.q.stats.retransmits / (double)a.q.stats.sent : 0.0,
+         a.delivered ? (double)(a.q.stats.sent + a.q.stats.retransmits + b.acksTx) /
+                           (double)a.delivered : 0.0,
+         b.rx.dups, b.rx.gaps, (unsigned long long)b.dupActed, (unsigned long long)b.crcBad);
+  a.delivery.printJson(stdout, "delivery_latency");
+  printf(",");
+  a.ackRtt.printJson(stdout, "ack_rtt");
+  printf(",\"reverse\":{\"offered\":%llu,\"delivered\":%llu,\"retx_ratio\":%.4f,\"expired\":%u},",
+         (unsigned long long)b.offered, (unsigned long long)b.delivered,
+         b.q.stats.sent ? (double)b.q.stats.retransmits / (double)b.q.stats.sent : 0.0,
+         b.q.stats.expired);
+  printf("\"link\":{");
+  printDir("ab", sab, secs);
+  printf(",");
+  printDir("ba", sba, secs);
+  printf("}}\n");
+  fflush(stdout);
+  g.link = nullptr;
+}
+
+static std::vector<double> parseList(const char* s) {
+  std::vector<double> v;
+  while (*s) {
+    char* end;
+    double x = strtod(s, &end);
+    if (end == s) break;
+    v.push_back(x);
+    s = *end == ',' ? end + 1 : end;
+  }
+  return v;
+}
+
+int main(int argc, char** argv) {
+  const Preset* p = &PRESETS[0];
+  std::vector<double> rto, retries, slots, loss, burst, rate;
+  double lossBa = -1, burstLen = 10, burstLoss = 1.0, revRate = -1;
+  double latencyMs = -1, jitterMs = -1, reorder = 0, reorderMs = 200, dup = 0, corrupt = 0;
+  double seconds = 3600, bw = 125.0;
+  int size = -1, revSize = -1, sf = 9, cr = 7;
+  long baud = -1;
+  uint64_t seed = 1;
+  bool poisson = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--preset") && v) {
+      p = nullptr;
+      for (auto& pr : PRESETS) if (!strcmp(pr.name, v)) p = &pr;
+      if (!p) { fprintf(stderr, "{\"error\":\"unknown preset\",\"preset\":\"%s\"}\n", v); return 2; }
+      i++;
+    }
+    else if (!strcmp(a, "--rto-ms") && v) { rto = parseList(v); i++; }
+    else if (!strcmp(a, "--retries") && v) { retries = parseList(v); i++; }
+    else if (!strcmp(a, "--slots") && v) { slots = parseList(v); i++; }
+    else if (!strcmp(a, "--loss") && v) { loss = parseList(v); i++; }
+    else if (!strcmp(a, "--loss-ba") && v) { lossBa = atof(v); i++; }
+    else if (!strcmp(a, "--burst") && v) { burst = parseList(v); i++; }
+    else if (!strcmp(a, "--burst-len") && v) { burstLen = atof(v); i++; }
+    else if (!strcmp(a, "--burst-loss") && v) { burstLoss = atof(v); i++; }
+    else if (!strcmp(a, "--rate") && v) { rate = parseList(v); i++; }
+    else if (!strcmp(a, "--size") && v) { size = atoi(v); i++; }
+    else if (!strcmp(a, "--rev-rate") && v) { revRate = atof(v); i++; }
+    else if (!strcmp(a, "--rev-size") && v) { revSize = atoi(v); i++; }
+    else if (!strcmp(a, "--latency-ms") && v) { latencyMs = atof(v); i++; }
+    else if (!strcmp(a, "--jitter-ms") && v) { jitterMs = atof(v); i++; }
+    else if (!strcmp(a, "--reorder") && v) { reorder = atof(v); i++; }
+    else if (!strcmp(a, "--reorder-ms") && v) { reorderMs = atof(v); i++; }
+    else if (!strcmp(a, "--dup") && v) { dup = atof(v); i++; }
+    else if (!strcmp(a, "--corrupt") && v) { corrupt = atof(v); i++; }
+    else if (!strcmp(a, "--baud") && v) { baud = atol(v); i++; }
+    else if (!strcmp(a, "--sf") && v) { sf = atoi(v); i++; }
+    else if (!strcmp(a, "--bw") && v) { bw = atof(v); i++; }
+    else if (!strcmp(a, "--cr") && v) { cr = atoi(v); i++; }
+    else if (!strcmp(a, "--seconds") && v) { seconds = atof(v); i++; }
+    else if (!strcmp(a, "--seed") && v) { seed = strtoull(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--poisson")) poisson = true;
+    else {
+      fprintf(stderr,
+              "usage: %s [--preset side_a|side_b_uart|side_b_lora|side_b_wifi|gateway]\n"
+              "       [--rto-ms L] [--retries L] [--slots L] [--loss L] [--burst L]\n"
+              "       [--rate L] [--loss-ba P] [--burst-len N] [--burst-loss P] [--size N]\n"
+              "       [--rev-rate N] [--rev-size N] [--latency-ms N] [--jitter-ms N]\n"
+              "       [--reorder P] [--reorder-ms N] [--dup P] [--corrupt P] [--baud N]\n"
+              "       [--sf N] [--bw KHZ] [--cr 5..8] [--seconds S] [--seed N] [--poisson]\n"
+              "  L = comma-separated list, swept\n", argv[0]);
+      return 2;
+    }
+  }
+  if (sf < 6 || sf > 12 || cr < 5 || cr > 8 || seconds <= 0) {
+    fprintf(stderr, "{\"error\":\"bad arguments\"}\n");
+    return 2;
+  }
+
+  if (rto.empty()) rto.push_back(p->rtoMs);
+  if (retries.empty()) retries.push_back(p->retries);
+  if (slots.empty()) slots.push_back(p->slots);
+  if (loss.empty()) loss.push_back(p->loss);
+  if (burst.empty()) burst.push_back(0);
+  if (rate.empty()) rate.push_back(p->rate);
+
+  Run r{};
+  r.p = p;
+  r.lossBa = lossBa;
+  r.burstLen = burstLen;
+  r.burstLoss = burstLoss;
+  r.revRate = revRate >= 0 ? revRate : p->revRate;
+  r.size = (uint16_t)(size >= 0 ? size : p->size);
+  r.revSize = (uint16_t)(revSize >= 0 ? revSize : p->revSize);
+  r.seconds = seconds;
+  r.poisson = poisson;
+  r.seed = seed;
+  r.halfDuplex = p->lora;
+  r.link.latency_ms = latencyMs >= 0 ? latencyMs : p->latencyMs;
+  r.link.jitter_ms = jitterMs >= 0 ? jitterMs : p->jitterMs;
+  r.link.reorder = reorder;
+  r.link.reorder_ms = reorderMs;
+  r.link.dup = dup;
+  r.link.corrupt = corrupt;
+  if (p->lora) {
+    r.link.lora_sf = sf;
+    r.link.lora_bw_khz = bw;
+    r.link.lora_cr = cr;
+    r.link.mtu = 255;
+  } else {
+    r.link.baud = (uint32_t)(baud >= 0 ? baud : p->baud);
+  }
+
+  for (double rt : rto)
+    for (double rr : retries)
+      for (double sl : slots)
+        for (double ls : loss)
+          for (double bu : burst)
+            for (double ra : rate) {
+              r.rtoMs = (uint32_t)rt;
+              r.retries = rr < 0 ? 0 : (rr > 255 ? 255 : (uint32_t)rr);
+              r.slots = sl < 1 ? 1 : (sl > 255 ? 255 : (uint32_t)sl);
+              r.loss = ls;
+              r.burst = bu;
+              r.rate = ra;
+              runOne(r);
+            }
+  return 0;
+}
@@ -0,0 +1,91 @@
+// mdp_capture — record raw timestamped bytes from an MDP link into a
+// .mdpcap file for mdp_replay.
+//
+//   mdp_capture --port /dev/ttyTHS1 --out run.mdpcap [--baud 115200]
+//               [--link uart|lora|udp|ble|sim] [--seconds N]
+//
+// Bytes are stored exactly as read() returned them (no framing), so bad CRCs,
+// partial frames and line noise replay the same way they arrived.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mdp_capture.h"
+#include "mdp_host_io.h"
+#include "mdp_shm_bus.h"
+
+static volatile sig_atomic_t running = 1;
+static void onSignal(int) { running = 0; }
+
+int main(int argc, char** argv) {
+  const char* port = nullptr;
+  const char* out = nullptr;
+  uint32_t baud = 115200;
+  uint8_t link = MDP_LINK_UART;
+  double seconds = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--port") && v) { port = v; i++; }
+    else if (!strcmp(a, "--out") && v) { out = v; i++; }
+    else if (!strcmp(a, "--baud") && v) { baud = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--link") && v) { link = mdp_link_from_name(v); i++; }
+    else if (!strcmp(a, "--seconds") && v) { seconds = atof(v); i++; }
+    else {
+      fprintf(stderr, "usage: %s --port <tty|-> --out file.mdpcap [--baud N] "
+                      "[--link uart|lora|udp|ble|sim] [--seconds N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!port || !out) {
+    fprintf(stderr, "{\"error\":\"missing --port/--out\"}\n");
+    return 2;
+  }
+
+  int fd = mdp_open_serial(port, baud);
+  if (fd < 0) {
+    fprintf(stderr, "{\"error\":\"open\",\"port\":\"%s\",\"errno\":%d}\n", port, errno);
+    return 1;
+  }
+  FILE* f = mdp_cap_create(out, link, MDP_CAP_DIR_RX, baud);
+  if (!f) {
+    fprintf(stderr, "{\"error\":\"create\",\"out\":\"%s\",\"errno\":%d}\n", out, errno);
+    return 1;
+  }
+
+  mdp_on_stop_signal(onSignal);
+
+  const uint64_t t0 = mdp_shm_now_ns();
+  const uint64_t limit = seconds > 0 ? (uint64_t)(seconds * 1e9) : 0;
+  uint64_t records = 0, bytes = 0;
+  uint8_t rx[4096];
+
+  while (running) {
+    ssize_t n = read(fd, rx, sizeof(rx));
+    uint64_t t = mdp_shm_now_ns() - t0;
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (n == 0) break;
+    if (!mdp_cap_write(f, t, rx, (uint32_t)n)) {
+      fprintf(stderr, "{\"error\":\"write\",\"errno\":%d}\n", errno);
+      break;
+    }
+    records++;
+    bytes += (uint64_t)n;
+    if (limit && t >= limit) break;
+  }
+
+  fclose(f);
+  if (fd != STDIN_FILENO) close(fd);
+  fprintf(stderr, "{\"records\":%llu,\"bytes\":%llu,\"seconds\":%.3f}\n",
+          (unsigned long long)records, (unsigned long long)bytes,
+          (double)(mdp_shm_now_ns() - t0) / 1e9);
+  return 0;
+}
@@ -0,0 +1,428 @@
+// mdp_replay — drive the MDP receive path from a .mdpcap capture.
+//
+// Two targets:
+//   decode (default)  in-process: the firmware's splitter rules,
+//                     mdp_decode_frame and the gateway's receive-side ARQ
+//                     bookkeeping. Latency = scheduled arrival -> decoded.
+//   pty               bytes go out a pseudo-terminal to a host daemon
+//                     (e.g. mdp_shm_pub). With --bus, delivery is observed on
+//                     the shared-memory bus and latency is end-to-end:
+//                     scheduled arrival -> visible to a bus consumer.
+//
+// Timing: --speed 1 replays at original timing, --speed N at N x, --speed 0
+// (or --fast) as fast as the target accepts bytes. --loop N repeats the
+// capture back to back for longer runs.
+//
+//   mdp_replay --in run.mdpcap [--speed N|--fast] [--loop N] [--print]
+//   mdp_replay --in run.mdpcap --pty [--exec "cmd {pty}"] [--bus /name]
+//              [--wait-ms 5000] [--drain-ms 500]
+//
+// The summary is one JSON object on stderr so runs can be diffed between
+// versions.
+
+#include <atomic>
+#include <deque>
+#include <errno.h>
+#include <fcntl.h>
+#include <mutex>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include <mdp_types.h>
+#include <mdp_utils.h>
+
+#include "mdp_capture.h"
+#include "mdp_host_io.h"
+#include "mdp_shm_bus.h"
+#include "mdp_stats.h"
+
+static volatile sig_atomic_t running = 1;
+static void onSignal(int) { running = 0; }
+
+struct Record {
+  uint64_t t_ns;
+  size_t   off;
+  uint32_t len;
+};
+
+// Receive-side ARQ bookkeeping, per source endpoint, mirroring the gateway's
+// handleFromB(): in-order advance only on seq == last + 1, ACK on request.
+struct RxModel {
+  uint32_t last_inorder[256] = {};
+  uint32_t peer_ack[256] = {};
+  uint64_t inorder = 0;
+  uint64_t dup = 0;
+  uint64_t gap = 0;
+  uint64_t acks_out = 0;
+  uint64_t acks_in = 0;
+
+  void onHeader(const mdp_hdr_v1_t* h) {
+    uint32_t& last = last_inorder[h->src];
+    int32_t d = (int32_t)(h->seq - last);
+    if (d == 1) { last = h->seq; inorder++; }
+    else if (d <= 0) dup++;
+    else gap++;
+    if ((int32_t)(h->ack - peer_ack[h->src]) > 0) peer_ack[h->src] = h->ack;
+    if (h->flags & IS_ACK) acks_in++;
+    if (h->flags & ACK_REQUESTED) acks_out++;
+  }
+};
+
+struct ReplayStats {
+  uint64_t frames = 0;
+  uint64_t decoded = 0;
+  uint64_t decode_errors = 0;
+  uint64_t bad_header = 0;
+  uint64_t sched_late_max_ns = 0;
+  RxModel rx;
+  MdpLatency latency;
+};
+
+// Shared between the writer and the bus observer in pty mode.
+struct Pending {
+  uint8_t  src;
+  uint8_t  type;
+  uint32_t seq;
+  uint64_t sched_ns;
+};
+
+struct BusWatch {
+  std::mutex mu;
+  std::deque<Pending> q;
+  std::atomic<bool> stop{false};
+  uint64_t delivered = 0;
+  uint64_t missing = 0;
+  uint64_t unexpected = 0;
+  uint64_t lost = 0;
+  MdpLatency e2e;
+};
+
+struct FrameCtx {
+  ReplayStats* st;
+  BusWatch* bus;       // non-null in pty+bus mode
+  uint64_t sched_ns;
+  bool print;
+};
+
+static void onFrame(void* ctx, const uint8_t* frame, size_t len) {
+  auto* fc = (FrameCtx*)ctx;
+  ReplayStats* st = fc->st;
+  static uint8_t payload[1536];
+  st->frames++;
+
+  size_t plen = mdp_decode_frame(frame, len, payload, sizeof(payload));
+  if (!plen) { st->decode_errors++; return; }
+  if (plen < sizeof(mdp_hdr_v1_t)) { st->bad_header++; return; }
+  auto* h = (const mdp_hdr_v1_t*)payload;
+  if (h->magic != MDP_MAGIC || h->version != MDP_VER) { st->bad_header++; return; }
+  st->decoded++;
+
+  if (fc->bus) {
+    std::lock_guard<std::mutex> lk(fc->bus->mu);
+    fc->bus->q.push_back(Pending{h->src, h->msg_type, h->seq, fc->sched_ns});
+    return;
+  }
+
+  st->rx.onHeader(h);
+  st->latency.add(mdp_shm_now_ns() - fc->sched_ns);
+  if (fc->print) {
+    printf("{\"t_ms\":%llu,\"src\":%u,\"dst\":%u,\"seq\":%u,\"ack\":%u,\"type\":%u,\"flags\":%u}\n",
+           (unsigned long long)(fc->sched_ns / 1000000ull), h->src, h->dst, h->seq, h->ack,
+           h->msg_type, h->flags);
+  }
+}
+
+static void busObserver(BusWatch* w, mdp_shm_reader_t* rd) {
+  while (!w->stop.load(std::memory_order_relaxed)) {
+    const mdp_shm_slot_t* s = mdp_shm_reader_peek(rd);
+    if (!s) {
+      mdp_shm_reader_wait(rd, 50000);
+      continue;
+    }
+    uint64_t now = mdp_shm_now_ns();
+    mdp_hdr_v1_t h = s->mdp;
+    if (!mdp_shm_reader_release(rd, s)) continue;
+
+    // The daemon publishes in arrival order, so walk the pending queue
+    // forward; anything skipped was dropped somewhere on the way.
+    std::lock_guard<std::mutex> lk(w->mu);
+    bool matched = false;
+    while (!w->q.empty()) {
+      Pending p = w->q.front();
+      w->q.pop_front();
+      if (p.src == h.src && p.seq == h.seq && p.type == h.msg_type) {
+        w->e2e.add(now - p.sched_ns);
+        w->delivered++;
+        matched = true;
+        break;
+      }
+      w->missing++;
+    }
+    if (!matched) w->unexpected++;
+  }
+  w->lost = rd->lost;
+}
+
+static void sleepUntil(uint64_t t_ns) {
+  struct timespec ts;
+  ts.tv_sec = (time_t)(t_ns / 1000000000ull);
+  ts.tv_nsec = (long)(t_ns % 1000000000ull);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && running) {}
+}
+
+static bool writeAll(int fd, const uint8_t* p, size_t n) {
+  while (n) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += w;
+    n -= (size_t)w;
+  }
+  return true;
+}
+
+static pid_t spawnShell(const std::string& cmd) {
+  // Own process group so stopping it also reaches anything the shell started.
+  std::string line = "exec " + cmd;
+  pid_t pid = fork();
+  if (pid == 0) {
+    setpgid(0, 0);
+    execl("/bin/sh", "sh", "-c", line.c_str(), (char*)nullptr);
+    _exit(127);
+  }
+  if (pid > 0) setpgid(pid, pid);
+  return pid;
+}
+
+int main(int argc, char** argv) {
+  const char* in = nullptr;
+  const char* execCmd = nullptr;
+  const char* busName = nullptr;
+  double speed = 1.0;
+  unsigned loops = 1;
+  bool usePty = false;
+  bool print = false;
+  unsigned waitMs = 5000;
+  unsigned drainMs = 500;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--in") && v) { in = v; i++; }
+    else if (!strcmp(a, "--speed") && v) { speed = atof(v); i++; }
+    else if (!strcmp(a, "--fast")) speed = 0;
+    else if (!strcmp(a, "--loop") && v) { loops = (unsigned)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--pty")) usePty = true;
+    else if (!strcmp(a, "--exec") && v) { execCmd = v; usePty = true; i++; }
+    else if (!strcmp(a, "--bus") && v) { busName = v; i++; }
+    else if (!strcmp(a, "--wait-ms") && v) { waitMs = (unsigned)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--drain-ms") && v) { drainMs = (unsigned)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--print")) print = true;
+    else {
+      fprintf(stderr, "usage: %s --in file.mdpcap [--speed N|--fast] [--loop N] [--print]\n"
+                      "       [--pty] [--exec \"cmd {pty}\"] [--bus /name] [--wait-ms N] "
+                      "[--drain-ms N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!in) {
+    fprintf(stderr, "{\"error\":\"missing --in\"}\n");
+    return 2;
+  }
+  if (!(speed >= 0)) {
+    fprintf(stderr, "{\"error\":\"--speed must be >= 0\"}\n");
+    return 2;
+  }
+  if (loops == 0) {
+    fprintf(stderr, "{\"error\":\"--loop must be >= 1\"}\n");
+    return 2;
+  }
+  if (busName && !usePty) {
+    fprintf(stderr, "{\"error\":\"--bus needs --pty\"}\n");
+    return 2;
+  }
+
+  // Load the whole capture first so file I/O never shows up in the timing.
+  mdp_cap_hdr_t ch;
+  FILE* f = mdp_cap_open(in, &ch);
+  if (!f) {
+    fprintf(stderr, "{\"error\":\"open\",\"in\":\"%s\",\"errno\":%d}\n", in, errno);
+    return 1;
+  }
+  std::vector<uint8_t> blob;
+  std::vector<Record> recs;
+  {
+    static uint8_t buf[MDP_CAP_MAX_REC];
+    mdp_cap_rec_t r;
+    int n;
+    while ((n = mdp_cap_next(f, &r, buf, sizeof(buf))) >= 0) {
+      recs.push_back(Record{r.t_ns, blob.size(), r.len});
+      blob.insert(blob.end(), buf, buf + n);
+    }
+    if (n == MDP_CAP_CORRUPT) fprintf(stderr, "{\"warning\":\"truncated capture\",\"records\":%zu}\n", recs.size());
+  }
+  fclose(f);
+  if (recs.empty()) {
+    fprintf(stderr, "{\"error\":\"empty capture\"}\n");
+    return 1;
+  }
+  const uint64_t span = recs.back().t_ns - recs.front().t_ns;
+
+  mdp_on_stop_signal(onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  int outFd = -1, slaveFd = -1;
+  pid_t child = -1;
+  BusWatch watch;
+  mdp_shm_reader_t rd;
+  std::thread observer;
+  bool haveBus = false;
+
+  if (usePty) {
+    outFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (outFd < 0 || grantpt(outFd) || unlockpt(outFd)) {
+      fprintf(stderr, "{\"error\":\"pty\",\"errno\":%d}\n", errno);
+      return 1;
+    }
+    const char* slave = ptsname(outFd);
+    // Hold the slave open (raw, no echo) so writes never hit a hung-up pty
+    // while the daemon is still starting.
+    slaveFd = open(slave, O_RDWR | O_NOCTTY);
+    if (slaveFd >= 0) {
+      struct termios tio;
+      if (tcgetattr(slaveFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slaveFd, TCSANOW, &tio);
+      }
+    }
+    fprintf(stderr, "{\"pty\":\"%s\"}\n", slave);
+
+    if (execCmd) {
+      std::string cmd = execCmd;
+      for (size_t p; (p = cmd.find("{pty}")) != std::string::npos;) cmd.replace(p, 5, slave);
+      child = spawnShell(cmd);
+    }
+
+    if (busName) {
+      // The daemon creates the segment once it is up; poll until then.
+      uint64_t deadline = mdp_shm_now_ns() + (uint64_t)waitMs * 1000000ull;
+      while (running && mdp_shm_reader_open(&rd, busName) != 0) {
+        if (mdp_shm_now_ns() > deadline) {
+          fprintf(stderr, "{\"error\":\"attach\",\"name\":\"%s\"}\n", busName);
+          if (child > 0) { kill(-child, SIGTERM); waitpid(child, nullptr, 0); }
+          return 1;
+        }
+        usleep(10000);
+      }
+      haveBus = true;
+      observer = std::thread(busObserver, &watch, &rd);
+    } else if (execCmd) {
+      usleep(waitMs > 200 ? 200000 : waitMs * 1000);
+    }
+  }
+
+  static ReplayStats st;
+  mdp_frame_splitter_t splitter;
+  mdp_splitter_init(&splitter);
+  FrameCtx fc{&st, haveBus ? &watch : nullptr, 0, print};
+
+  uint64_t bytes = 0, records = 0;
+  const uint64_t t0 = mdp_shm_now_ns();
+  for (unsigned loop = 0; loop < loops && running; loop++) {
+    const uint64_t loopOff = (uint64_t)loop * (span + 1000000ull);
+    for (size_t i = 0; i < recs.size() && running; i++) {
+      const Record& r = recs[i];
+      uint64_t now = mdp_shm_now_ns();
+      uint64_t sched = now;
+      if (speed > 0) {
+        sched = t0 + (uint64_t)((double)(r.t_ns - recs.front().t_ns + loopOff) / speed);
+        if (sched > now) sleepUntil(sched);
+        else if (now - sched > st.sched_late_max_ns) st.sched_late_max_ns = now - sched;
+      }
+      fc.sched_ns = sched;
+
+      const uint8_t* data = blob.data() + r.off;
+      if (usePty) {
+        // Frames are identified locally (for bus matching) before the bytes
+        // leave, so the observer never sees a message it does not expect.
+        if (haveBus) mdp_splitter_feed(&splitter, data, r.len, onFrame, &fc);
+        if (!writeAll(outFd, data, r.len)) {
+          fprintf(stderr, "{\"error\":\"pty write\",\"errno\":%d}\n", errno);
+          running = 0;
+          break;
+        }
+      } else {
+        mdp_splitter_feed(&splitter, data, r.len, onFrame, &fc);
+      }
+      bytes += r.len;
+      records++;
+    }
+  }
+  const uint64_t t1 = mdp_shm_now_ns();
+
+  if (usePty) {
+    if (haveBus) {
+      uint64_t deadline = mdp_shm_now_ns() + (uint64_t)drainMs * 1000000ull;
+      while (mdp_shm_now_ns() < deadline) {
+        {
+          std::lock_guard<std::mutex> lk(watch.mu);
+          if (watch.q.empty()) break;
+        }
+        usleep(1000);
+      }
+      watch.stop = true;
+      observer.join();
+      watch.missing += watch.q.size();
+      mdp_shm_reader_close(&rd);
+    } else {
+      usleep(drainMs * 1000);
+    }
+    if (child > 0) {
+      kill(-child, SIGTERM);
+      waitpid(child, nullptr, 0);
+    }
+    if (slaveFd >= 0) close(slaveFd);
+    close(outFd);
+  }
+
+  const double secs = (double)(t1 - t0) / 1e9;
+  fprintf(stderr,
+          "{\"capture\":\"%s\",\"target\":\"%s\",\"speed\":%g,\"loops\":%u,\"records\":%llu,"
+          "\"bytes\":%llu,\"elapsed_s\":%.3f,\"frames\":%llu,\"frames_per_s\":%.0f,"
+          "\"mbytes_per_s\":%.3f,\"decode_errors\":%llu,\"bad_header\":%llu,\"overflows\":%u,"
+          "\"sched_late_max_us\":%.1f,",
+          in, usePty ? "pty" : "decode", speed, loops, (unsigned long long)records,
+          (unsigned long long)bytes, secs, (unsigned long long)st.frames,
+          secs > 0 ? (double)st.frames / secs : 0.0, secs > 0 ? (double)bytes / secs / 1e6 : 0.0,
+          (unsigned long long)st.decode_errors, (unsigned long long)st.bad_header,
+          splitter.overflows, (double)st.sched_late_max_ns / 1000.0);
+  if (haveBus) {
+    fprintf(stderr, "\"bus\":{\"delivered\":%llu,\"missing\":%llu,\"unexpected\":%llu,"
+                    "\"lost\":%llu},",
+            (unsigned long long)watch.delivered, (unsigned long long)watch.missing,
+            (unsigned long long)watch.unexpected, (unsigned long long)watch.lost);
+    watch.e2e.printJson(stderr, "latency");
+  } else if (!usePty) {
+    fprintf(stderr, "\"arq\":{\"inorder\":%llu,\"dup\":%llu,\"gap\":%llu,\"acks_in\":%llu,"
+                    "\"acks_out\":%llu},",
+            (unsigned long long)st.rx.inorder, (unsigned long long)st.rx.dup,
+            (unsigned long long)st.rx.gap, (unsigned long long)st.rx.acks_in,
+            (unsigned long long)st.rx.acks_out);
+    st.latency.printJson(stderr, "latency");
+  } else {
+    fprintf(stderr, "\"latency\":null");
+  }
+  fprintf(stderr, "}\n");
+  return 0;
+}
@@ -0,0 +1,116 @@
+// mdp_shm_pub — read MDP frames from the Side-B/gateway UART and publish
+// every valid payload on the shared-memory telemetry bus.
+//
+//   mdp_shm_pub --port /dev/ttyTHS1 [--baud 115200] [--name /mycobrain.mdp]
+//               [--slots 4096] [--slot-size 1024] [--link uart]
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mdp_types.h>
+#include <mdp_utils.h>
+
+#include "mdp_host_io.h"
+#include "mdp_shm_bus.h"
+
+struct PubState {
+  mdp_shm_writer_t bus;
+  uint8_t link = MDP_LINK_UART;
+  uint64_t frames = 0;
+  uint64_t published = 0;
+  uint64_t crc_errors = 0;
+  uint64_t bad_header = 0;
+};
+
+static volatile sig_atomic_t running = 1;
+static void onSignal(int) { running = 0; }
+
+static void onFrame(void* ctx, const uint8_t* frame, size_t len) {
+  auto* st = (PubState*)ctx;
+  static uint8_t payload[1536];
+  st->frames++;
+
+  size_t plen = mdp_decode_frame(frame, len, payload, sizeof(payload));
+  if (!plen) { st->crc_errors++; return; }
+  if (plen < sizeof(mdp_hdr_v1_t)) { st->bad_header++; return; }
+  auto* h = (const mdp_hdr_v1_t*)payload;
+  if (h->magic != MDP_MAGIC || h->version != MDP_VER) { st->bad_header++; return; }
+
+  if (mdp_shm_publish(&st->bus, st->link, mdp_shm_now_ns(), payload, (uint16_t)plen)) {
+    st->published++;
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* port = nullptr;
+  const char* name = MDP_SHM_DEFAULT_NAME;
+  uint32_t baud = 115200;
+  uint32_t slots = MDP_SHM_DEFAULT_SLOTS;
+  uint32_t slotSize = MDP_SHM_DEFAULT_SLOT_SIZE;
+  static PubState st;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--port") && v) { port = v; i++; }
+    else if (!strcmp(a, "--baud") && v) { baud = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--name") && v) { name = v; i++; }
+    else if (!strcmp(a, "--slots") && v) { slots = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--slot-size") && v) { slotSize = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--link") && v) { st.link = mdp_link_from_name(v); i++; }
+    else {
+      fprintf(stderr, "usage: %s --port <tty|-> [--baud N] [--name /shm] [--slots N] "
+                      "[--slot-size N] [--link uart|lora|udp|ble|sim]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!port) {
+    fprintf(stderr, "{\"error\":\"missing --port\"}\n");
+    return 2;
+  }
+
+  int fd = mdp_open_serial(port, baud);
+  if (fd < 0) {
+    fprintf(stderr, "{\"error\":\"open\",\"port\":\"%s\",\"errno\":%d}\n", port, errno);
+    return 1;
+  }
+
+  int rc = mdp_shm_writer_open(&st.bus, name, slots, slotSize);
+  if (rc) {
+    fprintf(stderr, "{\"error\":\"shm_open\",\"name\":\"%s\",\"errno\":%d}\n", name, -rc);
+    return 1;
+  }
+
+  mdp_on_stop_signal(onSignal);
+
+  fprintf(stderr, "{\"bus\":\"%s\",\"slots\":%u,\"slot_size\":%u,\"status\":\"ready\"}\n",
+          name, st.bus.ring->slot_count, st.bus.ring->slot_size);
+
+  mdp_frame_splitter_t splitter;
+  mdp_splitter_init(&splitter);
+  uint8_t rx[4096];
+  while (running) {
+    ssize_t n = read(fd, rx, sizeof(rx));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (n == 0) break;
+    mdp_splitter_feed(&splitter, rx, (size_t)n, onFrame, &st);
+  }
+
+  fprintf(stderr,
+          "{\"frames\":%llu,\"published\":%llu,\"crc_errors\":%llu,\"bad_header\":%llu,"
+          "\"overflows\":%u}\n",
+          (unsigned long long)st.frames, (unsigned long long)st.published,
+          (unsigned long long)st.crc_errors, (unsigned long long)st.bad_header,
+          splitter.overflows);
+
+  mdp_shm_writer_close(&st.bus, true);
+  if (fd != STDIN_FILENO) close(fd);
+  return 0;
+}
@@ -0,0 +1,112 @@
+// mdp_shm_tail — subscribe to the shared-memory telemetry bus.
+//
+// Default output is one NDJSON line per message (same keys the gateway prints
+// on USB). --stats prints a once-per-second summary with publish-to-read
+// latency instead. --spin busy-polls for the lowest latency.
+//
+//   mdp_shm_tail [--name /mycobrain.mdp] [--stats] [--spin] [--type N]
+
+#include <algorithm>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <mdp_types.h>
+
+#include "mdp_host_io.h"
+#include "mdp_shm_bus.h"
+
+static volatile sig_atomic_t running = 1;
+static void onSignal(int) { running = 0; }
+
+static uint64_t percentile(std::vector<uint64_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t k = (size_t)(p * (double)(v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + (long)k, v.end());
+  return v[k];
+}
+
+int main(int argc, char** argv) {
+  const char* name = MDP_SHM_DEFAULT_NAME;
+  bool stats = false;
+  bool spin = false;
+  int typeFilter = -1;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--name") && v) { name = v; i++; }
+    else if (!strcmp(a, "--type") && v) { typeFilter = (int)strtol(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--stats")) stats = true;
+    else if (!strcmp(a, "--spin")) spin = true;
+    else {
+      fprintf(stderr, "usage: %s [--name /shm] [--stats] [--spin] [--type N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  mdp_shm_reader_t rd;
+  int rc = mdp_shm_reader_open(&rd, name);
+  if (rc) {
+    fprintf(stderr, "{\"error\":\"attach\",\"name\":\"%s\",\"errno\":%d}\n", name, -rc);
+    return 1;
+  }
+
+  mdp_on_stop_signal(onSignal);
+
+  std::vector<uint64_t> lat;
+  lat.reserve(1 << 16);
+  uint64_t windowStart = mdp_shm_now_ns();
+  uint64_t count = 0, lostReported = 0;
+
+  while (running) {
+    const mdp_shm_slot_t* s = mdp_shm_reader_peek(&rd);
+    if (!s) {
+      if (!spin) mdp_shm_reader_wait(&rd, 100000);
+    } else {
+      uint64_t now = mdp_shm_now_ns();
+      // Copy the few fields we print before validating the slot.
+      mdp_hdr_v1_t h = s->mdp;
+      uint64_t rxNs = s->rx_ns;
+      uint16_t len = s->payload_len;
+      uint8_t link = s->link;
+      uint64_t busSeq = s->msg_seq;
+      if (!stats && rd.lost != lostReported) {
+        printf("{\"overrun\":true,\"lost\":%llu}\n", (unsigned long long)(rd.lost - lostReported));
+        lostReported = rd.lost;
+      }
+      if (mdp_shm_reader_release(&rd, s) && (typeFilter < 0 || h.msg_type == typeFilter)) {
+        count++;
+        if (stats) {
+          lat.push_back(now - rxNs);
+        } else {
+          printf("{\"bus_seq\":%llu,\"link\":%u,\"src\":%u,\"dst\":%u,\"seq\":%u,\"ack\":%u,"
+                 "\"type\":%u,\"flags\":%u,\"len\":%u,\"lat_us\":%.1f}\n",
+                 (unsigned long long)busSeq, link, h.src, h.dst, h.seq, h.ack, h.msg_type,
+                 h.flags, len, (double)(now - rxNs) / 1000.0);
+        }
+      }
+    }
+
+    if (stats) {
+      uint64_t now = mdp_shm_now_ns();
+      if (now - windowStart >= 1000000000ull) {
+        printf("{\"msgs\":%llu,\"lost\":%llu,\"lat_p50_us\":%.1f,\"lat_p99_us\":%.1f,"
+               "\"lat_max_us\":%.1f}\n",
+               (unsigned long long)count, (unsigned long long)(rd.lost - lostReported),
+               percentile(lat, 0.50) / 1000.0, percentile(lat, 0.99) / 1000.0,
+               lat.empty() ? 0.0 : *std::max_element(lat.begin(), lat.end()) / 1000.0);
+        fflush(stdout);
+        lat.clear();
+        count = 0;
+        lostReported = rd.lost;
+        windowStart = now;
+      }
+    }
+  }
+
+  mdp_shm_reader_close(&rd);
+  return 0;
+}
@@ -0,0 +1,698 @@
+// mdp_storage_bench — latency, write amplification and wear of the Side-A
+// persistence paths on an emulated NOR chip (mdp_nor_emu, mdp_nvs_emu), using
+// the firmware's own storage code through the storage HAL.
+//
+//   mdp_storage_bench --hours 24 --outage-min 30 --outage-every-min 240
+//   mdp_storage_bench --store flashlog_batch --power-cuts 200
+//   mdp_storage_bench --workload scan --hours 24
+//
+// Workloads:
+//   queue  Side-A telemetry (~255-byte signed CBOR envelopes every --period-ms)
+//          through the durable replay queue, sent over the firmware's
+//          retransmit queue to a simulated Side-B that acks like the real
+//          one. The link drops for --outage-min every --outage-every-min, so
+//          a backlog builds and has to be replayed. Stores:
+//            legacy_nvs      the former NVS queue: 3 keys per message,
+//                            head/tail/count rewritten on enqueue and ack,
+//                            8 slots, replayed only after a reboot
+//            flashlog        mdp_flashlog, one record per message
+//            flashlog_batch  mdp_durable: group commit + LZ4 (firmware config)
+//   scan   the I2C scan cache, saved every --scan-ms with one address
+//          changing with probability --scan-change per scan: 76 one-byte keys
+//          (legacy) vs one blob written only when it changed.
+//
+// --power-cuts N (flashlog stores) cuts power at N random points, remounts,
+// and checks that every message persisted and not yet acked at the cut comes
+// back intact: lost_persisted and corrupt must be 0. Messages a full store
+// discarded or refused are counted in dropped_full (and in lost), not in
+// lost_persisted.
+//
+// Latencies come from the NOR timing model (datasheet typicals), not host
+// time. write_amp = bytes programmed / payload bytes; wear_years projects the
+// most-erased sector to 100k P/E cycles. --image keeps the NOR image in a
+// file (default: anonymous memory). One NDJSON line per store.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <mdp_arq.h>
+#include <mdp_durable.h>
+#include <mdp_storage.h>
+#include <myco_envelope.h>
+
+#include "mdp_nor_emu.h"
+#include "mdp_nvs_emu.h"
+#include "mdp_stats.h"
+
+static constexpr uint32_t SECTOR = 4096;
+static constexpr uint32_t TICK_MS = 10;
+static constexpr size_t MSG_HDR = 16;          // stands in for mdp_hdr_v1_t; seq at [0, 4), 1 at 4 for ACK-only
+static constexpr size_t MAX_PAYLOAD = 768;
+// Side-A retransmit queue (firmware/side_a cfg).
+static constexpr uint32_t RTO_MS = 120;
+static constexpr uint8_t MAX_RETRIES = 8;
+static constexpr uint8_t TX_SLOTS = 6;
+static constexpr uint32_t SEQ_SYNC_MS = 1000;  // durable_cfg::SEQ_SYNC_MS
+
+struct Opts {
+  std::string workload = "queue";
+  std::vector<std::string> stores;
+  double hours = 24;
+  uint32_t periodMs = 1000;
+  double outageMin = 30;
+  double outageEveryMin = 240;
+  uint32_t oneWayMs = 10;
+  uint32_t logKb = 1920;                   // partitions_side_a.csv mdplog
+  uint32_t nvsKb = 20;                     // partitions_side_a.csv nvs
+  uint32_t batchBytes = 6144;
+  uint32_t flushMs = 10000;
+  uint32_t scanMs = 5000;
+  double scanChange = 0.001;
+  uint32_t powerCuts = 0;
+  uint64_t seed = 1;
+  const char* image = nullptr;
+};
+
+static uint64_t rng_state = 1;
+static uint64_t rnd() {
+  uint64_t z = (rng_state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+static double rndU() { return (double)(rnd() >> 11) * (1.0 / 9007199254740992.0); }
+
+static uint32_t crc32(const uint8_t* p, size_t n) {
+  uint32_t c = 0xFFFFFFFFu;
+  while (n--) {
+    c ^= *p++;
+    for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+  }
+  return ~c;
+}
+
+// Side-A's buildTelemetryEnvelope(): the same seven readings through the real
+// MycoEnvelope builder. h and z come from the host stand-in crypto and are as
+// incompressible as on device.
+static uint16_t makeEnvelope(uint32_t seq, uint32_t nowMs, uint8_t* out) {
+  memset(out, 0, MSG_HDR);
+  memcpy(out, &seq, sizeof(seq));
+  const int32_t ai = 12000 + (int32_t)(rnd() % 100) * 100;
+  myco_reading_t r[7];
+  for (int i = 0; i < 4; i++) r[i] = { (uint16_t)(20 + i), ai >> i, 4, 9, 0 };         // AI1..4, V
+  for (int i = 0; i < 3; i++) r[4 + i] = { (uint16_t)(30 + i), i == 2 ? 1 : 0, 0, 10, 0 }; // MOS1..3
+  uint8_t msgId[16] = {};
+  memcpy(msgId + 12, &seq, sizeof(seq));
+  static const uint8_t sk[64] = {};
+  size_t n = 0;
+  if (myco_build_envelope_cbor(out + MSG_HDR, MAX_PAYLOAD - MSG_HDR, &n, "MYCOBRAIN-A1B2C3D4E5F6",
+                               MYCO_PROTO_OTHER, msgId, 1700000000000ll + nowMs, seq, nowMs,
+                               nullptr, r, 7, sk) != 0) {
+    return 0;
+  }
+  return (uint16_t)(MSG_HDR + n);
+}
+
+// durablePump()'s ACK-only frame for a seq no longer in the log.
+static void makeHoleFiller(uint32_t seq, uint8_t* out) {
+  memset(out, 0, MSG_HDR);
+  memcpy(out, &seq, sizeof(seq));
+  out[4] = 1;
+}
+
+static bool msgIsFiller(const uint8_t* p, uint16_t len) { return len == MSG_HDR && p[4] == 1; }
+
+static uint32_t msgSeq(const uint8_t* p) {
+  uint32_t s;
+  memcpy(&s, p, sizeof(s));
+  return s;
+}
+
+// ------------------------------------------------------------------ stores
+
+struct Store {
+  virtual ~Store() {}
+  virtual const char* name() const = 0;
+  virtual bool mount() = 0;
+  // Persist (and for legacy, send) one message.
+  virtual bool enqueue(const uint8_t* p, uint16_t len, uint32_t seq, uint32_t now, uint32_t acked) = 0;
+  virtual void ack(uint32_t ack) = 0;
+  virtual void poll(uint32_t now, uint32_t acked) = 0;
+  // Hand pending messages to the retransmit queue.
+  virtual void pump(mdp_arq_t* q, uint32_t now) = 0;
+  virtual uint32_t lastSeq() const { return 0; }
+  virtual uint32_t backlog() const = 0;
+  virtual uint64_t droppedFull() const = 0;   // pending records discarded for room
+  virtual void printExtra(FILE*) {}
+  MdpNorEmu nor;
+  mdp_arq_t* arq = nullptr;        // Side-A retransmit queue
+};
+
+// The durable queue as Side-A runs it (durablePump()).
+struct DurableStore : Store {
+  DurableStore(const char* n, const mdp_durable_cfg_t& c) : name_(n), cfg_(c) {}
+  const char* name() const override { return name_; }
+  bool mount() override {
+    // Counters restart at mount; keep totals across power cuts.
+    for (int i = 0; i < 4; i++) sum_.d[i] += cur(i, true);
+    for (int i = 0; i < 3; i++) sum_.l[i] += cur(i, false);
+    flash_ = nor.flash();
+    expiredSeen_ = 0;
+    fedThrough_ = 0;
+    return mdp_durable_mount(d_.get(), &flash_, &cfg_);
+  }
+  uint64_t cur(int i, bool durable) const {
+    const mdp_durable_stats_t& s = d_->stats;
+    if (durable) return i == 0 ? s.flushes : i == 1 ? s.marks : i == 2 ? s.raw_bytes : s.packed_bytes;
+    return i == 0 ? d_->log.stats.appends : i == 1 ? d_->log.stats.torn : d_->log.stats.dropped;
+  }
+  uint64_t total(int i, bool durable) const { return (durable ? sum_.d[i] : sum_.l[i]) + cur(i, durable); }
+  bool enqueue(const uint8_t* p, uint16_t len, uint32_t seq, uint32_t now, uint32_t acked) override {
+    if (!mdp_durable_enqueue(d_.get(), p, len, seq, now, acked)) return false;
+    if (cfg_.flush_ms == 0) mdp_durable_flush(d_.get(), acked);
+    return true;
+  }
+  void ack(uint32_t a) override { mdp_durable_ack(d_.get(), a); }
+  void poll(uint32_t now, uint32_t acked) override { mdp_durable_poll(d_.get(), now, acked); }
+  void pump(mdp_arq_t* q, uint32_t now) override {
+    if (q->stats.expired != expiredSeen_) {
+      if (mdp_arq_in_flight(q) != 0) return;
+      expiredSeen_ = q->stats.expired;
+      mdp_durable_rewind(d_.get(), q->peer_ack);
+      fedThrough_ = q->peer_ack;
+    }
+    if (fedThrough_ < q->peer_ack) fedThrough_ = q->peer_ack;
+    while (mdp_arq_in_flight(q) < TX_SLOTS) {
+      const uint8_t* p;
+      uint32_t seq = 0;
+      uint16_t len = mdp_durable_next(d_.get(), &p, &seq);
+      if (len == 0) break;
+      if (fedThrough_ != 0 && seq > fedThrough_ + 1) {
+        uint8_t hole[MSG_HDR];
+        makeHoleFiller(fedThrough_ + 1, hole);
+        if (!mdp_arq_send(q, hole, sizeof(hole), fedThrough_ + 1, now)) break;
+        fedThrough_++;
+        fillers++;
+        continue;
+      }
+      if (!mdp_arq_send(q, p, len, seq, now)) break;
+      mdp_durable_sent(d_.get(), seq);
+      if (seq > fedThrough_) fedThrough_ = seq;
+    }
+  }
+  uint32_t lastSeq() const override { return mdp_durable_last_seq(d_.get()); }
+  uint32_t backlog() const override { return d_->log.pending; }
+  uint64_t droppedFull() const override { return total(2, false); }
+  void printExtra(FILE* o) override {
+    uint64_t packed = total(3, true);
+    fprintf(o, ",\"log\":{\"records\":%llu,\"torn\":%llu,\"dropped\":%llu},"
+               "\"durable\":{\"flushes\":%llu,\"marks\":%llu,\"compress_ratio\":%.2f,"
+               "\"hole_fillers\":%llu}",
+            (unsigned long long)total(0, false), (unsigned long long)total(1, false),
+            (unsigned long long)total(2, false), (unsigned long long)total(0, true),
+            (unsigned long long)total(1, true), packed ? (double)total(2, true) / packed : 0.0,
+            (unsigned long long)fillers);
+  }
+  mdp_durable_t* d() { return d_.get(); }
+
+  const char* name_;
+  mdp_durable_cfg_t cfg_;
+  std::unique_ptr<mdp_durable_t> d_{new mdp_durable_t()};
+  mdp_flash_t flash_;
+  uint32_t expiredSeen_ = 0;
+  uint32_t fedThrough_ = 0;
+  uint64_t fillers = 0;
+  struct { uint64_t d[4], l[3]; } sum_ = {};
+};
+
+// The pre-flash-log Side-A queue: NVS keys q%u_s/_l/_d per slot, head/tail/
+// count rewritten on every enqueue and on every frame from Side-B, txseq
+// rewritten per message. Sent once on enqueue; replayed only after a reboot.
+struct LegacyNvsStore : Store {
+  static constexpr uint8_t CAP = 8;
+  const char* name() const override { return "legacy_nvs"; }
+  bool mount() override {
+    nvs_.reset(new MdpNvsEmu(&nor));
+    nvs_->format();
+    kv_ = nvs_->kv();
+    return true;
+  }
+  void put(const char* k, const void* v, size_t n) { kv_.set(kv_.ctx, k, v, n); }
+  void saveMeta() {
+    put("head", &head_, 1);
+    put("tail", &tail_, 1);
+    put("count", &count_, 1);
+  }
+  bool enqueue(const uint8_t* p, uint16_t len, uint32_t seq, uint32_t now, uint32_t) override {
+    uint32_t next = seq + 1;
+    put("txseq", &next, 4);
+    if (count_ >= CAP) {
+      tail_ = (uint8_t)((tail_ + 1) % CAP);
+      count_--;
+      dropped_++;
+    }
+    char k[8];
+    snprintf(k, sizeof(k), "q%u_s", head_); put(k, &seq, 4);
+    snprintf(k, sizeof(k), "q%u_l", head_); put(k, &len, 2);
+    snprintf(k, sizeof(k), "q%u_d", head_); put(k, p, len);
+    head_ = (uint8_t)((head_ + 1) % CAP);
+    count_++;
+    saveMeta();
+    (void)mdp_arq_send(arq, p, len, seq, now);
+    return true;
+  }
+  void ack(uint32_t a) override {
+    while (count_ > 0) {
+      char k[8];
+      uint32_t s = 0;
+      snprintf(k, sizeof(k), "q%u_s", tail_);
+      kv_.get(kv_.ctx, k, &s, 4);
+      if (s == 0 || s > a) break;
+      tail_ = (uint8_t)((tail_ + 1) % CAP);
+      count_--;
+    }
+    saveMeta();
+  }
+  void poll(uint32_t, uint32_t) override {}
+  void pump(mdp_arq_t*, uint32_t) override {}
+  uint32_t backlog() const override { return count_; }
+  uint64_t droppedFull() const override { return dropped_; }
+  void printExtra(FILE* o) override {
+    const MdpNvsStats& s = nvs_->stats();
+    fprintf(o, ",\"nvs\":{\"sets\":%llu,\"identical\":%llu,\"entries\":%llu,\"gc\":%llu}",
+            (unsigned long long)s.sets, (unsigned long long)s.identical,
+            (unsigned long long)s.entries, (unsigned long long)s.gc);
+  }
+
+  std::unique_ptr<MdpNvsEmu> nvs_;
+  mdp_kv_t kv_;
+  uint8_t head_ = 0, tail_ = 0, count_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+// ---------------------------------------------------------------- reporting
+
+static void printFlash(FILE* o, const MdpNorEmu& nor, double payloadBytes, double hours) {
+  const MdpNorStats& s = nor.stats();
+  uint32_t emax = 0;
+  double esum = 0;
+  for (uint32_t e : nor.eraseCounts()) {
+    if (e > emax) emax = e;
+    esum += e;
+  }
+  double perYear = hours > 0 ? (double)emax * 8760.0 / hours : 0;
+  fprintf(o, ",\"flash\":{\"programs\":%llu,\"page_programs\":%llu,\"program_bytes\":%llu,"
+             "\"erases\":%llu,\"violations\":%llu,\"write_amp\":%.3f,\"erase_max\":%u,"
+             "\"erase_mean\":%.2f,\"wear_years\":%.1f}",
+          (unsigned long long)s.programs, (unsigned long long)s.page_programs,
+          (unsigned long long)s.program_bytes, (unsigned long long)s.erases,
+          (unsigned long long)s.violations,
+          payloadBytes > 0 ? (double)s.program_bytes / payloadBytes : 0.0, emax,
+          esum / (double)nor.eraseCounts().size(), perYear > 0 ? 100000.0 / perYear : -1.0);
+}
+
+// --------------------------------------------------------------- queue sim
+
+struct Wire {
+  uint32_t at;
+  uint32_t val;
+  bool ackOnly;
+};
+
+struct QueueSim {
+  const Opts& o;
+  Store& st;
+  mdp_arq_t q;
+  mdp_arq_slot_t slots[TX_SLOTS];
+  uint8_t pool[TX_SLOTS][MAX_PAYLOAD];
+  mdp_arq_rx_t rx;
+  std::deque<Wire> toB, toA;             // seq in flight to B, ack values to A
+  uint32_t now = 0;
+  uint32_t txSeq = 1;
+  bool synced = false;                   // tx_seq checked against Side-B's ack
+  uint32_t syncStart = 0;
+  uint64_t offered = 0, payloadBytes = 0, delivered = 0;
+  uint32_t backlogPeak = 0;
+  uint32_t expectedLost = 0, corrupt = 0, cuts = 0;
+  uint64_t refused = 0, droppedAtCut = 0, droppedSeen = 0;
+  uint32_t persistedThrough = 0, lastEnq = 0, ackedAt = 0;
+  std::unordered_map<uint32_t, uint32_t> crcs;
+  std::unordered_set<uint32_t> rxSeen;
+  std::vector<uint32_t> cutPoints;
+  size_t nextCut = 0;
+  MdpLatency enqLat, ackLat, pollLat;
+
+  QueueSim(const Opts& opts, Store& s) : o(opts), st(s) {}
+
+  bool linkUp(uint32_t t) const {
+    if (o.outageMin <= 0) return true;
+    uint32_t every = (uint32_t)(o.outageEveryMin * 60000.0);
+    uint32_t out = (uint32_t)(o.outageMin * 60000.0);
+    return t % every < every - out;
+  }
+
+  static bool sendCb(void* ctx, const uint8_t* p, uint16_t len) {
+    QueueSim* s = (QueueSim*)ctx;
+    if (s->linkUp(s->now)) s->toB.push_back({ s->now + s->o.oneWayMs, msgSeq(p), msgIsFiller(p, len) });
+    return true;
+  }
+
+  void arqInit() {
+    const mdp_arq_cfg_t c = { RTO_MS, MAX_RETRIES };
+    mdp_arq_init(&q, slots, TX_SLOTS, &pool[0][0], MAX_PAYLOAD, &c, sendCb, this);
+    st.arq = &q;
+  }
+
+  uint32_t flushCount() {
+    DurableStore* d = dynamic_cast<DurableStore*>(&st);
+    return d ? d->d()->stats.flushes + d->d()->stats.marks : 0;
+  }
+
+  template <typename F>
+  void timed(MdpLatency& lat, F fn, bool always) {
+    uint64_t b = st.nor.busyNs();
+    fn();
+    uint64_t dt = st.nor.busyNs() - b;
+    if (always || dt) lat.add(dt);
+  }
+
+  // Side-A reboot after a power cut: remount, check what came back.
+  void reboot() {
+    DurableStore* d = dynamic_cast<DurableStore*>(&st);
+    cuts++;
+    st.nor.powerCycle();
+    if (!st.mount()) { fprintf(stderr, "remount failed\n"); exit(1); }
+    std::unordered_map<uint32_t, bool> got;
+    const uint8_t* p;
+    uint32_t seq;
+    uint16_t len;
+    uint32_t oldest = UINT32_MAX;
+    while ((len = mdp_durable_next(d->d(), &p, &seq)) != 0) {
+      auto it = crcs.find(seq);
+      if (it == crcs.end() || it->second != crc32(p, len)) corrupt++;
+      got[seq] = true;
+      oldest = std::min(oldest, seq);
+      mdp_durable_sent(d->d(), seq);
+    }
+    mdp_durable_rewind(d->d(), 0);
+    // A full log discards its oldest records, so persisted messages missing
+    // below the oldest one that came back were dropped for room (counted in
+    // dropped_full); the rest were lost to the cut. Either way each is
+    // counted once.
+    bool dropped = st.droppedFull() != droppedSeen;
+    droppedSeen = st.droppedFull();
+    for (uint32_t s = ackedAt + 1; s <= persistedThrough; s++) {
+      if (!crcs.count(s) || got.count(s)) continue;
+      bool full = oldest == UINT32_MAX ? dropped : s < oldest;
+      if (!full) expectedLost++;
+      else if (!rxSeen.count(s)) droppedAtCut++;
+      crcs.erase(s);
+    }
+    // Messages still in RAM at the cut are gone for good; their seqs are
+    // handed out again only if they never reached Side-B.
+    for (uint32_t s = persistedThrough + 1; s <= lastEnq; s++) crcs.erase(s);
+    arqInit();
+    toA.clear();                         // Side-A's UART buffer is gone too
+    boot();
+    lastEnq = persistedThrough = st.lastSeq();
+  }
+
+  // As Side-A's setup(): tx_seq after the log, and an ACK request (seq 0)
+  // whose answer moves it past Side-B's ack; see txSeqSync().
+  void boot() {
+    txSeq = st.lastSeq() + 1;
+    synced = false;
+    syncStart = now;
+    if (linkUp(now)) toB.push_back({ now + o.oneWayMs, 0, true });
+  }
+
+  bool seqReady() {
+    if (!synced && now - syncStart >= SEQ_SYNC_MS) synced = true;
+    return synced;
+  }
+
+  void step(bool produce) {
+    while (!toA.empty() && toA.front().at <= now) {
+      uint32_t a = toA.front().val;
+      toA.pop_front();
+      if (!linkUp(now)) continue;
+      mdp_arq_on_ack(&q, a);
+      timed(ackLat, [&] { st.ack(q.peer_ack); }, false);
+      ackedAt = q.peer_ack;
+      if (!synced) {
+        if (a >= txSeq) txSeq = a + 1;
+        synced = true;
+      }
+    }
+    while (!toB.empty() && toB.front().at <= now) {
+      Wire w = toB.front();
+      toB.pop_front();
+      if (!linkUp(now)) continue;
+      // v1 Side-B acts on every copy; count each message once.
+      (void)mdp_arq_rx_accept(&rx, w.val);
+      if (!w.ackOnly && rxSeen.insert(w.val).second) delivered++;
+      toA.push_back({ now + o.oneWayMs, rx.last_inorder, true });
+    }
+
+    if (produce && now % o.periodMs == 0 && seqReady()) {
+      uint8_t msg[MAX_PAYLOAD];
+      uint16_t len = makeEnvelope(txSeq, now, msg);
+      crcs[txSeq] = crc32(msg, len);
+      uint32_t before = flushCount(), prev = lastEnq;
+      bool ok = false;
+      timed(enqLat, [&] { ok = st.enqueue(msg, len, txSeq, now, q.peer_ack); }, true);
+      offered++;
+      if (ok) {
+        payloadBytes += len;
+        lastEnq = txSeq++;
+        if (flushCount() != before && st.nor.powered()) {
+          persistedThrough = dynamic_cast<DurableStore*>(&st)->cfg_.flush_ms == 0 ? lastEnq : prev;
+        }
+      } else {
+        refused++;
+        crcs.erase(txSeq);
+      }
+    }
+
+    uint32_t before = flushCount();
+    timed(pollLat, [&] { st.poll(now, q.peer_ack); }, false);
+    if (flushCount() != before && st.nor.powered()) persistedThrough = lastEnq;
+    if (seqReady()) st.pump(&q, now);
+    mdp_arq_pump(&q, now);
+    if (st.backlog() > backlogPeak) backlogPeak = st.backlog();
+
+    if (!st.nor.powered()) reboot();
+    if (nextCut < cutPoints.size() && now >= cutPoints[nextCut]) {
+      st.nor.armPowerLoss(rnd() % 1024);
+      nextCut++;
+    }
+  }
+
+  void run() {
+    rx_init();
+    arqInit();
+    boot();
+    uint32_t endMs = (uint32_t)(o.hours * 3600000.0);
+    for (uint32_t i = 0; i < o.powerCuts; i++) cutPoints.push_back((uint32_t)(rndU() * endMs));
+    std::sort(cutPoints.begin(), cutPoints.end());
+    for (now = 0; now < endMs; now += TICK_MS) step(true);
+    // Drain: no new messages; wait out any outage and let the backlog replay.
+    st.nor.disarm();
+    uint32_t drainEnd = endMs + (uint32_t)(o.outageMin * 60000.0) + 3600000u;
+    for (; now < drainEnd; now += TICK_MS) {
+      step(false);
+      if (linkUp(now) && mdp_arq_in_flight(&q) == 0 && toA.empty() && toB.empty() &&
+          st.backlog() == 0) break;
+    }
+  }
+
+  void rx_init() { mdp_arq_rx_init(&rx); }
+
+  // Messages a full store refused or discarded: whatever was enqueued and
+  // neither delivered nor lost at a cut.
+  uint64_t droppedFull() const {
+    uint64_t n = refused + droppedAtCut;
+    for (const auto& c : crcs) n += rxSeen.count(c.first) ? 0 : 1;
+    return n;
+  }
+
+  void report(FILE* out) {
+    fprintf(out, "{\"workload\":\"queue\",\"store\":\"%s\",\"hours\":%.2f,\"period_ms\":%u,"
+                 "\"outage_min\":%.1f,\"outage_every_min\":%.1f,\"messages\":%llu,"
+                 "\"payload_bytes\":%llu,\"delivered\":%llu,\"lost\":%lld,\"dropped_full\":%llu,"
+                 "\"backlog_peak\":%u,",
+            st.name(), o.hours, o.periodMs, o.outageMin, o.outageEveryMin,
+            (unsigned long long)offered, (unsigned long long)payloadBytes,
+            (unsigned long long)delivered, (long long)offered - (long long)delivered,
+            (unsigned long long)droppedFull(), backlogPeak);
+    enqLat.printJson(out, "enqueue");
+    fputc(',', out);
+    ackLat.printJson(out, "ack");
+    fputc(',', out);
+    pollLat.printJson(out, "poll");
+    printFlash(out, st.nor, (double)payloadBytes, o.hours);
+    st.printExtra(out);
+    if (o.powerCuts) {
+      fprintf(out, ",\"power\":{\"cuts\":%u,\"lost_persisted\":%u,\"corrupt\":%u}",
+              cuts, expectedLost, corrupt);
+    }
+    fprintf(out, "}\n");
+    fflush(out);
+  }
+};
+
+// ---------------------------------------------------------------- scan sim
+
+struct BusFound { uint8_t addrs[16]; uint8_t count; };
+struct BmeCandidate { bool present; uint8_t addr; uint8_t chip_id; };
+struct ScanCache {
+  uint8_t version;
+  BusFound found[4];
+  BmeCandidate bme[4];
+};
+
+static void runScan(const Opts& o, bool legacy) {
+  MdpNorEmu nor;
+  if (!nor.open(o.image, SECTOR, o.nvsKb * 1024 / SECTOR)) { perror("image"); exit(1); }
+  MdpNvsEmu nvs(&nor);
+  nvs.format();
+  mdp_kv_t kv = nvs.kv();
+  BusFound found[4] = {};
+  BmeCandidate bme[4] = {};
+  found[0].count = 3;
+  found[0].addrs[0] = 0x48; found[0].addrs[1] = 0x76; found[0].addrs[2] = 0x77;
+  bme[0] = { true, 0x77, 0x61 };
+
+  MdpLatency lat;
+  uint64_t saves = 0;
+  uint64_t payload = 0;
+  uint32_t endMs = (uint32_t)(o.hours * 3600000.0);
+  for (uint32_t t = 0; t < endMs; t += o.scanMs) {
+    if (rndU() < o.scanChange) found[0].addrs[rnd() % 3] = (uint8_t)(0x08 + rnd() % 0x70);
+    uint64_t b = nor.busyNs();
+    if (legacy) {
+      for (int bus = 0; bus < 4; bus++) {
+        char k[16];
+        snprintf(k, sizeof(k), "b%d_cnt", bus);
+        kv.set(kv.ctx, k, &found[bus].count, 1);
+        for (int i = 0; i < 16; i++) {
+          snprintf(k, sizeof(k), "b%d_a%02d", bus, i);
+          kv.set(kv.ctx, k, &found[bus].addrs[i], 1);
+        }
+        uint8_t a = bme[bus].present ? bme[bus].addr : 0, c = bme[bus].present ? bme[bus].chip_id : 0;
+        snprintf(k, sizeof(k), "b%d_bme_a", bus);
+        kv.set(kv.ctx, k, &a, 1);
+        snprintf(k, sizeof(k), "b%d_bme_c", bus);
+        kv.set(kv.ctx, k, &c, 1);
+      }
+      payload += 76;
+    } else {
+      ScanCache c, stored;
+      memset(&c, 0, sizeof(c));
+      c.version = 1;
+      memcpy(c.found, found, sizeof(c.found));
+      memcpy(c.bme, bme, sizeof(c.bme));
+      (void)mdp_kv_put_if_changed(&kv, "scan", &c, sizeof(c), &stored);
+      payload += sizeof(c);
+    }
+    lat.add(nor.busyNs() - b);
+    saves++;
+  }
+
+  printf("{\"workload\":\"scan\",\"store\":\"%s\",\"hours\":%.2f,\"scan_ms\":%u,\"saves\":%llu,",
+         legacy ? "legacy_keys" : "blob", o.hours, o.scanMs, (unsigned long long)saves);
+  lat.printJson(stdout, "save");
+  printFlash(stdout, nor, (double)payload, o.hours);
+  const MdpNvsStats& s = nvs.stats();
+  printf(",\"nvs\":{\"sets\":%llu,\"identical\":%llu,\"entries\":%llu,\"gc\":%llu}}\n",
+         (unsigned long long)s.sets, (unsigned long long)s.identical,
+         (unsigned long long)s.entries, (unsigned long long)s.gc);
+  fflush(stdout);
+}
+
+// ---------------------------------------------------------------------- main
+
+static std::unique_ptr<Store> makeStore(const std::string& n, const Opts& o) {
+  if (n == "legacy_nvs") return std::unique_ptr<Store>(new LegacyNvsStore());
+  if (n == "flashlog") {
+    mdp_durable_cfg_t c = { (uint16_t)(MDP_DURABLE_ENTRY_HDR + MAX_PAYLOAD), 0, false };
+    return std::unique_ptr<Store>(new DurableStore("flashlog", c));
+  }
+  if (n == "flashlog_batch") {
+    mdp_durable_cfg_t c = { (uint16_t)o.batchBytes, o.flushMs, true };
+    return std::unique_ptr<Store>(new DurableStore("flashlog_batch", c));
+  }
+  return nullptr;
+}
+
+int main(int argc, char** argv) {
+  Opts o;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--workload") && v) { o.workload = v; i++; }
+    else if (!strcmp(a, "--store") && v) { o.stores.push_back(v); i++; }
+    else if (!strcmp(a, "--hours") && v) { o.hours = atof(v); i++; }
+    else if (!strcmp(a, "--period-ms") && v) { o.periodMs = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--outage-min") && v) { o.outageMin = atof(v); i++; }
+    else if (!strcmp(a, "--outage-every-min") && v) { o.outageEveryMin = atof(v); i++; }
+    else if (!strcmp(a, "--one-way-ms") && v) { o.oneWayMs = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--log-kb") && v) { o.logKb = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--nvs-kb") && v) { o.nvsKb = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--batch-bytes") && v) { o.batchBytes = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--flush-ms") && v) { o.flushMs = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--scan-ms") && v) { o.scanMs = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--scan-change") && v) { o.scanChange = atof(v); i++; }
+    else if (!strcmp(a, "--power-cuts") && v) { o.powerCuts = (uint32_t)atol(v); i++; }
+    else if (!strcmp(a, "--seed") && v) { o.seed = strtoull(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--image") && v) { o.image = v; i++; }
+    else {
+      fprintf(stderr,
+              "usage: %s [--workload queue|scan] [--store legacy_nvs|flashlog|flashlog_batch]...\n"
+              "       [--hours H] [--period-ms N] [--outage-min M] [--outage-every-min M]\n"
+              "       [--one-way-ms N] [--log-kb N] [--nvs-kb N] [--batch-bytes N] [--flush-ms N]\n"
+              "       [--scan-ms N] [--scan-change P] [--power-cuts N] [--seed N] [--image FILE]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (o.periodMs % TICK_MS || o.periodMs == 0) {
+    fprintf(stderr, "--period-ms must be a multiple of %u\n", TICK_MS);
+    return 2;
+  }
+  if (o.batchBytes > MDP_DURABLE_BATCH_MAX) o.batchBytes = MDP_DURABLE_BATCH_MAX;
+
+  if (o.workload == "scan") {
+    rng_state = o.seed;
+    runScan(o, true);
+    rng_state = o.seed;
+    runScan(o, false);
+    return 0;
+  }
+
+  if (o.stores.empty()) o.stores = { "legacy_nvs", "flashlog", "flashlog_batch" };
+  for (const std::string& n : o.stores) {
+    std::unique_ptr<Store> st = makeStore(n, o);
+    if (!st) { fprintf(stderr, "unknown store %s\n", n.c_str()); return 2; }
+    bool legacy = n == "legacy_nvs";
+    uint32_t kb = legacy ? o.nvsKb : o.logKb;
+    if (!st->nor.open(o.image, SECTOR, kb * 1024 / SECTOR)) { perror("image"); return 1; }
+    st->nor.blank();
+    if (!st->mount()) { fprintf(stderr, "%s: mount failed\n", n.c_str()); return 1; }
+    rng_state = o.seed;
+    Opts run = o;
+    if (legacy) run.powerCuts = 0;
+    QueueSim sim(run, *st);
+    sim.run();
+    sim.report(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,1160 @@
+// mdp_swarm — virtual MycoBrain swarm for gateway load testing.
+//
+// Spawns N virtual nodes that speak MDP v1 exactly as the firmware does:
+// firmware/common framing, the Side-A command set (CMD_SET_TELEM_MS,
+// CMD_SET_MOS, ...) answered with EVT_CMD_RESULT events, cumulative ACKs and
+// the firmware's own retransmit queue (firmware/common/mdp_arq, with Side-A or
+// Side-B sizing). Each node emits BME688 + analog telemetry with slow drift
+// and noise.
+//
+// Links:
+//   pty    one pseudo-terminal per node; slave paths go to --pty-list for the
+//          daemon under test. Wall-clock time.
+//   udp    one UDP socket per node, sending to --gw host:port (Side-B's WiFi
+//          path). --gw-sim answers in-process. Wall-clock time.
+//   radio  one shared LoRa channel with Semtech airtime, talking to the
+//          in-process gateway model. Unslotted ALOHA: overlapping frames are
+//          lost unless the wanted one is --capture-db stronger (per-node
+//          RSSI), radios are half-duplex, plus --per random loss. Virtual
+//          time, so an hour of a 500-node site runs in seconds.
+//
+//   mdp_swarm --link radio --nodes 500 --telem-ms 30000 --duration 3600
+//   mdp_swarm --link udp --nodes 2000 --gw 127.0.0.1:8001 [--gw-sim]
+//   mdp_swarm --link pty --nodes 64 --pty-list ptys.txt
+//
+// Common options: --role a|b, --telem-ms N, --format envelope|compact, --rto-ms N,
+// --cmd-rate N (gateway model commands/s), --retune-ms N, --per P, --seed N,
+// --report-s N. NDJSON interval lines and a final summary go to stdout.
+//
+// Node timers run on a skewed crystal (--ppm) and fire a few ms late like a
+// polled loop() (--jitter-ms); without that, nodes with equal periods lock
+// into collisions that real hardware drifts out of.
+//
+// MDP v1 has no node address beyond the endpoint byte, so the gateway model
+// tells peers apart the way a multi-node gateway would have to: by UDP source
+// port, or (radio) by out-of-band sender id. The firmware gateway keeps one
+// seq space and one in-order counter for all peers; the model keeps them per
+// peer.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <queue>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <mdp_arq.h>
+#include <mdp_commands.h>
+#include <mdp_types.h>
+#include <mdp_utils.h>
+#include <myco_envelope.h>
+
+#include "mdp_host_io.h"
+#include "mdp_link_emu.h"
+#include "mdp_shm_bus.h"
+#include "mdp_stats.h"
+
+// Side-A local commands (side_a/src/main.cpp). The common header reuses
+// 0x0010.. for WiFi Sense, so these stay local exactly as in the firmware.
+static constexpr uint16_t CMD_SET_DEVICE_ROLE         = 0x000A;
+static constexpr uint16_t CMD_SET_DEVICE_DISPLAY_NAME = 0x000B;
+static constexpr uint16_t CMD_GET_DEVICE_IDENTITY     = 0x000C;
+static constexpr uint16_t CMD_PIXEL_SET_COLOR         = 0x0010;
+static constexpr uint16_t CMD_PIXEL_OFF               = 0x0013;
+static constexpr uint16_t CMD_BUZZER_TONE             = 0x0020;
+static constexpr uint16_t CMD_BUZZER_STOP             = 0x0022;
+
+static constexpr size_t   MAX_PAYLOAD     = 900;
+static constexpr size_t   MAX_FRAME       = 1200;
+static constexpr size_t   LORA_MAX_PACKET = 255;
+static constexpr uint64_t MS              = 1000000ull;
+static constexpr uint64_t SEC             = 1000000000ull;
+static constexpr uint64_t REBOOT_NS       = 2 * SEC;
+static constexpr uint64_t CMD_GIVEUP_NS   = 30 * SEC;
+static constexpr uint32_t GW_TAG          = 0xFFFFFFFFu;
+
+enum Link { LINK_PTY, LINK_UDP, LINK_RADIO };
+
+// Retransmit-queue behaviour of the two firmware sides.
+struct Profile {
+  const char* name;
+  uint8_t ep;
+  uint8_t dst;
+  uint8_t slots;
+  uint8_t maxRetries;
+  bool    ackUnseq;   // Side-A's ACK-only frames carry seq 0 and are sent once
+};
+static const Profile PROFILE_A = {"side_a", EP_SIDE_A, EP_SIDE_B, 6, 8, true};
+static const Profile PROFILE_B = {"side_b", EP_SIDE_B, EP_GATEWAY, 8, 5, false};
+
+// Envelope sensor/unit codes (mycobrain/myco-iot-stack/spec/sensor_codes.md).
+enum : uint16_t {
+  SID_AI1 = 20, SID_MOS1 = 30,
+  UNIT_V = 9, UNIT_BOOL = 10
+};
+
+#pragma pack(push,1)
+// --format compact: sim-only binary body for LoRa airtime budgeting.
+struct TelemCompact {
+  uint32_t uptime_ms;
+  float    ai_volts[4];
+  uint8_t  mos[3];
+  uint8_t  rsv;
+  float    bme_t;
+  float    bme_rh;
+  float    bme_p;
+  float    bme_gas;
+};
+#pragma pack(pop)
+
+struct Sensors {
+  double tBase, rhBase, p, logGas, phase;
+  double t, rh, gas;
+  double aiBase[4], ai[4];
+};
+
+struct Node {
+  uint32_t id = 0;
+  uint32_t txSeq = 1;
+  mdp_arq_rx_t rx;
+  uint32_t telemMs = 1000;
+  uint64_t bootNs = 0;
+  uint64_t upUntilNs = 0;      // > now while rebooting
+  uint64_t pumpAt = 0;
+  bool     pumpPending = false;
+  bool     mos[3] = {false, false, false};
+  char     role[32] = "standalone";
+  char     name[64] = "";
+  Sensors  s;
+  mdp_arq_t q;
+  std::vector<mdp_arq_slot_t> slots;
+  std::vector<uint8_t> pool;
+  std::vector<uint64_t> firstNs;   // per slot, sim time of the first send
+  int      fd = -1;
+  int      slaveFd = -1;
+  uint16_t port = 0;
+  uint64_t radioFreeAt = 0;
+  double   clock = 1.0;        // local ms per real ms (crystal skew)
+  double   rssi = -100.0;      // dBm, node <-> gateway
+};
+
+// Gateway model state per peer (see header comment).
+struct GwPeer {
+  uint32_t txSeq = 1;
+  mdp_arq_rx_t rx;
+  uint32_t maxSeq = 0;
+  uint32_t ackFrom = 0;
+  bool     cmdPending = false;
+  bool     cmdAcked = false;
+  uint8_t  cmdRetries = 0;
+  uint16_t cmdId = 0;
+  uint16_t cmdLen = 0;
+  uint32_t cmdSeq = 0;
+  uint64_t cmdFirstNs = 0;
+  uint64_t cmdLastNs = 0;
+  uint8_t  cmd[64];
+  sockaddr_in addr{};
+};
+
+struct RadioTx {
+  uint64_t start, end;
+  uint32_t from, to;          // node index or GW_TAG
+  bool done;
+  std::vector<uint8_t> frame;
+};
+
+enum EvKind : uint8_t { EV_TELEM, EV_PUMP, EV_RADIO_DONE, EV_GW_CMD, EV_GW_PUMP, EV_REPORT };
+
+struct Ev {
+  uint64_t t;
+  uint64_t order;
+  uint64_t arg;
+  uint8_t  kind;
+  bool operator>(const Ev& o) const { return t != o.t ? t > o.t : order > o.order; }
+};
+
+struct Counters {
+  uint64_t telem = 0, events = 0, acks = 0;   // originated messages
+  uint64_t framesTx = 0, bytesTx = 0, retx = 0;
+  uint64_t delivered = 0, telemDelivered = 0; // freed by a cumulative ACK
+  uint64_t expired = 0, queueFull = 0;
+  uint64_t framesRx = 0, rxBad = 0;
+  uint64_t cmdsRx = 0, reboots = 0, txDrop = 0;
+  MdpLatency ackLat;
+};
+
+struct GwCounters {
+  uint64_t framesRx = 0, rxBad = 0, inorder = 0, dup = 0, gap = 0;
+  uint64_t acksTx = 0, cmdsTx = 0, cmdRetx = 0, cmdResults = 0, cmdTimeouts = 0;
+  uint64_t bytesRx = 0;
+  MdpLatency cmdRtt;
+};
+
+struct RadioCounters {
+  uint64_t tx = 0, collided = 0, perLoss = 0, oversize = 0;
+  uint64_t airNs = 0;
+};
+
+static volatile sig_atomic_t running = 1;
+static void onSignal(int) { running = 0; }
+
+// ---- simulation state ----
+static struct {
+  Link link = LINK_RADIO;
+  const Profile* prof = &PROFILE_B;
+  bool virt = true;
+  bool envelopeBody = true;
+  bool gwModel = false;
+  uint32_t rtoMs = 0;
+  uint32_t gwRtoMs = 0;
+  uint32_t retuneMs = 0;
+  double cmdRate = 0;
+  double per = 0;
+  int sf = 9;
+  double bwKhz = 125.0;
+  int cr = 7;
+  double captureDb = 6.0;
+  double ppm = 20.0;
+  double jitterMs = 2.0;
+  uint64_t maxAirNs = 0;
+  uint64_t now = 0;
+  uint64_t t0 = 0;
+  uint64_t order = 0;
+  uint64_t rng = 0x9E3779B97F4A7C15ull;
+  std::priority_queue<Ev, std::vector<Ev>, std::greater<Ev>> heap;
+  std::vector<Node> nodes;
+  std::vector<GwPeer> peers;
+  std::vector<mdp_frame_splitter_t> splitters;
+  std::unordered_map<uint16_t, uint32_t> portToNode;
+  std::unordered_map<uint64_t, RadioTx> air;
+  std::vector<uint64_t> active;
+  uint64_t nextAirId = 1;
+  uint64_t gwRadioFreeAt = 0;
+  int epfd = -1;
+  int gwFd = -1;
+  sockaddr_in gwAddr{};
+  Counters c;
+  GwCounters gw;
+  RadioCounters radio;
+} g;
+
+static uint64_t rnd() {
+  uint64_t x = g.rng;
+  x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+  g.rng = x;
+  return x * 0x2545F4914F6CDD1Dull;
+}
+static double rndU() { return (double)(rnd() >> 11) * (1.0 / 9007199254740992.0); }
+static double rndN() {
+  double u1 = rndU(), u2 = rndU();
+  if (u1 < 1e-300) u1 = 1e-300;
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static uint64_t clockNs() { return g.virt ? g.now : mdp_shm_now_ns() - g.t0; }
+
+static void schedule(uint64_t t, EvKind kind, uint64_t arg) {
+  g.heap.push(Ev{t, g.order++, arg, (uint8_t)kind});
+}
+
+// A local-clock interval on node n, in sim ns, plus loop() poll latency.
+static uint64_t nodeDelayNs(const Node& n, uint64_t ms) {
+  return (uint64_t)((double)ms * (double)MS * n.clock + rndU() * g.jitterMs * (double)MS);
+}
+
+// ==============================
+//   Sensor model (BME688 + AI)
+// ==============================
+static void sensorInit(Sensors& s) {
+  s.tBase = 21.0 + rndN() * 2.0;
+  s.rhBase = 65.0 + rndN() * 8.0;
+  s.p = 1013.25 + rndN() * 6.0;
+  s.logGas = log(60000.0) + rndN() * 0.6;
+  s.phase = rndU() * 6.283185307179586;
+  for (int i = 0; i < 4; i++) {
+    s.aiBase[i] = 0.3 + rndU() * 2.4;
+    s.ai[i] = s.aiBase[i];
+  }
+  s.t = s.tBase;
+  s.rh = s.rhBase;
+  s.gas = exp(s.logGas);
+}
+
+static void sensorStep(Sensors& s, double tSec) {
+  // Diurnal temperature swing, humidity moving against it, slow pressure and
+  // VOC random walks, a few mV of ADC noise on the analog inputs.
+  double day = sin(6.283185307179586 * tSec / 86400.0 + s.phase);
+  s.t = s.tBase + 3.0 * day + rndN() * 0.05;
+  s.rh = s.rhBase - 10.0 * day + rndN() * 0.4;
+  if (s.rh < 5.0) s.rh = 5.0;
+  if (s.rh > 100.0) s.rh = 100.0;
+  s.p += rndN() * 0.02;
+  s.logGas += rndN() * 0.01 - 0.002 * (s.rh - s.rhBase) * 0.1;
+  if (s.logGas < log(5000.0)) s.logGas = log(5000.0);
+  if (s.logGas > log(500000.0)) s.logGas = log(500000.0);
+  s.gas = exp(s.logGas);
+  for (int i = 0; i < 4; i++) {
+    s.aiBase[i] += rndN() * 0.0005;
+    s.ai[i] = s.aiBase[i] + rndN() * 0.002;
+    if (s.ai[i] < 0.0) s.ai[i] = 0.0;
+    if (s.ai[i] > 3.3) s.ai[i] = 3.3;
+  }
+}
+
+// ==============================
+//   LoRa channel
+// ==============================
+static uint64_t loraAirtimeNs(size_t len) {
+  return mdp_lora_airtime_ns(len, g.sf, g.bwKhz, g.cr);
+}
+
+static void radioTx(uint32_t from, uint32_t to, const uint8_t* frame, size_t len) {
+  if (len > LORA_MAX_PACKET) { g.radio.oversize++; return; }
+  uint64_t& freeAt = (from == GW_TAG) ? g.gwRadioFreeAt : g.nodes[from].radioFreeAt;
+  uint64_t start = freeAt > g.now ? freeAt : g.now;
+  uint64_t end = start + loraAirtimeNs(len);
+  freeAt = end;
+
+  // Keep finished frames while they can still overlap one in flight.
+  size_t w = 0;
+  for (size_t i = 0; i < g.active.size(); i++) {
+    auto it = g.air.find(g.active[i]);
+    if (it == g.air.end()) continue;
+    if (it->second.done && it->second.end + g.maxAirNs <= g.now) { g.air.erase(it); continue; }
+    g.active[w++] = g.active[i];
+  }
+  g.active.resize(w);
+
+  RadioTx tx{start, end, from, to, false, std::vector<uint8_t>(frame, frame + len)};
+  uint64_t id = g.nextAirId++;
+  g.air.emplace(id, std::move(tx));
+  g.active.push_back(id);
+  g.radio.tx++;
+  g.radio.airNs += end - start;
+  schedule(end, EV_RADIO_DONE, id);
+}
+
+// ==============================
+//   Node: ARQ (firmware semantics)
+// ==============================
+// Whether the frame survives everything else on air at its receiver.
+static bool radioReceived(uint64_t id, const RadioTx& tx) {
+  uint32_t rx = tx.to;
+  double wanted = g.nodes[tx.from == GW_TAG ? tx.to : tx.from].rssi;
+  double worst = -1e9;
+  for (uint64_t oid : g.active) {
+    if (oid == id) continue;
+    auto it = g.air.find(oid);
+    if (it == g.air.end()) continue;
+    const RadioTx& o = it->second;
+    if (o.end <= tx.start || o.start >= tx.end) continue;
+    if (o.from == rx) return false;   // half-duplex: receiver was transmitting
+    // Interference power at the receiver; node-to-node paths are not
+    // modelled, so an interfering node counts with its gateway-link RSSI.
+    double p = g.nodes[o.from == GW_TAG ? rx : o.from].rssi;
+    if (p > worst) worst = p;
+  }
+  return wanted - worst >= g.captureDb;
+}
+
+static void nodeOnPayload(Node& n, const uint8_t* p, size_t len);
+static void gwOnPayload(uint32_t peer, const uint8_t* p, size_t len);
+
+static void nodeSendRaw(Node& n, const uint8_t* payload, uint16_t len) {
+  static uint8_t frame[MAX_FRAME];
+  size_t flen = mdp_build_frame(payload, len, frame, sizeof(frame));
+  if (!flen) return;
+  g.c.framesTx++;
+  g.c.bytesTx += flen;
+  switch (g.link) {
+    case LINK_PTY:
+    case LINK_UDP: {
+      ssize_t w = (g.link == LINK_PTY) ? write(n.fd, frame, flen) : send(n.fd, frame, flen, 0);
+      if (w != (ssize_t)flen) g.c.txDrop++;
+    } break;
+    case LINK_RADIO:
+      radioTx(n.id, GW_TAG, frame, flen);
+      break;
+  }
+}
+
+static void schedulePump(Node& n, uint64_t t) {
+  if (n.pumpPending && n.pumpAt <= t) return;
+  n.pumpPending = true;
+  n.pumpAt = t;
+  schedule(t, EV_PUMP, n.id);
+}
+
+// The node's millis(): sim time on its skewed crystal.
+static uint32_t nodeMillis(const Node& n) {
+  return (uint32_t)((double)g.now / ((double)MS * n.clock));
+}
+
+static void scheduleNextPump(Node& n) {
+  uint32_t due = mdp_arq_next_due(&n.q, nodeMillis(n));
+  if (due != UINT32_MAX) schedulePump(n, g.now + nodeDelayNs(n, due));
+}
+
+static bool nodeArqSend(void* ctx, const uint8_t* payload, uint16_t len) {
+  nodeSendRaw(*(Node*)ctx, payload, len);
+  return true;
+}
+
+static void nodeArqAcked(void* ctx, const mdp_arq_slot_t* it) {
+  Node& n = *(Node*)ctx;
+  g.c.delivered++;
+  if (((const mdp_hdr_v1_t*)it->payload)->msg_type == MDP_TELEMETRY) g.c.telemDelivered++;
+  g.c.ackLat.add(g.now - n.firstNs[(size_t)(it - n.slots.data())]);
+}
+
+static void nodeArqInit(Node& n) {
+  const mdp_arq_cfg_t c = { g.rtoMs, g.prof->maxRetries };
+  n.slots.resize(g.prof->slots);
+  n.pool.resize((size_t)g.prof->slots * MAX_PAYLOAD);
+  n.firstNs.resize(g.prof->slots);
+  mdp_arq_init(&n.q, n.slots.data(), g.prof->slots, n.pool.data(), MAX_PAYLOAD, &c,
+               nodeArqSend, &n);
+  n.q.on_acked = nodeArqAcked;
+  mdp_arq_rx_init(&n.rx);
+}
+
+// Send + keep for retransmission, as both firmware sides do. On a full queue
+// nothing goes out and the caller does not consume the seq.
+static bool nodeSendReliable(Node& n, const uint8_t* payload, uint16_t len) {
+  if (!mdp_arq_send(&n.q, payload, len, ((const mdp_hdr_v1_t*)payload)->seq, nodeMillis(n))) {
+    return false;
+  }
+  for (size_t i = 0; i < n.slots.size(); i++) {
+    if (n.slots[i].used && n.slots[i].seq == ((const mdp_hdr_v1_t*)payload)->seq) n.firstNs[i] = g.now;
+  }
+  scheduleNextPump(n);
+  return true;
+}
+
+static void txPump(Node& n) {
+  mdp_arq_pump(&n.q, nodeMillis(n));
+  scheduleNextPump(n);
+}
+
+static void fillHdr(mdp_hdr_v1_t* h, uint8_t type, uint32_t seq, uint32_t ack, uint8_t flags,
+                    uint8_t src, uint8_t dst) {
+  h->magic = MDP_MAGIC;
+  h->version = MDP_VER;
+  h->msg_type = type;
+  h->seq = seq;
+  h->ack = ack;
+  h->flags = flags;
+  h->src = src;
+  h->dst = dst;
+  h->rsv = 0;
+}
+
+// Side-B's ACK-only frames take a seq and are queued like any other message;
+// with the queue full they still go out once. Side-A's are unsequenced.
+static void nodeSendAck(Node& n) {
+  uint8_t out[sizeof(mdp_hdr_v1_t)];
+  auto* h = (mdp_hdr_v1_t*)out;
+  g.c.acks++;
+  if (g.prof->ackUnseq) {
+    fillHdr(h, MDP_ACK, 0, n.rx.last_inorder, IS_ACK, g.prof->ep, g.prof->dst);
+    nodeSendRaw(n, out, sizeof(out));
+    return;
+  }
+  fillHdr(h, MDP_ACK, n.txSeq++, n.rx.last_inorder, IS_ACK, g.prof->ep, g.prof->dst);
+  if (!nodeSendReliable(n, out, sizeof(out))) nodeSendRaw(n, out, sizeof(out));
+}
+
+static uint16_t buildTelemetryBody(Node& n, uint32_t seq, uint8_t* out, size_t cap) {
+  Sensors& s = n.s;
+  uint32_t upMs = (uint32_t)((g.now - n.bootNs) / MS);
+  if (!g.envelopeBody) {
+    TelemCompact t;
+    memset(&t, 0, sizeof(t));
+    t.uptime_ms = upMs;
+    for (int i = 0; i < 4; i++) t.ai_volts[i] = (float)s.ai[i];
+    for (int i = 0; i < 3; i++) t.mos[i] = n.mos[i] ? 1 : 0;
+    t.bme_t = (float)s.t;
+    t.bme_rh = (float)s.rh;
+    t.bme_p = (float)s.p;
+    t.bme_gas = (float)s.gas;
+    if (sizeof(t) > cap) return 0;
+    memcpy(out, &t, sizeof(t));
+    return (uint16_t)sizeof(t);
+  }
+
+  // Signed MycoEnvelope with the same readings, codes and scaling as Side-A's
+  // buildTelemetryEnvelope() (~255 bytes; the BME688 values only go in the
+  // compact body). Crypto is the host stand-in (myco_sim_crypto.cpp).
+  myco_reading_t r[7];
+  for (int i = 0; i < 4; i++) r[i] = { (uint16_t)(SID_AI1 + i), (int32_t)lround(s.ai[i] * 1e4), 4, UNIT_V, 0 };
+  for (int i = 0; i < 3; i++) r[4 + i] = { (uint16_t)(SID_MOS1 + i), n.mos[i] ? 1 : 0, 0, UNIT_BOOL, 0 };
+  uint8_t msgId[16] = {};
+  memcpy(msgId, &n.id, sizeof(n.id));
+  memcpy(msgId + 4, &n.bootNs, sizeof(n.bootNs));
+  memcpy(msgId + 12, &seq, sizeof(seq));
+  char devId[24];
+  snprintf(devId, sizeof(devId), "mycobrain-sim-%05u", n.id);
+  static const uint8_t sk[64] = {};
+  size_t len = 0;
+  if (myco_build_envelope_cbor(out, cap, &len, devId, MYCO_PROTO_OTHER, msgId,
+                               (int64_t)(1760000000ull * 1000 + g.now / MS), seq, upMs,
+                               nullptr, r, 7, sk) != 0) {
+    return 0;
+  }
+  return (uint16_t)len;
+}
+
+static void nodeTelemetry(Node& n) {
+  uint8_t out[MAX_PAYLOAD];
+  auto* h = (mdp_hdr_v1_t*)out;
+  sensorStep(n.s, (double)g.now / 1e9);
+  fillHdr(h, MDP_TELEMETRY, n.txSeq, n.rx.last_inorder, ACK_REQUESTED, g.prof->ep, g.prof->dst);
+  uint16_t body = buildTelemetryBody(n, h->seq, out + sizeof(*h), sizeof(out) - sizeof(*h));
+  if (!body) return;
+  g.c.telem++;
+  if (nodeSendReliable(n, out, (uint16_t)(sizeof(*h) + body))) n.txSeq++;
+}
+
+static uint32_t rd32(const uint8_t* d) {
+  return (uint32_t)d[0] | ((uint32_t)d[1] << 8) | ((uint32_t)d[2] << 16) | ((uint32_t)d[3] << 24);
+}
+
+// Mirrors Side-A's handleMdpPayload() command switch.
+static void nodeCommand(Node& n, const mdp_cmd_v1_t* cmd, size_t len) {
+  uint16_t cmdLen = cmd->cmd_len;
+  const uint8_t* data = cmd->cmd_data;
+  if (sizeof(mdp_cmd_v1_t) + cmdLen > len) return;
+  g.c.cmdsRx++;
+
+  int16_t status = 0;
+  switch (cmd->cmd_id) {
+    case CMD_SET_I2C:
+      if (cmdLen < 2) status = -2;
+      break;
+    case CMD_SCAN_I2C:
+    case CMD_SAVE_NVS:
+    case CMD_LOAD_NVS:
+    case CMD_GET_DEVICE_IDENTITY:
+    case CMD_PIXEL_OFF:
+    case CMD_BUZZER_STOP:
+      break;
+    case CMD_SET_TELEM_MS: {
+      if (cmdLen < 4) { status = -2; break; }
+      uint32_t ms = rd32(data);
+      if (ms < 100) ms = 100;
+      if (ms > 60000) ms = 60000;
+      n.telemMs = ms;
+    } break;
+    case CMD_SET_MOS: {
+      if (cmdLen < 2) { status = -2; break; }
+      int idx = (int)data[0] - 1;
+      if (idx < 0 || idx > 2) { status = -3; break; }
+      n.mos[idx] = data[1] != 0;
+    } break;
+    case CMD_REBOOT:
+      // ESP.restart() before the result goes out: RAM queue and peer
+      // tracking are lost, tx_seq survives (NVS).
+      g.c.reboots++;
+      mdp_arq_reset(&n.q);
+      mdp_arq_rx_init(&n.rx);
+      n.bootNs = g.now + REBOOT_NS;
+      n.upUntilNs = g.now + REBOOT_NS;
+      return;
+    case CMD_SET_DEVICE_ROLE:
+    case CMD_SET_DEVICE_DISPLAY_NAME: {
+      if (cmdLen < 1) { status = -2; break; }
+      char* dst = cmd->cmd_id == CMD_SET_DEVICE_ROLE ? n.role : n.name;
+      size_t cap = cmd->cmd_id == CMD_SET_DEVICE_ROLE ? sizeof(n.role) : sizeof(n.name);
+      size_t copyLen = cmdLen < cap - 1 ? cmdLen : cap - 1;
+      memcpy(dst, data, copyLen);
+      dst[copyLen] = '\0';
+    } break;
+    case CMD_PIXEL_SET_COLOR:
+      if (cmdLen < 3) status = -2;
+      break;
+    case CMD_BUZZER_TONE:
+      if (cmdLen < 4) status = -2;
+      break;
+    default:
+      status = -1;
+      break;
+  }
+
+  uint8_t out[sizeof(mdp_evt_cmd_result_v1_t)];
+  auto* e = (mdp_evt_cmd_result_v1_t*)out;
+  memset(out, 0, sizeof(out));
+  fillHdr(&e->hdr, MDP_EVENT, n.txSeq, n.rx.last_inorder, ACK_REQUESTED, g.prof->ep,
+          cmd->hdr.src);
+  e->evt_type = EVT_CMD_RESULT;
+  e->cmd_id = cmd->cmd_id;
+  e->status = status;
+  e->evt_len = sizeof(uint16_t) + sizeof(int16_t);
+  g.c.events++;
+  if (nodeSendReliable(n, out, sizeof(out))) n.txSeq++;
+}
+
+static void nodeOnPayload(Node& n, const uint8_t* p, size_t len) {
+  if (g.now < n.upUntilNs) return;
+  if (len < sizeof(mdp_hdr_v1_t)) { g.c.rxBad++; return; }
+  auto* h = (const mdp_hdr_v1_t*)p;
+  if (h->magic != MDP_MAGIC || h->version != MDP_VER) { g.c.rxBad++; return; }
+  g.c.framesRx++;
+
+  mdp_arq_on_ack(&n.q, h->ack);
+
+  // v1: every copy is acted on; only the in-order counter tells them apart.
+  (void)mdp_arq_rx_accept(&n.rx, h->seq);
+  if (h->flags & ACK_REQUESTED) nodeSendAck(n);
+
+  if (h->msg_type == MDP_COMMAND && len >= sizeof(mdp_cmd_v1_t)) {
+    nodeCommand(n, (const mdp_cmd_v1_t*)p, len);
+  }
+}
+
+static void nodeOnFrame(Node& n, const uint8_t* frame, size_t len) {
+  static uint8_t payload[1536];
+  size_t plen = mdp_decode_frame(frame, len, payload, sizeof(payload));
+  if (!plen) { g.c.rxBad++; return; }
+  nodeOnPayload(n, payload, plen);
+}
+
+static void onPtyFrame(void* ctx, const uint8_t* frame, size_t len) {
+  nodeOnFrame(*(Node*)ctx, frame, len);
+}
+
+// ==============================
+//   Gateway model
+// ==============================
+static void gwSendRaw(uint32_t peer, const uint8_t* payload, uint16_t len) {
+  static uint8_t frame[MAX_FRAME];
+  size_t flen = mdp_build_frame(payload, len, frame, sizeof(frame));
+  if (!flen) return;
+  if (g.link == LINK_RADIO) {
+    radioTx(GW_TAG, peer, frame, flen);
+  } else if (g.link == LINK_UDP) {
+    GwPeer& gp = g.peers[peer];
+    (void)sendto(g.gwFd, frame, flen, 0, (const sockaddr*)&gp.addr, sizeof(gp.addr));
+  }
+}
+
+static void gwSendAck(uint32_t peer) {
+  GwPeer& gp = g.peers[peer];
+  uint8_t out[sizeof(mdp_hdr_v1_t)];
+  fillHdr((mdp_hdr_v1_t*)out, MDP_ACK, gp.txSeq++, gp.rx.last_inorder, IS_ACK, EP_GATEWAY,
+          g.prof->ep);
+  g.gw.acksTx++;
+  gwSendRaw(peer, out, sizeof(out));
+}
+
+static void gwOnPayload(uint32_t peer, const uint8_t* p, size_t len) {
+  if (peer >= g.peers.size()) return;
+  if (len < sizeof(mdp_hdr_v1_t)) { g.gw.rxBad++; return; }
+  auto* h = (const mdp_hdr_v1_t*)p;
+  if (h->magic != MDP_MAGIC || h->version != MDP_VER) { g.gw.rxBad++; return; }
+  GwPeer& gp = g.peers[peer];
+  g.gw.framesRx++;
+  g.gw.bytesRx += len;
+
+  if (h->ack > gp.ackFrom) gp.ackFrom = h->ack;
+  if (gp.cmdPending && gp.ackFrom >= gp.cmdSeq) gp.cmdAcked = true;
+
+  if ((int32_t)(h->seq - gp.maxSeq) > 0) gp.maxSeq = h->seq;
+  mdp_arq_rx_result_t r = mdp_arq_rx_accept(&gp.rx, h->seq);
+  if (r == MDP_ARQ_RX_NEW) g.gw.inorder++;
+  else if (r == MDP_ARQ_RX_DUP) g.gw.dup++;
+  else g.gw.gap++;
+  if (h->flags & ACK_REQUESTED) gwSendAck(peer);
+
+  if (h->msg_type == MDP_EVENT && len >= sizeof(mdp_evt_cmd_result_v1_t)) {
+    auto* e = (const mdp_evt_cmd_result_v1_t*)p;
+    if (e->evt_type == EVT_CMD_RESULT && gp.cmdPending && e->cmd_id == gp.cmdId) {
+      g.gw.cmdResults++;
+      g.gw.cmdRtt.add(g.now - gp.cmdFirstNs);
+      gp.cmdPending = false;
+    }
+  }
+}
+
+static void gwOnFrame(uint32_t peer, const uint8_t* frame, size_t len) {
+  static uint8_t payload[1536];
+  size_t plen = mdp_decode_frame(frame, len, payload, sizeof(payload));
+  if (!plen) { g.gw.rxBad++; return; }
+  gwOnPayload(peer, payload, plen);
+}
+
+static void gwIssueCommand() {
+  uint32_t peer = (uint32_t)(rnd() % g.peers.size());
+  GwPeer& gp = g.peers[peer];
+  if (gp.cmdPending) return;
+
+  auto* cmd = (mdp_cmd_v1_t*)gp.cmd;
+  uint16_t dlen = 0;
+  switch (rnd() % 4) {
+    case 0: {
+      uint32_t ms = g.retuneMs ? g.retuneMs : g.nodes[peer].telemMs;
+      cmd->cmd_id = CMD_SET_TELEM_MS;
+      for (int i = 0; i < 4; i++) cmd->cmd_data[i] = (uint8_t)(ms >> (8 * i));
+      dlen = 4;
+    } break;
+    case 1:
+      cmd->cmd_id = CMD_SET_MOS;
+      cmd->cmd_data[0] = (uint8_t)(1 + rnd() % 3);
+      cmd->cmd_data[1] = (uint8_t)(rnd() & 1);
+      dlen = 2;
+      break;
+    case 2:
+      cmd->cmd_id = CMD_PIXEL_SET_COLOR;
+      cmd->cmd_data[0] = (uint8_t)rnd();
+      cmd->cmd_data[1] = (uint8_t)rnd();
+      cmd->cmd_data[2] = (uint8_t)rnd();
+      dlen = 3;
+      break;
+    default:
+      cmd->cmd_id = CMD_GET_DEVICE_IDENTITY;
+      break;
+  }
+  cmd->cmd_len = dlen;
+  fillHdr(&cmd->hdr, MDP_COMMAND, gp.txSeq++, gp.rx.last_inorder, ACK_REQUESTED, EP_GATEWAY,
+          g.prof->ep);
+  gp.cmdLen = (uint16_t)(sizeof(mdp_cmd_v1_t) + dlen);
+  gp.cmdId = cmd->cmd_id;
+  gp.cmdSeq = cmd->hdr.seq;
+  gp.cmdPending = true;
+  gp.cmdAcked = false;
+  gp.cmdRetries = 0;
+  gp.cmdFirstNs = g.now;
+  gp.cmdLastNs = g.now;
+  g.gw.cmdsTx++;
+  gwSendRaw(peer, gp.cmd, gp.cmdLen);
+  schedule(g.now + (uint64_t)g.gwRtoMs * MS, EV_GW_PUMP, peer);
+}
+
+static void gwPump(uint32_t peer) {
+  GwPeer& gp = g.peers[peer];
+  if (!gp.cmdPending) return;
+  if (g.now - gp.cmdFirstNs >= CMD_GIVEUP_NS ||
+      (!gp.cmdAcked && gp.cmdRetries >= PROFILE_B.maxRetries)) {
+    gp.cmdPending = false;
+    g.gw.cmdTimeouts++;
+    return;
+  }
+  if (!gp.cmdAcked) {
+    // Refresh the piggy-backed ack like a rebuilt frame would carry.
+    ((mdp_hdr_v1_t*)gp.cmd)->ack = gp.rx.last_inorder;
+    gp.cmdRetries++;
+    gp.cmdLastNs = g.now;
+    g.gw.cmdRetx++;
+    gwSendRaw(peer, gp.cmd, gp.cmdLen);
+  }
+  schedule(g.now + (uint64_t)g.gwRtoMs * MS, EV_GW_PUMP, peer);
+}
+
+// ==============================
+//   Transports
+// ==============================
+static bool setupPty(const char* listPath) {
+  FILE* lf = listPath ? fopen(listPath, "w") : nullptr;
+  if (listPath && !lf) return false;
+  g.splitters.resize(g.nodes.size());
+  for (auto& n : g.nodes) {
+    n.fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (n.fd < 0 || grantpt(n.fd) || unlockpt(n.fd)) return false;
+    const char* slave = ptsname(n.fd);
+    n.slaveFd = open(slave, O_RDWR | O_NOCTTY);
+    if (n.slaveFd >= 0) {
+      struct termios tio;
+      if (tcgetattr(n.slaveFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(n.slaveFd, TCSANOW, &tio);
+      }
+    }
+    mdp_splitter_init(&g.splitters[n.id]);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = n.id;
+    epoll_ctl(g.epfd, EPOLL_CTL_ADD, n.fd, &ev);
+    if (lf) fprintf(lf, "%u %s\n", n.id, slave);
+  }
+  if (lf) fclose(lf);
+  return true;
+}
+
+static bool setupUdp() {
+  if (g.gwModel) {
+    g.gwFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    setsockopt(g.gwFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int big = 8 << 20;
+    setsockopt(g.gwFd, SOL_SOCKET, SO_RCVBUF, &big, sizeof(big));
+    if (bind(g.gwFd, (const sockaddr*)&g.gwAddr, sizeof(g.gwAddr)) != 0) return false;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = GW_TAG;
+    epoll_ctl(g.epfd, EPOLL_CTL_ADD, g.gwFd, &ev);
+  }
+  for (auto& n : g.nodes) {
+    n.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (n.fd < 0) return false;
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = g.gwAddr.sin_addr.s_addr == htonl(INADDR_LOOPBACK)
+                                ? htonl(INADDR_LOOPBACK) : htonl(INADDR_ANY);
+    if (bind(n.fd, (const sockaddr*)&local, sizeof(local)) != 0) return false;
+    if (connect(n.fd, (const sockaddr*)&g.gwAddr, sizeof(g.gwAddr)) != 0) return false;
+    socklen_t sl = sizeof(local);
+    getsockname(n.fd, (sockaddr*)&local, &sl);
+    n.port = ntohs(local.sin_port);
+    g.portToNode[n.port] = n.id;
+    if (g.gwModel) g.peers[n.id].addr = local;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = n.id;
+    epoll_ctl(g.epfd, EPOLL_CTL_ADD, n.fd, &ev);
+  }
+  return true;
+}
+
+static void pollFds(int timeoutMs) {
+  epoll_event evs[256];
+  int n = epoll_wait(g.epfd, evs, 256, timeoutMs);
+  uint8_t buf[4096];
+  for (int i = 0; i < n; i++) {
+    uint64_t tag = evs[i].data.u64;
+    if (tag == GW_TAG) {
+      for (;;) {
+        sockaddr_in from{};
+        socklen_t fl = sizeof(from);
+        ssize_t r = recvfrom(g.gwFd, buf, sizeof(buf), 0, (sockaddr*)&from, &fl);
+        if (r <= 0) break;
+        g.now = clockNs();
+        auto it = g.portToNode.find(ntohs(from.sin_port));
+        if (it != g.portToNode.end()) gwOnFrame(it->second, buf, (size_t)r);
+      }
+      continue;
+    }
+    Node& nd = g.nodes[tag];
+    for (;;) {
+      ssize_t r = (g.link == LINK_PTY) ? read(nd.fd, buf, sizeof(buf)) : recv(nd.fd, buf, sizeof(buf), 0);
+      if (r <= 0) break;
+      g.now = clockNs();
+      if (g.link == LINK_PTY) mdp_splitter_feed(&g.splitters[nd.id], buf, (size_t)r, onPtyFrame, &nd);
+      else nodeOnFrame(nd, buf, (size_t)r);
+    }
+  }
+}
+
+// ==============================
+//   Reporting
+// ==============================
+static uint64_t inFlight() {
+  uint64_t k = 0;
+  for (auto& n : g.nodes) k += mdp_arq_in_flight(&n.q);
+  return k;
+}
+
+// Queue counters live in each node's mdp_arq_t; fold them into g.c.
+static void collectArqStats() {
+  g.c.retx = g.c.expired = g.c.queueFull = 0;
+  for (auto& n : g.nodes) {
+    g.c.retx += n.q.stats.retransmits;
+    g.c.expired += n.q.stats.expired;
+    g.c.queueFull += n.q.stats.queue_full;
+  }
+}
+
+struct Window {
+  uint64_t t = 0, delivered = 0, telem = 0, retx = 0, expired = 0, framesTx = 0;
+  size_t latFrom = 0;
+};
+
+static void report(Window& w) {
+  collectArqStats();
+  double dt = (double)(g.now - w.t) / 1e9;
+  MdpLatency win;
+  win.ns.assign(g.c.ackLat.ns.begin() + (long)w.latFrom, g.c.ackLat.ns.end());
+  printf("{\"t_s\":%.1f,\"telem\":%llu,\"frames_tx\":%llu,\"delivered\":%llu,"
+         "\"delivered_per_s\":%.1f,\"retx\":%llu,\"expired\":%llu,\"in_flight\":%llu,",
+         (double)g.now / 1e9, (unsigned long long)(g.c.telem - w.telem),
+         (unsigned long long)(g.c.framesTx - w.framesTx),
+         (unsigned long long)(g.c.delivered - w.delivered),
+         dt > 0 ? (double)(g.c.delivered - w.delivered) / dt : 0.0,
+         (unsigned long long)(g.c.retx - w.retx), (unsigned long long)(g.c.expired - w.expired),
+         (unsigned long long)inFlight());
+  win.printJson(stdout, "ack_latency");
+  printf("}\n");
+  fflush(stdout);
+  w.t = g.now;
+  w.delivered = g.c.delivered;
+  w.telem = g.c.telem;
+  w.retx = g.c.retx;
+  w.expired = g.c.expired;
+  w.framesTx = g.c.framesTx;
+  w.latFrom = g.c.ackLat.count();
+}
+
+static void summary(double secs) {
+  collectArqStats();
+  uint64_t reliable = g.c.telem + g.c.events + (g.prof->ackUnseq ? 0 : g.c.acks);
+  uint64_t lost = g.c.expired + g.c.queueFull;
+  printf("{\"summary\":true,\"link\":\"%s\",\"profile\":\"%s\",\"nodes\":%zu,\"sim_s\":%.1f,"
+         "\"format\":\"%s\",\"rto_ms\":%u,",
+         g.link == LINK_RADIO ? "radio" : (g.link == LINK_UDP ? "udp" : "pty"), g.prof->name,
+         g.nodes.size(), secs, g.envelopeBody ? "envelope" : "compact", g.rtoMs);
+  printf("\"nodes_tx\":{\"telemetry\":%llu,\"events\":%llu,\"acks\":%llu,\"frames\":%llu,"
+         "\"bytes\":%llu,\"retx\":%llu,\"drops\":%llu},",
+         (unsigned long long)g.c.telem, (unsigned long long)g.c.events,
+         (unsigned long long)g.c.acks, (unsigned long long)g.c.framesTx,
+         (unsigned long long)g.c.bytesTx, (unsigned long long)g.c.retx,
+         (unsigned long long)g.c.txDrop);
+  printf("\"delivery\":{\"delivered\":%llu,\"telemetry_delivered\":%llu,\"per_s\":%.1f,"
+         "\"tx_bps\":%.0f,\"expired\":%llu,\"queue_full\":%llu,\"in_flight\":%llu,"
+         "\"loss_pct\":%.3f},",
+         (unsigned long long)g.c.delivered, (unsigned long long)g.c.telemDelivered,
+         secs > 0 ? (double)g.c.delivered / secs : 0.0,
+         secs > 0 ? (double)g.c.bytesTx * 8.0 / secs : 0.0,
+         (unsigned long long)g.c.expired, (unsigned long long)g.c.queueFull,
+         (unsigned long long)inFlight(),
+         reliable ? 100.0 * (double)lost / (double)reliable : 0.0);
+  printf("\"nodes_rx\":{\"frames\":%llu,\"bad\":%llu,\"commands\":%llu,\"reboots\":%llu},",
+         (unsigned long long)g.c.framesRx, (unsigned long long)g.c.rxBad,
+         (unsigned long long)g.c.cmdsRx, (unsigned long long)g.c.reboots);
+  g.c.ackLat.printJson(stdout, "ack_latency");
+  if (g.gwModel) {
+    printf(",\"gateway\":{\"frames_rx\":%llu,\"bad\":%llu,\"inorder\":%llu,\"dup\":%llu,"
+           "\"gap\":%llu,\"acks_tx\":%llu,\"cmds\":%llu,\"cmd_retx\":%llu,\"cmd_results\":%llu,"
+           "\"cmd_timeouts\":%llu,",
+           (unsigned long long)g.gw.framesRx, (unsigned long long)g.gw.rxBad,
+           (unsigned long long)g.gw.inorder, (unsigned long long)g.gw.dup,
+           (unsigned long long)g.gw.gap, (unsigned long long)g.gw.acksTx,
+           (unsigned long long)g.gw.cmdsTx, (unsigned long long)g.gw.cmdRetx,
+           (unsigned long long)g.gw.cmdResults, (unsigned long long)g.gw.cmdTimeouts);
+    // A peer whose in-order counter sits behind the highest seq seen has a
+    // hole that v1 never fills once the sender gives up: nothing after it
+    // is acked again.
+    size_t stalled = 0;
+    for (auto& gp : g.peers) stalled += gp.maxSeq > gp.rx.last_inorder ? 1 : 0;
+    printf("\"stalled_peers\":%zu,", stalled);
+    g.gw.cmdRtt.printJson(stdout, "cmd_rtt");
+    printf("}");
+  }
+  if (g.link == LINK_RADIO) {
+    printf(",\"radio\":{\"sf\":%d,\"bw_khz\":%.1f,\"cr\":\"4/%d\",\"tx\":%llu,\"lost_on_air\":%llu,"
+           "\"per_loss\":%llu,\"oversize\":%llu,\"channel_util_pct\":%.2f}",
+           g.sf, g.bwKhz, g.cr, (unsigned long long)g.radio.tx,
+           (unsigned long long)g.radio.collided, (unsigned long long)g.radio.perLoss,
+           (unsigned long long)g.radio.oversize,
+           secs > 0 ? 100.0 * (double)g.radio.airNs / 1e9 / secs : 0.0);
+  }
+  printf("}\n");
+}
+
+// ==============================
+//   Main loop
+// ==============================
+static void dispatch(const Ev& e, uint64_t reportNs, Window& w) {
+  switch (e.kind) {
+    case EV_TELEM: {
+      Node& n = g.nodes[e.arg];
+      if (g.now >= n.upUntilNs) nodeTelemetry(n);
+      schedule(g.now + nodeDelayNs(n, n.telemMs), EV_TELEM, n.id);
+    } break;
+    case EV_PUMP: {
+      Node& n = g.nodes[e.arg];
+      if (!n.pumpPending || n.pumpAt != e.t) break;
+      n.pumpPending = false;
+      txPump(n);
+    } break;
+    case EV_RADIO_DONE: {
+      auto it = g.air.find(e.arg);
+      if (it == g.air.end()) break;
+      RadioTx& tx = it->second;
+      tx.done = true;
+      if (!radioReceived(e.arg, tx)) { g.radio.collided++; break; }
+      if (g.per > 0 && rndU() < g.per) { g.radio.perLoss++; break; }
+      // The handler may transmit, which prunes finished entries (this one).
+      std::vector<uint8_t> frame = std::move(tx.frame);
+      uint32_t from = tx.from, to = tx.to;
+      if (to == GW_TAG) gwOnFrame(from, frame.data(), frame.size());
+      else nodeOnFrame(g.nodes[to], frame.data(), frame.size());
+    } break;
+    case EV_GW_CMD:
+      gwIssueCommand();
+      schedule(g.now + (uint64_t)(-log(1.0 - rndU()) / g.cmdRate * 1e9), EV_GW_CMD, 0);
+      break;
+    case EV_GW_PUMP:
+      gwPump((uint32_t)e.arg);
+      break;
+    case EV_REPORT:
+      report(w);
+      schedule(g.now + reportNs, EV_REPORT, 0);
+      break;
+  }
+}
+
+static bool parseHostPort(const char* s, sockaddr_in* out) {
+  char host[64];
+  const char* colon = strrchr(s, ':');
+  if (!colon || (size_t)(colon - s) >= sizeof(host)) return false;
+  memcpy(host, s, (size_t)(colon - s));
+  host[colon - s] = '\0';
+  memset(out, 0, sizeof(*out));
+  out->sin_family = AF_INET;
+  out->sin_port = htons((uint16_t)atoi(colon + 1));
+  return inet_pton(AF_INET, host, &out->sin_addr) == 1;
+}
+
+int main(int argc, char** argv) {
+  uint32_t nodes = 100;
+  uint32_t telemMs = 1000;
+  double duration = 60;
+  double reportS = 10;
+  const char* ptyList = nullptr;
+  const char* gwStr = "127.0.0.1:8001";
+  int format = -1;
+  bool gwSim = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--link") && v) {
+      g.link = !strcmp(v, "pty") ? LINK_PTY : (!strcmp(v, "udp") ? LINK_UDP : LINK_RADIO);
+      i++;
+    }
+    else if (!strcmp(a, "--nodes") && v) { nodes = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--role") && v) { g.prof = !strcmp(v, "a") ? &PROFILE_A : &PROFILE_B; i++; }
+    else if (!strcmp(a, "--telem-ms") && v) { telemMs = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--duration") && v) { duration = atof(v); i++; }
+    else if (!strcmp(a, "--report-s") && v) { reportS = atof(v); i++; }
+    else if (!strcmp(a, "--format") && v) { format = !strcmp(v, "envelope") ? 1 : 0; i++; }
+    else if (!strcmp(a, "--rto-ms") && v) { g.rtoMs = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--cmd-rate") && v) { g.cmdRate = atof(v); i++; }
+    else if (!strcmp(a, "--retune-ms") && v) { g.retuneMs = (uint32_t)strtoul(v, nullptr, 0); i++; }
+    else if (!strcmp(a, "--per") && v) { g.per = atof(v); i++; }
+    else if (!strcmp(a, "--sf") && v) { g.sf = atoi(v); i++; }
+    else if (!strcmp(a, "--bw") && v) { g.bwKhz = atof(v); i++; }
+    else if (!strcmp(a, "--cr") && v) { g.cr = atoi(v); i++; }
+    else if (!strcmp(a, "--capture-db") && v) { g.captureDb = atof(v); i++; }
+    else if (!strcmp(a, "--ppm") && v) { g.ppm = atof(v); i++; }
+    else if (!strcmp(a, "--jitter-ms") && v) { g.jitterMs = atof(v); i++; }
+    else if (!strcmp(a, "--seed") && v) { g.rng ^= strtoull(v, nullptr, 0) * 0xD1B54A32D192ED03ull; i++; }
+    else if (!strcmp(a, "--pty-list") && v) { ptyList = v; i++; }
+    else if (!strcmp(a, "--gw") && v) { gwStr = v; i++; }
+    else if (!strcmp(a, "--gw-sim")) gwSim = true;
+    else {
+      fprintf(stderr,
+              "usage: %s [--link radio|udp|pty] [--nodes N] [--role a|b] [--telem-ms N]\n"
+              "       [--duration S] [--report-s S] [--format envelope|compact] [--rto-ms N]\n"
+              "       [--cmd-rate N] [--retune-ms N] [--per P] [--sf N] [--bw KHZ] [--cr 5..8]\n"
+              "       [--capture-db DB] [--ppm N] [--jitter-ms N]\n"
+              "       [--seed N] [--pty-list FILE] [--gw HOST:PORT] [--gw-sim]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!nodes || telemMs < 100 || g.sf < 6 || g.sf > 12 || g.cr < 5 || g.cr > 8) {
+    fprintf(stderr, "{\"error\":\"bad arguments\"}\n");
+    return 2;
+  }
+
+  g.virt = g.link == LINK_RADIO;
+  g.gwModel = g.link == LINK_RADIO || (g.link == LINK_UDP && gwSim);
+  g.envelopeBody = format < 0 ? g.link != LINK_RADIO : format == 1;
+  // RTO defaults follow the firmware's per-link constants.
+  uint32_t linkRto = g.link == LINK_RADIO ? 1800 : (g.link == LINK_UDP ? 500 : 120);
+  if (!g.rtoMs) g.rtoMs = linkRto;
+  g.gwRtoMs = linkRto;
+  g.maxAirNs = loraAirtimeNs(LORA_MAX_PACKET);
+  if (g.cmdRate > 0 && !g.gwModel) {
+    fprintf(stderr, "{\"warning\":\"--cmd-rate needs the gateway model (radio or --gw-sim)\"}\n");
+    g.cmdRate = 0;
+  }
+
+  // Two fds per pty node, one per UDP node.
+  struct rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  g.nodes.resize(nodes);
+  if (g.gwModel) g.peers.resize(nodes);
+  for (auto& gp : g.peers) mdp_arq_rx_init(&gp.rx);
+  for (uint32_t i = 0; i < nodes; i++) {
+    Node& n = g.nodes[i];
+    n.id = i;
+    n.telemMs = telemMs;
+    nodeArqInit(n);
+    n.clock = 1.0 + (rndU() * 2.0 - 1.0) * g.ppm * 1e-6;
+    n.rssi = -100.0 + rndN() * 8.0;
+    sensorInit(n.s);
+  }
+
+  if (g.link != LINK_RADIO) {
+    g.epfd = epoll_create1(0);
+    if (g.link == LINK_UDP && !parseHostPort(gwStr, &g.gwAddr)) {
+      fprintf(stderr, "{\"error\":\"bad --gw\",\"gw\":\"%s\"}\n", gwStr);
+      return 2;
+    }
+    bool ok = g.link == LINK_PTY ? setupPty(ptyList) : setupUdp();
+    if (!ok) {
+      fprintf(stderr, "{\"error\":\"transport setup\",\"errno\":%d}\n", errno);
+      return 1;
+    }
+  }
+
+  mdp_on_stop_signal(onSignal);
+  fprintf(stderr, "{\"nodes\":%u,\"status\":\"running\"}\n", nodes);
+
+  g.t0 = g.virt ? 0 : mdp_shm_now_ns();
+  g.now = 0;
+  for (auto& n : g.nodes) schedule((uint64_t)(rndU() * (double)n.telemMs * MS), EV_TELEM, n.id);
+  if (g.cmdRate > 0) schedule((uint64_t)(-log(1.0 - rndU()) / g.cmdRate * 1e9), EV_GW_CMD, 0);
+  const uint64_t reportNs = (uint64_t)(reportS * 1e9);
+  if (reportNs) schedule(reportNs, EV_REPORT, 0);
+  const uint64_t endNs = (uint64_t)(duration * 1e9);
+
+  Window w;
+  while (running) {
+    if (g.virt) {
+      if (g.heap.empty() || g.heap.top().t >= endNs) { g.now = endNs; break; }
+      Ev e = g.heap.top();
+      g.heap.pop();
+      g.now = e.t;
+      dispatch(e, reportNs, w);
+      continue;
+    }
+
+    g.now = clockNs();
+    if (g.now >= endNs) break;
+    while (!g.heap.empty() && g.heap.top().t <= g.now) {
+      Ev e = g.heap.top();
+      g.heap.pop();
+      dispatch(e, reportNs, w);
+    }
+    uint64_t next = g.heap.empty() ? g.now + 100 * MS : g.heap.top().t;
+    if (next > endNs) next = endNs;
+    int timeoutMs = next > g.now ? (int)((next - g.now + MS - 1) / MS) : 0;
+    if (timeoutMs > 100) timeoutMs = 100;
+    pollFds(timeoutMs);
+  }
+
+  summary((double)g.now / 1e9);
+
+  for (auto& n : g.nodes) {
+    if (n.fd >= 0) close(n.fd);
+    if (n.slaveFd >= 0) close(n.slaveFd);
+  }
+  if (g.gwFd >= 0) close(g.gwFd);
+  if (g.epfd >= 0) close(g.epfd);
+  return 0;
+}
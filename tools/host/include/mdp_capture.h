@@ -0,0 +1,70 @@
+#ifndef MDP_CAPTURE_H
+#define MDP_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// .mdpcap — raw timestamped bytes from one MDP link.
+//
+// File = header, then records until EOF. Everything little-endian.
+// A record is exactly what one read() returned on the link, so replay
+// reproduces the original chunking as well as the timing.
+//
+//   header  : magic "MDPCAP\r\n" | u16 version | u8 link | u8 dir
+//             | u32 baud | u64 start_unix_ns | u8 rsv[8]          (32 bytes)
+//   record  : u64 t_ns (since capture start) | u32 len | u32 rsv
+//             | bytes[len]
+
+#define MDP_CAP_MAGIC    "MDPCAP\r\n"
+#define MDP_CAP_VERSION  1
+#define MDP_CAP_MAX_REC  65536
+
+// mdp_cap_next() status codes (a record, even an empty one, returns >= 0)
+#define MDP_CAP_EOF      (-1)
+#define MDP_CAP_CORRUPT  (-2)
+
+enum MdpCapDir : uint8_t {
+  MDP_CAP_DIR_RX = 0,   // bytes received from the device
+  MDP_CAP_DIR_TX = 1    // bytes sent to the device
+};
+
+#pragma pack(push,1)
+typedef struct mdp_cap_hdr_t {
+  char     magic[8];
+  uint16_t version;
+  uint8_t  link;        // MdpShmLink
+  uint8_t  dir;         // MdpCapDir
+  uint32_t baud;
+  uint64_t start_unix_ns;
+  uint8_t  rsv[8];
+} mdp_cap_hdr_t;
+
+typedef struct mdp_cap_rec_t {
+  uint64_t t_ns;
+  uint32_t len;
+  uint32_t rsv;
+} mdp_cap_rec_t;
+#pragma pack(pop)
+
+// Writer: opens path and writes the header. Returns NULL on failure.
+FILE* mdp_cap_create(const char* path, uint8_t link, uint8_t dir, uint32_t baud);
+bool  mdp_cap_write(FILE* f, uint64_t t_ns, const uint8_t* data, uint32_t len);
+
+// Reader: validates the header. Returns NULL on failure.
+FILE* mdp_cap_open(const char* path, mdp_cap_hdr_t* hdr_out);
+// Reads the next record into buf (cap >= MDP_CAP_MAX_REC is always enough).
+// Returns record length (0 is a valid empty record), MDP_CAP_EOF at a
+// clean end of file, MDP_CAP_CORRUPT on a truncated/corrupt record.
+int   mdp_cap_next(FILE* f, mdp_cap_rec_t* rec, uint8_t* buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
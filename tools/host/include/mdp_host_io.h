@@ -0,0 +1,49 @@
+#ifndef MDP_HOST_IO_H
+#define MDP_HOST_IO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Open a tty in raw 8N1 mode at the given baud. "-" returns stdin.
+// Returns fd or -1 (errno set).
+int mdp_open_serial(const char* path, uint32_t baud);
+
+// "uart" | "lora" | "udp" | "ble" | "sim" -> MdpShmLink (unknown -> UART).
+uint8_t mdp_link_from_name(const char* name);
+
+// Route SIGINT/SIGTERM to handler without SA_RESTART, so a tool parked in a
+// blocking read() wakes up with EINTR and can shut down cleanly.
+void mdp_on_stop_signal(void (*handler)(int));
+
+// Accumulates a byte stream and yields complete COBS frames (without the
+// 0x00 delimiter). An over-long frame is dropped and counted, and its
+// remaining bytes are skipped up to the next delimiter.
+typedef struct mdp_frame_splitter_t {
+  uint8_t buf[2048];
+  size_t  len;
+  uint32_t overflows;
+  bool    discarding;     // past an overflow, skipping to the next 0x00
+} mdp_frame_splitter_t;
+
+static inline void mdp_splitter_init(mdp_frame_splitter_t* s) {
+  s->len = 0;
+  s->overflows = 0;
+  s->discarding = false;
+}
+
+// Feed bytes; on_frame(ctx, frame, len) runs once per delimiter. Returns the
+// number of frames emitted.
+size_t mdp_splitter_feed(mdp_frame_splitter_t* s, const uint8_t* data, size_t n,
+                         void (*on_frame)(void* ctx, const uint8_t* frame, size_t len),
+                         void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
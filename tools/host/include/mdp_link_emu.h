@@ -0,0 +1,107 @@
+#ifndef MDP_LINK_EMU_H
+#define MDP_LINK_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Lossy point-to-point link for host builds of the firmware protocol code.
+// Two directions (0 = A->B, 1 = B->A), each with its own impairments, driven
+// by the caller's virtual clock in ns. Frames are opaque bytes (normally a
+// COBS frame from mdp_build_frame), so CRC checks still run at the receiver.
+//
+// Per frame, in order:
+//   serialization  bytes*10/baud (UART 8N1), or LoRa airtime (Semtech
+//                  AN1200.13) when lora_sf is set. A direction sends one frame
+//                  at a time; up to queue_max more wait, the rest are dropped.
+//   half-duplex    (link-wide) LoRa-style: overlapping frames in opposite
+//                  directions are both lost, since neither side listens
+//                  before talking.
+//   loss           Gilbert-Elliott: per-frame good->bad / bad->good state
+//                  transitions, loss probability per state. ge_p_gb = 0 gives
+//                  plain independent loss.
+//   corrupt        one byte flipped.
+//   dup            delivered twice.
+//   latency/jitter fixed + uniform [0, jitter) propagation delay.
+//   reorder        held back an extra reorder_ms, so later frames overtake it.
+//   receive buffer at most inflight_max frames per direction may be in flight
+//                  or delivered but not yet polled; more are dropped, so a
+//                  stalled receiver bounds memory like a real link buffer.
+
+struct MdpLinkDirCfg {
+  double   loss = 0;          // loss probability in the good state
+  double   ge_p_gb = 0;       // P(good -> bad) per frame
+  double   ge_p_bg = 0.25;    // P(bad -> good) per frame
+  double   ge_loss_bad = 1.0; // loss probability in the bad state
+  double   corrupt = 0;
+  double   dup = 0;
+  double   latency_ms = 0;
+  double   jitter_ms = 0;
+  double   reorder = 0;
+  double   reorder_ms = 0;
+  uint32_t baud = 0;          // 0 = no serialization delay
+  int      lora_sf = 0;       // 6..12 selects LoRa airtime instead of baud
+  double   lora_bw_khz = 125.0;
+  int      lora_cr = 7;       // 4/5..4/8 -> 5..8
+  size_t   mtu = 0;           // larger frames are dropped (LoRa: 255)
+  uint32_t queue_max = 16;
+  uint32_t inflight_max = 64;
+};
+
+struct MdpLinkDirStats {
+  uint64_t offered = 0, delivered = 0;
+  uint64_t lost = 0, lost_burst = 0, collided = 0, queue_drop = 0, oversize = 0;
+  uint64_t overflow = 0;      // receive buffer full (inflight_max)
+  uint64_t corrupted = 0, duplicated = 0, reordered = 0;
+  uint64_t bytes = 0, air_ns = 0;
+};
+
+// Semtech AN1200.13; explicit header, CRC on, 8-symbol preamble.
+uint64_t mdp_lora_airtime_ns(size_t len, int sf, double bw_khz, int cr);
+
+class MdpLinkEmu {
+ public:
+  MdpLinkEmu(const MdpLinkDirCfg& ab, const MdpLinkDirCfg& ba, bool half_duplex, uint64_t seed);
+
+  // Hand a frame to direction dir at time now.
+  void send(int dir, uint64_t now, const uint8_t* data, size_t len);
+
+  // Time of the next delivery, UINT64_MAX if nothing is in flight.
+  uint64_t nextDelivery() const;
+
+  // Pop the earliest frame due at or before now. Returns false if none.
+  bool poll(uint64_t now, int* dir, std::vector<uint8_t>* out);
+
+  const MdpLinkDirCfg& cfg(int dir) const { return cfg_[dir]; }
+  const MdpLinkDirStats& stats(int dir) const { return st_[dir]; }
+
+ private:
+  struct Air {
+    uint64_t start, end;
+    bool collided;
+  };
+  struct Pending {
+    int dir;
+    std::shared_ptr<Air> air; // shared by duplicates, for collision marking
+    std::vector<uint8_t> data;
+  };
+
+  uint64_t airtime(int dir, size_t len) const;
+  bool lossDraw(int dir);
+  double rndU();
+
+  MdpLinkDirCfg cfg_[2];
+  MdpLinkDirStats st_[2];
+  bool halfDuplex_;
+  bool bad_[2] = {false, false};
+  uint64_t busyUntil_[2] = {0, 0};
+  std::vector<uint64_t> queued_[2];            // end times of frames not yet on air
+  std::vector<std::shared_ptr<Air>> recent_[2];  // frames that may still overlap
+  uint32_t inflight_[2] = {0, 0};              // entries of pending_ per direction
+  std::multimap<uint64_t, Pending> pending_;
+  uint64_t rng_;
+};
+
+#endif
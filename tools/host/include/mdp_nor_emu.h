@@ -0,0 +1,91 @@
+#ifndef MDP_NOR_EMU_H
+#define MDP_NOR_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include <mdp_storage.h>
+
+// File-backed NOR flash for host builds of the firmware storage paths, bound
+// to the storage HAL (mdp_flash_t). The image is mmap'd, so state survives
+// across runs like a real chip.
+//
+// NOR rules are enforced rather than assumed: a program ANDs into the array
+// (it can only clear bits) and any attempt to raise a 0 bit is counted as a
+// violation, i.e. a missing erase in the caller. Erase works on whole sectors
+// and bumps that sector's wear counter.
+//
+// Timing is modeled, not measured: each op adds the datasheet cost to
+// busyNs() (per page touched for programs, per sector for erases), so callers
+// can turn an API call into device latency by differencing busyNs().
+//
+// Power loss: armPowerLoss(n) lets n more bytes of work happen (an erase counts
+// as sector_size bytes), cuts the op in progress short (a partial program, or
+// a partially erased sector) and then fails every op until powerCycle().
+
+struct MdpNorTiming {
+  double op_us = 5;              // command/SPI overhead per call
+  double page_prog_us = 400;     // per page touched (W25Q/GD25Q typ.)
+  double sector_erase_us = 45000;
+  double read_mbps = 40;         // 80 MHz QIO
+};
+
+struct MdpNorStats {
+  uint64_t reads = 0, read_bytes = 0;
+  uint64_t programs = 0, page_programs = 0, program_bytes = 0;
+  uint64_t erases = 0;
+  uint64_t violations = 0;       // bits a program tried to raise 0 -> 1
+  uint64_t failed_ops = 0;       // rejected while powered down / out of range
+};
+
+class MdpNorEmu {
+ public:
+  MdpNorEmu() = default;
+  ~MdpNorEmu();
+  MdpNorEmu(const MdpNorEmu&) = delete;
+  MdpNorEmu& operator=(const MdpNorEmu&) = delete;
+
+  // Map path (created erased, or re-created if the size differs). Pass
+  // nullptr for an anonymous in-memory image.
+  bool open(const char* path, uint32_t sector_size, uint32_t sectors, uint32_t page_size = 256);
+  void close();
+
+  // Erase everything without counting wear (fresh chip).
+  void blank();
+
+  mdp_flash_t flash();
+
+  void armPowerLoss(uint64_t after_bytes);
+  void disarm() { armed_ = false; }
+  bool powered() const { return powered_; }
+  void powerCycle() { powered_ = true; armed_ = false; }
+
+  MdpNorTiming timing;
+  uint64_t busyNs() const { return busy_ns_; }
+  const MdpNorStats& stats() const { return st_; }
+  const std::vector<uint32_t>& eraseCounts() const { return erase_counts_; }
+  uint32_t sectorSize() const { return sector_size_; }
+  uint32_t sectors() const { return sectors_; }
+
+  bool read(uint32_t off, void* buf, size_t len);
+  bool write(uint32_t off, const void* buf, size_t len);
+  bool erase(uint32_t off);
+
+ private:
+  // Bytes of work allowed before the cut; returns len if unarmed.
+  size_t budget(size_t len);
+
+  uint8_t* mem_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  uint32_t sector_size_ = 0, sectors_ = 0, page_size_ = 256;
+  std::vector<uint32_t> erase_counts_;
+  MdpNorStats st_;
+  uint64_t busy_ns_ = 0;
+  bool powered_ = true;
+  bool armed_ = false;
+  uint64_t cut_after_ = 0;
+};
+
+#endif
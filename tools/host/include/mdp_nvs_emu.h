@@ -0,0 +1,83 @@
+#ifndef MDP_NVS_EMU_H
+#define MDP_NVS_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mdp_storage.h>
+
+#include "mdp_nor_emu.h"
+
+// ESP-IDF NVS cost model on top of MdpNorEmu, bound to the storage HAL
+// (mdp_kv_t), so Preferences-style code can be measured on host.
+//
+// Page geometry matches IDF: 4 KB page = 32 B header, 32 B entry-state bitmap
+// (2 bits per entry), 126 entries of 32 B. A value takes one entry if it fits
+// inline (<= 8 bytes), otherwise 1 + ceil(len / 32). set() programs the new
+// entries, marks them written, then marks the old copy erased, and writes
+// nothing when the stored value is identical (as IDF does). When only the
+// reserve page is free, the full page with the most erased entries is
+// compacted into it and erased.
+//
+// The key index lives in RAM (no remount): this measures cost and wear, it is
+// not a power-loss model. Use the flash log for that.
+
+struct MdpNvsStats {
+  uint64_t sets = 0;
+  uint64_t identical = 0;    // skipped, value unchanged
+  uint64_t gets = 0;
+  uint64_t entries = 0;      // 32-byte entries programmed (incl. GC copies)
+  uint64_t gc = 0;
+};
+
+class MdpNvsEmu {
+ public:
+  explicit MdpNvsEmu(MdpNorEmu* nor);
+
+  // Blank every page (no wear counted) and forget all keys.
+  void format();
+
+  size_t get(const char* key, void* buf, size_t cap);
+  bool set(const char* key, const void* buf, size_t len);
+
+  mdp_kv_t kv();
+  const MdpNvsStats& stats() const { return st_; }
+
+  static constexpr uint32_t PAGE = 4096;
+  static constexpr uint32_t ENTRIES = 126;
+  static constexpr uint32_t ENTRY = 32;
+
+ private:
+  enum PageState : uint8_t { FREE, ACTIVE, FULL };
+  struct Page {
+    PageState state = FREE;
+    uint32_t next = 0;       // first unused entry
+    uint32_t erased = 0;
+  };
+  struct Loc {
+    uint32_t page, entry, span;
+    size_t len;
+  };
+
+  uint32_t entryOff(uint32_t page, uint32_t entry) const;
+  void markEntries(uint32_t page, uint32_t entry, uint32_t span, bool erased);
+  void activate(uint32_t page);
+  void markFull(uint32_t page);
+  int firstFree() const;
+  uint32_t freePages() const;
+  bool gc();
+  bool alloc(uint32_t span, uint32_t* page, uint32_t* entry);
+  size_t dataOff(const Loc& l) const;
+
+  MdpNorEmu* nor_;
+  std::vector<Page> pages_;
+  std::map<std::string, Loc> idx_;
+  int active_ = -1;
+  uint32_t pageSeq_ = 0;
+  MdpNvsStats st_;
+};
+
+#endif
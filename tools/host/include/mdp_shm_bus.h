@@ -0,0 +1,146 @@
+#ifndef MDP_SHM_BUS_H
+#define MDP_SHM_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mdp_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// POSIX shared-memory broadcast ring for decoded MDP messages.
+//
+// One writer (the rail daemon) publishes every validated MDP payload into a
+// fixed ring of slots. Any number of local readers map the same segment and
+// follow the writer without ever blocking it (the only field a reader writes
+// is the parked-waiter count). Each slot is
+// guarded by a sequence lock: the writer marks it odd while copying and even
+// (2*n + 2 for message n) once published. A reader that finds a newer lock
+// value than it expects has been lapped and reports the overrun.
+//
+// Layout (little-endian, all offsets fixed for non-C consumers):
+//   mdp_shm_ring_hdr_t                  (256 bytes)
+//   slot[0..slot_count-1]               (slot_size bytes each)
+//     mdp_shm_slot_t                    (64 bytes)
+//     payload[slot_size - 64]           (raw MDP payload, header included)
+
+#define MDP_SHM_MAGIC    0x4250444Du   // "MDPB"
+#define MDP_SHM_VERSION  1
+
+#define MDP_SHM_DEFAULT_NAME       "/mycobrain.mdp"
+#define MDP_SHM_DEFAULT_SLOTS      4096
+#define MDP_SHM_DEFAULT_SLOT_SIZE  1024
+
+// Link the message arrived on (mirrors the rail legs in the MDP contracts).
+enum MdpShmLink : uint8_t {
+  MDP_LINK_UART = 0,
+  MDP_LINK_LORA = 1,
+  MDP_LINK_UDP  = 2,
+  MDP_LINK_BLE  = 3,
+  MDP_LINK_SIM  = 4
+};
+
+typedef struct mdp_shm_ring_hdr_t {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t hdr_size;
+  uint32_t slot_count;    // power of two
+  uint32_t slot_size;     // bytes per slot including mdp_shm_slot_t
+  uint64_t created_ns;    // CLOCK_REALTIME at creation
+  uint32_t writer_pid;
+  uint32_t rsv0;
+  uint8_t  pad0[32];
+
+  // Writer-owned, own cache line.
+  uint64_t write_seq;     // number of messages published so far
+  uint32_t notify;        // futex word, bumped on every publish
+  uint32_t waiters;       // readers currently parked on notify
+  uint8_t  pad1[48];
+
+  uint8_t  rsv[128];
+} mdp_shm_ring_hdr_t;
+
+typedef struct mdp_shm_slot_t {
+  uint64_t lock;          // seqlock: odd = being written, 2*n+2 = message n
+  uint64_t msg_seq;       // bus sequence n
+  uint64_t rx_ns;         // CLOCK_MONOTONIC when the frame was decoded
+  uint16_t payload_len;   // bytes in payload[]
+  uint8_t  link;          // MdpShmLink
+  uint8_t  rsv;
+  uint32_t rsv1;
+  mdp_hdr_v1_t mdp;       // copy of the decoded MDP header for cheap filtering
+  uint8_t  pad[16];
+} mdp_shm_slot_t;
+
+typedef struct mdp_shm_writer_t {
+  int fd;
+  size_t map_len;
+  mdp_shm_ring_hdr_t* ring;
+  uint8_t* slots;
+  char name[64];
+} mdp_shm_writer_t;
+
+typedef struct mdp_shm_reader_t {
+  int fd;
+  size_t map_len;
+  const mdp_shm_ring_hdr_t* ring;
+  const uint8_t* slots;
+  uint64_t next;          // next bus sequence this reader expects
+  uint64_t lost;          // messages skipped because the writer lapped us
+} mdp_shm_reader_t;
+
+// ---- writer ----
+
+// Create the segment. slot_count is rounded up to a power of two. An existing
+// segment is replaced only if it is stale (bad header, or its writer_pid is no
+// longer running). Returns 0 on success, -EEXIST if a live writer owns the
+// name, negative errno on other failures.
+int  mdp_shm_writer_open(mdp_shm_writer_t* w, const char* name,
+                         uint32_t slot_count, uint32_t slot_size);
+void mdp_shm_writer_close(mdp_shm_writer_t* w, bool unlink_segment);
+
+// Publish one MDP payload (header + body). Returns false if it does not fit
+// a slot or is shorter than an MDP header.
+bool mdp_shm_publish(mdp_shm_writer_t* w, uint8_t link, uint64_t rx_ns,
+                     const uint8_t* payload, uint16_t len);
+
+// ---- reader ----
+
+// Map an existing segment. New readers start at the writer's current
+// position (they only see messages published after subscribing).
+int  mdp_shm_reader_open(mdp_shm_reader_t* r, const char* name);
+void mdp_shm_reader_close(mdp_shm_reader_t* r);
+
+// Zero-copy read: returns a pointer to the next slot or NULL if nothing new.
+// The slot stays valid only until mdp_shm_reader_release() confirms that the
+// writer did not overwrite it in the meantime.
+const mdp_shm_slot_t* mdp_shm_reader_peek(mdp_shm_reader_t* r);
+
+// Finish consuming the slot returned by peek. Returns true if the data the
+// caller looked at was stable; false means it was overwritten mid-read and
+// must be discarded (counted in r->lost).
+bool mdp_shm_reader_release(mdp_shm_reader_t* r, const mdp_shm_slot_t* s);
+
+// Copying read for callers that hold data past the next publish.
+// Returns payload length, 0 if nothing new. *slot_out receives the metadata.
+size_t mdp_shm_reader_read(mdp_shm_reader_t* r, mdp_shm_slot_t* slot_out,
+                           uint8_t* payload_out, size_t payload_cap);
+
+// Park until the writer publishes something new or timeout_us elapses
+// (0 = return immediately, UINT32_MAX = forever).
+void mdp_shm_reader_wait(mdp_shm_reader_t* r, uint32_t timeout_us);
+
+static inline const uint8_t* mdp_shm_slot_payload(const mdp_shm_slot_t* s) {
+  return (const uint8_t*)s + sizeof(mdp_shm_slot_t);
+}
+
+uint64_t mdp_shm_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MDP_STATS_H
+#define MDP_STATS_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Latency sample set for the host tools' reports. Keeps raw samples (runs are
+// bounded) so percentiles are exact.
+struct MdpLatency {
+  std::vector<uint64_t> ns;
+
+  void add(uint64_t v) { ns.push_back(v); }
+  size_t count() const { return ns.size(); }
+  void clear() { ns.clear(); }
+
+  double pctUs(double p) {
+    if (ns.empty()) return 0.0;
+    size_t k = (size_t)(p * (double)(ns.size() - 1) + 0.5);
+    std::nth_element(ns.begin(), ns.begin() + (long)k, ns.end());
+    return (double)ns[k] / 1000.0;
+  }
+
+  double maxUs() const {
+    if (ns.empty()) return 0.0;
+    return (double)*std::max_element(ns.begin(), ns.end()) / 1000.0;
+  }
+
+  double meanUs() const {
+    if (ns.empty()) return 0.0;
+    long double s = 0;
+    for (uint64_t v : ns) s += v;
+    return (double)(s / ns.size()) / 1000.0;
+  }
+
+  // Prints `"<key>":{"n":..,"mean_us":..,"p50_us":..,...}` (no braces around).
+  void printJson(FILE* out, const char* key) {
+    fprintf(out, "\"%s\":{\"n\":%zu,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p90_us\":%.1f,"
+                 "\"p99_us\":%.1f,\"max_us\":%.1f}",
+            key, count(), meanUs(), pctUs(0.50), pctUs(0.90), pctUs(0.99), maxUs());
+  }
+};
+
+#endif
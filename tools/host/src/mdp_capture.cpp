@@ -0,0 +1,64 @@
+#include "mdp_capture.h"
+
+#include <string.h>
+#include <time.h>
+
+static_assert(sizeof(mdp_cap_hdr_t) == 32, "capture header layout is fixed");
+static_assert(sizeof(mdp_cap_rec_t) == 16, "capture record layout is fixed");
+
+FILE* mdp_cap_create(const char* path, uint8_t link, uint8_t dir, uint32_t baud) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return nullptr;
+
+  struct timespec rt;
+  clock_gettime(CLOCK_REALTIME, &rt);
+
+  mdp_cap_hdr_t h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, MDP_CAP_MAGIC, sizeof(h.magic));
+  h.version = MDP_CAP_VERSION;
+  h.link = link;
+  h.dir = dir;
+  h.baud = baud;
+  h.start_unix_ns = (uint64_t)rt.tv_sec * 1000000000ull + (uint64_t)rt.tv_nsec;
+  if (fwrite(&h, sizeof(h), 1, f) != 1) {
+    fclose(f);
+    return nullptr;
+  }
+  return f;
+}
+
+bool mdp_cap_write(FILE* f, uint64_t t_ns, const uint8_t* data, uint32_t len) {
+  if (!f || (!data && len)) return false;
+  if (len > MDP_CAP_MAX_REC) return false;
+  mdp_cap_rec_t r;
+  r.t_ns = t_ns;
+  r.len = len;
+  r.rsv = 0;
+  if (fwrite(&r, sizeof(r), 1, f) != 1) return false;
+  return len == 0 || fwrite(data, 1, len, f) == len;
+}
+
+FILE* mdp_cap_open(const char* path, mdp_cap_hdr_t* hdr_out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return nullptr;
+  mdp_cap_hdr_t h;
+  if (fread(&h, sizeof(h), 1, f) != 1 ||
+      memcmp(h.magic, MDP_CAP_MAGIC, sizeof(h.magic)) != 0 ||
+      h.version != MDP_CAP_VERSION) {
+    fclose(f);
+    return nullptr;
+  }
+  if (hdr_out) *hdr_out = h;
+  return f;
+}
+
+int mdp_cap_next(FILE* f, mdp_cap_rec_t* rec, uint8_t* buf, size_t cap) {
+  mdp_cap_rec_t r;
+  size_t got = fread(&r, 1, sizeof(r), f);
+  if (got == 0) return MDP_CAP_EOF;
+  if (got != sizeof(r) || r.len > MDP_CAP_MAX_REC || r.len > cap) return MDP_CAP_CORRUPT;
+  if (r.len && fread(buf, 1, r.len, f) != r.len) return MDP_CAP_CORRUPT;
+  if (rec) *rec = r;
+  return (int)r.len;
+}
@@ -0,0 +1,103 @@
+#include "mdp_host_io.h"
+#include "mdp_shm_bus.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static speed_t baudToSpeed(uint32_t baud) {
+  switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default:      return 0;
+  }
+}
+
+int mdp_open_serial(const char* path, uint32_t baud) {
+  if (!path) { errno = EINVAL; return -1; }
+  if (strcmp(path, "-") == 0) return STDIN_FILENO;
+
+  int fd = open(path, O_RDWR | O_NOCTTY);
+  if (fd < 0) return -1;
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) != 0) {
+    // Not a tty (plain file or FIFO): use as-is.
+    return fd;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  speed_t sp = baudToSpeed(baud);
+  if (sp) {
+    cfsetispeed(&tio, sp);
+    cfsetospeed(&tio, sp);
+  }
+  if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+    int e = errno;
+    close(fd);
+    errno = e;
+    return -1;
+  }
+  return fd;
+}
+
+size_t mdp_splitter_feed(mdp_frame_splitter_t* s, const uint8_t* data, size_t n,
+                         void (*on_frame)(void* ctx, const uint8_t* frame, size_t len),
+                         void* ctx) {
+  size_t frames = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t b = data[i];
+    if (b == 0x00) {
+      bool drop = s->discarding;
+      s->discarding = false;
+      if (s->len == 0 || drop) {
+        s->len = 0;
+        continue;
+      }
+      if (on_frame) on_frame(ctx, s->buf, s->len);
+      frames++;
+      s->len = 0;
+      continue;
+    }
+    if (s->discarding) continue;
+    if (s->len < sizeof(s->buf)) {
+      s->buf[s->len++] = b;
+    } else {
+      // The rest of the over-long frame is not a frame of its own.
+      s->len = 0;
+      s->overflows++;
+      s->discarding = true;
+    }
+  }
+  return frames;
+}
+
+uint8_t mdp_link_from_name(const char* name) {
+  if (!strcmp(name, "lora")) return MDP_LINK_LORA;
+  if (!strcmp(name, "udp")) return MDP_LINK_UDP;
+  if (!strcmp(name, "ble")) return MDP_LINK_BLE;
+  if (!strcmp(name, "sim")) return MDP_LINK_SIM;
+  return MDP_LINK_UART;
+}
+
+void mdp_on_stop_signal(void (*handler)(int)) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handler;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+}
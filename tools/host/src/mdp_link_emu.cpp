@@ -0,0 +1,127 @@
+#include "mdp_link_emu.h"
+
+#include <math.h>
+
+uint64_t mdp_lora_airtime_ns(size_t len, int sf, double bw_khz, int cr) {
+  double tsym = (double)(1u << sf) / (bw_khz * 1000.0);
+  int de = tsym > 0.016 ? 1 : 0;
+  double num = 8.0 * (double)len - 4.0 * sf + 28 + 16;
+  double nPay = 8 + fmax(ceil(num / (4.0 * (sf - 2 * de))) * cr, 0.0);
+  double t = (8 + 4.25) * tsym + nPay * tsym;
+  return (uint64_t)(t * 1e9);
+}
+
+MdpLinkEmu::MdpLinkEmu(const MdpLinkDirCfg& ab, const MdpLinkDirCfg& ba, bool half_duplex,
+                       uint64_t seed)
+    : halfDuplex_(half_duplex), rng_(seed * 0xD1B54A32D192ED03ull + 0x9E3779B97F4A7C15ull) {
+  cfg_[0] = ab;
+  cfg_[1] = ba;
+}
+
+double MdpLinkEmu::rndU() {
+  uint64_t x = rng_;
+  x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+  rng_ = x;
+  return (double)((x * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t MdpLinkEmu::airtime(int dir, size_t len) const {
+  const MdpLinkDirCfg& c = cfg_[dir];
+  if (c.lora_sf) return mdp_lora_airtime_ns(len, c.lora_sf, c.lora_bw_khz, c.lora_cr);
+  if (c.baud) return (uint64_t)len * 10ull * 1000000000ull / c.baud;
+  return 0;
+}
+
+// One Gilbert-Elliott step per frame, then the loss draw for the new state.
+bool MdpLinkEmu::lossDraw(int dir) {
+  const MdpLinkDirCfg& c = cfg_[dir];
+  if (c.ge_p_gb > 0) {
+    if (bad_[dir]) bad_[dir] = rndU() >= c.ge_p_bg;
+    else bad_[dir] = rndU() < c.ge_p_gb;
+  }
+  double p = bad_[dir] ? c.ge_loss_bad : c.loss;
+  if (p <= 0 || rndU() >= p) return false;
+  if (bad_[dir]) st_[dir].lost_burst++;
+  else st_[dir].lost++;
+  return true;
+}
+
+void MdpLinkEmu::send(int dir, uint64_t now, const uint8_t* data, size_t len) {
+  const MdpLinkDirCfg& c = cfg_[dir];
+  MdpLinkDirStats& st = st_[dir];
+  st.offered++;
+  if (c.mtu && len > c.mtu) { st.oversize++; return; }
+
+  // Frames still waiting for the transmitter.
+  std::vector<uint64_t>& q = queued_[dir];
+  size_t w = 0;
+  for (uint64_t s : q) if (s > now) q[w++] = s;
+  q.resize(w);
+  if (q.size() >= c.queue_max) { st.queue_drop++; return; }
+
+  uint64_t start = busyUntil_[dir] > now ? busyUntil_[dir] : now;
+  uint64_t end = start + airtime(dir, len);
+  busyUntil_[dir] = end;
+  if (start > now) q.push_back(start);
+  st.bytes += len;
+  st.air_ns += end - start;
+
+  std::shared_ptr<Air> air = std::make_shared<Air>(Air{start, end, false});
+  if (halfDuplex_) {
+    // Keep our own recent frames for the other direction to check against,
+    // and check against the other direction's.
+    for (int d = 0; d < 2; d++) {
+      std::vector<std::shared_ptr<Air>>& r = recent_[d];
+      size_t k = 0;
+      for (std::shared_ptr<Air>& a : r) if (a->end > now) r[k++] = std::move(a);
+      r.resize(k);
+    }
+    for (const std::shared_ptr<Air>& a : recent_[dir ^ 1]) {
+      if (a->end > start && a->start < end) {
+        a->collided = true;
+        air->collided = true;
+      }
+    }
+    recent_[dir].push_back(air);
+  }
+
+  if (lossDraw(dir)) return;
+
+  std::vector<uint8_t> copy(data, data + len);
+  if (c.corrupt > 0 && len && rndU() < c.corrupt) {
+    copy[(size_t)(rndU() * (double)len)] ^= (uint8_t)(1u + (unsigned)(rndU() * 255.0));
+    st.corrupted++;
+  }
+
+  int copies = (c.dup > 0 && rndU() < c.dup) ? 2 : 1;
+  if (copies == 2) st.duplicated++;
+  for (int i = 0; i < copies; i++) {
+    if (inflight_[dir] >= c.inflight_max) { st.overflow++; continue; }
+    uint64_t t = end + (uint64_t)((c.latency_ms + rndU() * c.jitter_ms) * 1e6);
+    if (c.reorder > 0 && rndU() < c.reorder) {
+      t += (uint64_t)(c.reorder_ms * 1e6);
+      st.reordered++;
+    }
+    pending_.emplace(t, Pending{dir, air, copy});
+    inflight_[dir]++;
+  }
+}
+
+uint64_t MdpLinkEmu::nextDelivery() const {
+  return pending_.empty() ? UINT64_MAX : pending_.begin()->first;
+}
+
+bool MdpLinkEmu::poll(uint64_t now, int* dir, std::vector<uint8_t>* out) {
+  while (!pending_.empty() && pending_.begin()->first <= now) {
+    auto it = pending_.begin();
+    Pending p = std::move(it->second);
+    pending_.erase(it);
+    inflight_[p.dir]--;
+    if (p.air->collided) { st_[p.dir].collided++; continue; }
+    st_[p.dir].delivered++;
+    *dir = p.dir;
+    *out = std::move(p.data);
+    return true;
+  }
+  return false;
+}
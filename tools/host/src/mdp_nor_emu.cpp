@@ -0,0 +1,132 @@
+#include "mdp_nor_emu.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MdpNorEmu::~MdpNorEmu() { close(); }
+
+bool MdpNorEmu::open(const char* path, uint32_t sector_size, uint32_t sectors, uint32_t page_size) {
+  close();
+  sector_size_ = sector_size;
+  sectors_ = sectors;
+  page_size_ = page_size ? page_size : sector_size;
+  size_ = (size_t)sector_size * sectors;
+  erase_counts_.assign(sectors, 0);
+  st_ = MdpNorStats();
+  busy_ns_ = 0;
+  powered_ = true;
+  armed_ = false;
+
+  if (!path) {
+    void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    mem_ = (uint8_t*)p;
+    mapped_ = true;
+    blank();
+    return true;
+  }
+
+  int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return false;
+  struct stat sb;
+  bool fresh = fstat(fd, &sb) != 0 || (size_t)sb.st_size != size_;
+  if (fresh && ftruncate(fd, (off_t)size_) != 0) {
+    ::close(fd);
+    return false;
+  }
+  void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+  mem_ = (uint8_t*)p;
+  mapped_ = true;
+  if (fresh) blank();
+  return true;
+}
+
+void MdpNorEmu::close() {
+  if (mapped_) {
+    msync(mem_, size_, MS_SYNC);
+    munmap(mem_, size_);
+  }
+  mem_ = nullptr;
+  mapped_ = false;
+}
+
+void MdpNorEmu::blank() {
+  if (mem_) memset(mem_, 0xFF, size_);
+}
+
+void MdpNorEmu::armPowerLoss(uint64_t after_bytes) {
+  armed_ = true;
+  cut_after_ = after_bytes;
+}
+
+size_t MdpNorEmu::budget(size_t len) {
+  if (!armed_) return len;
+  if (cut_after_ >= len) {
+    cut_after_ -= len;
+    return len;
+  }
+  size_t ok = (size_t)cut_after_;
+  armed_ = false;
+  powered_ = false;
+  return ok;
+}
+
+bool MdpNorEmu::read(uint32_t off, void* buf, size_t len) {
+  if (!powered_ || (size_t)off + len > size_) { st_.failed_ops++; return false; }
+  memcpy(buf, mem_ + off, len);
+  st_.reads++;
+  st_.read_bytes += len;
+  busy_ns_ += (uint64_t)(timing.op_us * 1000.0 + (double)len * 1000.0 / timing.read_mbps);
+  return true;
+}
+
+bool MdpNorEmu::write(uint32_t off, const void* buf, size_t len) {
+  if (!powered_ || (size_t)off + len > size_) { st_.failed_ops++; return false; }
+  const uint8_t* src = (const uint8_t*)buf;
+  size_t n = budget(len);
+  for (size_t i = 0; i < n; i++) {
+    uint8_t cur = mem_[off + i];
+    if (src[i] & ~cur) st_.violations++;
+    mem_[off + i] = cur & src[i];
+  }
+  if (len) {
+    uint64_t pages = (uint64_t)((off + len - 1) / page_size_ - off / page_size_ + 1);
+    st_.page_programs += pages;
+    busy_ns_ += (uint64_t)((timing.op_us + (double)pages * timing.page_prog_us) * 1000.0);
+  }
+  st_.programs++;
+  st_.program_bytes += n;
+  return n == len;
+}
+
+bool MdpNorEmu::erase(uint32_t off) {
+  if (!powered_ || off % sector_size_ || off >= size_) { st_.failed_ops++; return false; }
+  size_t n = budget(sector_size_);
+  // An interrupted erase leaves the sector partly erased.
+  memset(mem_ + off, 0xFF, n);
+  erase_counts_[off / sector_size_]++;
+  st_.erases++;
+  busy_ns_ += (uint64_t)((timing.op_us + timing.sector_erase_us) * 1000.0);
+  return n == sector_size_;
+}
+
+static bool norRead(void* ctx, uint32_t off, void* buf, size_t len) {
+  return ((MdpNorEmu*)ctx)->read(off, buf, len);
+}
+
+static bool norWrite(void* ctx, uint32_t off, const void* buf, size_t len) {
+  return ((MdpNorEmu*)ctx)->write(off, buf, len);
+}
+
+static bool norErase(void* ctx, uint32_t off) {
+  return ((MdpNorEmu*)ctx)->erase(off);
+}
+
+mdp_flash_t MdpNorEmu::flash() {
+  return mdp_flash_t{ norRead, norWrite, norErase, this, sector_size_, sectors_ };
+}
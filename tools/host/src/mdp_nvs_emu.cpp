@@ -0,0 +1,184 @@
+#include "mdp_nvs_emu.h"
+
+#include <string.h>
+
+static constexpr uint32_t HDR_BYTES = 32;
+static constexpr uint32_t BITMAP_OFF = 32;
+static constexpr uint32_t ENTRIES_OFF = 64;
+static constexpr size_t INLINE_MAX = 8;
+
+MdpNvsEmu::MdpNvsEmu(MdpNorEmu* nor) : nor_(nor) {
+  pages_.resize(nor->sectors() * nor->sectorSize() / PAGE);
+}
+
+void MdpNvsEmu::format() {
+  nor_->blank();
+  for (Page& p : pages_) p = Page();
+  idx_.clear();
+  active_ = -1;
+}
+
+uint32_t MdpNvsEmu::entryOff(uint32_t page, uint32_t entry) const {
+  return page * PAGE + ENTRIES_OFF + entry * ENTRY;
+}
+
+size_t MdpNvsEmu::dataOff(const Loc& l) const {
+  // Inline values sit in the last 8 bytes of the header entry.
+  return l.span == 1 ? entryOff(l.page, l.entry) + ENTRY - INLINE_MAX
+                     : entryOff(l.page, l.entry + 1);
+}
+
+// 2 bits per entry: 11 empty, 10 written, 00 erased. Read-modify-write of the
+// bitmap bytes covering [entry, entry + span), as IDF does.
+void MdpNvsEmu::markEntries(uint32_t page, uint32_t entry, uint32_t span, bool erased) {
+  uint32_t b0 = entry / 4, b1 = (entry + span - 1) / 4;
+  uint8_t bits[ENTRIES / 4 + 1];
+  nor_->read(page * PAGE + BITMAP_OFF + b0, bits, b1 - b0 + 1);
+  for (uint32_t e = entry; e < entry + span; e++) {
+    uint8_t mask = (uint8_t)((erased ? 3u : 1u) << ((e % 4) * 2));
+    bits[e / 4 - b0] &= (uint8_t)~mask;
+  }
+  nor_->write(page * PAGE + BITMAP_OFF + b0, bits, b1 - b0 + 1);
+}
+
+void MdpNvsEmu::activate(uint32_t page) {
+  uint8_t hdr[HDR_BYTES];
+  memset(hdr, 0xFF, sizeof(hdr));
+  uint32_t state = 0xFFFFFFFEu;
+  uint32_t seq = ++pageSeq_;
+  memcpy(hdr, &state, 4);
+  memcpy(hdr + 4, &seq, 4);
+  nor_->write(page * PAGE, hdr, sizeof(hdr));
+  pages_[page].state = ACTIVE;
+  pages_[page].next = 0;
+  pages_[page].erased = 0;
+  active_ = (int)page;
+}
+
+void MdpNvsEmu::markFull(uint32_t page) {
+  uint32_t state = 0xFFFFFFFCu;
+  nor_->write(page * PAGE, &state, 4);
+  pages_[page].state = FULL;
+  if (active_ == (int)page) active_ = -1;
+}
+
+int MdpNvsEmu::firstFree() const {
+  for (uint32_t p = 0; p < pages_.size(); p++) if (pages_[p].state == FREE) return (int)p;
+  return -1;
+}
+
+uint32_t MdpNvsEmu::freePages() const {
+  uint32_t n = 0;
+  for (const Page& p : pages_) n += p.state == FREE ? 1 : 0;
+  return n;
+}
+
+// Compact the full page with the most erased entries into the reserve page.
+bool MdpNvsEmu::gc() {
+  int victim = -1;
+  for (uint32_t p = 0; p < pages_.size(); p++) {
+    if (pages_[p].state != FULL || pages_[p].erased == 0) continue;
+    if (victim < 0 || pages_[p].erased > pages_[victim].erased) victim = (int)p;
+  }
+  int dst = firstFree();
+  if (victim < 0 || dst < 0) return false;
+  st_.gc++;
+  activate((uint32_t)dst);
+  uint8_t buf[ENTRIES * ENTRY];
+  for (auto& kv : idx_) {
+    Loc& l = kv.second;
+    if (l.page != (uint32_t)victim) continue;
+    nor_->read(entryOff(l.page, l.entry), buf, l.span * ENTRY);
+    Page& d = pages_[dst];
+    nor_->write(entryOff(dst, d.next), buf, l.span * ENTRY);
+    markEntries(dst, d.next, l.span, false);
+    st_.entries += l.span;
+    l.page = (uint32_t)dst;
+    l.entry = d.next;
+    d.next += l.span;
+  }
+  nor_->erase((uint32_t)victim * PAGE);
+  pages_[victim] = Page();
+  return true;
+}
+
+bool MdpNvsEmu::alloc(uint32_t span, uint32_t* page, uint32_t* entry) {
+  for (size_t tries = 0; tries <= 2 * pages_.size(); tries++) {
+    if (active_ >= 0 && pages_[active_].next + span <= ENTRIES) {
+      *page = (uint32_t)active_;
+      *entry = pages_[active_].next;
+      pages_[active_].next += span;
+      return true;
+    }
+    if (active_ >= 0) markFull((uint32_t)active_);
+    if (freePages() > 1) {
+      activate((uint32_t)firstFree());
+      continue;
+    }
+    if (!gc()) return false;
+  }
+  return false;
+}
+
+size_t MdpNvsEmu::get(const char* key, void* buf, size_t cap) {
+  st_.gets++;
+  auto it = idx_.find(key);
+  if (it == idx_.end()) return 0;
+  const Loc& l = it->second;
+  if (l.len <= cap) nor_->read((uint32_t)dataOff(l), buf, l.len);
+  return l.len;
+}
+
+bool MdpNvsEmu::set(const char* key, const void* buf, size_t len) {
+  st_.sets++;
+  const uint32_t span = len <= INLINE_MAX ? 1 : 1 + (uint32_t)((len + ENTRY - 1) / ENTRY);
+  if (span > ENTRIES) return false;
+
+  auto it = idx_.find(key);
+  if (it != idx_.end() && it->second.len == len) {
+    uint8_t cur[ENTRIES * ENTRY];
+    nor_->read((uint32_t)dataOff(it->second), cur, len);
+    if (memcmp(cur, buf, len) == 0) {
+      st_.identical++;
+      return true;
+    }
+  }
+
+  uint32_t page, entry;
+  if (!alloc(span, &page, &entry)) return false;
+  uint8_t out[ENTRIES * ENTRY];
+  memset(out, 0xFF, span * ENTRY);
+  out[0] = 1;                                  // namespace index
+  out[1] = span == 1 ? 0x04 : 0x42;            // u32-ish / blob data
+  out[2] = (uint8_t)span;
+  out[3] = 0xFF;                               // chunk index
+  memset(out + 4, 0, 4);                       // crc (not modeled)
+  strncpy((char*)out + 8, key, 16);
+  const Loc loc = { page, entry, span, len };
+  memcpy(out + (dataOff(loc) - entryOff(page, entry)), buf, len);
+  nor_->write(entryOff(page, entry), out, span * ENTRY);
+  markEntries(page, entry, span, false);
+  st_.entries += span;
+
+  if (it != idx_.end()) {
+    const Loc& old = it->second;
+    markEntries(old.page, old.entry, old.span, true);
+    pages_[old.page].erased += old.span;
+    it->second = loc;
+  } else {
+    idx_[key] = loc;
+  }
+  return true;
+}
+
+static size_t nvsGet(void* ctx, const char* key, void* buf, size_t cap) {
+  return ((MdpNvsEmu*)ctx)->get(key, buf, cap);
+}
+
+static bool nvsSet(void* ctx, const char* key, const void* buf, size_t len) {
+  return ((MdpNvsEmu*)ctx)->set(key, buf, len);
+}
+
+mdp_kv_t MdpNvsEmu::kv() {
+  return mdp_kv_t{ nvsGet, nvsSet, this };
+}
@@ -0,0 +1,278 @@
+#include "mdp_shm_bus.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(mdp_shm_ring_hdr_t) == 256, "ring header layout is ABI");
+static_assert(sizeof(mdp_shm_slot_t) == 64, "slot header layout is ABI");
+static_assert(offsetof(mdp_shm_ring_hdr_t, write_seq) == 64, "write_seq owns a cache line");
+
+uint64_t mdp_shm_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t roundPow2(uint32_t v) {
+  uint32_t p = 1;
+  while (p < v && p < (1u << 30)) p <<= 1;
+  return p;
+}
+
+static long futexCall(uint32_t* addr, int op, uint32_t val, const struct timespec* ts) {
+  return syscall(SYS_futex, addr, op, val, ts, nullptr, 0);
+}
+
+static inline const mdp_shm_slot_t* slotAt(const uint8_t* slots, const mdp_shm_ring_hdr_t* ring,
+                                           uint64_t n) {
+  return (const mdp_shm_slot_t*)(slots + (size_t)(n & (ring->slot_count - 1)) * ring->slot_size);
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+// A segment is stale if its header is incomplete or foreign, or the writer
+// that created it is no longer running. A live writer's segment is not.
+static bool segmentStale(const char* name) {
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) return true;
+  bool stale = true;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(mdp_shm_ring_hdr_t)) {
+    void* p = mmap(nullptr, sizeof(mdp_shm_ring_hdr_t), PROT_READ, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) {
+      const mdp_shm_ring_hdr_t* h = (const mdp_shm_ring_hdr_t*)p;
+      pid_t pid = (pid_t)h->writer_pid;
+      if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) == MDP_SHM_MAGIC &&
+          h->version == MDP_SHM_VERSION && pid > 0) {
+        stale = kill(pid, 0) != 0 && errno == ESRCH;
+      }
+      munmap(p, sizeof(mdp_shm_ring_hdr_t));
+    }
+  }
+  close(fd);
+  return stale;
+}
+
+int mdp_shm_writer_open(mdp_shm_writer_t* w, const char* name,
+                        uint32_t slot_count, uint32_t slot_size) {
+  if (!w || !name) return -EINVAL;
+  memset(w, 0, sizeof(*w));
+  w->fd = -1;
+
+  slot_count = roundPow2(slot_count ? slot_count : MDP_SHM_DEFAULT_SLOTS);
+  slot_size = (slot_size + 63u) & ~63u;
+  if (slot_size < sizeof(mdp_shm_slot_t) + sizeof(mdp_hdr_v1_t)) return -EINVAL;
+
+  strncpy(w->name, name, sizeof(w->name) - 1);
+  // Replace a stale segment so readers never see a layout mismatch, but never
+  // take the name from a writer that is still publishing.
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    if (!segmentStale(name)) return -EEXIST;
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  }
+  if (fd < 0) return -errno;
+
+  size_t len = sizeof(mdp_shm_ring_hdr_t) + (size_t)slot_count * slot_size;
+  if (ftruncate(fd, (off_t)len) != 0) {
+    int e = errno;
+    close(fd);
+    shm_unlink(name);
+    return -e;
+  }
+
+  void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    int e = errno;
+    close(fd);
+    shm_unlink(name);
+    return -e;
+  }
+
+  w->fd = fd;
+  w->map_len = len;
+  w->ring = (mdp_shm_ring_hdr_t*)p;
+  w->slots = (uint8_t*)p + sizeof(mdp_shm_ring_hdr_t);
+
+  struct timespec rt;
+  clock_gettime(CLOCK_REALTIME, &rt);
+
+  mdp_shm_ring_hdr_t* h = w->ring;
+  h->version = MDP_SHM_VERSION;
+  h->hdr_size = sizeof(mdp_shm_ring_hdr_t);
+  h->slot_count = slot_count;
+  h->slot_size = slot_size;
+  h->created_ns = (uint64_t)rt.tv_sec * 1000000000ull + (uint64_t)rt.tv_nsec;
+  h->writer_pid = (uint32_t)getpid();
+  // Magic last: readers refuse to attach until the header is complete.
+  __atomic_store_n(&h->magic, MDP_SHM_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+void mdp_shm_writer_close(mdp_shm_writer_t* w, bool unlink_segment) {
+  if (!w) return;
+  if (w->ring) munmap(w->ring, w->map_len);
+  if (w->fd >= 0) close(w->fd);
+  if (unlink_segment && w->name[0]) shm_unlink(w->name);
+  w->ring = nullptr;
+  w->slots = nullptr;
+  w->fd = -1;
+}
+
+bool mdp_shm_publish(mdp_shm_writer_t* w, uint8_t link, uint64_t rx_ns,
+                     const uint8_t* payload, uint16_t len) {
+  if (!w || !w->ring || !payload) return false;
+  if (len < sizeof(mdp_hdr_v1_t)) return false;
+  mdp_shm_ring_hdr_t* h = w->ring;
+  if ((size_t)len + sizeof(mdp_shm_slot_t) > h->slot_size) return false;
+
+  uint64_t n = h->write_seq;  // only this process writes it
+  mdp_shm_slot_t* s = (mdp_shm_slot_t*)slotAt(w->slots, h, n);
+
+  __atomic_store_n(&s->lock, 2 * n + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  s->msg_seq = n;
+  s->rx_ns = rx_ns;
+  s->payload_len = len;
+  s->link = link;
+  memcpy(&s->mdp, payload, sizeof(mdp_hdr_v1_t));
+  memcpy((uint8_t*)s + sizeof(mdp_shm_slot_t), payload, len);
+
+  __atomic_store_n(&s->lock, 2 * n + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&h->write_seq, n + 1, __ATOMIC_RELEASE);
+
+  // seq_cst pairs with the reader's waiter increment so a wake is never lost.
+  __atomic_add_fetch(&h->notify, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&h->waiters, __ATOMIC_SEQ_CST) != 0) {
+    futexCall(&h->notify, FUTEX_WAKE, INT32_MAX, nullptr);
+  }
+  return true;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+int mdp_shm_reader_open(mdp_shm_reader_t* r, const char* name) {
+  if (!r || !name) return -EINVAL;
+  memset(r, 0, sizeof(*r));
+  r->fd = -1;
+
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) return -errno;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mdp_shm_ring_hdr_t)) {
+    close(fd);
+    return -EPROTO;
+  }
+
+  void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    int e = errno;
+    close(fd);
+    return -e;
+  }
+
+  const mdp_shm_ring_hdr_t* h = (const mdp_shm_ring_hdr_t*)p;
+  size_t need = sizeof(mdp_shm_ring_hdr_t) + (size_t)h->slot_count * h->slot_size;
+  if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != MDP_SHM_MAGIC ||
+      h->version != MDP_SHM_VERSION || h->slot_count == 0 ||
+      (h->slot_count & (h->slot_count - 1)) != 0 || need > (size_t)st.st_size) {
+    munmap(p, (size_t)st.st_size);
+    close(fd);
+    return -EPROTO;
+  }
+
+  r->fd = fd;
+  r->map_len = (size_t)st.st_size;
+  r->ring = h;
+  r->slots = (const uint8_t*)p + sizeof(mdp_shm_ring_hdr_t);
+  r->next = __atomic_load_n(&h->write_seq, __ATOMIC_ACQUIRE);
+  return 0;
+}
+
+void mdp_shm_reader_close(mdp_shm_reader_t* r) {
+  if (!r) return;
+  if (r->ring) munmap((void*)r->ring, r->map_len);
+  if (r->fd >= 0) close(r->fd);
+  r->ring = nullptr;
+  r->slots = nullptr;
+  r->fd = -1;
+}
+
+const mdp_shm_slot_t* mdp_shm_reader_peek(mdp_shm_reader_t* r) {
+  if (!r || !r->ring) return nullptr;
+  const mdp_shm_ring_hdr_t* h = r->ring;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    const mdp_shm_slot_t* s = slotAt(r->slots, h, r->next);
+    uint64_t want = 2 * r->next + 2;
+    uint64_t lock = __atomic_load_n(&s->lock, __ATOMIC_ACQUIRE);
+    if (lock == want) return s;
+    if (lock < want) return nullptr;  // not published yet (or mid-write)
+
+    // Lapped: jump to the oldest message that can still be intact.
+    uint64_t ws = __atomic_load_n(&h->write_seq, __ATOMIC_ACQUIRE);
+    uint64_t oldest = (ws > h->slot_count) ? ws - h->slot_count + 1 : 0;
+    if (oldest > r->next) {
+      r->lost += oldest - r->next;
+      r->next = oldest;
+    } else {
+      r->lost++;
+      r->next++;
+    }
+  }
+  return nullptr;
+}
+
+bool mdp_shm_reader_release(mdp_shm_reader_t* r, const mdp_shm_slot_t* s) {
+  if (!r || !s) return false;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  uint64_t lock = __atomic_load_n(&s->lock, __ATOMIC_RELAXED);
+  bool ok = (lock == 2 * r->next + 2);
+  if (!ok) r->lost++;
+  r->next++;
+  return ok;
+}
+
+size_t mdp_shm_reader_read(mdp_shm_reader_t* r, mdp_shm_slot_t* slot_out,
+                           uint8_t* payload_out, size_t payload_cap) {
+  for (;;) {
+    const mdp_shm_slot_t* s = mdp_shm_reader_peek(r);
+    if (!s) return 0;
+    size_t len = s->payload_len;
+    if (len > payload_cap) len = payload_cap;
+    if (slot_out) memcpy(slot_out, s, sizeof(*slot_out));
+    if (payload_out) memcpy(payload_out, mdp_shm_slot_payload(s), len);
+    if (mdp_shm_reader_release(r, s)) return len;
+  }
+}
+
+void mdp_shm_reader_wait(mdp_shm_reader_t* r, uint32_t timeout_us) {
+  if (!r || !r->ring || timeout_us == 0) return;
+  mdp_shm_ring_hdr_t* h = (mdp_shm_ring_hdr_t*)r->ring;
+
+  uint32_t seen = __atomic_load_n(&h->notify, __ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&h->write_seq, __ATOMIC_ACQUIRE) > r->next) return;
+
+  struct timespec ts;
+  ts.tv_sec = timeout_us / 1000000u;
+  ts.tv_nsec = (long)(timeout_us % 1000000u) * 1000;
+
+  __atomic_add_fetch(&h->waiters, 1, __ATOMIC_SEQ_CST);
+  futexCall(&h->notify, FUTEX_WAIT, seen, timeout_us == UINT32_MAX ? nullptr : &ts);
+  __atomic_sub_fetch(&h->waiters, 1, __ATOMIC_ACQ_REL);
+}
@@ -0,0 +1,64 @@
+// Stand-in crypto hooks for the MycoEnvelope builder (mycobrain/myco-iot-stack/
+// embedded/c), so the host tools build the same signed CBOR envelopes as
+// Side-A without a crypto library. NOT cryptographic: h and z are a fast mix
+// of the input, which gives them the right length and makes them as
+// incompressible as the real BLAKE2b/Ed25519 output. verify() accepts what
+// sign() produced for the same message.
+
+#include <myco_envelope.h>
+
+#include <string.h>
+
+static uint64_t mix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+static uint64_t fnv1a(uint64_t h, const uint8_t* p, size_t n) {
+  for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 0x100000001B3ull;
+  return h;
+}
+
+static void expand(uint64_t seed, uint8_t* out, size_t n) {
+  for (size_t i = 0; i < n; i += 8) {
+    uint64_t v = mix64(seed + i);
+    memcpy(out + i, &v, n - i < 8 ? n - i : 8);
+  }
+}
+
+extern "C" {
+
+void myco_hash256_init(myco_hash256_ctx_t* ctx) {
+  ctx->opaque[0] = 0xCBF29CE484222325ull;
+}
+
+void myco_hash256_update(myco_hash256_ctx_t* ctx, const uint8_t* msg, size_t msg_len) {
+  ctx->opaque[0] = fnv1a(ctx->opaque[0], msg, msg_len);
+}
+
+void myco_hash256_final(myco_hash256_ctx_t* ctx, uint8_t out32[32]) {
+  expand(ctx->opaque[0], out32, 32);
+}
+
+void myco_hash256(uint8_t out32[32], const uint8_t* msg, size_t msg_len) {
+  myco_hash256_ctx_t c;
+  myco_hash256_init(&c);
+  myco_hash256_update(&c, msg, msg_len);
+  myco_hash256_final(&c, out32);
+}
+
+void myco_ed25519_sign(uint8_t sig64[64], const uint8_t sk64[64], const uint8_t* msg, size_t msg_len) {
+  (void)sk64;
+  expand(fnv1a(0x84222325CBF29CE4ull, msg, msg_len), sig64, 64);
+}
+
+int myco_ed25519_verify(const uint8_t pk32[32], const uint8_t* msg, size_t msg_len, const uint8_t sig64[64]) {
+  (void)pk32;
+  uint8_t want[64];
+  myco_ed25519_sign(want, nullptr, msg, msg_len);
+  return memcmp(want, sig64, sizeof(want)) == 0 ? 1 : 0;
+}
+
+}